@@ -0,0 +1,84 @@
+#include "GAAPrecompiledHeader.h"
+#include "AllocationTracker.h"
+#include <cstdlib>
+#include <new>
+
+//Constant initialized, so the counter is valid even for allocations made by other static constructors before main.
+std::atomic<uint64_t> AllocationTracker::s_TotalAllocations(0);
+uint64_t AllocationTracker::s_FrameStartAllocations = 0;
+uint64_t AllocationTracker::s_LastFrameAllocations = 0;
+uint64_t AllocationTracker::s_FrameIndex = 0;
+bool AllocationTracker::s_Warned = false;
+
+void AllocationTracker::EndFrame()
+{
+	uint64_t total = GetTotalAllocationCount();
+	s_LastFrameAllocations = total - s_FrameStartAllocations;
+	s_FrameStartAllocations = total;
+
+	if (++s_FrameIndex > s_WarmUpFrames && s_LastFrameAllocations > 0 && !s_Warned)
+	{
+		s_Warned = true;
+		std::cout << "Warning: Frame " << s_FrameIndex << " made " << s_LastFrameAllocations << " heap allocations after warming up! \n";
+	}
+}
+
+namespace
+{
+	void* AllocateTracked(size_t size)
+	{
+		AllocationTracker::RecordAllocation();
+		void* memory = std::malloc(size ? size : 1);
+		if (memory == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+
+	void* AllocateTrackedAligned(size_t size, size_t alignment)
+	{
+		AllocationTracker::RecordAllocation();
+#ifdef _MSC_VER
+		void* memory = _aligned_malloc(size ? size : 1, alignment);
+#else
+		void* memory = nullptr;
+		if (posix_memalign(&memory, alignment, size ? size : 1) != 0)
+		{
+			memory = nullptr;
+		}
+#endif
+		if (memory == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+
+	void FreeTrackedAligned(void* memory)
+	{
+#ifdef _MSC_VER
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+}
+
+void* operator new(size_t size) { return AllocateTracked(size); }
+void* operator new[](size_t size) { return AllocateTracked(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { try { return AllocateTracked(size); } catch (...) { return nullptr; } }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { try { return AllocateTracked(size); } catch (...) { return nullptr; } }
+void* operator new(size_t size, std::align_val_t alignment) { return AllocateTrackedAligned(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return AllocateTrackedAligned(size, (size_t)alignment); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { FreeTrackedAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { FreeTrackedAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { FreeTrackedAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { FreeTrackedAligned(memory); }
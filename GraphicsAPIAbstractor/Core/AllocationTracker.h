@@ -0,0 +1,25 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+//Counts every heap allocation made through operator new. AllocationTracker.cpp replaces the global operators, so this sees the STL's allocations as well as ours.
+//The render loop is expected to run without any once it has warmed up, and GetLastFrameAllocationCount() is how we check that.
+class AllocationTracker
+{
+public:
+	static void EndFrame(); //Snapshots this frame's count and starts the next. Warns the first time a frame past s_WarmUpFrames allocates.
+
+	inline static uint64_t GetTotalAllocationCount() { return s_TotalAllocations.load(std::memory_order_relaxed); }
+	inline static uint64_t GetLastFrameAllocationCount() { return s_LastFrameAllocations; }
+
+	inline static void RecordAllocation() { s_TotalAllocations.fetch_add(1, std::memory_order_relaxed); }
+
+	static constexpr uint64_t s_WarmUpFrames = 120; //Enough for pools, caches and frame buffers to have grown to what they need.
+
+private:
+	static std::atomic<uint64_t> s_TotalAllocations;
+	static uint64_t s_FrameStartAllocations;
+	static uint64_t s_LastFrameAllocations;
+	static uint64_t s_FrameIndex;
+	static bool s_Warned; //Only once, as a loop that allocates tends to do it every frame.
+};
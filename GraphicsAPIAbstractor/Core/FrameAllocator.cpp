@@ -0,0 +1,103 @@
+#include "GAAPrecompiledHeader.h"
+#include "FrameAllocator.h"
+
+std::vector<std::unique_ptr<LinearAllocator>> FrameAllocator::s_Arenas = []()
+{
+	std::vector<std::unique_ptr<LinearAllocator>> arenas; //unique_ptr can't be copied out of an initializer list.
+	arenas.push_back(std::make_unique<LinearAllocator>(FrameAllocator::s_DefaultCapacity));
+	arenas.push_back(std::make_unique<LinearAllocator>(FrameAllocator::s_DefaultCapacity));
+	return arenas;
+}();
+std::vector<std::vector<void*>> FrameAllocator::s_OverflowBlocks(2);
+std::mutex FrameAllocator::s_OverflowMutex;
+std::atomic<unsigned int> FrameAllocator::s_CurrentArena(0);
+size_t FrameAllocator::s_OverflowCount = 0;
+
+LinearAllocator::LinearAllocator(size_t capacityInBytes) : m_Memory(new unsigned char[capacityInBytes]), m_Capacity(capacityInBytes), m_Offset(0), m_HighWaterMark(0)
+{
+}
+
+LinearAllocator::~LinearAllocator()
+{
+	delete[] m_Memory;
+}
+
+void* LinearAllocator::Allocate(size_t size, size_t alignment)
+{
+	//We align the actual address rather than the offset, so alignments larger than what new[] gave us still work.
+	uintptr_t base = (uintptr_t)m_Memory;
+	size_t offset = m_Offset.load(std::memory_order_relaxed);
+	size_t alignedOffset, newOffset;
+	do
+	{
+		alignedOffset = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+		newOffset = alignedOffset + size;
+		if (newOffset > m_Capacity)
+		{
+			return nullptr;
+		}
+	} while (!m_Offset.compare_exchange_weak(offset, newOffset, std::memory_order_relaxed));
+
+	return m_Memory + alignedOffset;
+}
+
+void LinearAllocator::Reset()
+{
+	m_HighWaterMark = std::max(m_HighWaterMark, m_Offset.load(std::memory_order_relaxed));
+	m_Offset.store(0, std::memory_order_relaxed);
+}
+
+void FrameAllocator::Initialize(size_t capacityPerFrameInBytes)
+{
+	for (std::unique_ptr<LinearAllocator>& arena : s_Arenas)
+	{
+		arena = std::make_unique<LinearAllocator>(capacityPerFrameInBytes);
+	}
+}
+
+void FrameAllocator::ReserveArenas(unsigned int arenaCount)
+{
+	//New arenas join the ring after the last one, empty, so no memory handed out so far is reset any sooner than it would have been.
+	size_t capacity = s_Arenas[0]->GetCapacity();
+	std::lock_guard<std::mutex> lock(s_OverflowMutex);
+	while (s_Arenas.size() < arenaCount)
+	{
+		s_Arenas.push_back(std::make_unique<LinearAllocator>(capacity));
+		s_OverflowBlocks.emplace_back();
+	}
+}
+
+void* FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+	unsigned int arena = s_CurrentArena.load(std::memory_order_acquire);
+	void* memory = s_Arenas[arena]->Allocate(size, alignment);
+	if (memory != nullptr)
+	{
+		return memory;
+	}
+
+	//Out of frame memory. Rather than fail, we fall back to the heap and free it with the arena. The overflow count tells you to raise the capacity.
+	std::lock_guard<std::mutex> lock(s_OverflowMutex);
+	if (s_OverflowCount++ == 0)
+	{
+		std::cout << "Warning: Frame allocator is out of memory, falling back to the heap! \n";
+	}
+	memory = ::operator new(size + alignment);
+	s_OverflowBlocks[arena].push_back(memory);
+	return (void*)(((uintptr_t)memory + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+void FrameAllocator::EndFrame()
+{
+	unsigned int next = (s_CurrentArena.load(std::memory_order_relaxed) + 1) % (unsigned int)s_Arenas.size();
+	s_Arenas[next]->Reset();
+	{
+		std::lock_guard<std::mutex> lock(s_OverflowMutex);
+		for (void* block : s_OverflowBlocks[next])
+		{
+			::operator delete(block);
+		}
+		s_OverflowBlocks[next].clear();
+	}
+	s_CurrentArena.store(next, std::memory_order_release);
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+//A bump allocator over one fixed block of memory. Allocating is a single atomic add, so it is safe from any thread, and nothing is freed individually.
+//Everything goes away at once on Reset().
+class LinearAllocator
+{
+public:
+	LinearAllocator(size_t capacityInBytes);
+	~LinearAllocator();
+
+	LinearAllocator(const LinearAllocator&) = delete;
+	LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)); //Returns nullptr once full.
+	void Reset();
+
+	inline size_t GetCapacity() const { return m_Capacity; }
+	inline size_t GetUsed() const { return m_Offset.load(std::memory_order_relaxed); }
+	inline size_t GetHighWaterMark() const { return m_HighWaterMark; }
+
+private:
+	unsigned char* m_Memory;
+	size_t m_Capacity;
+	std::atomic<size_t> m_Offset;
+	size_t m_HighWaterMark;
+};
+
+//Per-frame scratch memory for data that only lives until the frame is submitted: command buffers, sort keys, culling results and other transient arrays.
+//The arenas form a ring, two unless more are reserved. Memory handed out in frame N stays valid until the ring comes back around to its arena, so with two
+//a consumer running one frame behind can still read it, and it is reset when frame N + 2 begins. The RenderThread reserves one per frame it lets run ahead.
+//Frames end on the GL thread while the main thread may already be recording the next one into the arena, which is fine as long as it never sees an arena
+//before its reset, so EndFrame resets the arena first and only then makes it current.
+class FrameAllocator
+{
+public:
+	static void Initialize(size_t capacityPerFrameInBytes); //Optional. The arenas start out at s_DefaultCapacity.
+	static void ReserveArenas(unsigned int arenaCount); //Adds arenas of the same capacity until there are at least arenaCount. Only while nothing else allocates.
+	static void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+	static void EndFrame(); //Flips arenas and resets the one we're about to reuse.
+
+	template<typename T>
+	static T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); } //Uninitialized, so keep it to trivial types.
+
+	inline static size_t GetUsed() { return s_Arenas[s_CurrentArena.load(std::memory_order_acquire)]->GetUsed(); }
+	inline static size_t GetCapacity() { return s_Arenas[s_CurrentArena.load(std::memory_order_acquire)]->GetCapacity(); }
+	inline static size_t GetOverflowCount() { return s_OverflowCount; } //Allocations that didn't fit and went to the heap instead. Should stay at 0.
+
+	static constexpr size_t s_DefaultCapacity = 4 * 1024 * 1024;
+
+private:
+	static std::vector<std::unique_ptr<LinearAllocator>> s_Arenas;
+	static std::vector<std::vector<void*>> s_OverflowBlocks; //Per arena.
+	static std::mutex s_OverflowMutex;
+	static std::atomic<unsigned int> s_CurrentArena;
+	static size_t s_OverflowCount;
+};
+
+//STL allocator that draws from the current frame's arena. deallocate() is a no-op, so reserve() up front where you can, since every regrowth leaves the old block behind until the reset.
+template<typename T>
+class FrameAllocatorAdapter
+{
+public:
+	using value_type = T;
+
+	FrameAllocatorAdapter() noexcept = default;
+	template<typename U>
+	FrameAllocatorAdapter(const FrameAllocatorAdapter<U>&) noexcept {}
+
+	T* allocate(size_t count) { return static_cast<T*>(FrameAllocator::Allocate(count * sizeof(T), alignof(T))); }
+	void deallocate(T*, size_t) noexcept {}
+
+	template<typename U>
+	bool operator==(const FrameAllocatorAdapter<U>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const FrameAllocatorAdapter<U>&) const noexcept { return false; }
+};
+
+//Same as above, but over a specific LinearAllocator, such as one owned by a worker thread. Once that is full, it falls back to the frame's memory rather
+//than failing, which in turn falls back to the heap. The allocator moves with the container, so a container can be pointed at another LinearAllocator by assigning it a new one.
+template<typename T>
+class LinearAllocatorAdapter
+{
+public:
+	using value_type = T;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	LinearAllocatorAdapter(LinearAllocator* allocator) noexcept : m_Allocator(allocator) {}
+	template<typename U>
+	LinearAllocatorAdapter(const LinearAllocatorAdapter<U>& other) noexcept : m_Allocator(other.m_Allocator) {}
+
+	T* allocate(size_t count)
+	{
+		void* memory = m_Allocator->Allocate(count * sizeof(T), alignof(T));
+		if (memory == nullptr)
+		{
+			memory = FrameAllocator::Allocate(count * sizeof(T), alignof(T));
+		}
+		return static_cast<T*>(memory);
+	}
+	void deallocate(T*, size_t) noexcept {}
+
+	template<typename U>
+	bool operator==(const LinearAllocatorAdapter<U>& other) const noexcept { return m_Allocator == other.m_Allocator; }
+	template<typename U>
+	bool operator!=(const LinearAllocatorAdapter<U>& other) const noexcept { return m_Allocator != other.m_Allocator; }
+
+	LinearAllocator* m_Allocator;
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocatorAdapter<T>>;
@@ -0,0 +1,15 @@
+#pragma once
+
+//Stops in the debugger right where it's called from. __debugbreak only exists on MSVC, so elsewhere we use the compiler's own trap, which lands a debugger
+//on the same line, or ends the program with SIGTRAP/SIGILL without one.
+#if defined(_MSC_VER)
+#define GAA_DEBUG_BREAK() __debugbreak()
+#elif defined(__GNUC__) || defined(__clang__)
+#define GAA_DEBUG_BREAK() __builtin_trap()
+#else
+#include <cstdlib>
+#define GAA_DEBUG_BREAK() std::abort()
+#endif
+
+//Checked in every configuration, as it always has been. Wrapped in a do while so it's a single statement, even under an if without braces.
+#define ASSERT(x) do { if (!(x)) { GAA_DEBUG_BREAK(); } } while (0)
@@ -0,0 +1,205 @@
+#include "GAAPrecompiledHeader.h"
+#include "Instrumentation.h"
+
+#ifdef GAA_ENABLE_INSTRUMENTATION
+
+#include <fstream>
+#include <iomanip>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GAA_HAS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GAA_HAS_RDTSC
+#endif
+
+struct Instrumentation::ThreadBuffer
+{
+	std::atomic<Event*> chunks[s_MaxChunksPerThread] = {};
+	std::atomic<size_t> count{ 0 }; //Stored after the event is written, so a reader that sees the count sees every event before it.
+	std::atomic<uint64_t> droppedCount{ 0 };
+	size_t writtenCount = 0; //How many WriteChromeTrace already wrote. Guarded by s_Mutex.
+	unsigned int threadID = 0;
+	std::string name; //Guarded by s_Mutex.
+};
+
+std::atomic<bool> Instrumentation::s_Enabled(true);
+std::mutex Instrumentation::s_Mutex;
+std::vector<Instrumentation::ThreadBuffer*> Instrumentation::s_Buffers;
+uint64_t Instrumentation::s_StartTimestamp = Instrumentation::ReadTimestamp();
+std::chrono::steady_clock::time_point Instrumentation::s_StartTime = std::chrono::steady_clock::now();
+
+namespace
+{
+	void WriteEscaped(std::ofstream& file, const char* text)
+	{
+		for (; *text; text++)
+		{
+			if (*text == '"' || *text == '\\')
+			{
+				file << '\\';
+			}
+			file << *text;
+		}
+	}
+}
+
+void Instrumentation::BeginZone(const char* name)
+{
+	Record(EventType::ZoneBegin, name, 0.0, ReadTimestamp());
+}
+
+void Instrumentation::EndZone()
+{
+	Record(EventType::ZoneEnd, nullptr, 0.0, ReadTimestamp());
+}
+
+void Instrumentation::Counter(const char* name, double value)
+{
+	Record(EventType::Counter, name, value, ReadTimestamp());
+}
+
+void Instrumentation::FrameMarker(const char* name)
+{
+	Record(EventType::FrameMarker, name, 0.0, ReadTimestamp());
+}
+
+void Instrumentation::SetThreadName(const std::string& name)
+{
+	ThreadBuffer& buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	buffer.name = name;
+}
+
+bool Instrumentation::WriteChromeTrace(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+
+	//The time stamp counter's rate isn't something we can ask for, so we measure it against the OS clock over everything since startup.
+	uint64_t nowTimestamp = ReadTimestamp();
+	double elapsedMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_StartTime).count();
+	double ticksPerMicrosecond = elapsedMicroseconds > 0.0 ? (double)(nowTimestamp - s_StartTimestamp) / elapsedMicroseconds : 1.0;
+
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "Warning: Couldn't open " << path << " to write the trace to! \n";
+		return false;
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	size_t eventCount = 0;
+	for (ThreadBuffer* buffer : s_Buffers)
+	{
+		if (!buffer->name.empty())
+		{
+			file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadID << ",\"args\":{\"name\":\"";
+			WriteEscaped(file, buffer->name.c_str());
+			file << "\"}}";
+			first = false;
+		}
+
+		size_t end = buffer->count.load(std::memory_order_acquire);
+		for (size_t i = buffer->writtenCount; i < end; i++)
+		{
+			const Event& event = buffer->chunks[i / s_EventsPerChunk].load(std::memory_order_acquire)[i % s_EventsPerChunk];
+			double microseconds = (double)(int64_t)(event.timestamp - s_StartTimestamp) / ticksPerMicrosecond;
+
+			file << (first ? "" : ",\n") << "{";
+			first = false;
+			if (event.name != nullptr)
+			{
+				file << "\"name\":\"";
+				WriteEscaped(file, event.name);
+				file << "\",";
+			}
+			switch (event.type)
+			{
+			case EventType::ZoneBegin:
+				file << "\"ph\":\"B\",";
+				break;
+			case EventType::ZoneEnd:
+				file << "\"ph\":\"E\",";
+				break;
+			case EventType::Counter:
+				file << "\"ph\":\"C\",\"args\":{\"value\":" << event.value << "},";
+				break;
+			case EventType::FrameMarker:
+				file << "\"ph\":\"i\",\"s\":\"g\","; //An instant event across every thread, drawn as a line through the whole trace.
+				break;
+			}
+			file << "\"pid\":1,\"tid\":" << buffer->threadID << ",\"ts\":" << microseconds << "}";
+		}
+		eventCount += end - buffer->writtenCount;
+		buffer->writtenCount = end;
+	}
+	file << "\n]}\n";
+
+	std::cout << "Wrote " << eventCount << " events from " << s_Buffers.size() << " threads to " << path << ". \n";
+	return true;
+}
+
+uint64_t Instrumentation::GetDroppedEventCount()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	uint64_t dropped = 0;
+	for (ThreadBuffer* buffer : s_Buffers)
+	{
+		dropped += buffer->droppedCount.load(std::memory_order_relaxed);
+	}
+	return dropped;
+}
+
+Instrumentation::ThreadBuffer& Instrumentation::GetThreadBuffer()
+{
+	thread_local ThreadBuffer* t_Buffer = nullptr;
+	if (t_Buffer == nullptr)
+	{
+		t_Buffer = new ThreadBuffer();
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		s_Buffers.push_back(t_Buffer);
+		t_Buffer->threadID = (unsigned int)s_Buffers.size();
+	}
+	return *t_Buffer;
+}
+
+void Instrumentation::Record(EventType type, const char* name, double value, uint64_t timestamp)
+{
+	if (!s_Enabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	//Only this thread ever writes to its buffer, so plain loads and one release store are all it takes.
+	ThreadBuffer& buffer = GetThreadBuffer();
+	size_t index = buffer.count.load(std::memory_order_relaxed);
+	size_t chunkIndex = index / s_EventsPerChunk;
+	if (chunkIndex >= s_MaxChunksPerThread)
+	{
+		buffer.droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Event* events = buffer.chunks[chunkIndex].load(std::memory_order_relaxed);
+	if (events == nullptr)
+	{
+		events = new Event[s_EventsPerChunk]; //Once every 16384 events on this thread, which is the only time recording allocates.
+		buffer.chunks[chunkIndex].store(events, std::memory_order_release);
+	}
+	events[index % s_EventsPerChunk] = Event{ timestamp, name, value, type };
+	buffer.count.store(index + 1, std::memory_order_release);
+}
+
+uint64_t Instrumentation::ReadTimestamp()
+{
+#ifdef GAA_HAS_RDTSC
+	return __rdtsc(); //Every CPU of the last decade keeps this counter at a constant rate and in step across cores.
+#else
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+#endif
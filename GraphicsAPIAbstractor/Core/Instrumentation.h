@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+//CPU side instrumentation: scoped zones, counters and frame markers, written out as a Chrome trace that chrome://tracing or ui.perfetto.dev open as they are.
+//Everything goes through the GAA_PROFILE_ macros at the bottom, which only do anything where GAA_ENABLE_INSTRUMENTATION is defined (the Debug configurations
+//define it). Anywhere else they expand to nothing and their arguments aren't even evaluated, so leaving them in the code costs nothing.
+#ifdef GAA_ENABLE_INSTRUMENTATION
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+//Every thread records into a buffer of its own, so recording an event takes no locks and never waits on another thread. Only the first event on a new thread
+//takes a lock, to register its buffer. Buffers grow in fixed size chunks, which are only ever added to, so the trace can be written while threads keep
+//recording. Once a thread has used up s_MaxChunksPerThread chunks, its further events are dropped and counted rather than growing without end.
+//Timestamps are read straight from the CPU's time stamp counter, which is far cheaper than asking the OS, and only converted to time when the trace is written.
+class Instrumentation
+{
+public:
+	enum class EventType : uint32_t
+	{
+		ZoneBegin = 0, ZoneEnd, Counter, FrameMarker
+	};
+
+	struct Event
+	{
+		uint64_t timestamp; //In time stamp counter ticks.
+		const char* name; //Kept as a pointer, so string literals or __FUNCTION__, nothing that goes away.
+		double value; //Counters only.
+		EventType type;
+	};
+
+	static void BeginZone(const char* name);
+	static void EndZone();
+	static void Counter(const char* name, double value);
+	static void FrameMarker(const char* name);
+	static void SetThreadName(const std::string& name); //Shown in place of the thread's number in the trace. Copied.
+
+	inline static void SetEnabled(bool enabled) { s_Enabled.store(enabled, std::memory_order_relaxed); } //Recording is on from the start.
+	inline static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+
+	//Writes every event recorded since the last call as Chrome trace event JSON. Any thread, any time.
+	static bool WriteChromeTrace(const std::string& path);
+	static uint64_t GetDroppedEventCount();
+
+	static constexpr size_t s_EventsPerChunk = 16384; //512 KB.
+	static constexpr size_t s_MaxChunksPerThread = 256;
+
+private:
+	struct ThreadBuffer;
+
+	static ThreadBuffer& GetThreadBuffer();
+	static void Record(EventType type, const char* name, double value, uint64_t timestamp);
+	static uint64_t ReadTimestamp();
+
+	static std::atomic<bool> s_Enabled;
+	static std::mutex s_Mutex; //Taken when a thread first records, and while writing the trace.
+	static std::vector<ThreadBuffer*> s_Buffers; //Never freed, as a thread's events are still wanted after it has exited.
+	static uint64_t s_StartTimestamp; //The two clocks read together at startup, so ticks can be converted to time later on.
+	static std::chrono::steady_clock::time_point s_StartTime;
+};
+
+//Records a zone from here to the end of the enclosing block.
+class InstrumentationZone
+{
+public:
+	InstrumentationZone(const char* name) { Instrumentation::BeginZone(name); }
+	~InstrumentationZone() { Instrumentation::EndZone(); }
+
+	InstrumentationZone(const InstrumentationZone&) = delete;
+	InstrumentationZone& operator=(const InstrumentationZone&) = delete;
+};
+
+#define GAA_PROFILE_CONCATENATE_INNER(a, b) a##b
+#define GAA_PROFILE_CONCATENATE(a, b) GAA_PROFILE_CONCATENATE_INNER(a, b)
+#define GAA_PROFILE_ZONE(name) InstrumentationZone GAA_PROFILE_CONCATENATE(instrumentationZone, __LINE__)(name)
+#define GAA_PROFILE_FUNCTION() GAA_PROFILE_ZONE(__FUNCTION__)
+#define GAA_PROFILE_COUNTER(name, value) Instrumentation::Counter(name, (double)(value))
+#define GAA_PROFILE_FRAME(name) Instrumentation::FrameMarker(name)
+#define GAA_PROFILE_THREAD(name) Instrumentation::SetThreadName(name)
+#define GAA_PROFILE_WRITE_CHROME_TRACE(path) Instrumentation::WriteChromeTrace(path)
+
+#else
+
+#define GAA_PROFILE_ZONE(name)
+#define GAA_PROFILE_FUNCTION()
+#define GAA_PROFILE_COUNTER(name, value)
+#define GAA_PROFILE_FRAME(name)
+#define GAA_PROFILE_THREAD(name)
+#define GAA_PROFILE_WRITE_CHROME_TRACE(path)
+
+#endif
@@ -0,0 +1,444 @@
+#include "GAAPrecompiledHeader.h"
+#include "JobSystem.h"
+#include "WorkStealingQueue.h"
+#include "Instrumentation.h"
+#include <algorithm>
+
+struct Job
+{
+	JobSystem::JobFunction function;
+	JobCounter* counter;
+};
+
+struct JobSystem::WorkerQueue
+{
+	WorkStealingQueue<Job> jobs;
+};
+
+bool JobSystem::s_Initialized = false;
+std::atomic<bool> JobSystem::s_Quit(false);
+std::vector<std::unique_ptr<JobSystem::WorkerQueue>> JobSystem::s_Queues;
+std::vector<std::thread> JobSystem::s_Threads;
+std::mutex JobSystem::s_SharedMutex;
+std::vector<Job*> JobSystem::s_SharedJobs;
+std::mutex JobSystem::s_MainThreadMutex;
+std::vector<Job*> JobSystem::s_MainThreadJobs;
+std::mutex JobSystem::s_FreeJobsMutex;
+std::vector<Job*> JobSystem::s_FreeJobs;
+std::atomic<int> JobSystem::s_QueuedJobs(0);
+std::atomic<int> JobSystem::s_SleepingWorkers(0);
+std::mutex JobSystem::s_SleepMutex;
+std::condition_variable JobSystem::s_WakeCondition;
+
+namespace
+{
+	//Which deque belongs to this thread. 0 is the main thread, workers count up from 1, and any other thread has none.
+	constexpr unsigned int s_NoQueue = ~0u;
+	thread_local unsigned int t_ThreadIndex = s_NoQueue;
+	std::thread::id s_MainThreadID;
+
+	//Each thread keeps a few free jobs of its own and only goes to s_FreeJobs a batch at a time, so recycling a job rarely takes the lock.
+	constexpr size_t s_JobCacheBatch = 32;
+	struct JobCache
+	{
+		std::vector<Job*> jobs;
+		~JobCache()
+		{
+			for (Job* job : jobs)
+			{
+				delete job;
+			}
+		}
+	};
+	thread_local JobCache t_JobCache;
+}
+
+void JobSystem::Initialize(unsigned int workerThreadCount)
+{
+	if (s_Initialized)
+	{
+		std::cout << "Warning: The job system is already initialized! \n";
+		return;
+	}
+	if (workerThreadCount == 0)
+	{
+		workerThreadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+	}
+
+	s_MainThreadID = std::this_thread::get_id();
+	t_ThreadIndex = 0;
+	s_Quit = false;
+	for (unsigned int i = 0; i <= workerThreadCount; i++)
+	{
+		s_Queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	//The queues have to exist before any worker starts stealing from them.
+	s_Initialized = true;
+	for (unsigned int i = 1; i <= workerThreadCount; i++)
+	{
+		s_Threads.emplace_back(&JobSystem::WorkerLoop, i);
+	}
+}
+
+void JobSystem::Shutdown()
+{
+	if (!s_Initialized)
+	{
+		return;
+	}
+
+	//Finish anything still queued first, as someone may be relying on it having run.
+	while (s_QueuedJobs.load() > 0)
+	{
+		if (Job* job = FindJob(0))
+		{
+			Execute(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_SleepMutex);
+		s_Quit = true;
+	}
+	s_WakeCondition.notify_all();
+	for (std::thread& thread : s_Threads)
+	{
+		thread.join();
+	}
+	s_Threads.clear();
+	//A job that was running when we asked the workers to quit may have queued more, which is ours to run now.
+	while (Job* job = FindJob(0))
+	{
+		Execute(job);
+	}
+	ProcessMainThreadJobs();
+
+	s_Initialized = false;
+	s_Queues.clear();
+	t_ThreadIndex = s_NoQueue;
+
+	//The workers' own caches went with their threads. The main thread's stays for the next Initialize, or until the program exits.
+	std::lock_guard<std::mutex> lock(s_FreeJobsMutex);
+	for (Job* job : s_FreeJobs)
+	{
+		delete job;
+	}
+	s_FreeJobs.clear();
+}
+
+void JobSystem::Run(JobFunction function, JobCounter* counter, JobCounter* dependency)
+{
+	if (!s_Initialized)
+	{
+		//Everything before it ran inline as well, so the dependency is already done.
+		function();
+		return;
+	}
+
+	Job* job = AllocateJob(std::move(function), counter);
+	if (counter)
+	{
+		counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (dependency)
+	{
+		//The last job on the dependency drops its count under the same lock, so it either sees us in its continuations or we see it done.
+		std::lock_guard<std::mutex> lock(dependency->m_Mutex);
+		if (dependency->m_Pending.load(std::memory_order_acquire) > 0)
+		{
+			dependency->m_Continuations.push_back(job);
+			return;
+		}
+	}
+	Schedule(job);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	if (!s_Initialized)
+	{
+		return;
+	}
+
+	unsigned int threadIndex = t_ThreadIndex;
+	bool mainThread = IsMainThread();
+	while (!counter.IsDone())
+	{
+		//Rather than block, help out. The main thread also keeps its own queue moving, in case what we wait on is waiting on that.
+		if (mainThread)
+		{
+			ProcessMainThreadJobs();
+		}
+		if (Job* job = FindJob(threadIndex))
+		{
+			Execute(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	//The count reaches zero while the last job still holds the mutex. Once we can take it, that job is done with the counter and it is safe to destroy.
+	std::lock_guard<std::mutex> lock(counter.m_Mutex);
+}
+
+void JobSystem::ParallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& function, size_t minimumGrainSize)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	minimumGrainSize = std::max<size_t>(1, minimumGrainSize);
+	if (!s_Initialized || s_Threads.empty() || count < 2 * minimumGrainSize)
+	{
+		function(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	if (t_ThreadIndex >= s_Queues.size())
+	{
+		//Jobs from a thread without a deque go through the shared queue, so there is nothing to tell us when they get stolen. Split up front into a few ranges per thread instead.
+		size_t rangeSize = std::max(minimumGrainSize, count / (GetThreadCount() * 4));
+		for (size_t begin = 0; begin < count; begin += rangeSize)
+		{
+			size_t end = std::min(count, begin + rangeSize);
+			Run([&function, begin, end]() { function(begin, end); }, &counter);
+		}
+		Wait(counter);
+		return;
+	}
+
+	//Keep the lower half and offer the upper half to thieves, for as long as the last half we offered has been taken. Whoever steals a half splits it the same way.
+	std::function<void(size_t, size_t)> process;
+	process = [&](size_t begin, size_t end)
+	{
+		while (end - begin >= 2 * minimumGrainSize && ShouldSplit())
+		{
+			size_t middle = begin + (end - begin) / 2;
+			Run([&process, middle, end]() { process(middle, end); }, &counter);
+			end = middle;
+		}
+		function(begin, end);
+	};
+	process(0, count);
+	Wait(counter);
+}
+
+void JobSystem::RunOnMainThread(JobFunction function, JobCounter* counter)
+{
+	if (!s_Initialized)
+	{
+		function();
+		return;
+	}
+
+	Job* job = AllocateJob(std::move(function), counter);
+	if (counter)
+	{
+		counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+	}
+	std::lock_guard<std::mutex> lock(s_MainThreadMutex);
+	s_MainThreadJobs.push_back(job);
+}
+
+void JobSystem::ProcessMainThreadJobs()
+{
+	if (!IsMainThread())
+	{
+		std::cout << "Warning: Main thread jobs can only be processed on the main thread! \n";
+		return;
+	}
+
+	//Swap them out first, so a job can queue another for the next call without us holding the lock while it runs.
+	std::vector<Job*> jobs;
+	{
+		std::lock_guard<std::mutex> lock(s_MainThreadMutex);
+		jobs.swap(s_MainThreadJobs);
+	}
+	for (Job* job : jobs)
+	{
+		Execute(job);
+	}
+}
+
+bool JobSystem::IsMainThread()
+{
+	return !s_Initialized || std::this_thread::get_id() == s_MainThreadID;
+}
+
+unsigned int JobSystem::GetThreadIndex()
+{
+	return t_ThreadIndex < s_Queues.size() ? t_ThreadIndex : GetThreadCount();
+}
+
+void JobSystem::WorkerLoop(unsigned int threadIndex)
+{
+	t_ThreadIndex = threadIndex;
+	GAA_PROFILE_THREAD("Worker " + std::to_string(threadIndex));
+	while (!s_Quit.load())
+	{
+		if (Job* job = FindJob(threadIndex))
+		{
+			Execute(job);
+			continue;
+		}
+
+		//Work tends to arrive in bursts, so spin a little before paying for a sleep and a wake up.
+		bool jobsQueued = false;
+		for (int spin = 0; spin < 64 && !jobsQueued; spin++)
+		{
+			std::this_thread::yield();
+			jobsQueued = s_QueuedJobs.load() > 0;
+		}
+		if (jobsQueued)
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(s_SleepMutex);
+		s_SleepingWorkers++;
+		s_WakeCondition.wait(lock, []() { return s_QueuedJobs.load() > 0 || s_Quit.load(); });
+		s_SleepingWorkers--;
+	}
+}
+
+void JobSystem::Schedule(Job* job)
+{
+	unsigned int threadIndex = t_ThreadIndex;
+	if (threadIndex < s_Queues.size())
+	{
+		if (!s_Queues[threadIndex]->jobs.Push(job))
+		{
+			//Our deque is full, which means plenty is queued already. Nobody will miss this one running right here.
+			Execute(job);
+			return;
+		}
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(s_SharedMutex);
+		s_SharedJobs.push_back(job);
+	}
+
+	s_QueuedJobs.fetch_add(1);
+	if (s_SleepingWorkers.load() > 0)
+	{
+		//Taking the lock means a worker can't be between checking s_QueuedJobs and going to sleep, where it would miss the notification.
+		{
+			std::lock_guard<std::mutex> lock(s_SleepMutex);
+		}
+		s_WakeCondition.notify_one();
+	}
+}
+
+Job* JobSystem::FindJob(unsigned int threadIndex)
+{
+	unsigned int queueCount = (unsigned int)s_Queues.size();
+	Job* job = nullptr;
+
+	//Our own newest job first, as whatever it touches is most likely still in our cache.
+	if (threadIndex < queueCount)
+	{
+		job = s_Queues[threadIndex]->jobs.Pop();
+	}
+	if (!job)
+	{
+		std::lock_guard<std::mutex> lock(s_SharedMutex);
+		if (!s_SharedJobs.empty())
+		{
+			job = s_SharedJobs.front();
+			s_SharedJobs.erase(s_SharedJobs.begin());
+		}
+	}
+	//Then steal, starting from our neighbour so the thieves spread out over the victims.
+	for (unsigned int i = 1; i <= queueCount && !job; i++)
+	{
+		unsigned int victim = (threadIndex + i) % queueCount;
+		if (victim != threadIndex)
+		{
+			job = s_Queues[victim]->jobs.Steal();
+		}
+	}
+
+	if (job)
+	{
+		s_QueuedJobs.fetch_sub(1);
+	}
+	return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	{
+		GAA_PROFILE_ZONE("Job");
+		job->function();
+	}
+	JobCounter* counter = job->counter;
+	FreeJob(job);
+	if (!counter)
+	{
+		return;
+	}
+
+	std::vector<Job*> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter->m_Mutex);
+		if (counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			continuations.swap(counter->m_Continuations);
+		}
+	}
+	for (Job* continuation : continuations)
+	{
+		Schedule(continuation);
+	}
+}
+
+Job* JobSystem::AllocateJob(JobFunction&& function, JobCounter* counter)
+{
+	std::vector<Job*>& cache = t_JobCache.jobs;
+	if (cache.empty())
+	{
+		cache.reserve(s_JobCacheBatch * 2);
+		std::lock_guard<std::mutex> lock(s_FreeJobsMutex);
+		size_t count = std::min(s_JobCacheBatch, s_FreeJobs.size());
+		cache.insert(cache.end(), s_FreeJobs.end() - count, s_FreeJobs.end());
+		s_FreeJobs.resize(s_FreeJobs.size() - count);
+	}
+	if (cache.empty())
+	{
+		return new Job{ std::move(function), counter };
+	}
+
+	Job* job = cache.back();
+	cache.pop_back();
+	job->function = std::move(function);
+	job->counter = counter;
+	return job;
+}
+
+void JobSystem::FreeJob(Job* job)
+{
+	job->function = nullptr; //Lets go of whatever it captured now, rather than whenever the job is next used.
+	std::vector<Job*>& cache = t_JobCache.jobs;
+	cache.reserve(s_JobCacheBatch * 2);
+	cache.push_back(job);
+	if (cache.size() >= s_JobCacheBatch * 2)
+	{
+		std::lock_guard<std::mutex> lock(s_FreeJobsMutex);
+		s_FreeJobs.insert(s_FreeJobs.end(), cache.end() - s_JobCacheBatch, cache.end());
+		cache.resize(cache.size() - s_JobCacheBatch);
+	}
+}
+
+bool JobSystem::ShouldSplit()
+{
+	//Only worth splitting again once someone has taken what we offered last time.
+	unsigned int threadIndex = t_ThreadIndex;
+	return threadIndex < s_Queues.size() && s_Queues[threadIndex]->jobs.IsEmpty();
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct Job;
+
+//Counts jobs that haven't finished. Pass one to JobSystem::Run to track a job, Wait on it to block until every job it tracks is done, or pass it as another
+//job's dependency to start that job only then. A counter can be reused once it is done, and must only be destroyed after a Wait on it has returned.
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	inline bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+	inline int GetPending() const { return m_Pending.load(std::memory_order_relaxed); }
+
+private:
+	friend class JobSystem;
+	std::atomic<int> m_Pending{ 0 };
+	std::mutex m_Mutex; //Guards m_Continuations, and is held while m_Pending drops, so Wait knows the last job has let go of the counter.
+	std::vector<Job*> m_Continuations; //Jobs waiting for this counter to reach zero before they are scheduled.
+};
+
+//The thread pool everything parallel runs on. Each worker owns a work stealing deque: jobs a worker spawns go onto its own deque, and a worker with nothing to do
+//steals from the others, so load balances itself without a central queue to fight over. Threads that aren't workers (a render or upload thread) hand
+//their jobs over through a shared queue instead.
+//Waiting is task based rather than fiber based: a thread waiting on a counter runs other jobs until the counter is done, so Wait can be called from inside a job
+//without tying up a worker, at the cost of that job's stack staying in use underneath.
+//GL calls can only be made on the thread that owns the context, so jobs that need it go to RunOnMainThread and are run by ProcessMainThreadJobs.
+//Until Initialize is called (and after Shutdown) everything simply runs on the calling thread.
+class JobSystem
+{
+public:
+	using JobFunction = std::function<void()>;
+
+	static void Initialize(unsigned int workerThreadCount = 0); //Call from the main thread. 0 means one worker per core, minus one for the main thread.
+	static void Shutdown(); //Runs whatever is still queued, then joins the workers.
+
+	//counter, if given, is incremented now and decremented once the job has run. dependency, if given, holds the job back until that counter is done.
+	static void Run(JobFunction function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+	static void Wait(JobCounter& counter); //Runs other jobs, and main thread jobs if this is the main thread, until counter is done.
+
+	//Calls function(begin, end) for non-overlapping ranges covering [0, count), in parallel, and returns once they have all run. Ranges are split in half lazily,
+	//only while the splitting thread has nothing queued for others to steal, so the grain adapts to how busy the workers are and how uneven the work is,
+	//rather than being guessed up front. Ranges never get smaller than minimumGrainSize.
+	static void ParallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& function, size_t minimumGrainSize = 1);
+
+	static void RunOnMainThread(JobFunction function, JobCounter* counter = nullptr);
+	static void ProcessMainThreadJobs(); //Call once per frame from the main thread.
+
+	static bool IsMainThread();
+	static unsigned int GetThreadIndex(); //0 on the main thread, 1 and up on the workers and GetThreadCount() on any other thread, for indexing per thread data.
+	inline static bool IsInitialized() { return s_Initialized; }
+	inline static unsigned int GetThreadCount() { return s_Queues.empty() ? 1 : (unsigned int)s_Queues.size(); } //The workers and the main thread, 1 before Initialize.
+
+private:
+	struct WorkerQueue;
+
+	static void WorkerLoop(unsigned int threadIndex);
+	static void Schedule(Job* job); //Onto this thread's deque, or the shared queue if it doesn't have one.
+	static Job* FindJob(unsigned int threadIndex);
+	static void Execute(Job* job);
+	static Job* AllocateJob(JobFunction&& function, JobCounter* counter);
+	static void FreeJob(Job* job);
+	static bool ShouldSplit();
+
+	static bool s_Initialized;
+	static std::atomic<bool> s_Quit;
+	static std::vector<std::unique_ptr<WorkerQueue>> s_Queues; //Index 0 is the main thread's.
+	static std::vector<std::thread> s_Threads;
+
+	static std::mutex s_SharedMutex; //Jobs from threads without a deque.
+	static std::vector<Job*> s_SharedJobs;
+	static std::mutex s_MainThreadMutex;
+	static std::vector<Job*> s_MainThreadJobs;
+	//Jobs are recycled rather than deleted, so once the pool has grown to the most jobs ever in flight at once, running one no longer allocates.
+	static std::mutex s_FreeJobsMutex;
+	static std::vector<Job*> s_FreeJobs;
+
+	//Idle workers sleep rather than spin. s_QueuedJobs counts jobs sitting in any deque or the shared queue, which is what they wake up for.
+	static std::atomic<int> s_QueuedJobs;
+	static std::atomic<int> s_SleepingWorkers;
+	static std::mutex s_SleepMutex;
+	static std::condition_variable s_WakeCondition;
+};
@@ -0,0 +1,203 @@
+#include "GAAPrecompiledHeader.h"
+#include "JsonReader.h"
+#include <cstdlib>
+#include <cstring>
+
+void JsonReader::SkipWhitespace()
+{
+	while (m_Cursor < m_End && (*m_Cursor == ' ' || *m_Cursor == '\t' || *m_Cursor == '\n' || *m_Cursor == '\r' || *m_Cursor == ',' || *m_Cursor == ':'))
+	{
+		m_Cursor++;
+	}
+}
+
+bool JsonReader::AtEndOfArray()
+{
+	SkipWhitespace();
+	if (m_Error || m_Cursor >= m_End)
+	{
+		m_Error = true;
+		return true;
+	}
+	if (*m_Cursor == ']')
+	{
+		m_Cursor++;
+		return true;
+	}
+	return false;
+}
+
+JsonReader::Token JsonReader::Next()
+{
+	SkipWhitespace();
+	if (m_Error)
+	{
+		return Token::Error;
+	}
+	if (m_Cursor >= m_End)
+	{
+		return Token::End;
+	}
+
+	char c = *m_Cursor;
+	switch (c)
+	{
+		case '{': m_Cursor++; return Token::BeginObject;
+		case '}': m_Cursor++; return Token::EndObject;
+		case '[': m_Cursor++; return Token::BeginArray;
+		case ']': m_Cursor++; return Token::EndArray;
+		case '"':
+		{
+			const char* begin = ++m_Cursor;
+			while (m_Cursor < m_End && *m_Cursor != '"')
+			{
+				m_Cursor += *m_Cursor == '\\' ? 2 : 1;
+			}
+			if (m_Cursor >= m_End)
+			{
+				return Fail();
+			}
+			m_String = std::string_view(begin, m_Cursor - begin);
+			m_Cursor++;
+
+			//A string followed by a colon is a key.
+			while (m_Cursor < m_End && (*m_Cursor == ' ' || *m_Cursor == '\t' || *m_Cursor == '\n' || *m_Cursor == '\r'))
+			{
+				m_Cursor++;
+			}
+			if (m_Cursor < m_End && *m_Cursor == ':')
+			{
+				m_Cursor++;
+				return Token::Key;
+			}
+			return Token::String;
+		}
+		case 't': m_Cursor += 4; return m_Cursor <= m_End ? Token::True : Fail();
+		case 'f': m_Cursor += 5; return m_Cursor <= m_End ? Token::False : Fail();
+		case 'n': m_Cursor += 4; return m_Cursor <= m_End ? Token::Null : Fail();
+	}
+
+	if (c == '-' || (c >= '0' && c <= '9'))
+	{
+		//strtod needs a terminated string, and the input may end right after the number, so we copy it out first. No number worth reading is this long.
+		char buffer[64];
+		size_t length = 0;
+		while (m_Cursor < m_End && length < sizeof(buffer) - 1 && (strchr("+-.eE", *m_Cursor) || (*m_Cursor >= '0' && *m_Cursor <= '9')))
+		{
+			buffer[length++] = *m_Cursor++;
+		}
+		buffer[length] = '\0';
+		m_Number = strtod(buffer, nullptr);
+		return Token::Number;
+	}
+	return Fail();
+}
+
+void JsonReader::Skip(Token token)
+{
+	if (token != Token::BeginObject && token != Token::BeginArray)
+	{
+		return; //Scalars are already consumed, and so is a key's colon.
+	}
+
+	int depth = 1;
+	while (depth > 0)
+	{
+		Token next = Next();
+		if (next == Token::BeginObject || next == Token::BeginArray)
+		{
+			depth++;
+		}
+		else if (next == Token::EndObject || next == Token::EndArray)
+		{
+			depth--;
+		}
+		else if (next == Token::End || next == Token::Error)
+		{
+			m_Error = true;
+			return;
+		}
+	}
+}
+
+std::string JsonReader::GetString() const
+{
+	std::string result;
+	result.reserve(m_String.size());
+	for (size_t i = 0; i < m_String.size(); i++)
+	{
+		char c = m_String[i];
+		if (c != '\\' || i + 1 >= m_String.size())
+		{
+			result += c;
+			continue;
+		}
+
+		char escaped = m_String[++i];
+		switch (escaped)
+		{
+			case 'n': result += '\n'; break;
+			case 't': result += '\t'; break;
+			case 'r': result += '\r'; break;
+			case 'b': result += '\b'; break;
+			case 'f': result += '\f'; break;
+			case 'u':
+			{
+				//Encoded back out as UTF-8. Surrogate pairs are rare enough in file paths that we don't combine them.
+				unsigned int codePoint = i + 4 < m_String.size() ? (unsigned int)strtoul(std::string(m_String.substr(i + 1, 4)).c_str(), nullptr, 16) : 0;
+				i += 4;
+				if (codePoint < 0x80)
+				{
+					result += (char)codePoint;
+				}
+				else if (codePoint < 0x800)
+				{
+					result += (char)(0xC0 | (codePoint >> 6));
+					result += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else
+				{
+					result += (char)(0xE0 | (codePoint >> 12));
+					result += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+					result += (char)(0x80 | (codePoint & 0x3F));
+				}
+				break;
+			}
+			default: result += escaped; break; //\" \\ and \/
+		}
+	}
+	return result;
+}
+
+double JsonReader::ReadNumber(double fallback)
+{
+	Token token = Next();
+	if (token == Token::Number)
+	{
+		return m_Number;
+	}
+	Skip(token);
+	return fallback;
+}
+
+std::string JsonReader::ReadString()
+{
+	Token token = Next();
+	if (token == Token::String)
+	{
+		return GetString();
+	}
+	Skip(token);
+	return std::string();
+}
+
+bool JsonReader::ReadBool(bool fallback)
+{
+	Token token = Next();
+	if (token == Token::True || token == Token::False)
+	{
+		return token == Token::True;
+	}
+	Skip(token);
+	return fallback;
+}
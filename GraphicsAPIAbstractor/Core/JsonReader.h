@@ -0,0 +1,77 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include <string_view>
+
+//A pull parser for JSON. Rather than building a tree of the whole document, the caller asks for one token at a time and reads what it cares about straight
+//into its own structures, skipping the rest. Nothing is allocated and the input is never copied, so it can read from a memory mapped file as is.
+//Commas and colons are consumed for you, and a string followed by a colon comes back as a Key rather than a String.
+class JsonReader
+{
+public:
+	enum class Token
+	{
+		BeginObject, EndObject, BeginArray, EndArray, Key, String, Number, True, False, Null, End, Error
+	};
+
+	JsonReader(const char* data, size_t size) : m_Cursor(data), m_End(data + size) {}
+
+	Token Next();
+	void Skip(Token token); //Skips the rest of the value that token started, so a whole object or array if it opened one.
+
+	inline std::string_view GetRawString() const { return m_String; } //As written, escapes included. Keys and most glTF strings never contain any.
+	std::string GetString() const; //With escapes decoded.
+	inline double GetNumber() const { return m_Number; }
+	inline bool HasError() const { return m_Error; }
+
+	//Convenience for the common case of reading a whole value of a known type. These skip anything of the wrong type.
+	double ReadNumber(double fallback = 0.0);
+	std::string ReadString();
+	bool ReadBool(bool fallback = false);
+
+	void SkipValue() { Skip(Next()); }
+
+	template<typename Function>
+	void ReadArray(Function&& function) //Calls function() once per element, which must read (or skip) exactly that element.
+	{
+		Token token = Next();
+		if (token != Token::BeginArray)
+		{
+			Skip(token);
+			return;
+		}
+		while (!AtEndOfArray())
+		{
+			function();
+		}
+	}
+
+	template<typename Function>
+	void ReadObject(Function&& function) //Calls function(key) once per member, which must read (or skip) that member's value.
+	{
+		Token token = Next();
+		if (token != Token::BeginObject)
+		{
+			Skip(token);
+			return;
+		}
+		for (token = Next(); token == Token::Key; token = Next())
+		{
+			function(m_String);
+		}
+		if (token != Token::EndObject)
+		{
+			m_Error = true;
+		}
+	}
+
+private:
+	void SkipWhitespace();
+	bool AtEndOfArray(); //Consumes the ] if it is next. Also true on an error, so loops over a broken array still end.
+	Token Fail() { m_Error = true; return Token::Error; }
+
+	const char* m_Cursor;
+	const char* m_End;
+	std::string_view m_String;
+	double m_Number = 0.0;
+	bool m_Error = false;
+};
@@ -0,0 +1,139 @@
+#include "GAAPrecompiledHeader.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filePath)
+{
+	Open(filePath);
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		m_Data = other.m_Data;
+		m_Size = other.m_Size;
+#ifdef _WIN32
+		m_FileHandle = other.m_FileHandle;
+		m_MappingHandle = other.m_MappingHandle;
+		other.m_FileHandle = nullptr;
+		other.m_MappingHandle = nullptr;
+#else
+		m_FileDescriptor = other.m_FileDescriptor;
+		other.m_FileDescriptor = -1;
+#endif
+		other.m_Data = nullptr;
+		other.m_Size = 0;
+	}
+	return *this;
+}
+
+bool MappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Warning: Failed to open " << filePath << " for mapping! \n";
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) //Empty files can't be mapped.
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view)
+	{
+		std::cout << "Warning: Failed to map " << filePath << "! \n";
+		if (mapping)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return false;
+	}
+
+	m_FileHandle = file;
+	m_MappingHandle = mapping;
+	m_Data = static_cast<const unsigned char*>(view);
+	m_Size = (size_t)size.QuadPart;
+#else
+	int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		std::cout << "Warning: Failed to open " << filePath << " for mapping! \n";
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(fileDescriptor, &status) != 0 || status.st_size == 0)
+	{
+		close(fileDescriptor);
+		return false;
+	}
+
+	void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (view == MAP_FAILED)
+	{
+		std::cout << "Warning: Failed to map " << filePath << "! \n";
+		close(fileDescriptor);
+		return false;
+	}
+	madvise(view, (size_t)status.st_size, MADV_SEQUENTIAL); //We read straight through it on upload.
+
+	m_FileDescriptor = fileDescriptor;
+	m_Data = static_cast<const unsigned char*>(view);
+	m_Size = (size_t)status.st_size;
+#endif
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (!m_Data)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_Data);
+	CloseHandle(m_MappingHandle);
+	CloseHandle(m_FileHandle);
+	m_MappingHandle = nullptr;
+	m_FileHandle = nullptr;
+#else
+	munmap(const_cast<unsigned char*>(m_Data), m_Size);
+	close(m_FileDescriptor);
+	m_FileDescriptor = -1;
+#endif
+	m_Data = nullptr;
+	m_Size = 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include <cstddef>
+
+//A read only view of a whole file through the OS's memory mapping, so reading it costs no copies and no allocation. Pages are only read from disk as they
+//are touched, and the OS can drop them again under memory pressure as they are backed by the file itself.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const std::string& filePath);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	inline bool IsOpen() const { return m_Data != nullptr; }
+	inline const unsigned char* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+
+private:
+	const unsigned char* m_Data = nullptr;
+	size_t m_Size = 0;
+#ifdef _WIN32
+	void* m_FileHandle = nullptr;
+	void* m_MappingHandle = nullptr;
+#else
+	int m_FileDescriptor = -1;
+#endif
+};
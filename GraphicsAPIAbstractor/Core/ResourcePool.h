@@ -0,0 +1,200 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+//A Handle is a 32 bit reference into a ResourcePool. The low 20 bits are the slot index and the high 12 bits are the slot's generation at the time the handle was made.
+//Destroying a resource bumps its slot's generation, so any handle still pointing at it becomes stale and Get() returns nullptr instead of someone else's resource.
+//Handles are plain values, so they can be copied around freely and passed between threads.
+template<typename T>
+struct Handle
+{
+	static constexpr uint32_t IndexBits = 20;
+	static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+	static constexpr uint32_t GenerationMask = (1u << (32 - IndexBits)) - 1;
+
+	uint32_t value = 0; //0 is never handed out, as generations start at 1.
+
+	Handle() = default;
+	Handle(uint32_t index, uint32_t generation) : value((generation << IndexBits) | index) {}
+
+	inline uint32_t GetIndex() const { return value & IndexMask; }
+	inline uint32_t GetGeneration() const { return value >> IndexBits; }
+	inline bool IsValid() const { return value != 0; }
+
+	bool operator==(const Handle& other) const { return value == other.value; }
+	bool operator!=(const Handle& other) const { return value != other.value; }
+};
+
+//Stores every T in fixed size pages that are never moved or freed while the pool lives, so a pointer from Get() stays valid until the object is destroyed and
+//collected, however many other objects come and go in between. That matters as commands hold on to those pointers until the GL thread executes them, frames later.
+//Slots map a handle's index straight to its place in the pages, and a dense list of live slots keeps iteration from visiting dead ones.
+//Destroyed objects are not destructed straight away, as commands in flight may still use them. They are parked until CollectGarbage() is told that the frame
+//they were destroyed in has completed. CollectGarbage() runs on the GL thread while the main thread creates and destroys, so every call takes the pool's lock.
+template<typename T>
+class ResourcePool
+{
+public:
+	ResourcePool() = default;
+	~ResourcePool() { Clear(); }
+
+	template<typename... Args>
+	Handle<T> Create(Args&&... args)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		uint32_t slotIndex;
+		if (!m_FreeSlots.empty())
+		{
+			slotIndex = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else
+		{
+			slotIndex = (uint32_t)m_Slots.size();
+			if (slotIndex > Handle<T>::IndexMask)
+			{
+				std::cout << "Error: Resource pool is out of slots! \n";
+				return Handle<T>();
+			}
+			if (slotIndex % s_PageSize == 0)
+			{
+				m_Pages.push_back(std::make_unique<Page>());
+			}
+			m_Slots.push_back({ s_InvalidIndex, 1 });
+		}
+
+		new (GetObject(slotIndex)) T(std::forward<Args>(args)...);
+		m_Slots[slotIndex].liveIndex = (uint32_t)m_LiveSlots.size();
+		m_LiveSlots.push_back(slotIndex);
+		return Handle<T>(slotIndex, m_Slots[slotIndex].generation);
+	}
+
+	T* Get(Handle<T> handle)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return IsLive(handle) ? GetObject(handle.GetIndex()) : nullptr; //Stale handles get nullptr. The resource they referred to has been destroyed.
+	}
+
+	inline bool IsAlive(Handle<T> handle) { return Get(handle) != nullptr; }
+
+	//The handle is invalidated immediately, but the object itself lives on, in place, until CollectGarbage() reports frameIndex as complete.
+	void Destroy(Handle<T> handle, uint64_t frameIndex)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (!IsLive(handle))
+		{
+			return;
+		}
+
+		//Swap the last live slot into the hole so the live list stays dense. The objects themselves don't move.
+		Slot& slot = m_Slots[handle.GetIndex()];
+		uint32_t lastSlot = m_LiveSlots.back();
+		m_LiveSlots[slot.liveIndex] = lastSlot;
+		m_Slots[lastSlot].liveIndex = slot.liveIndex;
+		m_LiveSlots.pop_back();
+
+		slot.liveIndex = s_InvalidIndex;
+		slot.generation = NextGeneration(slot.generation);
+		m_PendingDestruction.push_back({ frameIndex, handle.GetIndex() });
+	}
+
+	void CollectGarbage(uint64_t completedFrameIndex)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		size_t kept = 0;
+		for (const PendingSlot& pending : m_PendingDestruction)
+		{
+			if (pending.frameIndex <= completedFrameIndex)
+			{
+				GetObject(pending.slotIndex)->~T();
+				m_FreeSlots.push_back(pending.slotIndex); //Only reusable now, so a new object never lands where a command in flight expects the old one.
+			}
+			else
+			{
+				m_PendingDestruction[kept++] = pending;
+			}
+		}
+		m_PendingDestruction.resize(kept);
+	}
+
+	void Clear() //Destroys everything immediately, including pending objects. Only call once the GPU is idle.
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (uint32_t slotIndex : m_LiveSlots)
+		{
+			GetObject(slotIndex)->~T();
+		}
+		for (const PendingSlot& pending : m_PendingDestruction)
+		{
+			GetObject(pending.slotIndex)->~T();
+		}
+		m_LiveSlots.clear();
+		m_PendingDestruction.clear();
+		m_FreeSlots.clear();
+		for (uint32_t i = 0; i < m_Slots.size(); i++)
+		{
+			m_Slots[i].liveIndex = s_InvalidIndex;
+			m_Slots[i].generation = NextGeneration(m_Slots[i].generation);
+			m_FreeSlots.push_back(i);
+		}
+	}
+
+	inline size_t GetSize() const { std::lock_guard<std::mutex> lock(m_Mutex); return m_LiveSlots.size(); }
+	inline size_t GetPendingDestructionCount() const { std::lock_guard<std::mutex> lock(m_Mutex); return m_PendingDestruction.size(); }
+
+	//Calls function on every live object, under the pool's lock, so it mustn't call back into the pool.
+	template<typename Function>
+	void ForEach(Function&& function)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (uint32_t slotIndex : m_LiveSlots)
+		{
+			function(*GetObject(slotIndex));
+		}
+	}
+
+private:
+	struct Slot
+	{
+		uint32_t liveIndex; //Where the slot sits in m_LiveSlots, or s_InvalidIndex once destroyed.
+		uint32_t generation;
+	};
+
+	struct PendingSlot
+	{
+		uint64_t frameIndex;
+		uint32_t slotIndex;
+	};
+
+	static constexpr uint32_t s_InvalidIndex = 0xFFFFFFFF;
+	static constexpr uint32_t s_PageSize = 64; //Objects per page.
+
+	struct Page
+	{
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type objects[s_PageSize];
+	};
+
+	inline T* GetObject(uint32_t slotIndex) { return reinterpret_cast<T*>(&m_Pages[slotIndex / s_PageSize]->objects[slotIndex % s_PageSize]); }
+
+	bool IsLive(Handle<T> handle) const
+	{
+		uint32_t slotIndex = handle.GetIndex();
+		return handle.IsValid() && slotIndex < m_Slots.size() && m_Slots[slotIndex].generation == handle.GetGeneration() && m_Slots[slotIndex].liveIndex != s_InvalidIndex;
+	}
+
+	static uint32_t NextGeneration(uint32_t generation)
+	{
+		generation = (generation + 1) & Handle<T>::GenerationMask;
+		return generation == 0 ? 1 : generation; //Skip 0 on wrap around, so that a valid handle can never have a value of 0.
+	}
+
+	mutable std::mutex m_Mutex;
+	std::vector<std::unique_ptr<Page>> m_Pages;
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_LiveSlots;
+	std::vector<uint32_t> m_FreeSlots;
+	std::vector<PendingSlot> m_PendingDestruction;
+};
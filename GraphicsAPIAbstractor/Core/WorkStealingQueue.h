@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//A Chase-Lev work stealing deque with a fixed capacity, following the C11 memory model version by Le, Pop, Cohen and Zappa Nardelli (2013).
+//One thread owns it and pushes and pops at the bottom, last in first out, which keeps what it just produced hot in its cache. Any other thread can steal
+//from the top, taking the oldest item, which for recursively split work is also the biggest. Only a pop and a steal racing for the very last item ever
+//contend, and that is settled with a single compare and swap.
+template<typename T, size_t Capacity = 4096>
+class WorkStealingQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "The capacity has to be a power of two so indices can wrap with a mask.");
+
+public:
+	WorkStealingQueue() : m_Top(0), m_Bottom(0)
+	{
+		for (std::atomic<T*>& item : m_Items)
+		{
+			item.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	WorkStealingQueue(const WorkStealingQueue&) = delete;
+	WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+	//Owner only. Returns false if the queue is full, in which case the caller should just run the item itself.
+	bool Push(T* item)
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		if (bottom - top >= (int64_t)Capacity)
+		{
+			return false;
+		}
+		m_Items[bottom & (Capacity - 1)].store(item, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_release); //Publishes the item to thieves, who read bottom with acquire.
+		return true;
+	}
+
+	//Owner only.
+	T* Pop()
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom) //Empty.
+		{
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		T* item = m_Items[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			//The last one, which a thief may be taking at the same time. Whoever moves top first gets it.
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				item = nullptr;
+			}
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	//Any thread.
+	T* Steal()
+	{
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+		{
+			return nullptr;
+		}
+		T* item = m_Items[top & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr; //Lost to the owner or another thief.
+		}
+		return item;
+	}
+
+	inline bool IsEmpty() const { return m_Bottom.load(std::memory_order_relaxed) <= m_Top.load(std::memory_order_relaxed); } //Only a hint from other threads.
+
+private:
+	//Top and bottom on their own cache lines, as thieves hammer one and the owner the other.
+	alignas(64) std::atomic<int64_t> m_Top;
+	alignas(64) std::atomic<int64_t> m_Bottom;
+	alignas(64) std::atomic<T*> m_Items[Capacity];
+};
@@ -10,6 +10,20 @@
 #include "OpenGL/Shader.h"
 #include "OpenGL/VertexBufferLayout.h"
 #include "OpenGL/Texture.h"
+#include "OpenGL/SamplerCache.h"
+#include "OpenGL/RenderThread.h"
+#include "OpenGL/UploadThread.h"
+#include "OpenGL/GPUProfiler.h"
+#include "OpenGL/RenderStats.h"
+#include "OpenGL/GPUMemoryTracker.h"
+#include "OpenGL/GLDebug.h"
+#include "Core/JobSystem.h"
+#include "Core/FrameAllocator.h"
+#include "Core/Instrumentation.h"
+#include "Geometry/VertexQuantizer.h"
+#include "Geometry/MeshCooker.h"
+#include "Geometry/GLTFScene.h"
+#include "Geometry/FrustumCuller.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "imgui/imgui.h"
@@ -17,6 +31,11 @@
 #include "imgui/imgui_impl_opengl3.h"
 #include "Tests/TestClearColor.h"
 #include "Tests/TestTexture2D.h"
+#include "Tests/TestMultiDrawIndirect.h"
+#include "Tests/TestGPUCulling.h"
+#include "Tests/TestTextureStreaming.h"
+#include "Tests/TestCookedMesh.h"
+#include "Tests/TestModel.h"
 #include "LearnShader.h"
 #include "stb_image/stb_image.h"
 
@@ -26,9 +45,9 @@ unsigned int m_ScreenHeight = 600;
 float visibleValue = 0.1f;
 
 //This is a callback function that is called whenever a window is resized.
+//GLFW calls it from glfwPollEvents on the main thread, which doesn't have the context once the render thread is running, so the viewport is set through each frame's commands instead.
 void FramebufferResizeCallback(GLFWwindow* window, int windowWidth, int windowHeight)
 {
-    glViewport(0, 0, windowWidth, windowHeight);
     m_ScreenHeight = windowHeight;
     m_ScreenWidth = windowWidth; 
 }
@@ -39,7 +58,8 @@ void FramebufferResizeCallback(GLFWwindow* window, int windowWidth, int windowHe
 //We can use GLFW's "glfwGetKey()" function that takes the window as input together with a key.
 //The function returns whether said key is currently being pressed. We're creating a "ProcessInput" function to keep all input code organized.
 //This gives us an easy way to check for specific key presses and react accordingly every frame. An iteration of a render loop is more commonly called a frame. 
-void ProcessInput(GLFWwindow* window, LearnShader shaderProgram)
+//This runs on the main thread, which no longer has the GL context, so we only change values here. Setting the uniform goes into the frame's commands.
+void ProcessInput(GLFWwindow* window)
 {
     //Here, we check whether the user has pressed the escape key (if not pressed, "glfwGetKey()" returns GLFW_RELEASE).
     //If the user did press the escape key, we close GLFW by setting its WindowShouldClose property to true using "glfwSetWindowShouldClose()". 
@@ -52,20 +72,159 @@ void ProcessInput(GLFWwindow* window, LearnShader shaderProgram)
     if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
     {
         visibleValue = visibleValue + 0.05f;
-        unsigned int uniformLocation = glGetUniformLocation(shaderProgram.GetShaderID(), "textureViewValue");
-        glUniform1f(uniformLocation, visibleValue);
     }
 
 	if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
 	{
 		visibleValue = visibleValue - 0.05f;
-		unsigned int uniformLocation = glGetUniformLocation(shaderProgram.GetShaderID(), "textureViewValue");
-		glUniform1f(uniformLocation, visibleValue);
 	}
+
+    //F9 writes everything the CPU instrumentation has recorded since the last press to Trace.json, for chrome://tracing or ui.perfetto.dev. Debug builds only.
+    static bool traceKeyWasDown = false;
+    bool traceKeyDown = glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS;
+    if (traceKeyDown && !traceKeyWasDown)
+    {
+        GAA_PROFILE_WRITE_CHROME_TRACE("Trace.json");
+    }
+    traceKeyWasDown = traceKeyDown;
 }
 
-int main()
+//The tests record far more per frame than the quad does. The multi draw indirect test's command buffers alone come to about 20 MB on the frame it checks them.
+constexpr size_t s_TestFrameMemory = 32 * 1024 * 1024;
+
+//--tests opens the test menu instead of the quad. The tests make their GL calls straight from OnRender, so they run without the render thread, on this one
+//thread that keeps the context, the way the menu always has. Returns once the window closes, or after frameLimit frames when that isn't 0.
+int RunTestMenu(GLFWwindow* window, int frameLimit)
 {
+    FrameAllocator::Initialize(s_TestFrameMemory);
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::StyleColorsDark();
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 330");
+    OpenGLRenderer renderer;
+
+    Test::Test* currentTest = nullptr;
+    Test::TestMenu* testMenu = new Test::TestMenu(currentTest);
+    currentTest = testMenu;
+    testMenu->RegisterTest<Test::TestClearColor>("Clear Color");
+    testMenu->RegisterTest<Test::TestTexture2D>("2D Texture");
+    testMenu->RegisterTest<Test::TestMultiDrawIndirect>("Multi Draw Indirect");
+    testMenu->RegisterTest<Test::TestGPUCulling>("GPU Culling");
+    testMenu->RegisterTest<Test::TestTextureStreaming>("Texture Streaming");
+    testMenu->RegisterTest<Test::TestCookedMesh>("Cooked Mesh");
+    testMenu->RegisterTest<Test::TestModel>("glTF Model");
+
+    int frameCount = 0;
+    double lastTime = glfwGetTime();
+    while (!glfwWindowShouldClose(window) && (frameLimit == 0 || frameCount++ < frameLimit))
+    {
+        GAA_PROFILE_FRAME("Frame");
+        glfwPollEvents();
+        ProcessInput(window);
+        double time = glfwGetTime();
+        float deltaTime = (float)(time - lastTime);
+        lastTime = time;
+
+        GPUProfiler::BeginFrame();
+        glViewport(0, 0, m_ScreenWidth, m_ScreenHeight);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        renderer.Clear();
+
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+        currentTest->OnUpdate(deltaTime);
+        currentTest->OnRender();
+        ImGui::Begin("Test");
+        if (currentTest != testMenu && ImGui::Button("<-"))
+        {
+            delete currentTest;
+            currentTest = testMenu;
+        }
+        currentTest->OnImGuiRender();
+        ImGui::End();
+
+        ImGui::Begin("Graphical Information");
+        ImGui::Text("%s", renderer.RetrieveGraphicalInformation().rendererInformation);
+        ImGui::Text("%s", renderer.RetrieveGraphicalInformation().vendorInformation);
+        ImGui::Text("%s", renderer.RetrieveGraphicalInformation().versionInformation);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+        ImGui::End();
+        GPUProfiler::OnImGuiRender();
+        RenderStats::OnImGuiRender();
+        GPUMemoryTracker::OnImGuiRender();
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        GPUProfiler::EndFrame();
+
+        glfwSwapBuffers(window);
+        OpenGLRenderer::EndFrame(); //Retires what the tests destroyed, once the GPU is done with it.
+    }
+
+    if (currentTest != testMenu)
+    {
+        delete currentTest;
+    }
+    delete testMenu;
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    //Everything that runs in parallel, the offline tools below included, runs as jobs on the job system's worker threads. The main thread is one of them too.
+    GAA_PROFILE_THREAD("Main Thread");
+    JobSystem::Initialize();
+
+    //Cooking meshes is an offline step that needs no window or context, so we do it and leave before GLFW is even initialized.
+    bool ranTool = true;
+    int toolResult = 0;
+    if (MeshCooker::IsCookCommand(argc, argv))
+    {
+        toolResult = MeshCooker::RunCommandLine(argc, argv);
+    }
+    else if (GLTFScene::IsBenchmarkCommand(argc, argv))
+    {
+        toolResult = GLTFScene::RunBenchmark(argc, argv);
+    }
+    else if (FrustumCuller::IsBenchmarkCommand(argc, argv))
+    {
+        toolResult = FrustumCuller::RunBenchmark(argc, argv);
+    }
+    else
+    {
+        ranTool = false;
+    }
+    if (ranTool)
+    {
+        JobSystem::Shutdown();
+        return toolResult;
+    }
+
+    //--render-stats writes a row of RenderStats per frame to the file given, and --frames closes the window after that many frames, so a CI run can
+    //render a fixed number of frames and compare the file against the last one.
+    const char* renderStatsPath = nullptr;
+    int frameLimit = 0;
+    bool runTests = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--render-stats") == 0 && i + 1 < argc)
+        {
+            renderStatsPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            frameLimit = std::max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--tests") == 0)
+        {
+            runTests = true;
+        }
+    }
+
     std::cout << "Start of Program!" << "\n";
     RendererAbstractor::Renderer::InitializeSelectedRenderer(RendererAbstractor::Renderer::API::OpenGL);
 
@@ -82,15 +241,29 @@ int main()
     //We also tell GLFW that we explicitly want to use the core profile. This means we will get access to a smaller subset of OpenGL features without backwards compatible features we no longer need.
     //On Mac OS X, you need to add "glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);" for it to work.
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef GAA_ENABLE_GL_DEBUG
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE); //So the driver tells GLDebug everything it knows. Release builds don't pay for the extra checking.
+#endif
    
     //Creates a Window Object. This window object holds all the windowing data and is required by most of GLFW's other functions. 
     //The "glfwCreateWindow()" function requires the window width and height as its first two arguments respectively.
     //The third argument allows us to create a name for the window which I've called "OpenGL".
     //We can ignore the last 2 parameters. The function returns a GLFWwindow object that we will later need for other GLFW operations.
+    //3.3 is all we require, but we ask for 4.6 first so that newer features like multi draw indirect are there wherever the driver has them.
+    //Anything past 3.3 is checked for through GLEW before it is used, so if the driver can't give us 4.6 we simply retry with the 3.3 hints.
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     GLFWwindow* window = glfwCreateWindow(m_ScreenWidth, m_ScreenHeight, "OpenGL", nullptr, nullptr);
     if (window == nullptr)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(m_ScreenWidth, m_ScreenHeight, "OpenGL", nullptr, nullptr);
+    }
+    if (window == nullptr)
     {
         std::cout << "Failed to create GLFW Window! \n";
+        JobSystem::Shutdown();
         glfwTerminate();
         return -1;
     }
@@ -102,11 +275,28 @@ int main()
     //There are many callbacks we can set to register our own functions. This ranges from callbacks that process input, error messages etc. 
     //We register these callbacks after we've created the window and before the render loop is initiated. 
 
-    //Initializes GLEW. 
+    //Initializes GLEW. Core profiles list their extensions differently from the old way GLEW queries by default, so without glewExperimental it would
+    //report extensions like ARB_multi_draw_indirect as missing even where they are there.
+    glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK)
     {
         std::cout << "Error!" << std::endl;
     }
+    GLDebug::EnableForCurrentContext(); //Only does anything in the configurations that define GAA_ENABLE_GL_DEBUG.
+
+    if (runTests)
+    {
+        if (renderStatsPath != nullptr)
+        {
+            RenderStats::StartDump(renderStatsPath);
+        }
+        int testResult = RunTestMenu(window, frameLimit);
+        RenderStats::StopDump();
+        JobSystem::Shutdown();
+        OpenGLRenderer::Shutdown();
+        glfwTerminate();
+        return testResult;
+    }
 
     LearnShader ourShader("VertexShader.shader", "FragmentShader.shader");
 
@@ -174,7 +364,19 @@ int main()
     //If, for instance, one would have a buffer with data that is likely to change frequently, a usage type of GL_DYNAMIC_DRAW ensures the graphics card will place the data in memory that allows for faster writes.
     //As of now, we have stored the vertex data within memory on the graphics card as managed by a Vertex Buffer Object named VBO. Next, we want to create a vertex and fragment shader that actually processes this data, so lets start building those. 
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    //We don't actually upload the floats above as they are. Each vertex is 32 bytes of full precision floats, far more than these positions, colors and texture
+    //coordinates need. The VertexQuantizer packs every attribute into the smallest format that stays within the error we allow it, which here brings
+    //the vertex down to 12 bytes. The GPU converts the packed values back to floats as it fetches them, so the shader doesn't change at all.
+    QuantizationAttribute vertexAttributes[3];
+    vertexAttributes[0].componentCount = 3; //Positions.
+    vertexAttributes[0].maxError = 0.001f;
+    vertexAttributes[1].componentCount = 3; //Colors, which only need to be right to within one step of an 8 bit display.
+    vertexAttributes[1].maxError = 1.0f / 255.0f;
+    vertexAttributes[2].componentCount = 2; //Texture coordinates.
+    vertexAttributes[2].maxError = 0.001f;
+    QuantizedVertices quantizedVertices = VertexQuantizer::Quantize(vertices, 4, vertexAttributes, 3);
+
+    glBufferData(GL_ARRAY_BUFFER, quantizedVertices.data.size(), quantizedVertices.data.data(), GL_STATIC_DRAW);
 
 	//Index Buffer Creation
 	unsigned int indexBufferObject;
@@ -183,57 +385,31 @@ int main()
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
 
-    //Links the vertex attributes from the buffers that we passed into the shaders.
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    //Links the vertex attributes from the buffers that we passed into the shaders. The quantizer decided the formats, so we take them from the layout it built.
+    const auto& quantizedElements = quantizedVertices.layout.GetElements();
+    for (unsigned int i = 0; i < quantizedElements.size(); i++)
+    {
+        glVertexAttribPointer(i, quantizedElements[i].count, quantizedElements[i].type, quantizedElements[i].normalized, quantizedVertices.layout.GetStride(), (void*)(uintptr_t)quantizedElements[i].offset);
+        glEnableVertexAttribArray(i);
+    }
 
 
 
-    unsigned int textureData1, textureData2;
-    glGenTextures(1, &textureData1);
-    glBindTexture(GL_TEXTURE_2D, textureData1);
-    //Sets the texture wrapping and filtering options on the currently bound texture object. 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    //The texture wrapping and filtering options live in sampler objects shared through the SamplerCache, and each Texture binds its own to the slot it goes in.
+    SamplerState containerSampler;
+    containerSampler.wrapS = GL_REPEAT;
+    containerSampler.wrapT = GL_REPEAT;
+    containerSampler.minFilter = GL_NEAREST; //When objects are zoomed out aka scaled down (further away), we interpolate from the texel closest to the fragment. 
+    containerSampler.magFilter = GL_LINEAR; //When objects are zoomed in aka scaled up, we interpolate from a combination of nearest texels to the fragment.
+    SamplerState faceSampler = containerSampler;
+    faceSampler.wrapS = GL_MIRRORED_REPEAT;
+    faceSampler.wrapT = GL_MIRRORED_REPEAT;
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); //When objects are zoomed out aka scaled down (further away), we interpolate from the texel closest to the fragment. 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); //When objects are zoomed in aka scaled up, we interpolate from a combination of nearest texels to the fragment.
-   
- //Load and generate the texture.
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load("Resources/Textures/Container.jpg", &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load textures! \n";
-    }
-    stbi_image_free(data);
-
-    glGenTextures(1, &textureData2);
-    glBindTexture(GL_TEXTURE_2D, textureData2);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data2 = stbi_load("Resources/Textures/AwesomeFace.png", &width, &height, &nrChannels, 0);
-    if (data2)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data2);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    stbi_image_free(data2);
+    //Decoding and uploading textures takes long enough to drop frames, so both happen on the upload thread, which has a context of its own sharing objects
+    //with ours. The render loop starts right away and draws the quad once both textures are ready.
+    UploadThread::Start(window);
+    AsyncResource<Texture> containerTexture = UploadThread::CreateTexture("Resources/Textures/Container.jpg", containerSampler);
+    AsyncResource<Texture> faceTexture = UploadThread::CreateTexture("Resources/Textures/AwesomeFace.png", faceSampler);
     
 
     //unsigned int colorUniformLocation = glGetUniformLocation(shaderProgram, "ourColor");
@@ -250,9 +426,37 @@ int main()
     //The "glfwPollEvents()" function checks if any events are triggered (like keyboard input or mouse movement events), updates the window state and calls the corresponding functions which we can register via callback methods.
     //The "glfwSwapBuffers()" function will swap the color buffer (a large 2D buffer that contains color values for each pixel in GLFW's window) that is used to render to during this render iteration and show it as output on the screen.
 
-    while (!glfwWindowShouldClose(window))
+    //ImGui draws on the render thread, from the draw data each frame packet captures, so its setup is the only part of it that needs the context here.
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::StyleColorsDark();
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 330");
+    //ImGui_ImplOpenGL3_NewFrame makes its shaders and font texture the first time it runs, which would be on this thread after the context has moved on.
+    ImGui_ImplOpenGL3_CreateDeviceObjects();
+    //Its font atlas is the one thing of ImGui's big enough to count. The buffers it streams its draw data through are its own business.
+    ImGuiIO& imGuiIO = ImGui::GetIO();
+    unsigned int fontTexture = (unsigned int)(uintptr_t)imGuiIO.Fonts->TexID;
+    GPUMemoryTracker::Track(GLObjectType::Texture, fontTexture, GPUMemoryCategory::UI, (uint64_t)imGuiIO.Fonts->TexWidth * imGuiIO.Fonts->TexHeight * 4);
+    OpenGLRenderer renderer; //Reads the renderer, vendor and version strings for the "Graphical Information" window, which needs the context as well.
+
+    //From here on, a render thread of its own owns the context and does every GL call, so the driver's work overlaps with this thread getting the next frame ready.
+    //Each frame, this thread records what to draw into a frame packet and submits it. The render thread executes it a frame later, swaps buffers and retires resources.
+    RenderThread::Start(window);
+    if (renderStatsPath != nullptr)
     {
-        ProcessInput(window, ourShader); //Process key input events.
+        RenderStats::StartDump(renderStatsPath);
+    }
+
+    int frameCount = 0;
+    while (!glfwWindowShouldClose(window) && (frameLimit == 0 || frameCount++ < frameLimit))
+    {
+        GAA_PROFILE_FRAME("Frame");
+        {
+            GAA_PROFILE_ZONE("Poll Events");
+            glfwPollEvents();
+            ProcessInput(window); //Process key input events.
+        }
 
         /// ===== Rendering =====
 
@@ -265,30 +469,77 @@ int main()
         //Note that we also specify the color to clear the screen with using "glClearColor()".
         //Whenever we call "glClear()" and clear the color buffer, the entire color buffer will be filled with the color as configured with "glClearColor()".
         //As you may recall, the "glClearColor()" function is a state setting function and "glClear()" is a state using function in that it uses the current state to retrieve the clear color from.
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        //Both are recorded as commands here, and the render thread makes the actual calls.
+        FramePacket& packet = RenderThread::BeginFrame();
+        GAA_PROFILE_ZONE("Record Frame");
+        packet.commands.SetViewport(0, 0, m_ScreenWidth, m_ScreenHeight);
+        packet.commands.Clear(0.2f, 0.3f, 0.3f, 1.0f);
 
         //float timeValue = glfwGetTime();
         //float greenValue = (sin(timeValue) / 2.0f) + 0.5f;
         //glUniform4f(colorUniformLocation, 0.5f, greenValue, 0.4f, 0.4f);
-        //Draws Triangle
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textureData1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, textureData2);
+        //Draws Triangle. LearnShader and the raw GL objects predate the command buffer, so they go in as a callback, which runs in order with the other commands.
+        //Values that change from frame to frame are captured by copy, as the render thread runs this while we are already updating the next frame.
+        float textureViewValue = visibleValue;
+        if (containerTexture.IsReady() && faceTexture.IsReady())
+        {
+            packet.commands.BeginProfileScope("Quad"); //Shows up in the "GPU Profiler" window, under the frame's commands.
+            packet.commands.BindTexture(containerTexture.Get(), 0);
+            packet.commands.BindTexture(faceTexture.Get(), 1);
+            packet.commands.Callback([&ourShader, vertexArrayObject, textureViewValue]()
+            {
+                ourShader.UseShader();
+                ourShader.SetUniformFloat("textureViewValue", textureViewValue);
+                glBindVertexArray(vertexArrayObject); //Binds the buffer and configurations for the object we want to draw (provided we have binded it to something else before calling this).
+
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                RenderStats::RecordDraw(6); //Raw GL isn't counted on its own.
+                //glDrawArrays(GL_TRIANGLES, 0, 3);
+            });
+            packet.commands.EndProfileScope();
+        }
 
-        ourShader.UseShader();
-		glBindVertexArray(vertexArrayObject); //Binds the buffer and configurations for the object we want to draw (provided we have binded it to something else before calling this).
+        //The UI is built here on the main thread like any other frame's, and the packet takes its draw data over for the render thread to draw.
+        {
+            GAA_PROFILE_ZONE("ImGui");
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+            ImGui::Begin("Graphical Information");
+            ImGui::Text("%s", renderer.RetrieveGraphicalInformation().rendererInformation);
+            ImGui::Text("%s", renderer.RetrieveGraphicalInformation().vendorInformation);
+            ImGui::Text("%s", renderer.RetrieveGraphicalInformation().versionInformation);
+            ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+            ImGui::End();
+            GPUProfiler::OnImGuiRender();
+            RenderStats::OnImGuiRender();
+            GPUMemoryTracker::OnImGuiRender();
+            ImGui::Render();
+            packet.CaptureImGui(ImGui::GetDrawData());
+        }
 
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        //glDrawArrays(GL_TRIANGLES, 0, 3);
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        GAA_PROFILE_COUNTER("Commands", packet.commands.GetCommandCount());
+        RenderThread::SubmitFrame();
+        JobSystem::ProcessMainThreadJobs(); //Work that jobs handed back to this thread. Anything that needs GL goes to RenderThread::Enqueue instead.
     }
 
+    //The render thread finishes every frame we submitted and hands the context back, so the cleanup below can make GL calls on this thread again.
+    RenderThread::Stop();
+    UploadThread::Stop();
+    RenderStats::StopDump(); //After the render thread, so every frame it ran is in the file.
+    GPUMemoryTracker::Untrack(GLObjectType::Texture, fontTexture); //ImGui deletes it itself.
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+
+    //Jobs may still hand GL work back to us while they finish, so the workers go before the context does.
+    JobSystem::Shutdown();
     glDeleteVertexArrays(1, &vertexArrayObject);
     glDeleteBuffers(1, &vertexBufferObject);
     ourShader.DeleteShader();
+    containerTexture.Reset();
+    faceTexture.Reset();
+    OpenGLRenderer::Shutdown();
 
     //As we exit the render loop, remember to properly clean and delete all of GLFW's resources that were allocated.
     //We can do this via the "glfwTerminate()" function that we call at the end of the main function.
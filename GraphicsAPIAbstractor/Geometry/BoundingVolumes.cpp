@@ -0,0 +1,72 @@
+#include "GAAPrecompiledHeader.h"
+#include "BoundingVolumes.h"
+#include <algorithm>
+#include <cmath>
+
+BoundingSphere BoundingBox::GetBoundingSphere() const
+{
+	BoundingSphere sphere;
+	sphere.center = GetCenter();
+	sphere.radius = glm::length(GetExtents());
+	return sphere;
+}
+
+BoundingBox BoundingBox::Transform(const glm::mat4& transform) const
+{
+	//Each axis of the new box is as wide as the box's extents projected onto it (Arvo's method), which saves transforming all 8 corners.
+	glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.0f));
+	glm::vec3 extents = GetExtents();
+	glm::vec3 newExtents;
+	for (int i = 0; i < 3; i++)
+	{
+		newExtents[i] = std::abs(transform[0][i]) * extents.x + std::abs(transform[1][i]) * extents.y + std::abs(transform[2][i]) * extents.z;
+	}
+	return { center - newExtents, center + newExtents };
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	//Gribb and Hartmann. A point is inside when -w <= x, y, z <= w in clip space, and each of those 6 inequalities is a plane made of two rows of the matrix.
+	//GLM is column major, so row i is the i'th element of every column.
+	auto row = [&viewProjection](int i) { return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]); };
+	m_Planes[Left] = row(3) + row(0);
+	m_Planes[Right] = row(3) - row(0);
+	m_Planes[Bottom] = row(3) + row(1);
+	m_Planes[Top] = row(3) - row(1);
+	m_Planes[Near] = row(3) + row(2);
+	m_Planes[Far] = row(3) - row(2);
+
+	for (glm::vec4& plane : m_Planes)
+	{
+		float length = glm::length(glm::vec3(plane));
+		plane /= std::max(length, 1e-20f);
+	}
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const
+{
+	for (const glm::vec4& plane : m_Planes)
+	{
+		if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::Intersects(const BoundingBox& box) const
+{
+	glm::vec3 center = box.GetCenter();
+	glm::vec3 extents = box.GetExtents();
+	for (const glm::vec4& plane : m_Planes)
+	{
+		//How far the box reaches towards the plane's normal, which is all that matters for whether it is entirely behind it.
+		float reach = std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y + std::abs(plane.z) * extents.z;
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -reach)
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "glm/glm.hpp"
+
+//16 bytes, the same as a vec4 in a std430 buffer, so arrays of these can be uploaded for the GPU to cull with as they are.
+struct BoundingSphere
+{
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+};
+
+static_assert(sizeof(BoundingSphere) == 16, "BoundingSphere is read by shaders as a vec4.");
+
+struct BoundingBox
+{
+	glm::vec3 minimum = glm::vec3(0.0f);
+	glm::vec3 maximum = glm::vec3(0.0f);
+
+	inline glm::vec3 GetCenter() const { return (minimum + maximum) * 0.5f; }
+	inline glm::vec3 GetExtents() const { return (maximum - minimum) * 0.5f; } //Half the size.
+	BoundingSphere GetBoundingSphere() const;
+	BoundingBox Transform(const glm::mat4& transform) const; //The box around the transformed box, so it grows under rotation.
+};
+
+//The 6 planes of a view projection matrix, pointing inwards and normalized so that a point's signed distance from one is just dot(plane.xyz, point) + plane.w.
+class Frustum
+{
+public:
+	enum Plane { Left = 0, Right, Bottom, Top, Near, Far, PlaneCount };
+
+	Frustum() = default;
+	explicit Frustum(const glm::mat4& viewProjection);
+
+	//Conservative: something just outside a corner of the frustum can still pass, as each plane is tested on its own.
+	bool Intersects(const BoundingSphere& sphere) const;
+	bool Intersects(const BoundingBox& box) const;
+
+	inline const glm::vec4& GetPlane(unsigned int plane) const { return m_Planes[plane]; }
+	inline const glm::vec4* GetPlanes() const { return m_Planes; } //PlaneCount of them, ready for Shader::SetUniform4fv.
+
+private:
+	glm::vec4 m_Planes[PlaneCount];
+};
@@ -0,0 +1,135 @@
+#include "GAAPrecompiledHeader.h"
+#include "DepthPyramid.h"
+#include <algorithm>
+
+unsigned int DepthPyramid::CalculateLevelCount(unsigned int width, unsigned int height)
+{
+	unsigned int levelCount = 1;
+	for (unsigned int size = std::max(width, height); size > 1; size /= 2)
+	{
+		levelCount++;
+	}
+	return levelCount;
+}
+
+void DepthPyramid::Clear()
+{
+	m_Depth.clear();
+	m_Levels.clear();
+}
+
+void DepthPyramid::Build(const float* depth, unsigned int width, unsigned int height, const glm::mat4& viewProjection)
+{
+	Clear();
+	m_ViewProjection = viewProjection;
+	if (width == 0 || height == 0)
+	{
+		return;
+	}
+
+	unsigned int levelCount = CalculateLevelCount(width, height);
+	size_t totalSize = 0;
+	for (unsigned int level = 0, w = width, h = height; level < levelCount; level++, w = std::max(w / 2, 1u), h = std::max(h / 2, 1u))
+	{
+		m_Levels.push_back({ totalSize, w, h });
+		totalSize += (size_t)w * h;
+	}
+	m_Depth.resize(totalSize);
+	std::copy(depth, depth + (size_t)width * height, m_Depth.begin());
+
+	for (unsigned int level = 1; level < levelCount; level++)
+	{
+		const Level& source = m_Levels[level - 1];
+		const Level& destination = m_Levels[level];
+		const float* sourceDepth = m_Depth.data() + source.offset;
+		float* destinationDepth = m_Depth.data() + destination.offset;
+
+		for (unsigned int y = 0; y < destination.height; y++)
+		{
+			//A level that is 1 tall can't halve again, and its neighbour that is still shrinking in the other direction reads its only row.
+			unsigned int y0 = std::min(y * 2, source.height - 1);
+			unsigned int y1 = std::min(y * 2 + 1, source.height - 1);
+			//The last row of an odd sized level also takes in the row the halving would otherwise drop, so no depth goes missing.
+			unsigned int yLast = (y == destination.height - 1) ? source.height - 1 : y1;
+			for (unsigned int x = 0; x < destination.width; x++)
+			{
+				unsigned int x0 = std::min(x * 2, source.width - 1);
+				unsigned int xLast = (x == destination.width - 1) ? source.width - 1 : std::min(x * 2 + 1, source.width - 1);
+				float farthest = 0.0f;
+				for (unsigned int sy = y0; sy <= yLast; sy++)
+				{
+					for (unsigned int sx = x0; sx <= xLast; sx++)
+					{
+						farthest = std::max(farthest, sourceDepth[sy * source.width + sx]);
+					}
+				}
+				destinationDepth[y * destination.width + x] = farthest;
+			}
+		}
+	}
+}
+
+bool DepthPyramid::ProjectBox(const BoundingBox& box, const glm::mat4& viewProjection, ScreenBounds& bounds)
+{
+	bounds.minimum = glm::vec2(1e30f);
+	bounds.maximum = glm::vec2(-1e30f);
+	bounds.nearestDepth = 1.0f;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 position((corner & 1) ? box.maximum.x : box.minimum.x, (corner & 2) ? box.maximum.y : box.minimum.y, (corner & 4) ? box.maximum.z : box.minimum.z);
+		glm::vec4 clip = viewProjection * glm::vec4(position, 1.0f);
+		if (clip.w <= 1e-5f)
+		{
+			return false;
+		}
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		bounds.minimum = glm::min(bounds.minimum, glm::vec2(ndc));
+		bounds.maximum = glm::max(bounds.maximum, glm::vec2(ndc));
+		bounds.nearestDepth = std::min(bounds.nearestDepth, ndc.z * 0.5f + 0.5f);
+	}
+	bounds.minimum = bounds.minimum * 0.5f + 0.5f;
+	bounds.maximum = bounds.maximum * 0.5f + 0.5f;
+	return true;
+}
+
+bool DepthPyramid::IsOccluded(const BoundingSphere& sphere) const
+{
+	return IsOccluded(BoundingBox{ sphere.center - sphere.radius, sphere.center + sphere.radius });
+}
+
+bool DepthPyramid::IsOccluded(const BoundingBox& box) const
+{
+	ScreenBounds bounds;
+	if (IsEmpty() || !ProjectBox(box, m_ViewProjection, bounds))
+	{
+		return false;
+	}
+	if (bounds.maximum.x < 0.0f || bounds.maximum.y < 0.0f || bounds.minimum.x > 1.0f || bounds.minimum.y > 1.0f)
+	{
+		return false;
+	}
+
+	//The pixels the rectangle covers, then the first level at which they fit within 2x2 texels, so at most 4 reads cover the lot.
+	int width = (int)GetWidth(), height = (int)GetHeight();
+	int minimumX = std::clamp((int)(bounds.minimum.x * width), 0, width - 1);
+	int minimumY = std::clamp((int)(bounds.minimum.y * height), 0, height - 1);
+	int maximumX = std::clamp((int)(bounds.maximum.x * width), 0, width - 1);
+	int maximumY = std::clamp((int)(bounds.maximum.y * height), 0, height - 1);
+	unsigned int level = 0;
+	while (level + 1 < GetLevelCount() && ((maximumX >> level) - (minimumX >> level) > 1 || (maximumY >> level) - (minimumY >> level) > 1))
+	{
+		level++;
+	}
+
+	//Texel n of level l covers pixels n * 2^l up to (n + 1) * 2^l, and the last one also everything past that, hence the clamp rather than a rescale.
+	unsigned int levelWidth = GetWidth(level), levelHeight = GetHeight(level);
+	float farthest = 0.0f;
+	for (unsigned int y = std::min((unsigned int)minimumY >> level, levelHeight - 1); y <= std::min((unsigned int)maximumY >> level, levelHeight - 1); y++)
+	{
+		for (unsigned int x = std::min((unsigned int)minimumX >> level, levelWidth - 1); x <= std::min((unsigned int)maximumX >> level, levelWidth - 1); x++)
+		{
+			farthest = std::max(farthest, GetDepth(level, x, y));
+		}
+	}
+	return bounds.nearestDepth > farthest;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "BoundingVolumes.h"
+#include "glm/glm.hpp"
+
+//A hierarchical Z buffer on the CPU. Level 0 is a depth buffer, and every texel of each level after it holds the farthest depth of the 2x2 texels below it
+//(or 3 wide, at the odd edge of an odd sized level), so one texel of level n bounds 2^n x 2^n pixels of depth. Anything whose nearest point is farther than
+//the farthest depth over the rectangle it covers on screen is hidden.
+//This is the reference for HiZPyramid and GPUCuller, so the layout and the test here are exactly theirs: depth is window space [0, 1] with the bottom row first,
+//as glReadPixels returns it.
+class DepthPyramid
+{
+public:
+	//Where something lands on screen. Coordinates are [0, 1] across the viewport, nearestDepth is the window space depth of its closest point.
+	struct ScreenBounds
+	{
+		glm::vec2 minimum, maximum;
+		float nearestDepth;
+	};
+
+	//viewProjection is whatever the depth was drawn with, which IsOccluded projects through.
+	void Build(const float* depth, unsigned int width, unsigned int height, const glm::mat4& viewProjection);
+	void Clear();
+
+	//Always false for anything that reaches behind the camera or off screen, as the depth buffer knows nothing about what is there.
+	bool IsOccluded(const BoundingBox& box) const;
+	bool IsOccluded(const BoundingSphere& sphere) const; //Tests the box around the sphere, which is what the GPU does too.
+
+	//False if the box crosses the near plane, as it then has no sensible rectangle on screen.
+	static bool ProjectBox(const BoundingBox& box, const glm::mat4& viewProjection, ScreenBounds& bounds);
+
+	inline bool IsEmpty() const { return m_Levels.empty(); }
+	inline unsigned int GetLevelCount() const { return (unsigned int)m_Levels.size(); }
+	inline unsigned int GetWidth(unsigned int level = 0) const { return m_Levels[level].width; }
+	inline unsigned int GetHeight(unsigned int level = 0) const { return m_Levels[level].height; }
+	inline const float* GetLevel(unsigned int level) const { return m_Depth.data() + m_Levels[level].offset; }
+	inline float GetDepth(unsigned int level, unsigned int x, unsigned int y) const { return GetLevel(level)[y * m_Levels[level].width + x]; }
+	inline const glm::mat4& GetViewProjection() const { return m_ViewProjection; }
+
+	static unsigned int CalculateLevelCount(unsigned int width, unsigned int height); //Down to 1x1.
+
+private:
+	struct Level
+	{
+		size_t offset;
+		unsigned int width, height;
+	};
+
+	std::vector<float> m_Depth; //Every level, one after the other.
+	std::vector<Level> m_Levels;
+	glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+};
@@ -0,0 +1,255 @@
+#include "GAAPrecompiledHeader.h"
+#include "DepthRasterizer.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+//SSE is part of every x64 CPU, and MSVC targets it by default on x86 too.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAA_RASTERIZER_SSE 1
+#include <emmintrin.h>
+#else
+#define GAA_RASTERIZER_SSE 0
+#endif
+
+DepthRasterizer::DepthRasterizer(unsigned int width, unsigned int height)
+	: m_Width((std::max(width, 4u) + 3) & ~3u), m_Height(std::max(height, 1u)), m_ViewProjection(1.0f)
+{
+	m_TilesX = (m_Width + s_TileWidth - 1) / s_TileWidth;
+	m_TilesY = (m_Height + s_TileHeight - 1) / s_TileHeight;
+	m_Depth.resize((size_t)m_Width * m_Height, 1.0f);
+	m_Bins.resize((size_t)m_TilesX * m_TilesY);
+}
+
+void DepthRasterizer::Begin(const glm::mat4& viewProjection)
+{
+	m_ViewProjection = viewProjection;
+	std::fill(m_Depth.begin(), m_Depth.end(), 1.0f);
+	m_Triangles.clear();
+	for (std::vector<unsigned int>& bin : m_Bins)
+	{
+		bin.clear();
+	}
+}
+
+void DepthRasterizer::AddOccluder(const float* positions, size_t vertexCount, size_t vertexStride, const unsigned int* indices, size_t indexCount, const glm::mat4& model)
+{
+	glm::mat4 modelViewProjection = m_ViewProjection * model;
+	std::vector<glm::vec4> clipPositions(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const float* position = positions + i * vertexStride;
+		clipPositions[i] = modelViewProjection * glm::vec4(position[0], position[1], position[2], 1.0f);
+	}
+
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const glm::vec4& a = clipPositions[indices[i]];
+		const glm::vec4& b = clipPositions[indices[i + 1]];
+		const glm::vec4& c = clipPositions[indices[i + 2]];
+		//Entirely outside any one side of the frustum (bar the far plane, which the depth clamps for us) means it can't be on screen.
+		if ((a.x < -a.w && b.x < -b.w && c.x < -c.w) || (a.x > a.w && b.x > b.w && c.x > c.w) ||
+			(a.y < -a.w && b.y < -b.w && c.y < -c.w) || (a.y > a.w && b.y > b.w && c.y > c.w) ||
+			(a.z < -a.w && b.z < -b.w && c.z < -c.w))
+		{
+			continue;
+		}
+		AddClippedTriangle(a, b, c);
+	}
+}
+
+void DepthRasterizer::AddOccluder(const BoundingBox& box, const glm::mat4& model)
+{
+	float corners[8 * 3];
+	for (int corner = 0; corner < 8; corner++)
+	{
+		corners[corner * 3 + 0] = (corner & 1) ? box.maximum.x : box.minimum.x;
+		corners[corner * 3 + 1] = (corner & 2) ? box.maximum.y : box.minimum.y;
+		corners[corner * 3 + 2] = (corner & 4) ? box.maximum.z : box.minimum.z;
+	}
+	static const unsigned int indices[] =
+	{
+		0, 2, 1, 1, 2, 3,   4, 5, 6, 5, 7, 6, //-z, +z
+		0, 1, 4, 1, 5, 4,   2, 6, 3, 3, 6, 7, //-y, +y
+		0, 4, 2, 2, 4, 6,   1, 3, 5, 3, 7, 5  //-x, +x
+	};
+	AddOccluder(corners, 8, 3, indices, 36, model);
+}
+
+void DepthRasterizer::AddClippedTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+	//Only the near plane is clipped against properly, as dividing by a w at or behind the camera is meaningless. The other sides are handled by clamping the
+	//triangle's bounds to the screen.
+	glm::vec4 input[3] = { a, b, c };
+	glm::vec4 polygon[4];
+	int vertexCount = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& current = input[i];
+		const glm::vec4& next = input[(i + 1) % 3];
+		float currentDistance = current.z + current.w, nextDistance = next.z + next.w;
+		if (currentDistance >= 0.0f)
+		{
+			polygon[vertexCount++] = current;
+		}
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+		{
+			polygon[vertexCount++] = current + (next - current) * (currentDistance / (currentDistance - nextDistance));
+		}
+	}
+	if (vertexCount < 3)
+	{
+		return;
+	}
+
+	glm::vec3 screen[4];
+	for (int i = 0; i < vertexCount; i++)
+	{
+		glm::vec3 ndc = glm::vec3(polygon[i]) / std::max(polygon[i].w, 1e-7f);
+		screen[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * m_Width, (ndc.y * 0.5f + 0.5f) * m_Height, ndc.z * 0.5f + 0.5f);
+	}
+	AddScreenTriangle(screen[0], screen[1], screen[2]);
+	if (vertexCount == 4)
+	{
+		AddScreenTriangle(screen[0], screen[2], screen[3]);
+	}
+}
+
+void DepthRasterizer::AddScreenTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+	float area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+	if (std::abs(area) < 1e-8f)
+	{
+		return;
+	}
+	//Double sided: clockwise triangles are turned around so the edge functions are always positive inside.
+	glm::vec3 vertices[3] = { a, area > 0.0f ? b : c, area > 0.0f ? c : b };
+	area = std::abs(area);
+
+	ScreenTriangle triangle;
+	float minimumX = vertices[0].x, maximumX = vertices[0].x, minimumY = vertices[0].y, maximumY = vertices[0].y;
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec3& from = vertices[i];
+		const glm::vec3& to = vertices[(i + 1) % 3];
+		triangle.edgeA[i] = from.y - to.y;
+		triangle.edgeB[i] = to.x - from.x;
+		triangle.edgeC[i] = -(triangle.edgeA[i] * from.x + triangle.edgeB[i] * from.y);
+		minimumX = std::min(minimumX, from.x);
+		maximumX = std::max(maximumX, from.x);
+		minimumY = std::min(minimumY, from.y);
+		maximumY = std::max(maximumY, from.y);
+	}
+
+	//Window space depth is linear across the screen, so it is a plane too.
+	const glm::vec3& v0 = vertices[0];
+	const glm::vec3& v1 = vertices[1];
+	const glm::vec3& v2 = vertices[2];
+	triangle.depthA = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+	triangle.depthB = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+	triangle.depthC = v0.z - triangle.depthA * v0.x - triangle.depthB * v0.y;
+
+	//Pixel centers are at +0.5.
+	triangle.minimumX = std::max((int)std::ceil(minimumX - 0.5f), 0);
+	triangle.minimumY = std::max((int)std::ceil(minimumY - 0.5f), 0);
+	triangle.maximumX = std::min((int)std::floor(maximumX - 0.5f), (int)m_Width - 1);
+	triangle.maximumY = std::min((int)std::floor(maximumY - 0.5f), (int)m_Height - 1);
+	if (triangle.minimumX > triangle.maximumX || triangle.minimumY > triangle.maximumY)
+	{
+		return;
+	}
+
+	unsigned int index = (unsigned int)m_Triangles.size();
+	m_Triangles.push_back(triangle);
+	for (unsigned int tileY = triangle.minimumY / s_TileHeight; tileY <= triangle.maximumY / s_TileHeight; tileY++)
+	{
+		for (unsigned int tileX = triangle.minimumX / s_TileWidth; tileX <= triangle.maximumX / s_TileWidth; tileX++)
+		{
+			m_Bins[tileY * m_TilesX + tileX].push_back(index);
+		}
+	}
+}
+
+void DepthRasterizer::Rasterize()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	//Tiles never share pixels, so they can be drawn in any order on any thread without further synchronisation. Each is small, so let them go one at a time.
+	JobSystem::ParallelFor(m_Bins.size(), [this](size_t begin, size_t end)
+	{
+		for (size_t tile = begin; tile < end; tile++)
+		{
+			RasterizeTile((unsigned int)tile);
+		}
+	});
+
+	m_Pyramid.Build(m_Depth.data(), m_Width, m_Height, m_ViewProjection);
+	m_RasterizeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void DepthRasterizer::RasterizeTile(unsigned int tile)
+{
+	int tileStartX = (int)((tile % m_TilesX) * s_TileWidth), tileStartY = (int)((tile / m_TilesX) * s_TileHeight);
+	int tileEndX = std::min(tileStartX + (int)s_TileWidth, (int)m_Width), tileEndY = std::min(tileStartY + (int)s_TileHeight, (int)m_Height);
+
+	for (unsigned int index : m_Bins[tile])
+	{
+		const ScreenTriangle& triangle = m_Triangles[index];
+		//Groups of 4 start on a multiple of 4, and the tile and screen widths are multiples of 4 too, so a group never straddles either.
+		int startX = std::max(triangle.minimumX, tileStartX) & ~3;
+		int endX = std::min(triangle.maximumX, tileEndX - 1);
+		int startY = std::max(triangle.minimumY, tileStartY);
+		int endY = std::min(triangle.maximumY, tileEndY - 1);
+
+#if GAA_RASTERIZER_SSE
+		__m128 edgeA0 = _mm_set1_ps(triangle.edgeA[0]), edgeA1 = _mm_set1_ps(triangle.edgeA[1]), edgeA2 = _mm_set1_ps(triangle.edgeA[2]);
+		__m128 depthA = _mm_set1_ps(triangle.depthA);
+		__m128 zero = _mm_setzero_ps();
+		for (int y = startY; y <= endY; y++)
+		{
+			float centerY = y + 0.5f;
+			__m128 row0 = _mm_set1_ps(triangle.edgeB[0] * centerY + triangle.edgeC[0]);
+			__m128 row1 = _mm_set1_ps(triangle.edgeB[1] * centerY + triangle.edgeC[1]);
+			__m128 row2 = _mm_set1_ps(triangle.edgeB[2] * centerY + triangle.edgeC[2]);
+			__m128 rowDepth = _mm_set1_ps(triangle.depthB * centerY + triangle.depthC);
+			float* depthRow = m_Depth.data() + (size_t)y * m_Width;
+			for (int x = startX; x <= endX; x += 4)
+			{
+				__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+				__m128 inside = _mm_and_ps(_mm_and_ps(
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, centerX), row0), zero),
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, centerX), row1), zero)),
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, centerX), row2), zero));
+				if (_mm_movemask_ps(inside) == 0)
+				{
+					continue;
+				}
+				__m128 depth = _mm_add_ps(_mm_mul_ps(depthA, centerX), rowDepth);
+				__m128 current = _mm_loadu_ps(depthRow + x);
+				__m128 nearer = _mm_min_ps(current, depth);
+				_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+			}
+		}
+#else
+		for (int y = startY; y <= endY; y++)
+		{
+			float centerY = y + 0.5f;
+			float* depthRow = m_Depth.data() + (size_t)y * m_Width;
+			for (int x = startX; x <= endX; x++)
+			{
+				float centerX = x + 0.5f;
+				bool inside = true;
+				for (int edge = 0; edge < 3; edge++)
+				{
+					inside &= triangle.edgeA[edge] * centerX + (triangle.edgeB[edge] * centerY + triangle.edgeC[edge]) >= 0.0f;
+				}
+				if (inside)
+				{
+					depthRow[x] = std::min(depthRow[x], triangle.depthA * centerX + (triangle.depthB * centerY + triangle.depthC));
+				}
+			}
+		}
+#endif
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "BoundingVolumes.h"
+#include "DepthPyramid.h"
+#include "glm/glm.hpp"
+
+//A small software rasterizer that only writes depth, for occlusion culling on the CPU. A few large occluders (walls, terrain, buildings) are drawn into a low
+//resolution depth buffer from the camera, that is reduced into a DepthPyramid, and everything else is tested against it before it is ever submitted, so
+//neither the GPU nor a readback from it is involved. That also makes it testable on machines without a GPU.
+//Triangles are set up and sorted into screen tiles (binned) as they are added, then the tiles are rasterized in parallel, 4 pixels at a time with SSE.
+//Only pixels whose centers a triangle covers are written, and occluders are drawn double sided, so winding doesn't matter.
+class DepthRasterizer
+{
+public:
+	//Width is rounded up to a multiple of 4 for the SIMD loops. A few hundred pixels across is plenty for occlusion.
+	DepthRasterizer(unsigned int width = 320, unsigned int height = 180);
+
+	void Begin(const glm::mat4& viewProjection); //Clears the depth and the bins.
+	//positions are 3 floats per vertex, vertexStride floats apart. model takes them to world space.
+	void AddOccluder(const float* positions, size_t vertexCount, size_t vertexStride, const unsigned int* indices, size_t indexCount, const glm::mat4& model = glm::mat4(1.0f));
+	void AddOccluder(const BoundingBox& box, const glm::mat4& model = glm::mat4(1.0f)); //A solid box. Make it a little smaller than what it stands in for.
+	//Draws every bin, as jobs on the JobSystem, and builds the pyramid.
+	void Rasterize();
+
+	inline bool IsOccluded(const BoundingBox& box) const { return m_Pyramid.IsOccluded(box); }
+	inline bool IsOccluded(const BoundingSphere& sphere) const { return m_Pyramid.IsOccluded(sphere); }
+
+	inline const DepthPyramid& GetPyramid() const { return m_Pyramid; }
+	inline const float* GetDepth() const { return m_Depth.data(); } //Window space [0, 1], bottom row first, 1 where nothing was drawn.
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline size_t GetTriangleCount() const { return m_Triangles.size(); } //After clipping, of what was added since Begin.
+	inline double GetRasterizeMilliseconds() const { return m_RasterizeMilliseconds; }
+
+	static constexpr unsigned int s_TileWidth = 32, s_TileHeight = 32;
+
+private:
+	//Everything the inner loop needs, already in pixel space. Each edge function is a * x + b * y + c, positive inside, and depth is a plane the same way.
+	struct ScreenTriangle
+	{
+		float edgeA[3], edgeB[3], edgeC[3];
+		float depthA, depthB, depthC;
+		int minimumX, minimumY, maximumX, maximumY; //The pixels whose centers the triangle's bounds cover, clamped to the screen.
+	};
+
+	void AddClippedTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c); //Clip space.
+	void AddScreenTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c); //Pixels and window space depth.
+	void RasterizeTile(unsigned int tile);
+
+	unsigned int m_Width, m_Height;
+	unsigned int m_TilesX, m_TilesY;
+	glm::mat4 m_ViewProjection;
+	std::vector<float> m_Depth;
+	std::vector<ScreenTriangle> m_Triangles;
+	std::vector<std::vector<unsigned int>> m_Bins; //The triangles overlapping each tile, row by row.
+	DepthPyramid m_Pyramid;
+	double m_RasterizeMilliseconds = 0.0;
+};
@@ -0,0 +1,401 @@
+#include "GAAPrecompiledHeader.h"
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+//SSE is part of every x64 CPU, and MSVC targets it by default on x86 too. AVX isn't, so that path is compiled for it specifically and only taken if the CPU
+//says it has it. 8 wide float compares only need AVX, which every AVX2 CPU has, so that is all we check for.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAA_CULLING_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GAA_AVX_FUNCTION
+#else
+#define GAA_AVX_FUNCTION __attribute__((target("avx")))
+#endif
+#else
+#define GAA_CULLING_SIMD 0
+#endif
+
+namespace
+{
+	bool IsAVXAvailable()
+	{
+#if GAA_CULLING_SIMD && defined(_MSC_VER)
+		//The CPU has to support AVX, and the OS has to save the upper halves of the registers on a context switch.
+		int info[4];
+		__cpuid(info, 1);
+		bool osSavesRegisters = (info[2] & (1 << 27)) != 0;
+		bool hasAVX = (info[2] & (1 << 28)) != 0;
+		return osSavesRegisters && hasAVX && (_xgetbv(0) & 6) == 6;
+#elif GAA_CULLING_SIMD
+		return __builtin_cpu_supports("avx");
+#else
+		return false;
+#endif
+	}
+
+	const bool s_AVXAvailable = IsAVXAvailable();
+
+	unsigned int CountBits(const unsigned char* bytes, size_t size)
+	{
+		unsigned int count = 0;
+		for (size_t i = 0; i < size; i++)
+		{
+			unsigned int byte = bytes[i];
+			byte = byte - ((byte >> 1) & 0x55);
+			byte = (byte & 0x33) + ((byte >> 2) & 0x33);
+			count += (byte + (byte >> 4)) & 0x0F;
+		}
+		return count;
+	}
+}
+
+unsigned int FrustumCuller::Add(const BoundingBox& box)
+{
+	if (m_Count % 8 == 0)
+	{
+		size_t paddedSize = m_Count + 8;
+		for (std::vector<float>* component : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_Radius, &m_ExtentX, &m_ExtentY, &m_ExtentZ })
+		{
+			component->resize(paddedSize, 0.0f);
+		}
+	}
+	Set(m_Count, box);
+	return m_Count++;
+}
+
+unsigned int FrustumCuller::Add(const BoundingSphere& sphere)
+{
+	return Add(BoundingBox{ sphere.center - sphere.radius, sphere.center + sphere.radius });
+}
+
+void FrustumCuller::Set(unsigned int index, const BoundingBox& box)
+{
+	glm::vec3 center = box.GetCenter();
+	glm::vec3 extents = box.GetExtents();
+	m_CenterX[index] = center.x;
+	m_CenterY[index] = center.y;
+	m_CenterZ[index] = center.z;
+	m_Radius[index] = glm::length(extents);
+	m_ExtentX[index] = extents.x;
+	m_ExtentY[index] = extents.y;
+	m_ExtentZ[index] = extents.z;
+}
+
+void FrustumCuller::Set(unsigned int index, const BoundingSphere& sphere)
+{
+	//Keeps the sphere as it is rather than growing it to fit its box.
+	Set(index, BoundingBox{ sphere.center - sphere.radius, sphere.center + sphere.radius });
+	m_Radius[index] = sphere.radius;
+}
+
+void FrustumCuller::Clear()
+{
+	for (std::vector<float>* component : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_Radius, &m_ExtentX, &m_ExtentY, &m_ExtentZ })
+	{
+		component->clear();
+	}
+	m_Count = 0;
+}
+
+void FrustumCuller::Reserve(size_t count)
+{
+	for (std::vector<float>* component : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_Radius, &m_ExtentX, &m_ExtentY, &m_ExtentZ })
+	{
+		component->reserve((count + 7) & ~(size_t)7);
+	}
+}
+
+bool FrustumCuller::IsPathSupported(CullingPath path)
+{
+	switch (path)
+	{
+		case CullingPath::Automatic:
+		case CullingPath::Scalar:	return true;
+		case CullingPath::SSE:		return GAA_CULLING_SIMD != 0;
+		case CullingPath::AVX:		return s_AVXAvailable;
+	}
+	return false;
+}
+
+CullingPath FrustumCuller::GetBestPath()
+{
+	return s_AVXAvailable ? CullingPath::AVX : GAA_CULLING_SIMD ? CullingPath::SSE : CullingPath::Scalar;
+}
+
+const char* FrustumCuller::GetPathName(CullingPath path)
+{
+	switch (path)
+	{
+		case CullingPath::Automatic:	return GetPathName(GetBestPath());
+		case CullingPath::Scalar:		return "Scalar";
+		case CullingPath::SSE:			return "SSE";
+		case CullingPath::AVX:			return "AVX";
+	}
+	return "Unknown";
+}
+
+unsigned int FrustumCuller::Cull(const glm::mat4& viewProjection, unsigned char* visibility, CullingVolume volume, CullingPath path) const
+{
+	return CullRange(Frustum(viewProjection), 0, m_Count, visibility, volume, path);
+}
+
+unsigned int FrustumCuller::CullParallel(const glm::mat4& viewProjection, unsigned char* visibility, CullingVolume volume) const
+{
+	//Split in blocks of 64 objects, so no two jobs ever write into the same cache line of the mask, and never fewer than a few thousand objects per job.
+	constexpr unsigned int blockSize = 64, minimumBlocksPerJob = 4096 / blockSize;
+	Frustum frustum(viewProjection);
+	std::atomic<unsigned int> visibleCount(0);
+	JobSystem::ParallelFor((m_Count + blockSize - 1) / blockSize, [this, &frustum, &visibleCount, visibility, volume](size_t beginBlock, size_t endBlock)
+	{
+		unsigned int first = (unsigned int)beginBlock * blockSize;
+		unsigned int count = std::min((unsigned int)endBlock * blockSize, m_Count) - first;
+		visibleCount += CullRange(frustum, first, count, visibility, volume, CullingPath::Automatic);
+	}, minimumBlocksPerJob);
+	return visibleCount;
+}
+
+unsigned int FrustumCuller::CullRange(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume, CullingPath path) const
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+	if (path == CullingPath::Automatic || !IsPathSupported(path))
+	{
+		path = GetBestPath();
+	}
+
+	switch (path)
+	{
+		case CullingPath::AVX:	CullAVX(frustum, first, count, visibility, volume); break;
+		case CullingPath::SSE:	CullSSE(frustum, first, count, visibility, volume); break;
+		default:				CullScalar(frustum, first, count, visibility, volume); break;
+	}
+
+	unsigned char* bytes = visibility + first / 8;
+	size_t byteCount = GetMaskSize(count);
+	if (count % 8 != 0)
+	{
+		bytes[byteCount - 1] &= (unsigned char)((1u << (count % 8)) - 1);
+	}
+	return CountBits(bytes, byteCount);
+}
+
+void FrustumCuller::CullScalar(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume) const
+{
+	for (unsigned int group = first; group < first + count; group += 8)
+	{
+		unsigned int byte = 0;
+		for (unsigned int i = group; i < group + 8; i++)
+		{
+			bool visible = true;
+			for (unsigned int p = 0; p < Frustum::PlaneCount && visible; p++)
+			{
+				const glm::vec4& plane = frustum.GetPlane(p);
+				float distance = (plane.x * m_CenterX[i] + plane.y * m_CenterY[i]) + (plane.z * m_CenterZ[i] + plane.w); //Grouped as the SIMD paths add, so they all agree exactly.
+				float reach = volume == CullingVolume::Sphere ? m_Radius[i] : std::abs(plane.x) * m_ExtentX[i] + std::abs(plane.y) * m_ExtentY[i] + std::abs(plane.z) * m_ExtentZ[i];
+				visible = distance >= -reach;
+			}
+			byte |= (unsigned int)visible << (i - group);
+		}
+		visibility[group / 8] = (unsigned char)byte;
+	}
+}
+
+#if GAA_CULLING_SIMD
+
+void FrustumCuller::CullSSE(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume) const
+{
+	//Every plane's components splatted across a register, once, rather than per group of objects.
+	__m128 planeX[Frustum::PlaneCount], planeY[Frustum::PlaneCount], planeZ[Frustum::PlaneCount], planeW[Frustum::PlaneCount];
+	__m128 absoluteX[Frustum::PlaneCount], absoluteY[Frustum::PlaneCount], absoluteZ[Frustum::PlaneCount];
+	for (unsigned int p = 0; p < Frustum::PlaneCount; p++)
+	{
+		const glm::vec4& plane = frustum.GetPlane(p);
+		planeX[p] = _mm_set1_ps(plane.x);
+		planeY[p] = _mm_set1_ps(plane.y);
+		planeZ[p] = _mm_set1_ps(plane.z);
+		planeW[p] = _mm_set1_ps(plane.w);
+		absoluteX[p] = _mm_set1_ps(std::abs(plane.x));
+		absoluteY[p] = _mm_set1_ps(std::abs(plane.y));
+		absoluteZ[p] = _mm_set1_ps(std::abs(plane.z));
+	}
+
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	for (unsigned int group = first; group < first + count; group += 8)
+	{
+		int byte = 0;
+		for (unsigned int half = 0; half < 8; half += 4)
+		{
+			unsigned int i = group + half;
+			__m128 centerX = _mm_loadu_ps(&m_CenterX[i]);
+			__m128 centerY = _mm_loadu_ps(&m_CenterY[i]);
+			__m128 centerZ = _mm_loadu_ps(&m_CenterZ[i]);
+			__m128 radius = _mm_loadu_ps(&m_Radius[i]);
+			__m128 extentX = _mm_loadu_ps(&m_ExtentX[i]);
+			__m128 extentY = _mm_loadu_ps(&m_ExtentY[i]);
+			__m128 extentZ = _mm_loadu_ps(&m_ExtentZ[i]);
+
+			__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (unsigned int p = 0; p < Frustum::PlaneCount; p++)
+			{
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)), _mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+				__m128 reach = volume == CullingVolume::Sphere ? radius :
+					_mm_add_ps(_mm_add_ps(_mm_mul_ps(absoluteX[p], extentX), _mm_mul_ps(absoluteY[p], extentY)), _mm_mul_ps(absoluteZ[p], extentZ));
+				visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, _mm_xor_ps(reach, signBit)));
+			}
+			byte |= _mm_movemask_ps(visible) << half;
+		}
+		visibility[group / 8] = (unsigned char)byte;
+	}
+}
+
+GAA_AVX_FUNCTION void FrustumCuller::CullAVX(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume) const
+{
+	__m256 planeX[Frustum::PlaneCount], planeY[Frustum::PlaneCount], planeZ[Frustum::PlaneCount], planeW[Frustum::PlaneCount];
+	__m256 absoluteX[Frustum::PlaneCount], absoluteY[Frustum::PlaneCount], absoluteZ[Frustum::PlaneCount];
+	for (unsigned int p = 0; p < Frustum::PlaneCount; p++)
+	{
+		const glm::vec4& plane = frustum.GetPlane(p);
+		planeX[p] = _mm256_set1_ps(plane.x);
+		planeY[p] = _mm256_set1_ps(plane.y);
+		planeZ[p] = _mm256_set1_ps(plane.z);
+		planeW[p] = _mm256_set1_ps(plane.w);
+		absoluteX[p] = _mm256_set1_ps(std::abs(plane.x));
+		absoluteY[p] = _mm256_set1_ps(std::abs(plane.y));
+		absoluteZ[p] = _mm256_set1_ps(std::abs(plane.z));
+	}
+
+	const __m256 signBit = _mm256_set1_ps(-0.0f);
+	for (unsigned int i = first; i < first + count; i += 8)
+	{
+		__m256 centerX = _mm256_loadu_ps(&m_CenterX[i]);
+		__m256 centerY = _mm256_loadu_ps(&m_CenterY[i]);
+		__m256 centerZ = _mm256_loadu_ps(&m_CenterZ[i]);
+
+		__m256 visible;
+		if (volume == CullingVolume::Sphere)
+		{
+			__m256 negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(&m_Radius[i]), signBit);
+			visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (unsigned int p = 0; p < Frustum::PlaneCount; p++)
+			{
+				__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[p], centerX), _mm256_mul_ps(planeY[p], centerY)), _mm256_add_ps(_mm256_mul_ps(planeZ[p], centerZ), planeW[p]));
+				visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+			}
+		}
+		else
+		{
+			__m256 extentX = _mm256_loadu_ps(&m_ExtentX[i]);
+			__m256 extentY = _mm256_loadu_ps(&m_ExtentY[i]);
+			__m256 extentZ = _mm256_loadu_ps(&m_ExtentZ[i]);
+			visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (unsigned int p = 0; p < Frustum::PlaneCount; p++)
+			{
+				__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[p], centerX), _mm256_mul_ps(planeY[p], centerY)), _mm256_add_ps(_mm256_mul_ps(planeZ[p], centerZ), planeW[p]));
+				__m256 reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absoluteX[p], extentX), _mm256_mul_ps(absoluteY[p], extentY)), _mm256_mul_ps(absoluteZ[p], extentZ));
+				visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, _mm256_xor_ps(reach, signBit), _CMP_GE_OQ));
+			}
+		}
+		visibility[i / 8] = (unsigned char)_mm256_movemask_ps(visible);
+	}
+}
+
+#else
+
+void FrustumCuller::CullSSE(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume) const
+{
+	CullScalar(frustum, first, count, visibility, volume);
+}
+
+void FrustumCuller::CullAVX(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume) const
+{
+	CullScalar(frustum, first, count, visibility, volume);
+}
+
+#endif
+
+bool FrustumCuller::IsBenchmarkCommand(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark-culling") == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int FrustumCuller::RunBenchmark(int argc, char** argv)
+{
+	unsigned int objectCount = 1000000;
+	int iterations = 20;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+		{
+			objectCount = (unsigned int)std::max(1, atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+		{
+			iterations = std::max(1, atoi(argv[++i]));
+		}
+	}
+
+	//Objects scattered through a box around a camera looking down -z, so roughly a tenth of them are visible.
+	FrustumCuller culler;
+	culler.Reserve(objectCount);
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> size(0.5f, 5.0f);
+	for (unsigned int i = 0; i < objectCount; i++)
+	{
+		glm::vec3 center(position(random), position(random), position(random));
+		glm::vec3 extents(size(random), size(random), size(random));
+		culler.Add(BoundingBox{ center - extents, center + extents });
+	}
+	glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	std::vector<unsigned char> reference(GetMaskSize(objectCount)), visibility(GetMaskSize(objectCount));
+	std::cout << "Culling " << objectCount << " objects, best of " << iterations << " \n";
+	int failed = 0;
+	for (CullingVolume volume : { CullingVolume::Sphere, CullingVolume::Box })
+	{
+		const char* volumeName = volume == CullingVolume::Sphere ? "spheres" : "boxes";
+		culler.Cull(viewProjection, reference.data(), volume, CullingPath::Scalar);
+
+		//-1 stands for the parallel run, which uses the best path on every thread.
+		for (int path : { (int)CullingPath::Scalar, (int)CullingPath::SSE, (int)CullingPath::AVX, -1 })
+		{
+			if (path >= 0 && !IsPathSupported((CullingPath)path))
+			{
+				continue;
+			}
+			double bestNanoseconds = 1e30;
+			unsigned int visibleCount = 0;
+			for (int iteration = 0; iteration < iterations; iteration++)
+			{
+				auto start = std::chrono::steady_clock::now();
+				visibleCount = path >= 0 ? culler.Cull(viewProjection, visibility.data(), volume, (CullingPath)path) : culler.CullParallel(viewProjection, visibility.data(), volume);
+				bestNanoseconds = std::min(bestNanoseconds, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+			}
+
+			bool matches = visibility == reference;
+			failed += !matches;
+			std::string name = path >= 0 ? GetPathName((CullingPath)path) : std::string(GetPathName(GetBestPath())) + " x " + std::to_string(JobSystem::GetThreadCount()) + " threads";
+			std::cout << "  " << volumeName << ", " << name << ": " << bestNanoseconds / 1e6 << " ms, " << objectCount / bestNanoseconds << " objects/ns, "
+				<< visibleCount << " visible" << (matches ? "" : " (DIFFERS FROM SCALAR)") << "\n";
+		}
+	}
+	return failed == 0 ? 0 : 1;
+}
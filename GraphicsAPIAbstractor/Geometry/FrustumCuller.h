@@ -0,0 +1,64 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "BoundingVolumes.h"
+#include "glm/glm.hpp"
+
+enum class CullingVolume
+{
+	Sphere = 0, //Cheapest, but loose around long thin objects.
+	Box
+};
+
+enum class CullingPath
+{
+	Automatic = 0, //The widest this CPU supports.
+	Scalar,
+	SSE, //4 objects per instruction.
+	AVX //8 objects per instruction.
+};
+
+//Frustum culling for many objects at once. The bounding volumes are kept in structure of arrays form, one array per component, so a single SIMD compare tests
+//the same plane against 8 objects (4 with SSE) without any shuffling, and 6 planes later we have a byte saying which of the 8 are visible.
+//Results are a bitmask, one bit per object, bit (i & 7) of byte (i >> 3), which IsVisible reads.
+class FrustumCuller
+{
+public:
+	unsigned int Add(const BoundingBox& box); //Stores the box and the sphere around it. Returns the object's index.
+	unsigned int Add(const BoundingSphere& sphere); //The box is the one around the sphere.
+	void Set(unsigned int index, const BoundingBox& box);
+	void Set(unsigned int index, const BoundingSphere& sphere);
+	void Clear();
+	void Reserve(size_t count);
+
+	inline unsigned int GetCount() const { return m_Count; }
+	inline static size_t GetMaskSize(unsigned int count) { return (count + 7) / 8; } //Bytes of visibility mask needed for count objects.
+	inline static bool IsVisible(const unsigned char* visibility, unsigned int index) { return (visibility[index >> 3] >> (index & 7)) & 1; }
+
+	//Writes GetMaskSize(GetCount()) bytes of visibility and returns how many objects are visible.
+	unsigned int Cull(const glm::mat4& viewProjection, unsigned char* visibility, CullingVolume volume = CullingVolume::Sphere, CullingPath path = CullingPath::Automatic) const;
+	//The same, split into jobs on the JobSystem. Only worth it from tens of thousands of objects.
+	unsigned int CullParallel(const glm::mat4& viewProjection, unsigned char* visibility, CullingVolume volume = CullingVolume::Sphere) const;
+
+	static bool IsPathSupported(CullingPath path);
+	static CullingPath GetBestPath();
+	static const char* GetPathName(CullingPath path);
+
+	//GraphicsAPIAbstractor --benchmark-culling [--objects <count>] [--iterations <count>]
+	//Culls random objects with every path and reports objects per nanosecond, checking they all agree with the scalar one.
+	static bool IsBenchmarkCommand(int argc, char** argv);
+	static int RunBenchmark(int argc, char** argv);
+
+private:
+	//first is a multiple of 8, so each range writes whole bytes of the mask. The paths fill in every byte they touch, padding and all, and CullRange then
+	//clears the padding's bits and counts what is left.
+	unsigned int CullRange(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume, CullingPath path) const;
+	void CullScalar(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume) const;
+	void CullSSE(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume) const;
+	void CullAVX(const Frustum& frustum, unsigned int first, unsigned int count, unsigned char* visibility, CullingVolume volume) const;
+
+	//Every array is padded up to a multiple of 8 so the SIMD paths never need a scalar tail. The padding is masked out of the results.
+	std::vector<float> m_CenterX, m_CenterY, m_CenterZ;
+	std::vector<float> m_Radius;
+	std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ; //Half the box's size. Boxes share the sphere's center.
+	unsigned int m_Count = 0;
+};
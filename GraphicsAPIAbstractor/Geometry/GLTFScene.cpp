@@ -0,0 +1,1186 @@
+#include "GAAPrecompiledHeader.h"
+#include "GLTFScene.h"
+#include "JobSystem.h"
+#include "JsonReader.h"
+#include "stb_image/stb_image.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "glm/gtc/type_ptr.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+//SSE2 is part of every x64 CPU, and MSVC targets it by default on x86 too.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAA_GLTF_SSE2 1
+#include <emmintrin.h>
+#else
+#define GAA_GLTF_SSE2 0
+#endif
+
+namespace
+{
+	constexpr uint32_t s_GLBMagic = 0x46546C67; //"glTF"
+	constexpr uint32_t s_GLBChunkJSON = 0x4E4F534A;
+	constexpr uint32_t s_GLBChunkBinary = 0x004E4942;
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	bool IsValidComponentType(unsigned int componentType)
+	{
+		return componentType == GL_BYTE || componentType == GL_UNSIGNED_BYTE || componentType == GL_SHORT || componentType == GL_UNSIGNED_SHORT ||
+			   componentType == GL_UNSIGNED_INT || componentType == GL_FLOAT;
+	}
+
+	unsigned int GetComponentCount(std::string_view type)
+	{
+		if (type == "SCALAR") return 1;
+		if (type == "VEC2") return 2;
+		if (type == "VEC3") return 3;
+		if (type == "VEC4") return 4;
+		return 0; //Matrices only show up in skins, which we don't read.
+	}
+
+	std::vector<unsigned char> DecodeBase64(std::string_view text)
+	{
+		static const auto table = []()
+		{
+			std::array<signed char, 256> values;
+			values.fill(-1);
+			const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			for (int i = 0; i < 64; i++)
+			{
+				values[(unsigned char)alphabet[i]] = (signed char)i;
+			}
+			return values;
+		}();
+
+		std::vector<unsigned char> result;
+		result.reserve(text.size() / 4 * 3);
+		unsigned int bits = 0;
+		int bitCount = 0;
+		for (char c : text)
+		{
+			int value = table[(unsigned char)c];
+			if (value < 0)
+			{
+				continue; //Padding, and any whitespace a generator slipped in.
+			}
+			bits = (bits << 6) | (unsigned int)value;
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				result.push_back((unsigned char)(bits >> bitCount));
+			}
+		}
+		return result;
+	}
+
+	//data:[<mediatype>][;base64],<data>. Returns false if the URI isn't one.
+	bool DecodeDataURI(const std::string& uri, std::vector<unsigned char>& data)
+	{
+		if (uri.compare(0, 5, "data:") != 0)
+		{
+			return false;
+		}
+		size_t comma = uri.find(',');
+		if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos)
+		{
+			data.clear();
+			return true; //A data URI we can't read, which the caller sees as empty.
+		}
+		data = DecodeBase64(std::string_view(uri).substr(comma + 1));
+		return true;
+	}
+
+	//Relative URIs may be percent encoded, such as spaces in file names.
+	std::string DecodeFileURI(const std::string& directory, const std::string& uri)
+	{
+		std::string path = directory;
+		for (size_t i = 0; i < uri.size(); i++)
+		{
+			if (uri[i] == '%' && i + 2 < uri.size())
+			{
+				path += (char)strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16);
+				i += 2;
+			}
+			else
+			{
+				path += uri[i];
+			}
+		}
+		return path;
+	}
+
+	void WidenIndices(const uint16_t* source, unsigned int* destination, size_t count)
+	{
+		size_t i = 0;
+#if GAA_GLTF_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_unpacklo_epi16(indices, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 4), _mm_unpackhi_epi16(indices, zero));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			destination[i] = source[i];
+		}
+	}
+
+	void WidenIndices(const uint8_t* source, unsigned int* destination, size_t count)
+	{
+		size_t i = 0;
+#if GAA_GLTF_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			__m128i low = _mm_unpacklo_epi8(indices, zero);
+			__m128i high = _mm_unpackhi_epi8(indices, zero);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_unpacklo_epi16(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 4), _mm_unpackhi_epi16(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 8), _mm_unpacklo_epi16(high, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 12), _mm_unpackhi_epi16(high, zero));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			destination[i] = source[i];
+		}
+	}
+
+	float ComponentToFloat(const unsigned char* source, unsigned int componentType, bool normalized)
+	{
+		switch (componentType)
+		{
+			case GL_FLOAT:			{ float value; memcpy(&value, source, 4); return value; }
+			case GL_UNSIGNED_INT:	{ uint32_t value; memcpy(&value, source, 4); return (float)value; }
+			case GL_UNSIGNED_SHORT:	{ uint16_t value; memcpy(&value, source, 2); return normalized ? value / 65535.0f : (float)value; }
+			case GL_SHORT:			{ int16_t value; memcpy(&value, source, 2); return normalized ? std::max(value / 32767.0f, -1.0f) : (float)value; }
+			case GL_UNSIGNED_BYTE:	return normalized ? *source / 255.0f : (float)*source;
+			case GL_BYTE:			return normalized ? std::max((signed char)*source / 127.0f, -1.0f) : (float)(signed char)*source;
+		}
+		return 0.0f;
+	}
+
+	//Indices stay integers all the way, as a float only holds them exactly up to 2^24.
+	unsigned int ComponentToIndex(const unsigned char* source, unsigned int componentType)
+	{
+		switch (componentType)
+		{
+			case GL_UNSIGNED_INT:	{ uint32_t value; memcpy(&value, source, 4); return value; }
+			case GL_UNSIGNED_SHORT:	{ uint16_t value; memcpy(&value, source, 2); return value; }
+			case GL_UNSIGNED_BYTE:	return *source;
+		}
+		return 0;
+	}
+
+#if GAA_GLTF_SSE2
+	//Converts 4 32 bit integers and applies the normalization, clamping signed values to -1 as OpenGL does.
+	inline void StoreComponents(float* destination, __m128i values, __m128 scale, bool clamp)
+	{
+		__m128 result = _mm_mul_ps(_mm_cvtepi32_ps(values), scale);
+		_mm_storeu_ps(destination, clamp ? _mm_max_ps(result, _mm_set1_ps(-1.0f)) : result);
+	}
+#endif
+
+	//Converts a tightly packed run of components to floats. Quantized texture coordinates and colors are common in glTF, so the 8 and 16 bit cases
+	//convert 8 or 16 components per iteration.
+	void ConvertComponents(const unsigned char* source, unsigned int componentType, bool normalized, float* destination, size_t count)
+	{
+		size_t i = 0;
+		if (componentType == GL_FLOAT)
+		{
+			memcpy(destination, source, count * sizeof(float));
+			return;
+		}
+#if GAA_GLTF_SSE2
+		bool isSigned = componentType == GL_SHORT || componentType == GL_BYTE;
+		float normalization = componentType == GL_UNSIGNED_SHORT ? 1.0f / 65535.0f : componentType == GL_SHORT ? 1.0f / 32767.0f : componentType == GL_UNSIGNED_BYTE ? 1.0f / 255.0f : 1.0f / 127.0f;
+		__m128 scale = _mm_set1_ps(normalized ? normalization : 1.0f);
+		bool clamp = normalized && isSigned;
+		const __m128i zero = _mm_setzero_si128();
+		if (componentType == GL_UNSIGNED_SHORT || componentType == GL_SHORT)
+		{
+			for (; i + 8 <= count; i += 8)
+			{
+				__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2));
+				//Unpacking a value with itself puts it in the top half of each 32 bit lane, where an arithmetic shift sign extends it.
+				__m128i low = isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16) : _mm_unpacklo_epi16(values, zero);
+				__m128i high = isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16) : _mm_unpackhi_epi16(values, zero);
+				StoreComponents(destination + i, low, scale, clamp);
+				StoreComponents(destination + i + 4, high, scale, clamp);
+			}
+		}
+		else if (componentType == GL_UNSIGNED_BYTE || componentType == GL_BYTE)
+		{
+			for (; i + 16 <= count; i += 16)
+			{
+				__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+				__m128i low = isSigned ? _mm_unpacklo_epi8(values, values) : _mm_unpacklo_epi8(values, zero);
+				__m128i high = isSigned ? _mm_unpackhi_epi8(values, values) : _mm_unpackhi_epi8(values, zero);
+				__m128i lanes[4] =
+				{
+					isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(low, low), 24) : _mm_unpacklo_epi16(low, zero),
+					isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(low, low), 24) : _mm_unpackhi_epi16(low, zero),
+					isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(high, high), 24) : _mm_unpacklo_epi16(high, zero),
+					isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(high, high), 24) : _mm_unpackhi_epi16(high, zero)
+				};
+				for (int lane = 0; lane < 4; lane++)
+				{
+					StoreComponents(destination + i + lane * 4, lanes[lane], scale, clamp);
+				}
+			}
+		}
+#endif
+		unsigned int componentSize = VertexBufferElement::GetSizeOfType(componentType);
+		for (; i < count; i++)
+		{
+			destination[i] = ComponentToFloat(source + i * componentSize, componentType, normalized);
+		}
+	}
+}
+
+void GLTFImagePixelsDeleter::operator()(unsigned char* pixels) const
+{
+	stbi_image_free(pixels);
+}
+
+bool GLTFScene::Load(const std::string& filePath)
+{
+	auto start = std::chrono::steady_clock::now();
+	size_t directoryEnd = filePath.find_last_of("/\\");
+	m_Directory = directoryEnd == std::string::npos ? std::string() : filePath.substr(0, directoryEnd + 1);
+
+	MappedFile file;
+	if (!file.Open(filePath))
+	{
+		return false;
+	}
+	m_Statistics.fileBytes = file.GetSize();
+	m_Files.push_back(std::move(file)); //Moving a mapping doesn't move the memory, so views into it stay valid.
+	const unsigned char* data = m_Files.back().GetData();
+	size_t size = m_Files.back().GetSize();
+
+	//A .glb is a 12 byte header followed by chunks, the JSON first and then optionally the binary buffer. Both are used in place.
+	const char* json = reinterpret_cast<const char*>(data);
+	size_t jsonSize = size;
+	const unsigned char* binaryChunk = nullptr;
+	size_t binaryChunkSize = 0;
+	uint32_t magic = 0;
+	if (size >= 4)
+	{
+		memcpy(&magic, data, 4);
+	}
+	if (magic == s_GLBMagic)
+	{
+		uint32_t version = 0;
+		memcpy(&version, data + 4, std::min<size_t>(size - 4, 4));
+		if (size < 20 || version != 2)
+		{
+			std::cout << "Warning: " << filePath << " isn't a glTF 2.0 binary! \n";
+			return false;
+		}
+		json = nullptr;
+		for (size_t offset = 12; offset + 8 <= size;)
+		{
+			uint32_t chunk[2];
+			memcpy(chunk, data + offset, 8);
+			if (chunk[0] > size - offset - 8)
+			{
+				std::cout << "Warning: " << filePath << " is truncated! \n";
+				return false;
+			}
+			if (chunk[1] == s_GLBChunkJSON && !json)
+			{
+				json = reinterpret_cast<const char*>(data + offset + 8);
+				jsonSize = chunk[0];
+			}
+			else if (chunk[1] == s_GLBChunkBinary && !binaryChunk)
+			{
+				binaryChunk = data + offset + 8;
+				binaryChunkSize = chunk[0];
+			}
+			offset += 8 + ((chunk[0] + 3) & ~3u);
+		}
+		if (!json)
+		{
+			std::cout << "Warning: " << filePath << " has no JSON chunk! \n";
+			return false;
+		}
+	}
+
+	if (!ParseJSON(json, jsonSize))
+	{
+		std::cout << "Warning: Failed to parse " << filePath << "! \n";
+		return false;
+	}
+	m_Statistics.parseMilliseconds = MillisecondsSince(start);
+
+	auto decodeStart = std::chrono::steady_clock::now();
+	if (!LoadBuffers(binaryChunk, binaryChunkSize) || !ResolveAccessors())
+	{
+		std::cout << "Warning: " << filePath << " references buffers that don't exist or are too small! \n";
+		return false;
+	}
+
+	//Images take longest by far, so they go first, a job each, and decode alongside the geometry. We only wait for them at the very end.
+	std::atomic<size_t> imageBytes(0);
+	m_Images.resize(m_ImageURIs.size());
+	auto decodeImage = [this, &imageBytes](size_t index)
+	{
+		std::vector<unsigned char> decoded;
+		MappedFile external;
+		const unsigned char* encoded = nullptr;
+		size_t encodedSize = 0;
+		if (m_ImageBufferViews[index] >= 0)
+		{
+			encoded = GetBufferViewData(m_ImageBufferViews[index], encodedSize);
+		}
+		else if (DecodeDataURI(m_ImageURIs[index], decoded))
+		{
+			encoded = decoded.data();
+			encodedSize = decoded.size();
+		}
+		else if (!m_ImageURIs[index].empty() && external.Open(DecodeFileURI(m_Directory, m_ImageURIs[index])))
+		{
+			encoded = external.GetData();
+			encodedSize = external.GetSize();
+		}
+		if (!encoded || encodedSize == 0)
+		{
+			return;
+		}
+		imageBytes += encodedSize;
+
+		GLTFImage& image = m_Images[index];
+		stbi_set_flip_vertically_on_load_thread(0); //glTF's texture coordinates start at the top left, so unlike Texture's files these must not be flipped.
+		int channels = 0;
+		image.pixels.reset(stbi_load_from_memory(encoded, (int)encodedSize, &image.width, &image.height, &channels, 4));
+		if (!image.pixels)
+		{
+			std::cout << "Warning: Failed to decode image " << index << ": " << stbi_failure_reason() << "! \n";
+		}
+	};
+	JobCounter imageJobs;
+	for (size_t index = 0; index < m_Images.size(); index++)
+	{
+		JobSystem::Run([&decodeImage, index]() { decodeImage(index); }, &imageJobs);
+	}
+	auto imageStart = std::chrono::steady_clock::now();
+
+	//Every primitive decodes independently into the slot ParseJSON made for it, so they need no locking.
+	//While this thread waits for them it helps with whatever is queued, images included.
+	JobSystem::ParallelFor(m_PrimitiveSources.size(), [this](size_t begin, size_t end)
+	{
+		for (size_t index = begin; index < end; index++)
+		{
+			const PrimitiveSource& source = m_PrimitiveSources[index];
+			GLTFPrimitive& primitive = m_Meshes[source.mesh].primitives[source.primitive];
+			if (!DecodePrimitive(source, primitive))
+			{
+				primitive.vertexCount = 0; //Dropped below.
+			}
+		}
+	});
+	for (GLTFMesh& mesh : m_Meshes)
+	{
+		mesh.primitives.erase(std::remove_if(mesh.primitives.begin(), mesh.primitives.end(), [](const GLTFPrimitive& primitive) { return primitive.vertexCount == 0; }), mesh.primitives.end());
+		for (const GLTFPrimitive& primitive : mesh.primitives)
+		{
+			m_Statistics.vertexBytes += primitive.vertexDataSize;
+			m_Statistics.indexBytes += primitive.indexCount * sizeof(unsigned int);
+			m_Statistics.copiedBytes += primitive.m_InterleavedVertices.size() + primitive.m_WidenedIndices.size() * sizeof(unsigned int);
+		}
+	}
+
+	//Without a scene to say otherwise, every node nobody parents is a root.
+	if (m_DefaultScene < 0 && !m_Scenes.empty())
+	{
+		m_DefaultScene = 0;
+	}
+	if (m_DefaultScene >= 0 && m_DefaultScene < (int)m_Scenes.size())
+	{
+		m_RootNodes = m_Scenes[m_DefaultScene];
+	}
+	else
+	{
+		std::vector<bool> isChild(m_Nodes.size(), false);
+		for (const GLTFNode& node : m_Nodes)
+		{
+			for (int child : node.children)
+			{
+				if (child >= 0 && child < (int)m_Nodes.size())
+				{
+					isChild[child] = true;
+				}
+			}
+		}
+		for (size_t i = 0; i < m_Nodes.size(); i++)
+		{
+			if (!isChild[i])
+			{
+				m_RootNodes.push_back((int)i);
+			}
+		}
+	}
+	m_RootNodes.erase(std::remove_if(m_RootNodes.begin(), m_RootNodes.end(), [this](int node) { return node < 0 || node >= (int)m_Nodes.size(); }), m_RootNodes.end());
+	for (int root : m_RootNodes)
+	{
+		UpdateWorldTransforms(root, glm::mat4(1.0f), 0);
+	}
+	m_Statistics.decodeMilliseconds = MillisecondsSince(decodeStart);
+
+	JobSystem::Wait(imageJobs);
+	m_Statistics.imageMilliseconds = MillisecondsSince(imageStart);
+	m_Statistics.imageBytes = imageBytes;
+	m_Statistics.totalMilliseconds = MillisecondsSince(start);
+	return true;
+}
+
+bool GLTFScene::ParseJSON(const char* json, size_t size)
+{
+	JsonReader reader(json, size);
+	bool supported = true;
+	auto readNumbers = [&reader](float* values, size_t maxCount)
+	{
+		size_t count = 0;
+		reader.ReadArray([&]()
+		{
+			float value = (float)reader.ReadNumber();
+			if (count < maxCount)
+			{
+				values[count] = value;
+			}
+			count++;
+		});
+		return count;
+	};
+	auto readIndex = [&reader]() { return (int)reader.ReadNumber(-1.0); };
+
+	//Only what we use is read. Everything else, including every extension's data, is skipped without being looked at.
+	reader.ReadObject([&](std::string_view key)
+	{
+		if (key == "asset")
+		{
+			reader.ReadObject([&](std::string_view assetKey)
+			{
+				if (assetKey != "version")
+				{
+					reader.SkipValue();
+				}
+				else if (reader.ReadString().compare(0, 2, "2.") != 0)
+				{
+					std::cout << "Warning: Only glTF 2.0 is supported! \n";
+					supported = false;
+				}
+			});
+		}
+		else if (key == "extensionsRequired")
+		{
+			reader.ReadArray([&]()
+			{
+				//Quantized attributes keep their own formats in our layouts anyway, so KHR_mesh_quantization needs nothing extra from us.
+				std::string extension = reader.ReadString();
+				if (extension != "KHR_mesh_quantization")
+				{
+					std::cout << "Warning: The file requires " << extension << ", which we don't support! \n";
+					supported = false;
+				}
+			});
+		}
+		else if (key == "scene")
+		{
+			m_DefaultScene = readIndex();
+		}
+		else if (key == "scenes")
+		{
+			reader.ReadArray([&]()
+			{
+				m_Scenes.emplace_back();
+				reader.ReadObject([&](std::string_view sceneKey)
+				{
+					if (sceneKey == "nodes")
+					{
+						reader.ReadArray([&]() { m_Scenes.back().push_back(readIndex()); });
+					}
+					else
+					{
+						reader.SkipValue();
+					}
+				});
+			});
+		}
+		else if (key == "nodes")
+		{
+			reader.ReadArray([&]()
+			{
+				m_Nodes.emplace_back();
+				GLTFNode& node = m_Nodes.back();
+				float matrix[16];
+				bool hasMatrix = false;
+				float translation[3] = { 0.0f, 0.0f, 0.0f }, rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f }, scale[3] = { 1.0f, 1.0f, 1.0f };
+				reader.ReadObject([&](std::string_view nodeKey)
+				{
+					if (nodeKey == "name") node.name = reader.ReadString();
+					else if (nodeKey == "mesh") node.mesh = readIndex();
+					else if (nodeKey == "children") reader.ReadArray([&]() { node.children.push_back(readIndex()); });
+					else if (nodeKey == "matrix") hasMatrix = readNumbers(matrix, 16) == 16;
+					else if (nodeKey == "translation") readNumbers(translation, 3);
+					else if (nodeKey == "rotation") readNumbers(rotation, 4);
+					else if (nodeKey == "scale") readNumbers(scale, 3);
+					else reader.SkipValue();
+				});
+
+				//A node has either a column major matrix or a translation, rotation and scale applied in that order. The quaternion is stored x, y, z, w.
+				if (hasMatrix)
+				{
+					node.localTransform = glm::make_mat4(matrix);
+				}
+				else
+				{
+					node.localTransform = glm::translate(glm::mat4(1.0f), glm::make_vec3(translation)) * glm::mat4_cast(glm::quat(rotation[3], rotation[0], rotation[1], rotation[2])) *
+										  glm::scale(glm::mat4(1.0f), glm::make_vec3(scale));
+				}
+			});
+		}
+		else if (key == "meshes")
+		{
+			reader.ReadArray([&]()
+			{
+				int meshIndex = (int)m_Meshes.size();
+				m_Meshes.emplace_back();
+				reader.ReadObject([&](std::string_view meshKey)
+				{
+					if (meshKey == "name")
+					{
+						m_Meshes[meshIndex].name = reader.ReadString();
+					}
+					else if (meshKey == "primitives")
+					{
+						reader.ReadArray([&]()
+						{
+							PrimitiveSource source;
+							source.mesh = meshIndex;
+							source.primitive = (int)m_Meshes[meshIndex].primitives.size();
+							reader.ReadObject([&](std::string_view primitiveKey)
+							{
+								if (primitiveKey == "attributes")
+								{
+									reader.ReadObject([&](std::string_view attribute)
+									{
+										if (attribute == "POSITION") source.position = readIndex();
+										else if (attribute == "NORMAL") source.normal = readIndex();
+										else if (attribute == "TEXCOORD_0") source.textureCoordinate = readIndex();
+										else reader.SkipValue();
+									});
+								}
+								else if (primitiveKey == "indices") source.indices = readIndex();
+								else if (primitiveKey == "material") source.material = readIndex();
+								else if (primitiveKey == "mode") source.mode = (unsigned int)reader.ReadNumber(4.0);
+								else reader.SkipValue();
+							});
+							//Made now, so the decode can fill them in from any thread without the vector moving under it.
+							m_Meshes[meshIndex].primitives.emplace_back();
+							m_PrimitiveSources.push_back(source);
+						});
+					}
+					else
+					{
+						reader.SkipValue();
+					}
+				});
+			});
+		}
+		else if (key == "accessors")
+		{
+			reader.ReadArray([&]()
+			{
+				Accessor accessor;
+				size_t minimumCount = 0, maximumCount = 0;
+				reader.ReadObject([&](std::string_view accessorKey)
+				{
+					if (accessorKey == "bufferView") accessor.bufferView = readIndex();
+					else if (accessorKey == "byteOffset") accessor.byteOffset = (size_t)reader.ReadNumber();
+					else if (accessorKey == "componentType") accessor.componentType = (unsigned int)reader.ReadNumber();
+					else if (accessorKey == "normalized") accessor.normalized = reader.ReadBool();
+					else if (accessorKey == "count") accessor.count = (size_t)reader.ReadNumber();
+					else if (accessorKey == "type") accessor.componentCount = GetComponentCount(reader.ReadString());
+					else if (accessorKey == "min") minimumCount = readNumbers(accessor.minimum, 3);
+					else if (accessorKey == "max") maximumCount = readNumbers(accessor.maximum, 3);
+					else if (accessorKey == "sparse") { accessor.sparse = true; reader.SkipValue(); }
+					else reader.SkipValue();
+				});
+				accessor.hasBounds = minimumCount == 3 && maximumCount == 3;
+				m_Accessors.push_back(accessor);
+			});
+		}
+		else if (key == "bufferViews")
+		{
+			reader.ReadArray([&]()
+			{
+				BufferView view;
+				reader.ReadObject([&](std::string_view viewKey)
+				{
+					if (viewKey == "buffer") view.buffer = readIndex();
+					else if (viewKey == "byteOffset") view.byteOffset = (size_t)reader.ReadNumber();
+					else if (viewKey == "byteLength") view.byteLength = (size_t)reader.ReadNumber();
+					else if (viewKey == "byteStride") view.byteStride = (size_t)reader.ReadNumber();
+					else reader.SkipValue();
+				});
+				m_BufferViews.push_back(view);
+			});
+		}
+		else if (key == "buffers")
+		{
+			reader.ReadArray([&]()
+			{
+				Buffer buffer;
+				reader.ReadObject([&](std::string_view bufferKey)
+				{
+					if (bufferKey == "uri") buffer.uri = reader.ReadString();
+					else if (bufferKey == "byteLength") buffer.byteLength = (size_t)reader.ReadNumber();
+					else reader.SkipValue();
+				});
+				m_Buffers.push_back(buffer);
+			});
+		}
+		else if (key == "materials")
+		{
+			reader.ReadArray([&]()
+			{
+				m_Materials.emplace_back();
+				GLTFMaterial& material = m_Materials.back();
+				reader.ReadObject([&](std::string_view materialKey)
+				{
+					if (materialKey == "name")
+					{
+						material.name = reader.ReadString();
+					}
+					else if (materialKey == "pbrMetallicRoughness")
+					{
+						reader.ReadObject([&](std::string_view pbrKey)
+						{
+							if (pbrKey == "baseColorFactor")
+							{
+								readNumbers(material.baseColorFactor, 4);
+							}
+							else if (pbrKey == "baseColorTexture")
+							{
+								reader.ReadObject([&](std::string_view textureKey)
+								{
+									if (textureKey == "index") material.baseColorTexture = readIndex();
+									else reader.SkipValue();
+								});
+							}
+							else
+							{
+								reader.SkipValue();
+							}
+						});
+					}
+					else
+					{
+						reader.SkipValue();
+					}
+				});
+			});
+		}
+		else if (key == "textures")
+		{
+			reader.ReadArray([&]()
+			{
+				GLTFTexture texture;
+				int sampler = -1;
+				reader.ReadObject([&](std::string_view textureKey)
+				{
+					if (textureKey == "source") texture.image = readIndex();
+					else if (textureKey == "sampler") sampler = readIndex();
+					else reader.SkipValue();
+				});
+				m_Textures.push_back(texture);
+				m_TextureSamplers.push_back(sampler);
+			});
+		}
+		else if (key == "samplers")
+		{
+			reader.ReadArray([&]()
+			{
+				GLTFTexture sampler;
+				reader.ReadObject([&](std::string_view samplerKey)
+				{
+					if (samplerKey == "minFilter") sampler.minFilter = (unsigned int)reader.ReadNumber(GL_LINEAR_MIPMAP_LINEAR);
+					else if (samplerKey == "magFilter") sampler.magFilter = (unsigned int)reader.ReadNumber(GL_LINEAR);
+					else if (samplerKey == "wrapS") sampler.wrapS = (unsigned int)reader.ReadNumber(GL_REPEAT);
+					else if (samplerKey == "wrapT") sampler.wrapT = (unsigned int)reader.ReadNumber(GL_REPEAT);
+					else reader.SkipValue();
+				});
+				m_Samplers.push_back(sampler);
+			});
+		}
+		else if (key == "images")
+		{
+			reader.ReadArray([&]()
+			{
+				m_Images.emplace_back();
+				std::string uri;
+				int bufferView = -1;
+				reader.ReadObject([&](std::string_view imageKey)
+				{
+					if (imageKey == "name") m_Images.back().name = reader.ReadString();
+					else if (imageKey == "uri") uri = reader.ReadString();
+					else if (imageKey == "bufferView") bufferView = readIndex();
+					else reader.SkipValue();
+				});
+				m_ImageURIs.push_back(uri);
+				m_ImageBufferViews.push_back(bufferView);
+			});
+		}
+		else
+		{
+			reader.SkipValue();
+		}
+	});
+
+	for (size_t i = 0; i < m_Textures.size(); i++)
+	{
+		int sampler = m_TextureSamplers[i];
+		if (sampler >= 0 && sampler < (int)m_Samplers.size())
+		{
+			int image = m_Textures[i].image;
+			m_Textures[i] = m_Samplers[sampler];
+			m_Textures[i].image = image;
+		}
+	}
+	return supported && !reader.HasError();
+}
+
+bool GLTFScene::LoadBuffers(const unsigned char* binaryChunk, size_t binaryChunkSize)
+{
+	for (size_t i = 0; i < m_Buffers.size(); i++)
+	{
+		Buffer& buffer = m_Buffers[i];
+		size_t loadedSize = 0;
+		std::vector<unsigned char> decoded;
+		if (buffer.uri.empty())
+		{
+			//Only the first buffer of a .glb may leave out its URI, and it is the binary chunk.
+			if (i != 0 || !binaryChunk)
+			{
+				return false;
+			}
+			buffer.data = binaryChunk;
+			loadedSize = binaryChunkSize;
+		}
+		else if (DecodeDataURI(buffer.uri, decoded))
+		{
+			m_DecodedBuffers.push_back(std::move(decoded));
+			buffer.data = m_DecodedBuffers.back().data();
+			loadedSize = m_DecodedBuffers.back().size();
+		}
+		else
+		{
+			MappedFile file;
+			if (!file.Open(DecodeFileURI(m_Directory, buffer.uri)))
+			{
+				return false;
+			}
+			m_Statistics.fileBytes += file.GetSize();
+			buffer.data = file.GetData();
+			loadedSize = file.GetSize();
+			m_Files.push_back(std::move(file));
+		}
+
+		if (loadedSize < buffer.byteLength)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool GLTFScene::ResolveAccessors()
+{
+	//Everything past here reads straight out of the buffers, so every view and accessor has to be checked to lie within them first.
+	for (const BufferView& view : m_BufferViews)
+	{
+		if (view.buffer < 0 || view.buffer >= (int)m_Buffers.size() || view.byteOffset > m_Buffers[view.buffer].byteLength ||
+			view.byteLength > m_Buffers[view.buffer].byteLength - view.byteOffset)
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < m_Accessors.size(); i++)
+	{
+		Accessor& accessor = m_Accessors[i];
+		if (!IsValidComponentType(accessor.componentType) || accessor.componentCount == 0)
+		{
+			accessor.componentCount = 0; //Unusable, so anything referencing it is rejected where it is used.
+			continue;
+		}
+		if (accessor.sparse)
+		{
+			std::cout << "Warning: Accessor " << i << " is sparse. We read it without its substitutions! \n";
+		}
+		if (accessor.bufferView < 0 || accessor.count == 0)
+		{
+			continue; //No view means all zeros.
+		}
+		if (accessor.bufferView >= (int)m_BufferViews.size())
+		{
+			return false;
+		}
+
+		const BufferView& view = m_BufferViews[accessor.bufferView];
+		size_t elementSize = accessor.GetElementSize();
+		accessor.stride = view.byteStride != 0 ? view.byteStride : elementSize;
+		if (accessor.byteOffset > view.byteLength || elementSize > view.byteLength - accessor.byteOffset ||
+			accessor.count - 1 > (view.byteLength - accessor.byteOffset - elementSize) / accessor.stride)
+		{
+			return false;
+		}
+		accessor.data = m_Buffers[view.buffer].data + view.byteOffset + accessor.byteOffset;
+	}
+	return true;
+}
+
+const unsigned char* GLTFScene::GetBufferViewData(int bufferView, size_t& size) const
+{
+	if (bufferView < 0 || bufferView >= (int)m_BufferViews.size())
+	{
+		size = 0;
+		return nullptr;
+	}
+	const BufferView& view = m_BufferViews[bufferView];
+	size = view.byteLength;
+	return m_Buffers[view.buffer].data + view.byteOffset;
+}
+
+bool GLTFScene::DecodePrimitive(const PrimitiveSource& source, GLTFPrimitive& primitive)
+{
+	if (source.mode != GL_TRIANGLES)
+	{
+		std::cout << "Warning: Skipping a primitive of mode " << source.mode << ", as only triangle lists are supported! \n";
+		return false;
+	}
+
+	auto getAccessor = [this](int index) -> const Accessor*
+	{
+		return index >= 0 && index < (int)m_Accessors.size() && m_Accessors[index].componentCount > 0 ? &m_Accessors[index] : nullptr;
+	};
+	const Accessor* attributes[3] = { getAccessor(source.position), getAccessor(source.normal), getAccessor(source.textureCoordinate) };
+	if (!attributes[0] || !attributes[0]->data)
+	{
+		std::cout << "Warning: Skipping a primitive without positions! \n";
+		return false;
+	}
+	for (int i = 1; i < 3; i++)
+	{
+		if (attributes[i] && (!attributes[i]->data || attributes[i]->count != attributes[0]->count))
+		{
+			attributes[i] = nullptr; //An accessor without data is all zeros, which is what a missing attribute reads as anyway.
+		}
+	}
+	primitive.vertexCount = attributes[0]->count;
+	primitive.material = source.material;
+	primitive.positionAccessor = source.position;
+	primitive.normalAccessor = attributes[1] ? source.normal : -1;
+	primitive.textureCoordinateAccessor = attributes[2] ? source.textureCoordinate : -1;
+
+	//If the file already interleaves all three attributes in one view, that view is our vertex buffer as it is. Only its layout is ours.
+	const BufferView& positionView = m_BufferViews[attributes[0]->bufferView];
+	bool alreadyInterleaved = positionView.byteStride != 0;
+	for (const Accessor* attribute : attributes)
+	{
+		alreadyInterleaved = alreadyInterleaved && attribute && attribute->bufferView == attributes[0]->bufferView && attribute->byteOffset + attribute->GetElementSize() <= positionView.byteStride;
+	}
+	//KHR_mesh_quantization allows plain integers that still mean floats, but integer elements bind as integer inputs now. Those get widened to floats below.
+	bool widen[3] = {};
+	for (int i = 0; i < 3; i++)
+	{
+		widen[i] = attributes[i] && VertexBufferElement::IsIntegerAttribute(attributes[i]->componentType, (unsigned char)attributes[i]->normalized);
+		alreadyInterleaved = alreadyInterleaved && !widen[i];
+	}
+
+	VertexBufferElement elements[3];
+	unsigned int stride = 0;
+	if (alreadyInterleaved)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			elements[i] = { attributes[i]->componentType, attributes[i]->componentCount, (unsigned char)attributes[i]->normalized, (unsigned int)attributes[i]->byteOffset };
+		}
+		stride = (unsigned int)positionView.byteStride;
+		size_t viewSize = 0;
+		primitive.m_FileVertices = GetBufferViewData(attributes[0]->bufferView, viewSize);
+		primitive.vertexDataSize = std::min(viewSize, (size_t)stride * primitive.vertexCount);
+	}
+	else
+	{
+		//Otherwise this is the one copy, into the same formats the file used bar the widened integers. Missing normals and texture coordinates take the smallest zeros we can fetch.
+		for (int i = 0; i < 3; i++)
+		{
+			if (widen[i])
+			{
+				elements[i] = { GL_FLOAT, attributes[i]->componentCount, GL_FALSE, stride };
+			}
+			else if (attributes[i])
+			{
+				elements[i] = { attributes[i]->componentType, attributes[i]->componentCount, (unsigned char)attributes[i]->normalized, stride };
+			}
+			else
+			{
+				elements[i] = i == 1 ? VertexBufferElement{ GL_INT_2_10_10_10_REV, 4, GL_TRUE, stride } : VertexBufferElement{ GL_HALF_FLOAT, 2, GL_FALSE, stride };
+			}
+			stride += (VertexBufferElement::GetSize(elements[i].type, elements[i].count) + 3) & ~3u; //Attributes start on 4 bytes, as in VertexBufferLayout::Align().
+		}
+
+		primitive.m_InterleavedVertices.resize((size_t)stride * primitive.vertexCount);
+		primitive.vertexDataSize = primitive.m_InterleavedVertices.size();
+		for (int i = 0; i < 3; i++)
+		{
+			if (!attributes[i])
+			{
+				continue;
+			}
+			const unsigned char* read = attributes[i]->data;
+			unsigned char* write = primitive.m_InterleavedVertices.data() + elements[i].offset;
+			size_t elementSize = attributes[i]->GetElementSize();
+			for (size_t v = 0; v < primitive.vertexCount; v++, read += attributes[i]->stride, write += stride)
+			{
+				if (widen[i])
+				{
+					float element[4];
+					ConvertComponents(read, attributes[i]->componentType, false, element, attributes[i]->componentCount);
+					memcpy(write, element, attributes[i]->componentCount * sizeof(float));
+				}
+				else
+				{
+					memcpy(write, read, elementSize);
+				}
+			}
+		}
+	}
+	primitive.layout = VertexBufferLayout(elements, 3, stride);
+
+	//glTF requires min and max on positions, but we don't rely on it.
+	if (attributes[0]->hasBounds)
+	{
+		memcpy(primitive.boundsMinimum, attributes[0]->minimum, sizeof(primitive.boundsMinimum));
+		memcpy(primitive.boundsMaximum, attributes[0]->maximum, sizeof(primitive.boundsMaximum));
+	}
+	else
+	{
+		std::vector<float> positions(primitive.vertexCount * 3);
+		DecodeAccessorFloat(source.position, positions.data(), 3, 3);
+		for (int c = 0; c < 3; c++)
+		{
+			primitive.boundsMinimum[c] = primitive.boundsMaximum[c] = positions[c];
+		}
+		for (size_t v = 0; v < positions.size(); v++)
+		{
+			primitive.boundsMinimum[v % 3] = std::min(primitive.boundsMinimum[v % 3], positions[v]);
+			primitive.boundsMaximum[v % 3] = std::max(primitive.boundsMaximum[v % 3], positions[v]);
+		}
+	}
+	return DecodeIndices(source.indices, primitive);
+}
+
+bool GLTFScene::DecodeIndices(int accessorIndex, GLTFPrimitive& primitive)
+{
+	primitive.indexAccessor = accessorIndex;
+	if (accessorIndex < 0)
+	{
+		//Unindexed, so every three vertices are a triangle. We still need indices as the renderer always draws indexed.
+		primitive.m_WidenedIndices.resize(primitive.vertexCount - primitive.vertexCount % 3);
+		for (size_t i = 0; i < primitive.m_WidenedIndices.size(); i++)
+		{
+			primitive.m_WidenedIndices[i] = (unsigned int)i;
+		}
+		primitive.indexCount = primitive.m_WidenedIndices.size();
+		return primitive.indexCount > 0;
+	}
+
+	const Accessor* accessor = accessorIndex < (int)m_Accessors.size() ? &m_Accessors[accessorIndex] : nullptr;
+	if (!accessor || !accessor->data || accessor->componentCount != 1 ||
+		(accessor->componentType != GL_UNSIGNED_INT && accessor->componentType != GL_UNSIGNED_SHORT && accessor->componentType != GL_UNSIGNED_BYTE))
+	{
+		std::cout << "Warning: Skipping a primitive with invalid indices! \n";
+		return false;
+	}
+
+	//32 bit indices go up as they are. Smaller ones are widened, as IndexBuffer only takes 32 bit.
+	size_t count = accessor->count - accessor->count % 3;
+	bool tight = accessor->stride == accessor->GetElementSize();
+	if (accessor->componentType == GL_UNSIGNED_INT && tight && reinterpret_cast<uintptr_t>(accessor->data) % 4 == 0)
+	{
+		primitive.m_FileIndices = reinterpret_cast<const unsigned int*>(accessor->data);
+	}
+	else
+	{
+		primitive.m_WidenedIndices.resize(count);
+		if (accessor->componentType == GL_UNSIGNED_SHORT && tight)
+		{
+			WidenIndices(reinterpret_cast<const uint16_t*>(accessor->data), primitive.m_WidenedIndices.data(), count);
+		}
+		else if (accessor->componentType == GL_UNSIGNED_BYTE && tight)
+		{
+			WidenIndices(reinterpret_cast<const uint8_t*>(accessor->data), primitive.m_WidenedIndices.data(), count);
+		}
+		else
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				primitive.m_WidenedIndices[i] = ComponentToIndex(accessor->data + i * accessor->stride, accessor->componentType);
+			}
+		}
+	}
+	primitive.indexCount = count;
+
+	//An index past the end would read outside the vertex buffer on the GPU.
+	const unsigned int* indices = primitive.GetIndices();
+	unsigned int maximum = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		maximum = std::max(maximum, indices[i]);
+	}
+	if (count == 0 || maximum >= primitive.vertexCount)
+	{
+		std::cout << "Warning: Skipping a primitive whose indices reference vertices it doesn't have! \n";
+		return false;
+	}
+	return true;
+}
+
+void GLTFScene::UpdateWorldTransforms(int node, const glm::mat4& parentTransform, int depth)
+{
+	if (depth > (int)m_Nodes.size())
+	{
+		return; //Only a cycle could go this deep, which glTF forbids, but we would rather not recurse forever.
+	}
+	m_Nodes[node].worldTransform = parentTransform * m_Nodes[node].localTransform;
+	for (int child : m_Nodes[node].children)
+	{
+		if (child >= 0 && child < (int)m_Nodes.size())
+		{
+			UpdateWorldTransforms(child, m_Nodes[node].worldTransform, depth + 1);
+		}
+	}
+}
+
+size_t GLTFScene::DecodeAccessorFloat(int accessorIndex, float* destination, unsigned int componentCount, unsigned int destinationStride) const
+{
+	if (accessorIndex < 0 || accessorIndex >= (int)m_Accessors.size() || m_Accessors[accessorIndex].componentCount == 0)
+	{
+		return 0;
+	}
+
+	const Accessor& accessor = m_Accessors[accessorIndex];
+	if (!accessor.data)
+	{
+		for (size_t i = 0; i < accessor.count; i++)
+		{
+			std::fill(destination + i * destinationStride, destination + i * destinationStride + componentCount, 0.0f);
+		}
+		return accessor.count;
+	}
+
+	//The common case of a tightly packed accessor into a tightly packed destination converts as one run.
+	if (accessor.stride == accessor.GetElementSize() && accessor.componentCount == componentCount && destinationStride == componentCount)
+	{
+		ConvertComponents(accessor.data, accessor.componentType, accessor.normalized, destination, accessor.count * componentCount);
+		return accessor.count;
+	}
+
+	float element[4];
+	for (size_t i = 0; i < accessor.count; i++)
+	{
+		ConvertComponents(accessor.data + i * accessor.stride, accessor.componentType, accessor.normalized, element, accessor.componentCount);
+		for (unsigned int c = 0; c < componentCount; c++)
+		{
+			destination[i * destinationStride + c] = c < accessor.componentCount ? element[c] : 0.0f;
+		}
+	}
+	return accessor.count;
+}
+
+bool GLTFScene::IsBenchmarkCommand(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark-gltf") == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int GLTFScene::RunBenchmark(int argc, char** argv)
+{
+	std::vector<std::string> filePaths;
+	int iterations = 5;
+	bool readingFiles = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark-gltf") == 0)
+		{
+			readingFiles = true;
+		}
+		else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+		{
+			iterations = std::max(1, atoi(argv[++i]));
+			readingFiles = false;
+		}
+		else if (readingFiles)
+		{
+			filePaths.push_back(argv[i]);
+		}
+	}
+
+	if (filePaths.empty())
+	{
+		std::cout << "Usage: GraphicsAPIAbstractor --benchmark-gltf <.gltf or .glb files...> [--iterations <count>] \n";
+		return 1;
+	}
+
+	//The first load also pays for reading the file from disk, so the best of several is the loader's own speed.
+	int failed = 0;
+	for (const std::string& filePath : filePaths)
+	{
+		GLTFStatistics best;
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			GLTFScene scene;
+			if (!scene.Load(filePath))
+			{
+				failed++;
+				break;
+			}
+			if (iteration == 0 || scene.GetStatistics().totalMilliseconds < best.totalMilliseconds)
+			{
+				best = scene.GetStatistics();
+			}
+		}
+		if (best.totalMilliseconds <= 0.0)
+		{
+			continue;
+		}
+
+		std::cout << filePath << ": " << best.fileBytes / (1024.0 * 1024.0) << "MB in " << best.totalMilliseconds << "ms, " << best.GetMegabytesPerSecond() << "MB/s \n";
+		std::cout << "    Parse " << best.parseMilliseconds << "ms, geometry " << best.decodeMilliseconds << "ms, images " << best.imageMilliseconds << "ms ("
+				  << best.imageBytes / (1024.0 * 1024.0) << "MB). \n";
+		std::cout << "    " << (best.vertexBytes + best.indexBytes) / (1024.0 * 1024.0) << "MB of vertices and indices to upload, of which "
+				  << best.copiedBytes / (1024.0 * 1024.0) << "MB had to be copied. \n";
+	}
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "MappedFile.h"
+#include "../OpenGL/VertexBufferLayout.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+
+//A glTF 2.0 scene (.gltf or .glb) read into the shapes our renderer wants, ready for VertexBuffer, IndexBuffer, VertexBufferLayout and Texture.
+//Binary buffers are memory mapped and never copied on the way to the GPU if they can be avoided: vertices that are already interleaved in the file are handed over
+//as a view into the mapping, with a VertexBufferLayout describing them as they are, and 32 bit indices likewise. Anything else is copied exactly once, into the
+//interleaved or widened form we upload. Embedded and external images are decoded in parallel with the geometry.
+//Every primitive uses the same attribute locations: 0 is position, 1 is normal and 2 is the first set of texture coordinates. Missing ones read as 0.
+
+struct GLTFStatistics
+{
+	size_t fileBytes = 0; //The JSON plus every binary buffer it references.
+	size_t imageBytes = 0; //Encoded image data, counted within fileBytes if it is embedded.
+	size_t vertexBytes = 0; //What will be uploaded.
+	size_t indexBytes = 0;
+	size_t copiedBytes = 0; //How much of the above had to be copied out of the file rather than uploaded straight from it.
+	double parseMilliseconds = 0.0;
+	double decodeMilliseconds = 0.0; //Buffers and accessors, so everything but the images.
+	double imageMilliseconds = 0.0; //Wall time until the last image finished, which overlaps the decode.
+	double totalMilliseconds = 0.0;
+
+	inline double GetMegabytesPerSecond() const { return totalMilliseconds > 0.0 ? fileBytes / (1024.0 * 1024.0) / (totalMilliseconds / 1000.0) : 0.0; }
+};
+
+struct GLTFPrimitive
+{
+	VertexBufferLayout layout;
+	size_t vertexCount = 0;
+	size_t vertexDataSize = 0;
+	size_t indexCount = 0;
+	int material = -1;
+	float boundsMinimum[3] = { 0.0f, 0.0f, 0.0f };
+	float boundsMaximum[3] = { 0.0f, 0.0f, 0.0f };
+	int positionAccessor = -1, normalAccessor = -1, textureCoordinateAccessor = -1, indexAccessor = -1; //For DecodeAccessorFloat. -1 where missing.
+
+	//Either straight into the mapped file, or into the copy we had to make.
+	inline const void* GetVertexData() const { return m_InterleavedVertices.empty() ? m_FileVertices : m_InterleavedVertices.data(); }
+	inline const unsigned int* GetIndices() const { return m_WidenedIndices.empty() ? m_FileIndices : m_WidenedIndices.data(); }
+
+private:
+	friend class GLTFScene;
+	const void* m_FileVertices = nullptr;
+	const unsigned int* m_FileIndices = nullptr;
+	std::vector<unsigned char> m_InterleavedVertices;
+	std::vector<unsigned int> m_WidenedIndices;
+};
+
+struct GLTFMesh
+{
+	std::string name;
+	std::vector<GLTFPrimitive> primitives;
+};
+
+struct GLTFNode
+{
+	std::string name;
+	int mesh = -1;
+	std::vector<int> children;
+	glm::mat4 localTransform = glm::mat4(1.0f);
+	glm::mat4 worldTransform = glm::mat4(1.0f); //Only set for nodes reachable from the scene we loaded.
+};
+
+struct GLTFMaterial
+{
+	std::string name;
+	float baseColorFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	int baseColorTexture = -1; //Into GetTextures().
+};
+
+struct GLTFTexture
+{
+	int image = -1;
+	unsigned int minFilter = GL_LINEAR_MIPMAP_LINEAR; //The glTF sampler, which uses the GL enums directly. These are the defaults when it leaves them out.
+	unsigned int magFilter = GL_LINEAR;
+	unsigned int wrapS = GL_REPEAT;
+	unsigned int wrapT = GL_REPEAT;
+};
+
+struct GLTFImagePixelsDeleter
+{
+	void operator()(unsigned char* pixels) const;
+};
+
+struct GLTFImage
+{
+	std::string name;
+	int width = 0, height = 0;
+	std::unique_ptr<unsigned char, GLTFImagePixelsDeleter> pixels; //RGBA8, top row first, which is what glTF's texture coordinates expect. Null if decoding failed.
+};
+
+class GLTFScene
+{
+public:
+	bool Load(const std::string& filePath); //Once per GLTFScene. Blocks until every buffer and image is decoded.
+
+	inline const std::vector<GLTFMesh>& GetMeshes() const { return m_Meshes; }
+	inline const std::vector<GLTFNode>& GetNodes() const { return m_Nodes; }
+	inline const std::vector<int>& GetRootNodes() const { return m_RootNodes; }
+	inline const std::vector<GLTFMaterial>& GetMaterials() const { return m_Materials; }
+	inline const std::vector<GLTFTexture>& GetTextures() const { return m_Textures; }
+	inline std::vector<GLTFImage>& GetImages() { return m_Images; } //Not const, so the pixels can be released once they are uploaded.
+	inline const GLTFStatistics& GetStatistics() const { return m_Statistics; }
+
+	//Converts any accessor to floats, applying normalization. Writes componentCount floats per element, destinationStride floats apart, zero filling any
+	//components the accessor doesn't have. Returns the element count, or 0 for an invalid accessor.
+	size_t DecodeAccessorFloat(int accessor, float* destination, unsigned int componentCount, unsigned int destinationStride) const;
+
+	//GraphicsAPIAbstractor --benchmark-gltf <.gltf or .glb files...> [--iterations <count>]
+	//Loads each file repeatedly without a window or context and reports the best throughput, which is what to watch when changing the loader.
+	static bool IsBenchmarkCommand(int argc, char** argv);
+	static int RunBenchmark(int argc, char** argv);
+
+	//GLTFScene holds views into its own mappings, so it can't be copied.
+	GLTFScene() = default;
+	GLTFScene(const GLTFScene&) = delete;
+	GLTFScene& operator=(const GLTFScene&) = delete;
+
+private:
+	struct Buffer
+	{
+		std::string uri;
+		size_t byteLength = 0;
+		const unsigned char* data = nullptr;
+	};
+
+	struct BufferView
+	{
+		int buffer = -1;
+		size_t byteOffset = 0, byteLength = 0, byteStride = 0;
+	};
+
+	struct Accessor
+	{
+		int bufferView = -1;
+		size_t byteOffset = 0, count = 0;
+		unsigned int componentType = 0, componentCount = 0;
+		bool normalized = false, sparse = false;
+		bool hasBounds = false;
+		float minimum[3] = { 0.0f, 0.0f, 0.0f }, maximum[3] = { 0.0f, 0.0f, 0.0f };
+
+		//Resolved once the buffers are loaded.
+		const unsigned char* data = nullptr;
+		size_t stride = 0;
+		inline unsigned int GetElementSize() const { return VertexBufferElement::GetSize(componentType, componentCount); }
+	};
+
+	struct PrimitiveSource
+	{
+		int mesh = -1, primitive = -1; //Where it decodes to.
+		int position = -1, normal = -1, textureCoordinate = -1, indices = -1, material = -1;
+		unsigned int mode = 4; //GL_TRIANGLES
+	};
+
+	bool ParseJSON(const char* json, size_t size);
+	bool LoadBuffers(const unsigned char* binaryChunk, size_t binaryChunkSize);
+	bool ResolveAccessors();
+	bool DecodePrimitive(const PrimitiveSource& source, GLTFPrimitive& primitive);
+	bool DecodeIndices(int accessor, GLTFPrimitive& primitive);
+	void UpdateWorldTransforms(int node, const glm::mat4& parentTransform, int depth);
+	const unsigned char* GetBufferViewData(int bufferView, size_t& size) const;
+
+	std::string m_Directory; //External buffers and images are relative to the file.
+	std::vector<MappedFile> m_Files; //The .glb, or the .gltf's external buffers.
+	std::vector<std::vector<unsigned char>> m_DecodedBuffers; //Buffers embedded as base64 data URIs.
+	std::vector<Buffer> m_Buffers;
+	std::vector<BufferView> m_BufferViews;
+	std::vector<Accessor> m_Accessors;
+	std::vector<PrimitiveSource> m_PrimitiveSources;
+	std::vector<std::string> m_ImageURIs; //Either these or the buffer views below, per image.
+	std::vector<int> m_ImageBufferViews;
+	std::vector<std::vector<int>> m_Scenes; //The root nodes of each.
+	std::vector<GLTFTexture> m_Samplers; //Only the filters and wrapping are used.
+	std::vector<int> m_TextureSamplers;
+	int m_DefaultScene = -1;
+
+	std::vector<GLTFMesh> m_Meshes;
+	std::vector<GLTFNode> m_Nodes;
+	std::vector<int> m_RootNodes;
+	std::vector<GLTFMaterial> m_Materials;
+	std::vector<GLTFTexture> m_Textures;
+	std::vector<GLTFImage> m_Images;
+	GLTFStatistics m_Statistics;
+};
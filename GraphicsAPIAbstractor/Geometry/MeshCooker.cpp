@@ -0,0 +1,444 @@
+#include "GAAPrecompiledHeader.h"
+#include "MeshCooker.h"
+#include "GLTFScene.h"
+#include "JobSystem.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexQuantizer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "glm/glm.hpp"
+
+namespace
+{
+	//An OBJ face corner references position, texture coordinate and normal separately. Each unique combination becomes one vertex.
+	struct CornerKey
+	{
+		int position, textureCoordinate, normal;
+		bool operator==(const CornerKey& other) const { return position == other.position && textureCoordinate == other.textureCoordinate && normal == other.normal; }
+	};
+
+	struct CornerKeyHash
+	{
+		size_t operator()(const CornerKey& key) const { return (size_t)key.position * 73856093u ^ (size_t)key.textureCoordinate * 19349663u ^ (size_t)key.normal * 83492791u; }
+	};
+
+	//Vertices without a normal get the area weighted average of the faces around them.
+	void GenerateMissingNormals(std::vector<float>& vertices, const std::vector<unsigned int>& indices, const std::vector<bool>& hasNormal)
+	{
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const float* a = &vertices[indices[i] * MeshCooker::s_VertexStride];
+			const float* b = &vertices[indices[i + 1] * MeshCooker::s_VertexStride];
+			const float* c = &vertices[indices[i + 2] * MeshCooker::s_VertexStride];
+			float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			float normal[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+			for (int corner = 0; corner < 3; corner++)
+			{
+				if (!hasNormal[indices[i + corner]])
+				{
+					float* vertexNormal = &vertices[indices[i + corner] * MeshCooker::s_VertexStride + 3];
+					vertexNormal[0] += normal[0];
+					vertexNormal[1] += normal[1];
+					vertexNormal[2] += normal[2];
+				}
+			}
+		}
+		for (size_t v = 0; v < hasNormal.size(); v++)
+		{
+			float* normal = &vertices[v * MeshCooker::s_VertexStride + 3];
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (!hasNormal[v] && length > 0.0f)
+			{
+				normal[0] /= length;
+				normal[1] /= length;
+				normal[2] /= length;
+			}
+		}
+	}
+
+	std::string MakeOutputPath(const std::string& inputPath, const std::string& outputDirectory)
+	{
+		size_t nameStart = inputPath.find_last_of("/\\");
+		nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+		size_t extension = inputPath.find_last_of('.');
+		std::string name = inputPath.substr(nameStart, extension != std::string::npos && extension > nameStart ? extension - nameStart : std::string::npos);
+
+		if (outputDirectory.empty())
+		{
+			return inputPath.substr(0, nameStart) + name + ".gaam";
+		}
+		char last = outputDirectory.back();
+		return outputDirectory + (last == '/' || last == '\\' ? "" : "/") + name + ".gaam";
+	}
+}
+
+bool MeshCooker::LoadOBJ(const std::string& filePath, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+	std::ifstream stream(filePath, std::ios::binary | std::ios::ate);
+	if (!stream)
+	{
+		std::cout << "Warning: Failed to open " << filePath << "! \n";
+		return false;
+	}
+	std::string text((size_t)stream.tellg(), '\0');
+	stream.seekg(0);
+	stream.read(&text[0], (std::streamsize)text.size());
+
+	std::vector<float> positions, normals, textureCoordinates;
+	std::unordered_map<CornerKey, unsigned int, CornerKeyHash> corners;
+	std::vector<bool> hasNormal;
+	std::vector<unsigned int> polygon;
+	vertices.clear();
+	indices.clear();
+
+	//We parse straight out of the buffer with strtof and strtol rather than through streams, which are several times slower on large files.
+	const char* cursor = text.c_str();
+	const char* end = cursor + text.size();
+	while (cursor < end)
+	{
+		const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+		lineEnd = lineEnd ? lineEnd : end;
+		while (cursor < lineEnd && (*cursor == ' ' || *cursor == '\t'))
+		{
+			cursor++;
+		}
+
+		char* next = nullptr;
+		if (cursor[0] == 'v' && cursor[1] == ' ')
+		{
+			cursor += 2;
+			for (int i = 0; i < 3; i++, cursor = next)
+			{
+				positions.push_back(strtof(cursor, &next));
+			}
+		}
+		else if (cursor[0] == 'v' && cursor[1] == 't')
+		{
+			cursor += 2;
+			for (int i = 0; i < 2; i++, cursor = next)
+			{
+				textureCoordinates.push_back(strtof(cursor, &next));
+			}
+		}
+		else if (cursor[0] == 'v' && cursor[1] == 'n')
+		{
+			cursor += 2;
+			for (int i = 0; i < 3; i++, cursor = next)
+			{
+				normals.push_back(strtof(cursor, &next));
+			}
+		}
+		else if (cursor[0] == 'f' && cursor[1] == ' ')
+		{
+			cursor += 2;
+			polygon.clear();
+			//Corners are v, v/vt, v//vn or v/vt/vn. Indices start at 1, and negative ones count back from the most recent element.
+			auto resolve = [](long index, size_t count) { return index < 0 ? (int)(count + index) : (int)index - 1; };
+			while (true)
+			{
+				long position = strtol(cursor, &next, 10);
+				if (next == cursor || next > lineEnd)
+				{
+					break;
+				}
+				cursor = next;
+
+				CornerKey key = { resolve(position, positions.size() / 3), -1, -1 };
+				if (*cursor == '/')
+				{
+					cursor++;
+					if (*cursor != '/')
+					{
+						key.textureCoordinate = resolve(strtol(cursor, &next, 10), textureCoordinates.size() / 2);
+						cursor = next;
+					}
+					if (*cursor == '/')
+					{
+						cursor++;
+						key.normal = resolve(strtol(cursor, &next, 10), normals.size() / 3);
+						cursor = next;
+					}
+				}
+
+				if (key.position < 0 || (size_t)key.position >= positions.size() / 3 || key.textureCoordinate >= (int)(textureCoordinates.size() / 2) || key.normal >= (int)(normals.size() / 3))
+				{
+					std::cout << "Warning: " << filePath << " references a vertex that doesn't exist! \n";
+					return false;
+				}
+
+				auto inserted = corners.emplace(key, (unsigned int)(vertices.size() / s_VertexStride));
+				if (inserted.second)
+				{
+					const float* p = &positions[key.position * 3];
+					vertices.insert(vertices.end(), { p[0], p[1], p[2] });
+					if (key.normal >= 0)
+					{
+						vertices.insert(vertices.end(), { normals[key.normal * 3], normals[key.normal * 3 + 1], normals[key.normal * 3 + 2] });
+					}
+					else
+					{
+						vertices.insert(vertices.end(), { 0.0f, 0.0f, 0.0f });
+					}
+					if (key.textureCoordinate >= 0)
+					{
+						vertices.insert(vertices.end(), { textureCoordinates[key.textureCoordinate * 2], textureCoordinates[key.textureCoordinate * 2 + 1] });
+					}
+					else
+					{
+						vertices.insert(vertices.end(), { 0.0f, 0.0f });
+					}
+					hasNormal.push_back(key.normal >= 0);
+				}
+				polygon.push_back(inserted.first->second);
+			}
+
+			for (size_t i = 2; i < polygon.size(); i++) //Fan triangulation, which is all OBJ's convex polygons need.
+			{
+				indices.insert(indices.end(), { polygon[0], polygon[i - 1], polygon[i] });
+			}
+		}
+		cursor = lineEnd + 1;
+	}
+
+	GenerateMissingNormals(vertices, indices, hasNormal);
+	return true;
+}
+
+bool MeshCooker::LoadGLTF(const std::string& filePath, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+	GLTFScene scene;
+	if (!scene.Load(filePath))
+	{
+		return false;
+	}
+	vertices.clear();
+	indices.clear();
+
+	//A cooked mesh has no hierarchy, so every instance of every mesh in the scene is flattened into one, in world space.
+	const std::vector<GLTFNode>& nodes = scene.GetNodes();
+	const std::vector<GLTFMesh>& meshes = scene.GetMeshes();
+	std::vector<bool> hasNormal, visited(nodes.size(), false);
+	std::vector<int> pending(scene.GetRootNodes().rbegin(), scene.GetRootNodes().rend());
+	while (!pending.empty())
+	{
+		int nodeIndex = pending.back();
+		pending.pop_back();
+		if (visited[nodeIndex])
+		{
+			continue;
+		}
+		visited[nodeIndex] = true;
+		const GLTFNode& node = nodes[nodeIndex];
+		for (auto child = node.children.rbegin(); child != node.children.rend(); ++child)
+		{
+			if (*child >= 0 && *child < (int)nodes.size())
+			{
+				pending.push_back(*child);
+			}
+		}
+		if (node.mesh < 0 || node.mesh >= (int)meshes.size())
+		{
+			continue;
+		}
+
+		glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(node.worldTransform)));
+		bool mirrored = glm::determinant(glm::mat3(node.worldTransform)) < 0.0f; //Mirroring flips the winding, which we flip back.
+		for (const GLTFPrimitive& primitive : meshes[node.mesh].primitives)
+		{
+			size_t firstVertex = vertices.size() / s_VertexStride;
+			vertices.resize(vertices.size() + primitive.vertexCount * s_VertexStride, 0.0f);
+			float* destination = &vertices[firstVertex * s_VertexStride];
+			scene.DecodeAccessorFloat(primitive.positionAccessor, destination, 3, s_VertexStride);
+			scene.DecodeAccessorFloat(primitive.normalAccessor, destination + 3, 3, s_VertexStride); //Leaves the zeros if there are none.
+			scene.DecodeAccessorFloat(primitive.textureCoordinateAccessor, destination + 6, 2, s_VertexStride);
+			for (size_t v = 0; v < primitive.vertexCount; v++)
+			{
+				float* vertex = destination + v * s_VertexStride;
+				glm::vec3 position = glm::vec3(node.worldTransform * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+				glm::vec3 normal = normalTransform * glm::vec3(vertex[3], vertex[4], vertex[5]);
+				float length = glm::length(normal);
+				normal = length > 0.0f ? normal / length : normal;
+				memcpy(vertex, &position[0], sizeof(float) * 3);
+				memcpy(vertex + 3, &normal[0], sizeof(float) * 3);
+			}
+			hasNormal.resize(firstVertex + primitive.vertexCount, primitive.normalAccessor >= 0);
+
+			const unsigned int* primitiveIndices = primitive.GetIndices();
+			for (size_t i = 0; i < primitive.indexCount; i += 3)
+			{
+				unsigned int second = mirrored ? 2 : 1;
+				indices.insert(indices.end(), { (unsigned int)firstVertex + primitiveIndices[i], (unsigned int)firstVertex + primitiveIndices[i + second], (unsigned int)firstVertex + primitiveIndices[i + 3 - second] });
+			}
+		}
+	}
+
+	if (indices.empty())
+	{
+		std::cout << "Warning: " << filePath << " has no triangles to cook! \n";
+		return false;
+	}
+	GenerateMissingNormals(vertices, indices, hasNormal);
+	return true;
+}
+
+bool MeshCooker::CookMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const std::string& outputPath, const MeshCookSettings& settings)
+{
+	size_t vertexCount = vertices.size() / s_VertexStride;
+	if (indices.empty())
+	{
+		std::cout << "Warning: Nothing to cook for " << outputPath << ", the mesh has no triangles! \n";
+		return false;
+	}
+
+	//LODs first, as simplification needs the full precision attributes. Normal and texture coordinate changes are weighted so a full unit costs about 1% of the mesh.
+	float extent = MeshSimplifier::CalculateMeshExtent(vertices.data(), vertexCount, s_VertexStride);
+	const float attributeWeights[5] = { 0.0001f, 0.0001f, 0.0001f, 0.0001f, 0.0001f };
+	std::vector<unsigned int> lodIndices;
+	std::vector<MeshLOD> lods = MeshSimplifier::GenerateLODChain(lodIndices, indices.data(), indices.size(), vertices.data(), vertexCount, s_VertexStride,
+		settings.maxLODCount, settings.lodReduction, settings.lodMaxError, false, 3, 5, attributeWeights);
+
+	//LOD 0 is drawn up close, where overdraw matters most, so it gets the overdraw pass on top of the cache order the LOD chain already gave it.
+	std::vector<unsigned int> cacheOrdered(lods[0].indexCount), clusters;
+	MeshOptimizer::OptimizeVertexCacheTipsify(cacheOrdered.data(), lodIndices.data(), lods[0].indexCount, vertexCount, 16, &clusters);
+	MeshOptimizer::OptimizeOverdraw(lodIndices.data(), cacheOrdered.data(), lods[0].indexCount, vertices.data(), vertexCount, s_VertexStride, clusters);
+
+	//Every LOD shares the vertex buffer, so the fetch order follows all of them, LOD 0 first.
+	std::vector<float> fetchOrdered(vertices.size());
+	size_t usedVertexCount = MeshOptimizer::OptimizeVertexFetch(fetchOrdered.data(), lodIndices.data(), lodIndices.size(), vertices.data(), vertexCount, s_VertexStride * sizeof(float));
+	fetchOrdered.resize(usedVertexCount * s_VertexStride);
+
+	std::vector<Meshlet> meshlets = MeshOptimizer::BuildMeshlets(lodIndices.data(), lods[0].indexCount, fetchOrdered.data(), usedVertexCount, s_VertexStride);
+
+	float boundsMinimum[3] = { INFINITY, INFINITY, INFINITY }, boundsMaximum[3] = { -INFINITY, -INFINITY, -INFINITY };
+	for (size_t v = 0; v < usedVertexCount; v++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			boundsMinimum[axis] = std::min(boundsMinimum[axis], fetchOrdered[v * s_VertexStride + axis]);
+			boundsMaximum[axis] = std::max(boundsMaximum[axis], fetchOrdered[v * s_VertexStride + axis]);
+		}
+	}
+
+	QuantizationAttribute attributes[3];
+	attributes[0].componentCount = 3;
+	attributes[0].maxError = settings.positionError * (extent > 0.0f ? extent : 1.0f);
+	attributes[0].allowRemap = true; //Positions are rarely within [0, 1], and the mesh's dequantization is a single scale and offset the shader can apply.
+	attributes[1].componentCount = 3;
+	attributes[1].maxError = settings.normalError;
+	attributes[2].componentCount = 2;
+	attributes[2].maxError = settings.textureCoordinateError;
+	QuantizedVertices quantized = VertexQuantizer::Quantize(fetchOrdered.data(), usedVertexCount, attributes, 3);
+
+	if (!MeshFile::Write(outputPath, quantized, lodIndices, lods, meshlets, boundsMinimum, boundsMaximum))
+	{
+		return false;
+	}
+
+	VertexCacheStatistics before = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+	VertexCacheStatistics after = MeshOptimizer::AnalyzeVertexCache(lodIndices.data(), lods[0].indexCount, usedVertexCount);
+	std::stringstream summary; //Built up front so lines from meshes cooking in parallel don't interleave.
+	summary << "Cooked " << outputPath << ": " << indices.size() / 3 << " triangles, " << lods.size() << " LODs down to " << lods.back().indexCount / 3 << " triangles, "
+			<< meshlets.size() << " meshlets. ACMR " << before.acmr << " -> " << after.acmr << ", vertex size " << s_VertexStride * sizeof(float) << " -> " << quantized.layout.GetStride() << " bytes. \n";
+	std::cout << summary.str();
+	return true;
+}
+
+bool MeshCooker::CookFile(const std::string& inputPath, const std::string& outputPath, const MeshCookSettings& settings)
+{
+	std::string extension = inputPath.substr(inputPath.find_last_of('.') + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	if (extension == "obj")
+	{
+		if (!LoadOBJ(inputPath, vertices, indices))
+		{
+			return false;
+		}
+	}
+	else if (extension == "gltf" || extension == "glb")
+	{
+		if (!LoadGLTF(inputPath, vertices, indices))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		std::cout << "Warning: Don't know how to cook " << inputPath << "! \n";
+		return false;
+	}
+	return CookMesh(vertices, indices, outputPath, settings);
+}
+
+unsigned int MeshCooker::CookFiles(const std::vector<std::string>& inputPaths, const std::string& outputDirectory, const MeshCookSettings& settings)
+{
+	//Every mesh cooks independently. One file per range, as even a small mesh is plenty of work for a job.
+	std::atomic<unsigned int> succeeded(0);
+	JobSystem::ParallelFor(inputPaths.size(), [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			if (CookFile(inputPaths[i], MakeOutputPath(inputPaths[i], outputDirectory), settings))
+			{
+				succeeded++;
+			}
+		}
+	});
+	return succeeded;
+}
+
+bool MeshCooker::IsCookCommand(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--cook") == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int MeshCooker::RunCommandLine(int argc, char** argv)
+{
+	std::vector<std::string> inputPaths;
+	std::string outputDirectory;
+	bool readingInputs = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--cook") == 0)
+		{
+			readingInputs = true;
+		}
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+		{
+			outputDirectory = argv[++i];
+			readingInputs = false;
+		}
+		else if (readingInputs)
+		{
+			inputPaths.push_back(argv[i]);
+		}
+	}
+
+	if (inputPaths.empty())
+	{
+		std::cout << "Usage: GraphicsAPIAbstractor --cook <.obj, .gltf or .glb files...> [--output <directory>] \n";
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	unsigned int succeeded = CookFiles(inputPaths, outputDirectory);
+	auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Cooked " << succeeded << " of " << inputPaths.size() << " meshes in " << milliseconds << "ms. \n";
+	return succeeded == inputPaths.size() ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+
+struct MeshCookSettings
+{
+	unsigned int maxLODCount = 4;
+	float lodReduction = 0.5f; //Each LOD aims for this fraction of the previous one's triangles.
+	float lodMaxError = 0.02f; //Relative to the mesh's extent.
+	float positionError = 0.0005f; //Quantization bounds. Positions are relative to the mesh's extent, normals and texture coordinates are absolute.
+	float normalError = 0.005f;
+	float textureCoordinateError = 1.0f / 4096.0f;
+};
+
+//Turns source models into cooked .gaam meshes (see MeshFile.h). Each mesh is welded, simplified into a LOD chain, reordered for the vertex cache, overdraw
+//and vertex fetch, split into meshlets and quantized. Cooked vertices are position, normal and texture coordinates, in that order.
+class MeshCooker
+{
+public:
+	static bool CookFile(const std::string& inputPath, const std::string& outputPath, const MeshCookSettings& settings = MeshCookSettings());
+	static unsigned int CookFiles(const std::vector<std::string>& inputPaths, const std::string& outputDirectory, const MeshCookSettings& settings = MeshCookSettings()); //In parallel. Returns how many succeeded.
+
+	//GraphicsAPIAbstractor --cook <input files...> [--output <directory>]
+	static bool IsCookCommand(int argc, char** argv);
+	static int RunCommandLine(int argc, char** argv);
+
+	//Interleaved position, normal, texture coordinates. Missing normals are generated, missing texture coordinates are 0.
+	static bool LoadOBJ(const std::string& filePath, std::vector<float>& vertices, std::vector<unsigned int>& indices);
+	static bool LoadGLTF(const std::string& filePath, std::vector<float>& vertices, std::vector<unsigned int>& indices); //Every mesh the default scene instances, flattened into world space.
+	static bool CookMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const std::string& outputPath, const MeshCookSettings& settings);
+
+	static constexpr unsigned int s_VertexStride = 8; //In floats.
+};
@@ -0,0 +1,170 @@
+#include "GAAPrecompiledHeader.h"
+#include "MeshFile.h"
+#include <cstring>
+
+namespace
+{
+	uint64_t AlignSection(uint64_t offset)
+	{
+		return (offset + 15) & ~15ull;
+	}
+}
+
+bool MeshFile::Open(const std::string& filePath)
+{
+	Close();
+	if (!m_File.Open(filePath))
+	{
+		return false;
+	}
+
+	size_t fileSize = m_File.GetSize();
+	const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(m_File.GetData());
+	if (fileSize < sizeof(MeshFileHeader) || memcmp(header->magic, "GAAM", 4) != 0)
+	{
+		std::cout << "Warning: " << filePath << " is not a cooked mesh! \n";
+		m_File.Close();
+		return false;
+	}
+	if (header->version != MeshFileHeader::s_CurrentVersion)
+	{
+		std::cout << "Warning: " << filePath << " was cooked as version " << header->version << ", but we read version " << MeshFileHeader::s_CurrentVersion << ". Recook it! \n";
+		m_File.Close();
+		return false;
+	}
+
+	//We hand these sections straight to OpenGL, so a truncated or corrupt file has to be caught here rather than read past the end of the mapping.
+	auto sectionFits = [fileSize](uint64_t offset, uint64_t size) { return offset % 4 == 0 && offset <= fileSize && size <= fileSize - offset; };
+	bool valid = sectionFits(header->attributesOffset, (uint64_t)header->attributeCount * sizeof(MeshFileAttribute)) &&
+				 sectionFits(header->verticesOffset, (uint64_t)header->vertexCount * header->vertexStride) &&
+				 sectionFits(header->indicesOffset, (uint64_t)header->indexCount * sizeof(unsigned int)) &&
+				 sectionFits(header->lodsOffset, (uint64_t)header->lodCount * sizeof(MeshLOD)) &&
+				 sectionFits(header->meshletsOffset, (uint64_t)header->meshletCount * sizeof(Meshlet));
+	if (!valid)
+	{
+		std::cout << "Warning: " << filePath << " is truncated or corrupt! \n";
+		m_File.Close();
+		return false;
+	}
+
+	//The sections fitting isn't enough: the ranges inside them go straight to the GPU as well, which would read past its buffers just the same.
+	m_Header = header;
+	if (!ValidateContents())
+	{
+		std::cout << "Warning: " << filePath << " has attributes, LODs, meshlets or indices outside its vertex or index data! \n";
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool MeshFile::ValidateContents() const
+{
+	const MeshFileAttribute* attributes = GetAttributes();
+	for (uint32_t i = 0; i < m_Header->attributeCount; i++)
+	{
+		const MeshFileAttribute& attribute = attributes[i];
+		unsigned int typeSize = VertexBufferElement::FindSizeOfType(attribute.type);
+		bool packed = VertexBufferElement::IsPackedType(attribute.type);
+		if (typeSize == 0 || attribute.count < 1 || attribute.count > 4 || (packed && attribute.count != 4) ||
+			(uint64_t)attribute.byteOffset + VertexBufferElement::GetSize(attribute.type, attribute.count) > m_Header->vertexStride)
+		{
+			return false;
+		}
+	}
+
+	const MeshLOD* lods = GetLODs();
+	for (uint32_t i = 0; i < m_Header->lodCount; i++)
+	{
+		if ((uint64_t)lods[i].firstIndex + lods[i].indexCount > m_Header->indexCount)
+		{
+			return false;
+		}
+	}
+
+	const Meshlet* meshlets = GetMeshlets();
+	for (uint32_t i = 0; i < m_Header->meshletCount; i++)
+	{
+		if ((uint64_t)meshlets[i].firstIndex + (uint64_t)meshlets[i].triangleCount * 3 > m_Header->indexCount)
+		{
+			return false;
+		}
+	}
+
+	//The cooker never writes an index past the last vertex, so this only finds corruption. It touches every index, but the upload is about to anyway.
+	const unsigned int* indices = GetIndices();
+	for (uint32_t i = 0; i < m_Header->indexCount; i++)
+	{
+		if (indices[i] >= m_Header->vertexCount)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+VertexBufferLayout MeshFile::CreateLayout() const
+{
+	std::vector<VertexBufferElement> elements(m_Header->attributeCount);
+	const MeshFileAttribute* attributes = GetAttributes();
+	for (uint32_t i = 0; i < m_Header->attributeCount; i++)
+	{
+		elements[i] = { attributes[i].type, attributes[i].count, (unsigned char)attributes[i].normalized, attributes[i].byteOffset };
+	}
+	return VertexBufferLayout(elements.data(), (unsigned int)elements.size(), m_Header->vertexStride);
+}
+
+bool MeshFile::Write(const std::string& filePath, const QuantizedVertices& vertices, const std::vector<unsigned int>& indices, const std::vector<MeshLOD>& lods,
+	const std::vector<Meshlet>& meshlets, const float boundsMinimum[3], const float boundsMaximum[3])
+{
+	const auto& elements = vertices.layout.GetElements();
+	std::vector<MeshFileAttribute> attributes(elements.size());
+	for (size_t i = 0; i < elements.size(); i++)
+	{
+		MeshFileAttribute& attribute = attributes[i]; //Value initialized by the vector, so nothing is left unset.
+		attribute.type = elements[i].type;
+		attribute.count = elements[i].count;
+		attribute.normalized = elements[i].normalized;
+		attribute.byteOffset = elements[i].offset;
+		memcpy(attribute.dequantizeScale, vertices.attributes[i].scale, sizeof(attribute.dequantizeScale));
+		memcpy(attribute.dequantizeOffset, vertices.attributes[i].offset, sizeof(attribute.dequantizeOffset));
+	}
+
+	MeshFileHeader header = {};
+	memcpy(header.magic, "GAAM", 4);
+	header.version = MeshFileHeader::s_CurrentVersion;
+	header.vertexCount = (uint32_t)vertices.vertexCount;
+	header.vertexStride = vertices.layout.GetStride();
+	header.attributeCount = (uint32_t)attributes.size();
+	header.indexCount = (uint32_t)indices.size();
+	header.lodCount = (uint32_t)lods.size();
+	header.meshletCount = (uint32_t)meshlets.size();
+	header.attributesOffset = AlignSection(sizeof(MeshFileHeader));
+	header.verticesOffset = AlignSection(header.attributesOffset + attributes.size() * sizeof(MeshFileAttribute));
+	header.indicesOffset = AlignSection(header.verticesOffset + vertices.data.size());
+	header.lodsOffset = AlignSection(header.indicesOffset + indices.size() * sizeof(unsigned int));
+	header.meshletsOffset = AlignSection(header.lodsOffset + lods.size() * sizeof(MeshLOD));
+	memcpy(header.boundsMinimum, boundsMinimum, sizeof(header.boundsMinimum));
+	memcpy(header.boundsMaximum, boundsMaximum, sizeof(header.boundsMaximum));
+
+	std::ofstream stream(filePath, std::ios::binary);
+	if (!stream)
+	{
+		std::cout << "Warning: Failed to open " << filePath << " for writing! \n";
+		return false;
+	}
+
+	auto writeSection = [&stream](uint64_t offset, const void* data, size_t size)
+	{
+		static const char padding[16] = {};
+		stream.write(padding, (std::streamsize)(offset - (uint64_t)stream.tellp()));
+		stream.write(static_cast<const char*>(data), (std::streamsize)size);
+	};
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeSection(header.attributesOffset, attributes.data(), attributes.size() * sizeof(MeshFileAttribute));
+	writeSection(header.verticesOffset, vertices.data.data(), vertices.data.size());
+	writeSection(header.indicesOffset, indices.data(), indices.size() * sizeof(unsigned int));
+	writeSection(header.lodsOffset, lods.data(), lods.size() * sizeof(MeshLOD));
+	writeSection(header.meshletsOffset, meshlets.data(), meshlets.size() * sizeof(Meshlet));
+	return (bool)stream;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexQuantizer.h"
+#include <cstdint>
+
+//The cooked mesh format (.gaam). Everything is laid out exactly as the GPU and renderer want it, so loading is a memory map, a few bounds checks and
+//a straight upload. There is no parsing. Sections follow the header in the order below, each aligned to 16 bytes:
+//  MeshFileAttribute[attributeCount]  The vertex layout, with the dequantization for each attribute.
+//  vertex data                        vertexCount * vertexStride bytes of quantized, interleaved vertices.
+//  unsigned int[indexCount]           Every LOD's triangles, one after another.
+//  MeshLOD[lodCount]                  Ranges into the indices, finest first.
+//  Meshlet[meshletCount]              Clusters of LOD 0, for culling.
+//All values are little endian, which covers every platform we build for.
+
+struct MeshFileHeader
+{
+	char magic[4]; //"GAAM"
+	uint32_t version;
+	uint32_t vertexCount;
+	uint32_t vertexStride;
+	uint32_t attributeCount;
+	uint32_t indexCount;
+	uint32_t lodCount;
+	uint32_t meshletCount;
+	uint64_t attributesOffset;
+	uint64_t verticesOffset;
+	uint64_t indicesOffset;
+	uint64_t lodsOffset;
+	uint64_t meshletsOffset;
+	float boundsMinimum[3];
+	float boundsMaximum[3];
+
+	static constexpr uint32_t s_CurrentVersion = 1;
+};
+
+struct MeshFileAttribute
+{
+	uint32_t type; //The GL type, as in VertexBufferElement.
+	uint32_t count;
+	uint32_t normalized;
+	uint32_t byteOffset;
+	float dequantizeScale[4]; //Decoded value = fetched value * scale + offset. Only differs from 1 and 0 for remapped attributes, which the shader has to apply.
+	float dequantizeOffset[4];
+};
+
+static_assert(sizeof(MeshLOD) == 12 && sizeof(Meshlet) == 40, "MeshLOD and Meshlet are written to disk as they are, so changing them needs a new file version.");
+
+//A cooked mesh mapped into memory. The pointers stay valid for as long as the MeshFile is open.
+class MeshFile
+{
+public:
+	bool Open(const std::string& filePath); //Validates the header, that every section lies within the file, and that every range in them lies within its data.
+	void Close() { m_File.Close(); m_Header = nullptr; }
+
+	inline bool IsOpen() const { return m_Header != nullptr; }
+	inline const MeshFileHeader& GetHeader() const { return *m_Header; }
+	inline const MeshFileAttribute* GetAttributes() const { return reinterpret_cast<const MeshFileAttribute*>(m_File.GetData() + m_Header->attributesOffset); }
+	inline const void* GetVertexData() const { return m_File.GetData() + m_Header->verticesOffset; }
+	inline size_t GetVertexDataSize() const { return (size_t)m_Header->vertexCount * m_Header->vertexStride; }
+	inline const unsigned int* GetIndices() const { return reinterpret_cast<const unsigned int*>(m_File.GetData() + m_Header->indicesOffset); }
+	inline const MeshLOD* GetLODs() const { return reinterpret_cast<const MeshLOD*>(m_File.GetData() + m_Header->lodsOffset); }
+	inline const Meshlet* GetMeshlets() const { return reinterpret_cast<const Meshlet*>(m_File.GetData() + m_Header->meshletsOffset); }
+	VertexBufferLayout CreateLayout() const;
+
+	//Writes a mesh out in this format. The indices hold every LOD, as ranged by lods.
+	static bool Write(const std::string& filePath, const QuantizedVertices& vertices, const std::vector<unsigned int>& indices, const std::vector<MeshLOD>& lods,
+		const std::vector<Meshlet>& meshlets, const float boundsMinimum[3], const float boundsMaximum[3]);
+
+private:
+	bool ValidateContents() const;
+
+	MappedFile m_File;
+	const MeshFileHeader* m_Header = nullptr;
+};
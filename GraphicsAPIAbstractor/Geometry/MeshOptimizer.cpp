@@ -0,0 +1,594 @@
+#include "GAAPrecompiledHeader.h"
+#include "MeshOptimizer.h"
+#include "../Core/GAAAssert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	//Which triangles use each vertex, stored flat. The live triangles of vertex v are triangles[offsets[v], offsets[v] + liveCounts[v]).
+	struct TriangleAdjacency
+	{
+		std::vector<unsigned int> offsets;
+		std::vector<unsigned int> liveCounts;
+		std::vector<unsigned int> triangles;
+
+		TriangleAdjacency(const unsigned int* indices, size_t indexCount, size_t vertexCount) : offsets(vertexCount + 1, 0), liveCounts(vertexCount, 0), triangles(indexCount)
+		{
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				liveCounts[indices[i]]++;
+			}
+			for (size_t v = 0; v < vertexCount; v++)
+			{
+				offsets[v + 1] = offsets[v] + liveCounts[v];
+			}
+
+			std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				triangles[cursor[indices[i]]++] = (unsigned int)(i / 3);
+			}
+		}
+
+		void RemoveTriangle(unsigned int vertex, unsigned int triangle)
+		{
+			unsigned int* live = &triangles[offsets[vertex]];
+			for (unsigned int i = 0; i < liveCounts[vertex]; i++)
+			{
+				if (live[i] == triangle)
+				{
+					std::swap(live[i], live[liveCounts[vertex] - 1]);
+					liveCounts[vertex]--;
+					return;
+				}
+			}
+		}
+	};
+
+	//FIFO cache simulation with timestamps. A vertex is in the cache if fewer than cacheSize misses have happened since it was last loaded.
+	struct FIFOCache
+	{
+		std::vector<unsigned int> timestamps;
+		unsigned int timestamp;
+		unsigned int cacheSize;
+
+		FIFOCache(size_t vertexCount, unsigned int size) : timestamps(vertexCount, 0), timestamp(size + 1), cacheSize(size) {}
+
+		bool Access(unsigned int vertex) //Returns true on a miss.
+		{
+			if (timestamp - timestamps[vertex] > cacheSize)
+			{
+				timestamps[vertex] = timestamp++;
+				return true;
+			}
+			return false;
+		}
+
+		void Flush() { timestamp += cacheSize + 1; }
+	};
+
+	float ForsythVertexScore(int cachePosition, unsigned int remainingTriangles, unsigned int cacheSize)
+	{
+		if (remainingTriangles == 0)
+		{
+			return -1.0f; //Nothing left to draw with it.
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				score = 0.75f; //Used by the last triangle. A fixed score, so we don't favour any particular winding through it.
+			}
+			else
+			{
+				score = std::pow(1.0f - (cachePosition - 3) / (float)(cacheSize - 3), 1.5f);
+			}
+		}
+		//Boost vertices with few triangles left, so we finish them off rather than leave lone triangles behind to be picked up later at a full miss.
+		return score + 2.0f / std::sqrt((float)remainingTriangles);
+	}
+}
+
+void MeshOptimizer::OptimizeVertexCacheForsyth(unsigned int* destination, const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+{
+	size_t triangleCount = indexCount / 3;
+	ASSERT((destination != indices));
+	ASSERT((cacheSize > 3));
+
+	TriangleAdjacency adjacency(indices, indexCount, vertexCount);
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScores[v] = ForsythVertexScore(-1, adjacency.liveCounts[v], cacheSize);
+	}
+
+	unsigned int bestTriangle = ~0u;
+	float bestScore = -1.0f;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+		if (triangleScores[t] > bestScore)
+		{
+			bestScore = triangleScores[t];
+			bestTriangle = (unsigned int)t;
+		}
+	}
+
+	//The cache holds 3 more than its size, so the vertices pushed out by the last triangle still get their scores lowered.
+	std::vector<unsigned int> cache, nextCache;
+	cache.reserve(cacheSize + 3);
+	nextCache.reserve(cacheSize + 3);
+	size_t inputCursor = 0;
+
+	for (size_t outputTriangle = 0; outputTriangle < triangleCount; outputTriangle++)
+	{
+		if (bestTriangle == ~0u) //Nothing in the cache has triangles left, so start again from the next triangle we haven't drawn.
+		{
+			while (emitted[inputCursor])
+			{
+				inputCursor++;
+			}
+			bestTriangle = (unsigned int)inputCursor;
+		}
+
+		const unsigned int* triangle = &indices[bestTriangle * 3];
+		memcpy(destination + outputTriangle * 3, triangle, 3 * sizeof(unsigned int));
+		emitted[bestTriangle] = true;
+
+		//The new triangle's vertices go to the front of the cache, in an LRU fashion.
+		nextCache.assign(triangle, triangle + 3);
+		for (unsigned int vertex : cache)
+		{
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+			{
+				nextCache.push_back(vertex);
+			}
+		}
+		for (int i = 0; i < 3; i++)
+		{
+			adjacency.RemoveTriangle(triangle[i], bestTriangle);
+		}
+
+		//Rescore everything that was or is in the cache, and pick the best triangle among theirs for next time.
+		bestTriangle = ~0u;
+		bestScore = -1.0f;
+		for (size_t i = 0; i < nextCache.size(); i++)
+		{
+			unsigned int vertex = nextCache[i];
+			cachePositions[vertex] = i < cacheSize ? (int)i : -1;
+			vertexScores[vertex] = ForsythVertexScore(cachePositions[vertex], adjacency.liveCounts[vertex], cacheSize);
+		}
+		for (size_t i = 0; i < nextCache.size(); i++)
+		{
+			unsigned int vertex = nextCache[i];
+			for (unsigned int j = 0; j < adjacency.liveCounts[vertex]; j++)
+			{
+				unsigned int t = adjacency.triangles[adjacency.offsets[vertex] + j];
+				triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+				if (triangleScores[t] > bestScore)
+				{
+					bestScore = triangleScores[t];
+					bestTriangle = t;
+				}
+			}
+		}
+
+		if (nextCache.size() > cacheSize)
+		{
+			nextCache.resize(cacheSize);
+		}
+		std::swap(cache, nextCache);
+	}
+}
+
+void MeshOptimizer::OptimizeVertexCacheTipsify(unsigned int* destination, const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize, std::vector<unsigned int>* clusters)
+{
+	size_t triangleCount = indexCount / 3;
+	ASSERT((destination != indices));
+
+	TriangleAdjacency adjacency(indices, indexCount, vertexCount);
+	std::vector<unsigned int>& liveCounts = adjacency.liveCounts; //Counted down as triangles are emitted. The triangle lists themselves stay put, we skip emitted triangles instead.
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEndStack;
+	std::vector<unsigned int> candidates;
+	deadEndStack.reserve(indexCount);
+
+	unsigned int timestamp = cacheSize + 1;
+	size_t inputCursor = 0;
+	size_t outputIndex = 0;
+	if (clusters)
+	{
+		clusters->clear();
+		clusters->push_back(0);
+	}
+
+	//Find a vertex to start fanning from. Vertex 0 may not be referenced at all, in which case we skip ahead like any other dead end.
+	auto skipDeadEnd = [&]() -> int
+	{
+		while (!deadEndStack.empty()) //Recently used vertices first, as they may still be in the cache.
+		{
+			unsigned int vertex = deadEndStack.back();
+			deadEndStack.pop_back();
+			if (liveCounts[vertex] > 0)
+			{
+				return (int)vertex;
+			}
+		}
+		while (inputCursor < vertexCount)
+		{
+			if (liveCounts[inputCursor] > 0)
+			{
+				return (int)inputCursor;
+			}
+			inputCursor++;
+		}
+		return -1;
+	};
+
+	int fanningVertex = skipDeadEnd();
+	while (fanningVertex >= 0)
+	{
+		//Emit every remaining triangle around the fanning vertex.
+		candidates.clear();
+		unsigned int begin = adjacency.offsets[fanningVertex], end = adjacency.offsets[fanningVertex + 1];
+		for (unsigned int i = begin; i < end; i++)
+		{
+			unsigned int t = adjacency.triangles[i];
+			if (emitted[t])
+			{
+				continue;
+			}
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				unsigned int vertex = indices[t * 3 + corner];
+				destination[outputIndex++] = vertex;
+				deadEndStack.push_back(vertex);
+				candidates.push_back(vertex);
+				liveCounts[vertex]--;
+				if (timestamp - timestamps[vertex] > cacheSize)
+				{
+					timestamps[vertex] = timestamp++;
+				}
+			}
+			emitted[t] = true;
+		}
+
+		//Next, the candidate that will still be in the cache after its own remaining triangles are drawn, preferring the oldest so we use it before it is evicted.
+		int nextVertex = -1;
+		int bestPriority = -1;
+		for (unsigned int vertex : candidates)
+		{
+			if (liveCounts[vertex] == 0)
+			{
+				continue;
+			}
+			int priority = 0;
+			if (timestamp - timestamps[vertex] + 2 * liveCounts[vertex] <= cacheSize)
+			{
+				priority = (int)(timestamp - timestamps[vertex]);
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				nextVertex = (int)vertex;
+			}
+		}
+
+		if (nextVertex == -1)
+		{
+			nextVertex = skipDeadEnd();
+			if (clusters && nextVertex >= 0 && outputIndex < indexCount)
+			{
+				clusters->push_back((unsigned int)outputIndex); //A dead end is where the cache effectively starts over, so reordering around it costs nothing.
+			}
+		}
+		fanningVertex = nextVertex;
+	}
+	ASSERT((outputIndex == triangleCount * 3));
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride,
+	const std::vector<unsigned int>& clusters, unsigned int cacheSize, float threshold)
+{
+	ASSERT((destination != indices));
+	if (indexCount == 0)
+	{
+		return;
+	}
+
+	//Split the hard clusters further at every point where the miss ratio so far is within the threshold of the cluster as a whole. Each of these soft clusters
+	//starts with a cold cache, which is what lets us draw them in any order and know the vertex shading cost stays within the threshold.
+	std::vector<unsigned int> softClusters;
+	FIFOCache cache(vertexCount, cacheSize);
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		size_t begin = clusters[c], end = c + 1 < clusters.size() ? clusters[c + 1] : indexCount;
+		if (begin >= end)
+		{
+			continue;
+		}
+
+		cache.Flush();
+		unsigned int clusterMisses = 0;
+		for (size_t i = begin; i < end; i++)
+		{
+			clusterMisses += cache.Access(indices[i]);
+		}
+		float clusterThreshold = threshold * clusterMisses / (float)((end - begin) / 3);
+
+		cache.Flush();
+		softClusters.push_back((unsigned int)begin);
+		unsigned int misses = 0, triangles = 0;
+		for (size_t i = begin; i < end; i += 3)
+		{
+			misses += cache.Access(indices[i]) + cache.Access(indices[i + 1]) + cache.Access(indices[i + 2]);
+			triangles++;
+			if (i + 3 < end && misses / (float)triangles <= clusterThreshold)
+			{
+				softClusters.push_back((unsigned int)(i + 3));
+				cache.Flush();
+				misses = 0;
+				triangles = 0;
+			}
+		}
+	}
+
+	//Clusters far from the mesh center that face away from it are on the outside of the mesh, and should be drawn first so they occlude the ones inside.
+	struct ClusterSortKey
+	{
+		unsigned int cluster;
+		float key;
+	};
+	std::vector<ClusterSortKey> sortKeys(softClusters.size());
+	std::vector<float> clusterCentroids(softClusters.size() * 3), clusterNormals(softClusters.size() * 3);
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < softClusters.size(); c++)
+	{
+		size_t begin = softClusters[c], end = c + 1 < softClusters.size() ? softClusters[c + 1] : indexCount;
+		float centroid[3] = { 0.0f, 0.0f, 0.0f }, normal[3] = { 0.0f, 0.0f, 0.0f };
+		float area = 0.0f;
+		for (size_t i = begin; i < end; i += 3)
+		{
+			const float* a = positions + indices[i] * positionStride;
+			const float* b = positions + indices[i + 1] * positionStride;
+			const float* d = positions + indices[i + 2] * positionStride;
+			float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			float ad[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+			float cross[3] = { ab[1] * ad[2] - ab[2] * ad[1], ab[2] * ad[0] - ab[0] * ad[2], ab[0] * ad[1] - ab[1] * ad[0] };
+			float triangleArea = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				centroid[axis] += (a[axis] + b[axis] + d[axis]) / 3.0f * triangleArea;
+				normal[axis] += cross[axis]; //Already weighted by area, as the cross product's length is twice it.
+			}
+			area += triangleArea;
+		}
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			meshCentroid[axis] += centroid[axis];
+			clusterCentroids[c * 3 + axis] = area > 0.0f ? centroid[axis] / area : 0.0f;
+		}
+		meshArea += area;
+
+		float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			clusterNormals[c * 3 + axis] = normalLength > 0.0f ? normal[axis] / normalLength : 0.0f;
+		}
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		meshCentroid[axis] = meshArea > 0.0f ? meshCentroid[axis] / meshArea : 0.0f;
+	}
+
+	for (size_t c = 0; c < softClusters.size(); c++)
+	{
+		float key = 0.0f;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			key += (clusterCentroids[c * 3 + axis] - meshCentroid[axis]) * clusterNormals[c * 3 + axis];
+		}
+		sortKeys[c] = { (unsigned int)c, key };
+	}
+	std::stable_sort(sortKeys.begin(), sortKeys.end(), [](const ClusterSortKey& a, const ClusterSortKey& b) { return a.key > b.key; });
+
+	size_t outputIndex = 0;
+	for (const ClusterSortKey& sortKey : sortKeys)
+	{
+		size_t begin = softClusters[sortKey.cluster], end = sortKey.cluster + 1 < softClusters.size() ? softClusters[sortKey.cluster + 1] : indexCount;
+		memcpy(destination + outputIndex, indices + begin, (end - begin) * sizeof(unsigned int));
+		outputIndex += end - begin;
+	}
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(void* destinationVertices, unsigned int* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t vertexSize)
+{
+	ASSERT((destinationVertices != vertices));
+	std::vector<unsigned int> remap(vertexCount, ~0u);
+	unsigned int nextVertex = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		unsigned int& newIndex = remap[indices[i]];
+		if (newIndex == ~0u)
+		{
+			newIndex = nextVertex++;
+			memcpy((unsigned char*)destinationVertices + newIndex * vertexSize, (const unsigned char*)vertices + indices[i] * vertexSize, vertexSize);
+		}
+		indices[i] = newIndex;
+	}
+	return nextVertex;
+}
+
+std::vector<Meshlet> MeshOptimizer::BuildMeshlets(const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride,
+	unsigned int maxVertices, unsigned int maxTriangles)
+{
+	std::vector<Meshlet> meshlets;
+	std::vector<unsigned int> meshletStamps(vertexCount, ~0u); //Which meshlet last claimed each vertex, so counting unique vertices needs no clearing.
+	std::vector<unsigned int> meshletVertices;
+	meshletVertices.reserve(maxVertices);
+
+	auto finishMeshlet = [&](size_t firstIndex, size_t endIndex)
+	{
+		Meshlet meshlet = {};
+		meshlet.firstIndex = (unsigned int)firstIndex;
+		meshlet.triangleCount = (unsigned int)((endIndex - firstIndex) / 3);
+
+		float minimum[3] = { INFINITY, INFINITY, INFINITY }, maximum[3] = { -INFINITY, -INFINITY, -INFINITY };
+		for (unsigned int vertex : meshletVertices)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				minimum[axis] = std::min(minimum[axis], positions[vertex * positionStride + axis]);
+				maximum[axis] = std::max(maximum[axis], positions[vertex * positionStride + axis]);
+			}
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			meshlet.center[axis] = (minimum[axis] + maximum[axis]) * 0.5f;
+		}
+		for (unsigned int vertex : meshletVertices)
+		{
+			const float* p = positions + vertex * positionStride;
+			float dx = p[0] - meshlet.center[0], dy = p[1] - meshlet.center[1], dz = p[2] - meshlet.center[2];
+			meshlet.radius = std::max(meshlet.radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+		}
+
+		//The cone axis is the average triangle normal, and its angle is set by the normal furthest from it.
+		std::vector<float> normals;
+		normals.reserve(meshlet.triangleCount * 3);
+		float axis[3] = { 0.0f, 0.0f, 0.0f };
+		for (size_t i = firstIndex; i < endIndex; i += 3)
+		{
+			const float* a = positions + indices[i] * positionStride;
+			const float* b = positions + indices[i + 1] * positionStride;
+			const float* c = positions + indices[i + 2] * positionStride;
+			float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			float normal[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length == 0.0f)
+			{
+				continue;
+			}
+			for (int k = 0; k < 3; k++)
+			{
+				normals.push_back(normal[k] / length);
+				axis[k] += normal[k] / length;
+			}
+		}
+
+		float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		float minimumDot = 1.0f;
+		for (size_t n = 0; n < normals.size() && axisLength > 0.0f; n += 3)
+		{
+			minimumDot = std::min(minimumDot, (normals[n] * axis[0] + normals[n + 1] * axis[1] + normals[n + 2] * axis[2]) / axisLength);
+		}
+
+		meshlet.coneCutoff = 1.0f;
+		if (axisLength > 0.0f && minimumDot > 0.0f) //A cone wider than a hemisphere always has some triangle facing the camera.
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				meshlet.coneAxis[k] = axis[k] / axisLength;
+			}
+			meshlet.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+		}
+		meshlets.push_back(meshlet);
+		meshletVertices.clear();
+	};
+
+	size_t firstIndex = 0;
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		unsigned int meshletIndex = (unsigned int)meshlets.size();
+		unsigned int newVertices = 0;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			newVertices += meshletStamps[indices[i + corner]] != meshletIndex;
+		}
+		if (meshletVertices.size() + newVertices > maxVertices || (i - firstIndex) / 3 >= maxTriangles)
+		{
+			finishMeshlet(firstIndex, i);
+			firstIndex = i;
+			meshletIndex++;
+		}
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			unsigned int vertex = indices[i + corner];
+			if (meshletStamps[vertex] != meshletIndex)
+			{
+				meshletStamps[vertex] = meshletIndex;
+				meshletVertices.push_back(vertex);
+			}
+		}
+	}
+	if (firstIndex < indexCount)
+	{
+		finishMeshlet(firstIndex, indexCount);
+	}
+	return meshlets;
+}
+
+VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+{
+	VertexCacheStatistics statistics;
+	FIFOCache cache(vertexCount, cacheSize);
+	std::vector<bool> referenced(vertexCount, false);
+	size_t uniqueVertices = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		statistics.vertexTransforms += cache.Access(indices[i]);
+		if (!referenced[indices[i]])
+		{
+			referenced[indices[i]] = true;
+			uniqueVertices++;
+		}
+	}
+
+	statistics.acmr = indexCount > 0 ? statistics.vertexTransforms / (float)(indexCount / 3) : 0.0f;
+	statistics.atvr = uniqueVertices > 0 ? statistics.vertexTransforms / (float)uniqueVertices : 0.0f;
+	return statistics;
+}
+
+VertexFetchStatistics MeshOptimizer::AnalyzeVertexFetch(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t vertexSize, unsigned int cacheLineSize, unsigned int cacheLineCount)
+{
+	//Same FIFO trick as the vertex cache, but over the cache lines each vertex spans.
+	VertexFetchStatistics statistics;
+	size_t lineCount = (vertexCount * vertexSize + cacheLineSize - 1) / cacheLineSize;
+	FIFOCache cache(lineCount, cacheLineCount);
+	std::vector<bool> referenced(vertexCount, false);
+	size_t uniqueVertices = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		unsigned int vertex = indices[i];
+		size_t firstLine = vertex * vertexSize / cacheLineSize, lastLine = ((size_t)vertex * vertexSize + vertexSize - 1) / cacheLineSize;
+		for (size_t line = firstLine; line <= lastLine; line++)
+		{
+			statistics.bytesFetched += cache.Access((unsigned int)line) ? cacheLineSize : 0;
+		}
+		if (!referenced[vertex])
+		{
+			referenced[vertex] = true;
+			uniqueVertices++;
+		}
+	}
+
+	statistics.overfetch = uniqueVertices > 0 ? statistics.bytesFetched / (float)(uniqueVertices * vertexSize) : 0.0f;
+	return statistics;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include <cstdint>
+
+//Reorders a mesh so the GPU does less work drawing it, without changing what ends up on screen. Meant to run once at import or cook time, not per frame.
+//The usual order is OptimizeVertexCacheTipsify (which also produces clusters), then OptimizeOverdraw with those clusters, then OptimizeVertexFetch last,
+//as it renumbers vertices in the order the final index buffer uses them. Every pass works on triangle lists with 32 bit indices.
+
+struct VertexCacheStatistics
+{
+	unsigned int vertexTransforms = 0; //How many times the vertex shader would run.
+	float acmr = 0.0f; //Average cache miss ratio: transforms per triangle. 3 is no reuse at all, around 0.5 to 0.7 is excellent for a regular mesh.
+	float atvr = 0.0f; //Average transform to vertex ratio: transforms per referenced vertex. 1 is ideal, as every vertex is then shaded exactly once.
+};
+
+struct VertexFetchStatistics
+{
+	size_t bytesFetched = 0; //Simulated memory traffic, counted in whole cache lines.
+	float overfetch = 0.0f; //bytesFetched over the size of the vertices actually used. 1 is ideal.
+};
+
+//A small cluster of triangles that are consecutive in the index buffer, with the bounds needed to cull them as a group.
+struct Meshlet
+{
+	unsigned int firstIndex;
+	unsigned int triangleCount;
+	float center[3]; //Bounding sphere.
+	float radius;
+	float coneAxis[3]; //Every triangle's normal lies within this cone, so the meshlet is entirely backfacing when
+	float coneCutoff; //dot(center - cameraPosition, coneAxis) >= coneCutoff * length(center - cameraPosition) + radius. A cutoff of 1 never culls.
+};
+
+class MeshOptimizer
+{
+public:
+	//Tom Forsyth's linear speed vertex cache optimization. Greedily picks the next triangle by a score favouring vertices recently used and vertices with few triangles left.
+	//Tuned for an LRU cache, so it works well across hardware whose real cache size we don't know.
+	static void OptimizeVertexCacheForsyth(unsigned int* destination, const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 32);
+
+	//Tipsify (Sander, Nehab and Barczak). Faster than Forsyth and targets a FIFO cache of the given size directly. If clusters is given, it receives the index offset
+	//of every point where the cache was flushed, which OptimizeOverdraw uses as boundaries it can reorder around without hurting the cache.
+	static void OptimizeVertexCacheTipsify(unsigned int* destination, const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 16, std::vector<unsigned int>* clusters = nullptr);
+
+	//Sorts clusters so that the ones facing outwards from the mesh center are drawn first, as they tend to occlude the rest. Clusters are split further wherever the
+	//cache miss ratio stays within threshold times the original, so 1.05 trades up to 5% more vertex shading for less overdraw. positionStride is in floats.
+	static void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride,
+		const std::vector<unsigned int>& clusters, unsigned int cacheSize = 16, float threshold = 1.05f);
+
+	//Rewrites the vertex buffer in the order the indices first reference each vertex, so fetches walk memory linearly. Unreferenced vertices are dropped.
+	//Indices are remapped in place. Returns the new vertex count.
+	static size_t OptimizeVertexFetch(void* destinationVertices, unsigned int* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t vertexSize);
+
+	//Splits the triangles into meshlets in their current order, which after the passes above is spatially coherent. Each meshlet stays within both limits,
+	//the defaults being a good fit for both compute culling and mesh shaders.
+	static std::vector<Meshlet> BuildMeshlets(const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride,
+		unsigned int maxVertices = 64, unsigned int maxTriangles = 124);
+
+	//Post-transform cache simulation, so the passes above can be measured without a GPU. Models a FIFO of the given size, which is how most hardware behaves.
+	static VertexCacheStatistics AnalyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 16);
+	static VertexFetchStatistics AnalyzeVertexFetch(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t vertexSize, unsigned int cacheLineSize = 64, unsigned int cacheLineCount = 64);
+};
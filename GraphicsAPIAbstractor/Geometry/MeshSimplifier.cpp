@@ -0,0 +1,417 @@
+#include "GAAPrecompiledHeader.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include <cstdint>
+#include <cstring>
+#include <unordered_set>
+
+namespace
+{
+	//A symmetric 4x4 matrix summing the squared distance to a set of planes, plus the total weight so we can report an average rather than a sum.
+	struct Quadric
+	{
+		double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+		double weight = 0;
+
+		void AddPlane(double a, double b, double c, double d, double planeWeight)
+		{
+			a2 += a * a * planeWeight; ab += a * b * planeWeight; ac += a * c * planeWeight; ad += a * d * planeWeight;
+			b2 += b * b * planeWeight; bc += b * c * planeWeight; bd += b * d * planeWeight;
+			c2 += c * c * planeWeight; cd += c * d * planeWeight;
+			d2 += d * d * planeWeight;
+			weight += planeWeight;
+		}
+
+		void Add(const Quadric& other)
+		{
+			a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad; b2 += other.b2; bc += other.bc; bd += other.bd; c2 += other.c2; cd += other.cd; d2 += other.d2;
+			weight += other.weight;
+		}
+
+		double Evaluate(const float* position) const //Squared distance, summed over every plane and weighted.
+		{
+			double x = position[0], y = position[1], z = position[2];
+			double result = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x + b2 * y * y + 2 * bc * y * z + 2 * bd * y + c2 * z * z + 2 * cd * z + d2;
+			return std::max(result, 0.0); //Rounding can push a perfect fit slightly negative.
+		}
+	};
+
+	enum class VertexKind : unsigned char
+	{
+		Manifold, //Free to collapse in any direction.
+		Border, //On an open edge, so may only slide along it.
+		Locked //Seams, complex borders, non-manifold geometry, and every border when lockBorder is set.
+	};
+
+	void Cross(const float* a, const float* b, const float* c, float* normal) //Of (b - a) and (c - a).
+	{
+		float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+		normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+		normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+	}
+
+	uint64_t EdgeKey(unsigned int a, unsigned int b) { return ((uint64_t)a << 32) | b; }
+	uint64_t UndirectedEdgeKey(unsigned int a, unsigned int b) { return a < b ? EdgeKey(a, b) : EdgeKey(b, a); }
+
+	struct Collapse
+	{
+		unsigned int from;
+		unsigned int to;
+		double cost;
+	};
+}
+
+float MeshSimplifier::CalculateMeshExtent(const float* vertices, size_t vertexCount, size_t vertexStride)
+{
+	if (vertexCount == 0)
+	{
+		return 0.0f;
+	}
+
+	float minimum[3] = { vertices[0], vertices[1], vertices[2] }, maximum[3] = { vertices[0], vertices[1], vertices[2] };
+	for (size_t v = 1; v < vertexCount; v++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			minimum[axis] = std::min(minimum[axis], vertices[v * vertexStride + axis]);
+			maximum[axis] = std::max(maximum[axis], vertices[v * vertexStride + axis]);
+		}
+	}
+	return std::max(std::max(maximum[0] - minimum[0], maximum[1] - minimum[1]), maximum[2] - minimum[2]);
+}
+
+size_t MeshSimplifier::Simplify(unsigned int* destination, const unsigned int* indices, size_t indexCount, const float* vertices, size_t vertexCount, size_t vertexStride,
+	size_t targetIndexCount, float targetError, bool lockBorder, unsigned int attributeOffset, unsigned int attributeCount, const float* attributeWeights, float* resultError)
+{
+	memcpy(destination, indices, indexCount * sizeof(unsigned int));
+	size_t currentIndexCount = indexCount;
+	if (resultError)
+	{
+		*resultError = 0.0f;
+	}
+
+	float extent = CalculateMeshExtent(vertices, vertexCount, vertexStride);
+	extent = extent > 0.0f ? extent : 1.0f;
+	double errorLimit = (double)targetError * extent;
+	double maxCost = 0.0;
+	auto position = [vertices, vertexStride](unsigned int vertex) { return vertices + vertex * vertexStride; };
+
+	//Vertices that share a position are the same point on the surface, split for differing attributes. Topology is worked out on these canonical indices,
+	//so that an attribute seam isn't mistaken for a hole in the mesh.
+	struct PositionHash
+	{
+		size_t operator()(const std::array<float, 3>& p) const
+		{
+			uint32_t bits[3];
+			memcpy(bits, p.data(), sizeof(bits));
+			return (size_t)bits[0] * 73856093u ^ (size_t)bits[1] * 19349663u ^ (size_t)bits[2] * 83492791u;
+		}
+	};
+	std::unordered_map<std::array<float, 3>, unsigned int, PositionHash> positionToVertex;
+	std::vector<unsigned int> canonical(vertexCount);
+	std::vector<unsigned int> wedgeCounts(vertexCount, 0);
+	for (unsigned int v = 0; v < vertexCount; v++)
+	{
+		const float* p = position(v);
+		canonical[v] = positionToVertex.emplace(std::array<float, 3>{ p[0], p[1], p[2] }, v).first->second;
+	}
+	std::vector<bool> referenced(vertexCount, false);
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		if (!referenced[indices[i]])
+		{
+			referenced[indices[i]] = true;
+			wedgeCounts[canonical[indices[i]]]++;
+		}
+	}
+
+	//An edge whose opposite half edge doesn't exist is on a border. One that appears twice in the same direction is non-manifold, and we leave it alone.
+	std::unordered_map<uint64_t, unsigned int> halfEdges;
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			halfEdges[EdgeKey(canonical[indices[i + corner]], canonical[indices[i + (corner + 1) % 3]])]++;
+		}
+	}
+
+	std::unordered_set<uint64_t> borderEdges;
+	std::vector<unsigned int> borderEdgeCounts(vertexCount, 0);
+	std::vector<bool> nonManifold(vertexCount, false);
+	for (const auto& halfEdge : halfEdges)
+	{
+		unsigned int a = (unsigned int)(halfEdge.first >> 32), b = (unsigned int)(halfEdge.first & 0xFFFFFFFF);
+		if (halfEdge.second > 1)
+		{
+			nonManifold[a] = nonManifold[b] = true;
+		}
+		if (halfEdges.find(EdgeKey(b, a)) == halfEdges.end())
+		{
+			borderEdges.insert(UndirectedEdgeKey(a, b));
+			borderEdgeCounts[a]++;
+			borderEdgeCounts[b]++;
+		}
+	}
+
+	std::vector<VertexKind> kinds(vertexCount, VertexKind::Manifold);
+	for (unsigned int v = 0; v < vertexCount; v++)
+	{
+		unsigned int c = canonical[v];
+		if (wedgeCounts[c] > 1 || nonManifold[c])
+		{
+			kinds[v] = VertexKind::Locked;
+		}
+		else if (borderEdgeCounts[c] > 0)
+		{
+			kinds[v] = lockBorder || borderEdgeCounts[c] != 2 ? VertexKind::Locked : VertexKind::Border; //Anything but a simple border has no single direction to slide in.
+		}
+	}
+
+	//Each vertex's quadric is the area weighted sum of the planes of the triangles around it. Border edges add a plane standing perpendicular to the surface
+	//along the edge, so sliding along the border is cheap but pulling it inwards isn't.
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		unsigned int corners[3] = { canonical[indices[i]], canonical[indices[i + 1]], canonical[indices[i + 2]] };
+		float normal[3];
+		Cross(position(corners[0]), position(corners[1]), position(corners[2]), normal);
+		float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length == 0.0f)
+		{
+			continue;
+		}
+
+		double a = normal[0] / length, b = normal[1] / length, c = normal[2] / length;
+		const float* p0 = position(corners[0]);
+		double d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+		for (int corner = 0; corner < 3; corner++)
+		{
+			quadrics[corners[corner]].AddPlane(a, b, c, d, length * 0.5);
+		}
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			unsigned int from = corners[corner], to = corners[(corner + 1) % 3];
+			if (borderEdges.find(UndirectedEdgeKey(from, to)) == borderEdges.end())
+			{
+				continue;
+			}
+
+			const float* p = position(from);
+			const float* q = position(to);
+			double edge[3] = { q[0] - p[0], q[1] - p[1], q[2] - p[2] };
+			double edgeLength = std::sqrt(edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]);
+			double perpendicular[3] = { edge[1] * c - edge[2] * b, edge[2] * a - edge[0] * c, edge[0] * b - edge[1] * a };
+			double perpendicularLength = std::sqrt(perpendicular[0] * perpendicular[0] + perpendicular[1] * perpendicular[1] + perpendicular[2] * perpendicular[2]);
+			if (perpendicularLength == 0.0)
+			{
+				continue;
+			}
+
+			double pa = perpendicular[0] / perpendicularLength, pb = perpendicular[1] / perpendicularLength, pc = perpendicular[2] / perpendicularLength;
+			double pd = -(pa * p[0] + pb * p[1] + pc * p[2]);
+			quadrics[from].AddPlane(pa, pb, pc, pd, edgeLength * edgeLength * 10.0);
+			quadrics[to].AddPlane(pa, pb, pc, pd, edgeLength * edgeLength * 10.0);
+		}
+	}
+
+	double attributeScale = (double)extent * extent;
+	auto collapseCost = [&](unsigned int from, unsigned int to)
+	{
+		Quadric combined = quadrics[canonical[from]];
+		combined.Add(quadrics[canonical[to]]);
+		double cost = combined.weight > 0.0 ? combined.Evaluate(position(to)) / combined.weight : 0.0;
+		for (unsigned int k = 0; k < attributeCount; k++)
+		{
+			double difference = vertices[from * vertexStride + attributeOffset + k] - vertices[to * vertexStride + attributeOffset + k];
+			cost += attributeWeights[k] * difference * difference * attributeScale;
+		}
+		return cost;
+	};
+
+	//We collapse in passes rather than through a priority queue. Each pass takes every valid edge collapse, cheapest first, and applies those that don't touch a
+	//vertex another collapse in the same pass already changed. That keeps the adjacency and flip checks valid without having to update anything mid pass.
+	std::vector<unsigned int> remap(vertexCount);
+	std::vector<bool> touched(vertexCount);
+	std::vector<Collapse> collapses;
+	std::vector<unsigned int> adjacencyOffsets(vertexCount + 1), adjacency;
+	while (currentIndexCount > targetIndexCount)
+	{
+		//Triangles around every vertex, for the flip check.
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (size_t i = 0; i < currentIndexCount; i++)
+		{
+			adjacencyOffsets[destination[i] + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		}
+		adjacency.resize(currentIndexCount);
+		std::vector<unsigned int> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < currentIndexCount; i++)
+		{
+			adjacency[cursor[destination[i]]++] = (unsigned int)(i / 3);
+		}
+
+		collapses.clear();
+		for (size_t i = 0; i < currentIndexCount; i += 3)
+		{
+			for (int corner = 0; corner < 3; corner++)
+			{
+				unsigned int a = destination[i + corner], b = destination[i + (corner + 1) % 3];
+				for (int direction = 0; direction < 2; direction++)
+				{
+					unsigned int from = direction == 0 ? a : b, to = direction == 0 ? b : a;
+					if (kinds[from] == VertexKind::Locked || canonical[from] == canonical[to])
+					{
+						continue;
+					}
+					if (kinds[from] == VertexKind::Border && borderEdges.find(UndirectedEdgeKey(canonical[from], canonical[to])) == borderEdges.end())
+					{
+						continue;
+					}
+					collapses.push_back({ from, to, collapseCost(from, to) });
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		for (unsigned int v = 0; v < vertexCount; v++)
+		{
+			remap[v] = v;
+		}
+		std::fill(touched.begin(), touched.end(), false);
+
+		size_t triangleCount = currentIndexCount / 3, targetTriangleCount = targetIndexCount / 3;
+		size_t removedTriangles = 0;
+		unsigned int collapseCount = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (collapse.cost > errorLimit * errorLimit || triangleCount - removedTriangles <= targetTriangleCount)
+			{
+				break;
+			}
+			if (touched[collapse.from] || touched[collapse.to])
+			{
+				continue;
+			}
+
+			//Moving from onto to must not flip any of the triangles that survive the collapse.
+			bool flips = false;
+			unsigned int trianglesRemoved = 0;
+			for (unsigned int j = adjacencyOffsets[collapse.from]; j < adjacencyOffsets[collapse.from + 1] && !flips; j++)
+			{
+				const unsigned int* triangle = &destination[adjacency[j] * 3];
+				if (canonical[triangle[0]] == canonical[collapse.to] || canonical[triangle[1]] == canonical[collapse.to] || canonical[triangle[2]] == canonical[collapse.to])
+				{
+					trianglesRemoved++;
+					continue;
+				}
+
+				const float* before[3] = { position(triangle[0]), position(triangle[1]), position(triangle[2]) };
+				const float* after[3] = { before[0], before[1], before[2] };
+				for (int corner = 0; corner < 3; corner++)
+				{
+					if (triangle[corner] == collapse.from)
+					{
+						after[corner] = position(collapse.to);
+					}
+				}
+
+				float normalBefore[3], normalAfter[3];
+				Cross(before[0], before[1], before[2], normalBefore);
+				Cross(after[0], after[1], after[2], normalAfter);
+				float dot = normalBefore[0] * normalAfter[0] + normalBefore[1] * normalAfter[1] + normalBefore[2] * normalAfter[2];
+				float lengths = std::sqrt((normalBefore[0] * normalBefore[0] + normalBefore[1] * normalBefore[1] + normalBefore[2] * normalBefore[2]) *
+										  (normalAfter[0] * normalAfter[0] + normalAfter[1] * normalAfter[1] + normalAfter[2] * normalAfter[2]));
+				flips = dot <= 0.25f * lengths; //More than about 75 degrees of rotation, or a triangle that became degenerate.
+			}
+			if (flips)
+			{
+				continue;
+			}
+
+			remap[collapse.from] = collapse.to;
+			quadrics[canonical[collapse.to]].Add(quadrics[canonical[collapse.from]]);
+			touched[collapse.from] = touched[collapse.to] = true;
+			for (unsigned int j = adjacencyOffsets[collapse.from]; j < adjacencyOffsets[collapse.from + 1]; j++)
+			{
+				const unsigned int* triangle = &destination[adjacency[j] * 3];
+				touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+			}
+
+			removedTriangles += trianglesRemoved;
+			maxCost = std::max(maxCost, collapse.cost);
+			collapseCount++;
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		//Apply the pass and drop the triangles that collapsed to a line.
+		size_t writeIndex = 0;
+		for (size_t i = 0; i < currentIndexCount; i += 3)
+		{
+			unsigned int a = remap[destination[i]], b = remap[destination[i + 1]], c = remap[destination[i + 2]];
+			if (canonical[a] == canonical[b] || canonical[b] == canonical[c] || canonical[a] == canonical[c])
+			{
+				continue;
+			}
+			destination[writeIndex++] = a;
+			destination[writeIndex++] = b;
+			destination[writeIndex++] = c;
+		}
+		currentIndexCount = writeIndex;
+	}
+
+	if (resultError)
+	{
+		*resultError = (float)(std::sqrt(maxCost) / extent);
+	}
+	return currentIndexCount;
+}
+
+std::vector<MeshLOD> MeshSimplifier::GenerateLODChain(std::vector<unsigned int>& lodIndices, const unsigned int* indices, size_t indexCount, const float* vertices, size_t vertexCount, size_t vertexStride,
+	unsigned int maxLODCount, float reductionPerLOD, float maxError, bool lockBorder, unsigned int attributeOffset, unsigned int attributeCount, const float* attributeWeights)
+{
+	std::vector<MeshLOD> lods;
+	lodIndices.clear();
+	float extent = CalculateMeshExtent(vertices, vertexCount, vertexStride);
+
+	std::vector<unsigned int> current(indices, indices + indexCount);
+	std::vector<unsigned int> simplified(indexCount);
+	float accumulatedError = 0.0f;
+	for (unsigned int lod = 0; lod < maxLODCount; lod++)
+	{
+		size_t lodIndexCount = current.size();
+		if (lod > 0)
+		{
+			//Simplifying from the previous LOD rather than the original is much faster, and keeps the chain nested. Errors add up, so we keep a running total.
+			size_t targetIndexCount = (size_t)(current.size() / 3 * reductionPerLOD) * 3;
+			float lodError = 0.0f;
+			lodIndexCount = Simplify(simplified.data(), current.data(), current.size(), vertices, vertexCount, vertexStride, targetIndexCount, maxError, lockBorder,
+				attributeOffset, attributeCount, attributeWeights, &lodError);
+			if (lodIndexCount == 0 || lodIndexCount > current.size() * 9 / 10)
+			{
+				break;
+			}
+			accumulatedError += lodError * extent;
+			current.assign(simplified.begin(), simplified.begin() + lodIndexCount);
+		}
+
+		MeshLOD meshLOD;
+		meshLOD.firstIndex = (unsigned int)lodIndices.size();
+		meshLOD.indexCount = (unsigned int)lodIndexCount;
+		meshLOD.error = accumulatedError;
+		lods.push_back(meshLOD);
+
+		lodIndices.resize(lodIndices.size() + lodIndexCount);
+		MeshOptimizer::OptimizeVertexCacheTipsify(lodIndices.data() + meshLOD.firstIndex, current.data(), lodIndexCount, vertexCount);
+	}
+	return lods;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include <algorithm>
+#include <cmath>
+
+//One level of detail within a shared index buffer. Every LOD indexes the same vertex buffer, so switching between them is just a different index range.
+struct MeshLOD
+{
+	unsigned int firstIndex = 0;
+	unsigned int indexCount = 0;
+	float error = 0.0f; //Largest deviation from the original surface, in object space units.
+};
+
+//Picks the coarsest LOD whose error, projected onto the screen at this distance, stays under maxPixelError. LODs are expected from finest to coarsest.
+//projectionScale is screenHeight / (2 * tan(fovY / 2)), the number of pixels one unit covers at a distance of one unit.
+inline unsigned int SelectMeshLOD(const MeshLOD* lods, unsigned int lodCount, float distance, float projectionScale, float maxPixelError = 1.0f)
+{
+	unsigned int selected = 0;
+	for (unsigned int i = 1; i < lodCount; i++)
+	{
+		float projectedError = lods[i].error / std::max(distance, 1e-4f) * projectionScale;
+		if (projectedError > maxPixelError)
+		{
+			break;
+		}
+		selected = i;
+	}
+	return selected;
+}
+
+inline float CalculateProjectionScale(float screenHeight, float fovYInRadians)
+{
+	return screenHeight / (2.0f * std::tan(fovYInRadians * 0.5f));
+}
+
+//Quadric error metric simplification by half edge collapse (Garland and Heckbert). Collapsing u into v moves u onto a vertex that already exists, so the
+//simplified mesh only ever references original vertices and every LOD can share one vertex buffer.
+//Vertices are interleaved floats with the position in the first 3. Attributes, if any, start at attributeOffset and add a penalty for collapsing across a change
+//in them, so UVs and normals aren't smeared. The penalty is weight * difference squared, scaled by the mesh's extent squared so it is comparable with the
+//geometric error: a weight of 0.0001 makes a full unit of change cost about as much as moving the surface by 1% of the mesh.
+//Vertices on an attribute seam (the same position split into several vertices) never move. Vertices on an open border only slide along it, or don't move at all if lockBorder is set, so meshes that tile with their neighbours stay watertight.
+class MeshSimplifier
+{
+public:
+	//Returns the number of indices written to destination, which must hold indexCount. targetError is relative to the mesh's extent, so 0.01 is 1% of its size.
+	//Stops at whichever of targetIndexCount or targetError is hit first. resultError, if given, receives the error actually reached, also relative.
+	static size_t Simplify(unsigned int* destination, const unsigned int* indices, size_t indexCount, const float* vertices, size_t vertexCount, size_t vertexStride,
+		size_t targetIndexCount, float targetError, bool lockBorder = false, unsigned int attributeOffset = 3, unsigned int attributeCount = 0, const float* attributeWeights = nullptr, float* resultError = nullptr);
+
+	//Builds LODs by repeatedly simplifying the previous one down by reductionPerLOD, and appends them all to lodIndices. LOD 0 is the original mesh.
+	//Generation stops early once a LOD can't get meaningfully smaller. Each LOD is reordered for the vertex cache on the way.
+	static std::vector<MeshLOD> GenerateLODChain(std::vector<unsigned int>& lodIndices, const unsigned int* indices, size_t indexCount, const float* vertices, size_t vertexCount, size_t vertexStride,
+		unsigned int maxLODCount = 4, float reductionPerLOD = 0.5f, float maxError = 0.05f, bool lockBorder = false, unsigned int attributeOffset = 3, unsigned int attributeCount = 0, const float* attributeWeights = nullptr);
+
+	static float CalculateMeshExtent(const float* vertices, size_t vertexCount, size_t vertexStride); //The largest side of the bounding box, which errors are relative to.
+};
@@ -0,0 +1,363 @@
+#include "GAAPrecompiledHeader.h"
+#include "VertexQuantizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+QuantizedVertices VertexQuantizer::Quantize(const float* vertices, size_t vertexCount, const QuantizationAttribute* attributes, unsigned int attributeCount)
+{
+	QuantizedVertices quantized;
+	quantized.vertexCount = vertexCount;
+
+	unsigned int sourceStride = 0;
+	for (unsigned int i = 0; i < attributeCount; i++)
+	{
+		sourceStride += attributes[i].componentCount;
+	}
+
+	unsigned int sourceOffset = 0;
+	for (unsigned int attributeIndex = 0; attributeIndex < attributeCount; attributeIndex++)
+	{
+		const QuantizationAttribute& source = attributes[attributeIndex];
+		unsigned int componentCount = source.componentCount;
+		ASSERT((componentCount >= 1 && componentCount <= 4));
+
+		//The range of every component decides which formats can hold it without a remap, and what the remap is if one is allowed.
+		float minimum[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, maximum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			const float* components = vertices + vertex * sourceStride + sourceOffset;
+			for (unsigned int c = 0; c < componentCount; c++)
+			{
+				minimum[c] = vertex == 0 ? components[c] : std::min(minimum[c], components[c]);
+				maximum[c] = vertex == 0 ? components[c] : std::max(maximum[c], components[c]);
+			}
+		}
+
+		bool withinSigned = true, withinUnsigned = true;
+		for (unsigned int c = 0; c < componentCount; c++)
+		{
+			withinSigned &= minimum[c] >= -1.0f && maximum[c] <= 1.0f;
+			withinUnsigned &= minimum[c] >= 0.0f && maximum[c] <= 1.0f;
+		}
+
+		//Smallest first. Packed formats only pay off with 3 or 4 components, below that the 16 bit formats are the same size or smaller and more precise.
+		struct Candidate
+		{
+			QuantizedFormat format;
+			bool remap;
+		};
+		std::vector<Candidate> candidates;
+		if (componentCount >= 3)
+		{
+			if (withinSigned)
+			{
+				candidates.push_back({ QuantizedFormat::Snorm10_10_10_2, false });
+			}
+			if (withinUnsigned || source.allowRemap)
+			{
+				candidates.push_back({ QuantizedFormat::Unorm10_10_10_2, !withinUnsigned });
+			}
+		}
+		candidates.push_back({ QuantizedFormat::Half, false }); //Preferred over the 16 bit integer formats as it never needs a remap.
+		if (withinSigned)
+		{
+			candidates.push_back({ QuantizedFormat::Snorm16, false });
+		}
+		if (withinUnsigned || source.allowRemap)
+		{
+			candidates.push_back({ QuantizedFormat::Unorm16, !withinUnsigned });
+		}
+		candidates.push_back({ QuantizedFormat::Float, false });
+
+		//Rather than reason about each format's worst case, we encode every vertex, decode it the way the GPU will, and keep the first format that stays within the bound.
+		QuantizedAttribute chosen;
+		for (const Candidate& candidate : candidates)
+		{
+			QuantizedAttribute attribute;
+			attribute.format = candidate.format;
+			if (candidate.remap)
+			{
+				for (unsigned int c = 0; c < componentCount; c++)
+				{
+					attribute.scale[c] = maximum[c] - minimum[c];
+					attribute.offset[c] = minimum[c];
+				}
+			}
+
+			unsigned char encoded[16];
+			float decoded[4];
+			for (size_t vertex = 0; vertex < vertexCount; vertex++)
+			{
+				const float* components = vertices + vertex * sourceStride + sourceOffset;
+				Encode(attribute.format, attribute, components, componentCount, encoded);
+				Decode(attribute.format, attribute, encoded, componentCount, decoded);
+				for (unsigned int c = 0; c < componentCount; c++)
+				{
+					float error = std::fabs(decoded[c] - components[c]);
+					attribute.measuredError = std::isnan(error) ? INFINITY : std::max(attribute.measuredError, error);
+				}
+			}
+
+			chosen = attribute;
+			if (attribute.measuredError <= source.maxError)
+			{
+				break;
+			}
+		}
+
+		PushFormat(quantized.layout, chosen.format, componentCount);
+		quantized.attributes.push_back(chosen);
+		sourceOffset += componentCount;
+	}
+
+	//Now that the layout is final, write every vertex out at its offsets.
+	unsigned int stride = quantized.layout.GetStride();
+	const auto& elements = quantized.layout.GetElements();
+	quantized.data.assign(vertexCount * stride, 0);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		const float* components = vertices + vertex * sourceStride;
+		for (unsigned int attributeIndex = 0; attributeIndex < attributeCount; attributeIndex++)
+		{
+			const QuantizedAttribute& attribute = quantized.attributes[attributeIndex];
+			Encode(attribute.format, attribute, components, attributes[attributeIndex].componentCount, quantized.data.data() + vertex * stride + elements[attributeIndex].offset);
+			components += attributes[attributeIndex].componentCount;
+		}
+	}
+	return quantized;
+}
+
+void VertexQuantizer::Dequantize(const QuantizedVertices& quantized, unsigned int attributeIndex, size_t vertexIndex, float* output)
+{
+	const QuantizedAttribute& attribute = quantized.attributes[attributeIndex];
+	const VertexBufferElement& element = quantized.layout.GetElements()[attributeIndex];
+	unsigned int componentCount = VertexBufferElement::IsPackedType(element.type) ? 4 : element.count;
+	Decode(attribute.format, attribute, quantized.data.data() + vertexIndex * quantized.layout.GetStride() + element.offset, componentCount, output);
+}
+
+void VertexQuantizer::PushFormat(VertexBufferLayout& layout, QuantizedFormat format, unsigned int componentCount)
+{
+	switch (format)
+	{
+		case QuantizedFormat::Float:			layout.Push<float>(componentCount); break;
+		case QuantizedFormat::Half:				layout.Push<VertexFormat::Half>(componentCount); break;
+		case QuantizedFormat::Snorm16:			layout.Push<VertexFormat::Snorm16>(componentCount); break;
+		case QuantizedFormat::Unorm16:			layout.Push<VertexFormat::Unorm16>(componentCount); break;
+		case QuantizedFormat::Snorm10_10_10_2:	layout.Push<VertexFormat::Snorm10_10_10_2>(4); break;
+		case QuantizedFormat::Unorm10_10_10_2:	layout.Push<VertexFormat::Unorm10_10_10_2>(4); break;
+	}
+	layout.Align(4); //One or three 16 bit components would leave the next attribute misaligned.
+}
+
+void VertexQuantizer::Encode(QuantizedFormat format, const QuantizedAttribute& attribute, const float* components, unsigned int componentCount, unsigned char* output)
+{
+	auto normalize = [&attribute](float value, unsigned int c) //Into [0, 1] for the unorm formats.
+	{
+		float normalized = attribute.scale[c] != 0.0f ? (value - attribute.offset[c]) / attribute.scale[c] : 0.0f;
+		return std::min(std::max(normalized, 0.0f), 1.0f);
+	};
+
+	switch (format)
+	{
+		case QuantizedFormat::Float:
+		{
+			memcpy(output, components, componentCount * sizeof(float));
+			break;
+		}
+		case QuantizedFormat::Half:
+		{
+			for (unsigned int c = 0; c < componentCount; c++)
+			{
+				uint16_t half = FloatToHalf(components[c]);
+				memcpy(output + c * 2, &half, 2);
+			}
+			break;
+		}
+		case QuantizedFormat::Snorm16:
+		{
+			for (unsigned int c = 0; c < componentCount; c++)
+			{
+				int16_t value = (int16_t)std::lround(std::min(std::max(components[c], -1.0f), 1.0f) * 32767.0f);
+				memcpy(output + c * 2, &value, 2);
+			}
+			break;
+		}
+		case QuantizedFormat::Unorm16:
+		{
+			for (unsigned int c = 0; c < componentCount; c++)
+			{
+				uint16_t value = (uint16_t)std::lround(normalize(components[c], c) * 65535.0f);
+				memcpy(output + c * 2, &value, 2);
+			}
+			break;
+		}
+		case QuantizedFormat::Snorm10_10_10_2:
+		{
+			//x in the lowest bits, w in the top 2. A missing w is written as 1, the same as OpenGL would fill in.
+			uint32_t packed = 0;
+			for (unsigned int c = 0; c < 4; c++)
+			{
+				float value = c < componentCount ? std::min(std::max(components[c], -1.0f), 1.0f) : 1.0f;
+				int32_t stored = (int32_t)std::lround(value * (c < 3 ? 511.0f : 1.0f));
+				packed |= ((uint32_t)stored & (c < 3 ? 0x3FFu : 0x3u)) << (c * 10);
+			}
+			memcpy(output, &packed, 4);
+			break;
+		}
+		case QuantizedFormat::Unorm10_10_10_2:
+		{
+			uint32_t packed = 0;
+			for (unsigned int c = 0; c < 4; c++)
+			{
+				float value = c < componentCount ? normalize(components[c], c) : 1.0f;
+				packed |= (uint32_t)std::lround(value * (c < 3 ? 1023.0f : 3.0f)) << (c * 10);
+			}
+			memcpy(output, &packed, 4);
+			break;
+		}
+	}
+}
+
+void VertexQuantizer::Decode(QuantizedFormat format, const QuantizedAttribute& attribute, const unsigned char* input, unsigned int componentCount, float* output)
+{
+	//Signed normalized values decode with the OpenGL 4.2 rule, max(c / (2^(b-1) - 1), -1), which is what current hardware does regardless of context version.
+	switch (format)
+	{
+		case QuantizedFormat::Float:
+		{
+			memcpy(output, input, componentCount * sizeof(float));
+			return;
+		}
+		case QuantizedFormat::Half:
+		{
+			for (unsigned int c = 0; c < componentCount; c++)
+			{
+				uint16_t half;
+				memcpy(&half, input + c * 2, 2);
+				output[c] = HalfToFloat(half);
+			}
+			return;
+		}
+		case QuantizedFormat::Snorm16:
+		{
+			for (unsigned int c = 0; c < componentCount; c++)
+			{
+				int16_t value;
+				memcpy(&value, input + c * 2, 2);
+				output[c] = std::max(value / 32767.0f, -1.0f);
+			}
+			return;
+		}
+		case QuantizedFormat::Unorm16:
+		{
+			for (unsigned int c = 0; c < componentCount; c++)
+			{
+				uint16_t value;
+				memcpy(&value, input + c * 2, 2);
+				output[c] = value / 65535.0f * attribute.scale[c] + attribute.offset[c];
+			}
+			return;
+		}
+		case QuantizedFormat::Snorm10_10_10_2:
+		{
+			uint32_t packed;
+			memcpy(&packed, input, 4);
+			for (unsigned int c = 0; c < componentCount && c < 4; c++)
+			{
+				unsigned int bits = c < 3 ? 10 : 2;
+				int32_t stored = (int32_t)((packed >> (c * 10)) << (32 - bits)) >> (32 - bits); //Sign extend the field.
+				output[c] = std::max(stored / (float)((1 << (bits - 1)) - 1), -1.0f);
+			}
+			return;
+		}
+		case QuantizedFormat::Unorm10_10_10_2:
+		{
+			uint32_t packed;
+			memcpy(&packed, input, 4);
+			for (unsigned int c = 0; c < componentCount && c < 4; c++)
+			{
+				unsigned int bits = c < 3 ? 10 : 2;
+				uint32_t stored = (packed >> (c * 10)) & ((1u << bits) - 1);
+				output[c] = stored / (float)((1u << bits) - 1) * attribute.scale[c] + attribute.offset[c];
+			}
+			return;
+		}
+	}
+}
+
+uint16_t VertexQuantizer::FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	if (magnitude >= 0x7F800000) //Infinity or NaN.
+	{
+		return (uint16_t)(sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0));
+	}
+	if (magnitude >= 0x477FF000) //65520 and up round past the largest half (65504).
+	{
+		return (uint16_t)(sign | 0x7C00);
+	}
+	if (magnitude < 0x38800000) //Below the smallest normal half, so this becomes a denormal (or 0).
+	{
+		if (magnitude < 0x33000000)
+		{
+			return (uint16_t)sign;
+		}
+		uint32_t exponent = magnitude >> 23;
+		uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+		uint32_t shift = 126 - exponent;
+		uint32_t half = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+		{
+			half++;
+		}
+		return (uint16_t)(sign | half);
+	}
+
+	//Rebias the exponent from 127 to 15 and drop 13 bits of mantissa, rounding to nearest even. A carry out of the mantissa correctly bumps the exponent.
+	uint32_t half = (magnitude - 0x38000000) >> 13;
+	uint32_t remainder = magnitude & 0x1FFF;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+	{
+		half++;
+	}
+	return (uint16_t)(sign | half);
+}
+
+float VertexQuantizer::HalfToFloat(uint16_t value)
+{
+	uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x3FF;
+
+	if (exponent == 0) //Zero or denormal.
+	{
+		float magnitude = std::ldexp((float)mantissa, -24);
+		return sign ? -magnitude : magnitude;
+	}
+
+	uint32_t bits = exponent == 31 ? (sign | 0x7F800000 | (mantissa << 13)) : (sign | ((exponent + 112) << 23) | (mantissa << 13));
+	float result;
+	memcpy(&result, &bits, 4);
+	return result;
+}
+
+const char* VertexQuantizer::GetFormatName(QuantizedFormat format)
+{
+	switch (format)
+	{
+		case QuantizedFormat::Float:			return "Float";
+		case QuantizedFormat::Half:				return "Half";
+		case QuantizedFormat::Snorm16:			return "Snorm16";
+		case QuantizedFormat::Unorm16:			return "Unorm16";
+		case QuantizedFormat::Snorm10_10_10_2:	return "Snorm10_10_10_2";
+		case QuantizedFormat::Unorm10_10_10_2:	return "Unorm10_10_10_2";
+	}
+	return "Unknown";
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "../OpenGL/VertexBufferLayout.h"
+#include <cstdint>
+
+//The vertex quantizer runs offline (or at load time) over full float vertices and packs each attribute into the smallest format that stays within its error bound.
+//Vertex fetch is bandwidth bound on large meshes, so a 32 byte vertex that becomes 12 bytes draws noticeably faster, and the GPU converts back to floats for free.
+
+enum class QuantizedFormat
+{
+	Float, Half, Snorm16, Unorm16, Snorm10_10_10_2, Unorm10_10_10_2
+};
+
+struct QuantizationAttribute
+{
+	unsigned int componentCount = 3; //Floats per vertex in the source data, 1 to 4.
+	float maxError = 0.001f; //The largest absolute error we accept on any component after decoding.
+	bool allowRemap = false; //Lets values outside [0, 1] be rescaled into a unorm format. The shader then has to apply the attribute's scale and offset itself.
+};
+
+struct QuantizedAttribute
+{
+	QuantizedFormat format = QuantizedFormat::Float;
+	float scale[4] = { 1.0f, 1.0f, 1.0f, 1.0f }; //Decoded value = stored value * scale + offset. Only differs from 1 and 0 when remapped.
+	float offset[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	float measuredError = 0.0f; //The largest error we actually saw decoding the result back.
+};
+
+struct QuantizedVertices
+{
+	std::vector<unsigned char> data;
+	VertexBufferLayout layout;
+	std::vector<QuantizedAttribute> attributes;
+	size_t vertexCount = 0;
+};
+
+class VertexQuantizer
+{
+public:
+	//The source vertices are interleaved floats with the attributes in the given order, so the source stride is the sum of their component counts.
+	static QuantizedVertices Quantize(const float* vertices, size_t vertexCount, const QuantizationAttribute* attributes, unsigned int attributeCount);
+	static void Dequantize(const QuantizedVertices& quantized, unsigned int attributeIndex, size_t vertexIndex, float* output); //Decodes the way the GPU would.
+
+	static uint16_t FloatToHalf(float value); //Rounds to nearest even. Out of range values become infinity.
+	static float HalfToFloat(uint16_t value);
+	static const char* GetFormatName(QuantizedFormat format);
+
+private:
+	static void Encode(QuantizedFormat format, const QuantizedAttribute& attribute, const float* components, unsigned int componentCount, unsigned char* output);
+	static void Decode(QuantizedFormat format, const QuantizedAttribute& attribute, const unsigned char* input, unsigned int componentCount, float* output);
+	static void PushFormat(VertexBufferLayout& layout, QuantizedFormat format, unsigned int componentCount);
+};
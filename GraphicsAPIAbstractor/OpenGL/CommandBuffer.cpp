@@ -0,0 +1,358 @@
+#include "GAAPrecompiledHeader.h"
+#include "CommandBuffer.h"
+#include "OpenGLRenderer.h"
+#include "GPUProfiler.h"
+#include "RenderStats.h"
+#include "Texture.h"
+#include "VertexArrayCache.h"
+#include "VertexBufferLayout.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	struct ClearCommand
+	{
+		float color[4];
+		unsigned int mask;
+	};
+
+	struct ViewportCommand
+	{
+		int x, y, width, height;
+	};
+
+	struct BindTextureCommand
+	{
+		const Texture* texture;
+		unsigned int slot;
+		unsigned int padding; //Spelled out so it is zeroed like everything else, which keeps two recordings of the same commands byte for byte identical.
+	};
+
+	struct UniformCommand
+	{
+		Shader* shader;
+		char name[CommandBuffer::s_MaxUniformNameLength + 1];
+		float values[16]; //Enough for a mat4. Integers are stored in values[0] as they are.
+	};
+
+	struct DrawCommand
+	{
+		const VertexArray* vertexArray;
+		const IndexBuffer* indexBuffer;
+		const Shader* shader;
+		unsigned int firstIndex, indexCount;
+	};
+
+	struct DrawWithLayoutCommand
+	{
+		unsigned int vertexBufferID, indexBufferID;
+		const VertexBufferElement* elements; //Either a compile time layout's, which live forever, or a VertexBufferLayout's, which has to outlive the frame.
+		unsigned int elementCount, stride;
+		uint64_t layoutHash;
+		const Shader* shader;
+		unsigned int firstIndex, indexCount;
+	};
+
+	struct CallbackCommand
+	{
+		void* callable; //Null once Append has moved it to another buffer.
+		void (*invoke)(void*);
+		void (*destroy)(void*);
+	};
+
+	struct ProfileScopeCommand
+	{
+		const char* name;
+	};
+
+	void DrawIndexed(unsigned int firstIndex, unsigned int indexCount)
+	{
+		GLCall(glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, (const void*)(uintptr_t)(firstIndex * sizeof(unsigned int))));
+		RenderStats::RecordDraw(indexCount);
+	}
+}
+
+template<typename Command>
+void CommandBuffer::Write(RenderCommandType type, const Command& command)
+{
+	static_assert(std::is_trivially_copyable<Command>::value && alignof(Command) <= 8, "Commands are copied into the stream as plain bytes.");
+	CommandHeader header = { type, (uint32_t)((sizeof(Command) + 7) & ~(size_t)7) };
+	size_t offset = Grow(sizeof(CommandHeader) + header.size);
+	memcpy(m_Data.data() + offset, &header, sizeof(CommandHeader));
+	memcpy(m_Data.data() + offset + sizeof(CommandHeader), &command, sizeof(Command));
+	m_CommandCount++;
+}
+
+CommandBuffer::~CommandBuffer()
+{
+	DestroyCallbacks();
+}
+
+size_t CommandBuffer::Grow(size_t size)
+{
+	if (m_Data.capacity() == 0)
+	{
+		m_Data.reserve(std::max(m_LargestSize, s_MinimumReserve)); //Every regrowth leaves the old block in the arena until it's reset, so we try to only grow once.
+	}
+	size_t offset = m_Data.size();
+	m_Data.resize(offset + size);
+	return offset;
+}
+
+void CommandBuffer::Clear(float red, float green, float blue, float alpha, unsigned int mask)
+{
+	Write(RenderCommandType::Clear, ClearCommand{ { red, green, blue, alpha }, mask });
+}
+
+void CommandBuffer::SetViewport(int x, int y, int width, int height)
+{
+	Write(RenderCommandType::SetViewport, ViewportCommand{ x, y, width, height });
+}
+
+void CommandBuffer::BindTexture(const Texture& texture, unsigned int slot)
+{
+	Write(RenderCommandType::BindTexture, BindTextureCommand{ &texture, slot, 0 });
+}
+
+void CommandBuffer::SetUniform1i(Shader& shader, const char* name, int value)
+{
+	UniformCommand command = {};
+	command.shader = &shader;
+	CopyUniformName(command.name, name);
+	memcpy(command.values, &value, sizeof(int));
+	Write(RenderCommandType::SetUniform1i, command);
+}
+
+void CommandBuffer::SetUniform1f(Shader& shader, const char* name, float value)
+{
+	UniformCommand command = {};
+	command.shader = &shader;
+	CopyUniformName(command.name, name);
+	command.values[0] = value;
+	Write(RenderCommandType::SetUniform1f, command);
+}
+
+void CommandBuffer::SetUniform4f(Shader& shader, const char* name, const glm::vec4& value)
+{
+	UniformCommand command = {};
+	command.shader = &shader;
+	CopyUniformName(command.name, name);
+	memcpy(command.values, &value[0], sizeof(float) * 4);
+	Write(RenderCommandType::SetUniform4f, command);
+}
+
+void CommandBuffer::SetUniformMat4f(Shader& shader, const char* name, const glm::mat4& matrix)
+{
+	UniformCommand command = {};
+	command.shader = &shader;
+	CopyUniformName(command.name, name);
+	memcpy(command.values, &matrix[0][0], sizeof(float) * 16);
+	Write(RenderCommandType::SetUniformMat4f, command);
+}
+
+void CommandBuffer::Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, const Shader& shader, unsigned int firstIndex, unsigned int indexCount)
+{
+	Write(RenderCommandType::Draw, DrawCommand{ &vertexArray, &indexBuffer, &shader, firstIndex, indexCount == 0 ? indexBuffer.GetCount() : indexCount });
+}
+
+void CommandBuffer::Draw(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout, const Shader& shader, unsigned int firstIndex, unsigned int indexCount)
+{
+	const auto& elements = layout.GetElements();
+	DrawWithLayout(vertexBuffer, indexBuffer, elements.data(), (unsigned int)elements.size(), layout.GetStride(), layout.GetHash(), shader, firstIndex, indexCount);
+}
+
+void CommandBuffer::DrawWithLayout(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferElement* elements, unsigned int elementCount, unsigned int stride, uint64_t layoutHash, const Shader& shader, unsigned int firstIndex, unsigned int indexCount)
+{
+	DrawWithLayoutCommand command;
+	command.vertexBufferID = vertexBuffer.GetRendererID();
+	command.indexBufferID = indexBuffer.GetRendererID();
+	command.elements = elements;
+	command.elementCount = elementCount;
+	command.stride = stride;
+	command.layoutHash = layoutHash;
+	command.shader = &shader;
+	command.firstIndex = firstIndex;
+	command.indexCount = indexCount == 0 ? indexBuffer.GetCount() : indexCount;
+	Write(RenderCommandType::DrawWithLayout, command);
+}
+
+void CommandBuffer::WriteCallback(void* callable, void (*invoke)(void*), void (*destroy)(void*))
+{
+	Write(RenderCommandType::Callback, CallbackCommand{ callable, invoke, destroy });
+	m_CallbackCount++;
+}
+
+void CommandBuffer::BeginProfileScope(const char* name)
+{
+	Write(RenderCommandType::BeginProfileScope, ProfileScopeCommand{ name });
+}
+
+void CommandBuffer::EndProfileScope()
+{
+	Write(RenderCommandType::EndProfileScope, ProfileScopeCommand{ nullptr });
+}
+
+void CommandBuffer::Execute() const
+{
+	const unsigned char* data = m_Data.data();
+	const unsigned char* end = data + m_Data.size();
+	while (data < end)
+	{
+		const CommandHeader& header = *reinterpret_cast<const CommandHeader*>(data);
+		const void* command = data + sizeof(CommandHeader);
+		data += sizeof(CommandHeader) + header.size;
+
+		switch (header.type)
+		{
+		case RenderCommandType::Clear:
+		{
+			const ClearCommand& clear = *static_cast<const ClearCommand*>(command);
+			glClearColor(clear.color[0], clear.color[1], clear.color[2], clear.color[3]);
+			glClear(clear.mask);
+			break;
+		}
+		case RenderCommandType::SetViewport:
+		{
+			const ViewportCommand& viewport = *static_cast<const ViewportCommand*>(command);
+			glViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+			break;
+		}
+		case RenderCommandType::BindTexture:
+		{
+			const BindTextureCommand& bind = *static_cast<const BindTextureCommand*>(command);
+			bind.texture->Bind(bind.slot);
+			break;
+		}
+		case RenderCommandType::SetUniform1i:
+		case RenderCommandType::SetUniform1f:
+		case RenderCommandType::SetUniform4f:
+		case RenderCommandType::SetUniformMat4f:
+		{
+			//Uniforms are per program, so the shader has to be bound for them to land.
+			const UniformCommand& uniform = *static_cast<const UniformCommand*>(command);
+			uniform.shader->Bind();
+			if (header.type == RenderCommandType::SetUniform1i)
+			{
+				int value;
+				memcpy(&value, uniform.values, sizeof(int));
+				uniform.shader->SetUniform1i(uniform.name, value);
+			}
+			else if (header.type == RenderCommandType::SetUniform1f)
+			{
+				uniform.shader->SetUniform1f(uniform.name, uniform.values[0]);
+			}
+			else if (header.type == RenderCommandType::SetUniform4f)
+			{
+				uniform.shader->SetUniform4f(uniform.name, uniform.values[0], uniform.values[1], uniform.values[2], uniform.values[3]);
+			}
+			else
+			{
+				glm::mat4 matrix;
+				memcpy(&matrix[0][0], uniform.values, sizeof(float) * 16);
+				uniform.shader->SetUniformMat4f(uniform.name, matrix);
+			}
+			break;
+		}
+		case RenderCommandType::Draw:
+		{
+			const DrawCommand& draw = *static_cast<const DrawCommand*>(command);
+			draw.shader->Bind();
+			draw.vertexArray->Bind();
+			draw.indexBuffer->Bind();
+			DrawIndexed(draw.firstIndex, draw.indexCount);
+			break;
+		}
+		case RenderCommandType::DrawWithLayout:
+		{
+			const DrawWithLayoutCommand& draw = *static_cast<const DrawWithLayoutCommand*>(command);
+			draw.shader->Bind();
+			VertexArrayCache::Bind(draw.vertexBufferID, draw.indexBufferID, draw.elements, draw.elementCount, draw.stride, draw.layoutHash);
+			DrawIndexed(draw.firstIndex, draw.indexCount);
+			break;
+		}
+		case RenderCommandType::Callback:
+		{
+			const CallbackCommand& callback = *static_cast<const CallbackCommand*>(command);
+			if (callback.callable)
+			{
+				callback.invoke(callback.callable);
+			}
+			break;
+		}
+		case RenderCommandType::BeginProfileScope:
+			GPUProfiler::BeginScope(static_cast<const ProfileScopeCommand*>(command)->name);
+			break;
+		case RenderCommandType::EndProfileScope:
+			GPUProfiler::EndScope();
+			break;
+		}
+	}
+}
+
+void CommandBuffer::Reset()
+{
+	DestroyCallbacks();
+	m_LargestSize = std::max(m_LargestSize, m_Data.size());
+	m_Data = FrameVector<unsigned char>(); //Nothing to free, the old stream goes back with its frame's memory.
+	m_CommandCount = 0;
+	m_CallbackCount = 0;
+}
+
+void CommandBuffer::DestroyCallbacks()
+{
+	if (m_CallbackCount == 0)
+	{
+		return;
+	}
+	unsigned char* data = m_Data.data();
+	unsigned char* end = data + m_Data.size();
+	while (data < end)
+	{
+		const CommandHeader& header = *reinterpret_cast<const CommandHeader*>(data);
+		if (header.type == RenderCommandType::Callback)
+		{
+			CallbackCommand& callback = *reinterpret_cast<CallbackCommand*>(data + sizeof(CommandHeader));
+			if (callback.callable)
+			{
+				callback.destroy(callback.callable);
+				callback.callable = nullptr;
+			}
+		}
+		data += sizeof(CommandHeader) + header.size;
+	}
+	m_CallbackCount = 0;
+}
+
+void CommandBuffer::Append(CommandBuffer& source, size_t offset, size_t size)
+{
+	size_t destinationOffset = Grow(size);
+	memcpy(m_Data.data() + destinationOffset, source.m_Data.data() + offset, size);
+
+	//The callbacks' functions now belong to us, so the source mustn't run or destroy them. Everything else only needs copying.
+	unsigned char* data = source.m_Data.data() + offset;
+	unsigned char* end = data + size;
+	while (data < end)
+	{
+		const CommandHeader& header = *reinterpret_cast<const CommandHeader*>(data);
+		if (header.type == RenderCommandType::Callback)
+		{
+			reinterpret_cast<CallbackCommand*>(data + sizeof(CommandHeader))->callable = nullptr;
+			m_CallbackCount++;
+		}
+		data += sizeof(CommandHeader) + header.size;
+		m_CommandCount++;
+	}
+}
+
+void CommandBuffer::CopyUniformName(char* destination, const char* name)
+{
+	size_t length = strlen(name);
+	if (length > s_MaxUniformNameLength)
+	{
+		std::cout << "Warning: Uniform name " << name << " is too long for a command buffer and will be cut short! \n";
+		length = s_MaxUniformNameLength;
+	}
+	memcpy(destination, name, length);
+	destination[length] = '\0';
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+#include "FrameAllocator.h"
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+class Shader;
+class Texture;
+class VertexArray;
+class VertexBuffer;
+class IndexBuffer;
+class VertexBufferLayout;
+struct VertexBufferElement;
+
+enum class RenderCommandType : uint32_t
+{
+	Clear = 0, SetViewport, BindTexture, SetUniform1i, SetUniform1f, SetUniform4f, SetUniformMat4f, Draw, DrawWithLayout, Callback, BeginProfileScope, EndProfileScope
+};
+
+//GL work recorded now and executed later on whichever thread owns the context. Recording only copies small plain structs into a byte stream, so it never
+//touches GL and works on any thread. The stream lives in the FrameAllocator, so recording never goes to the heap, and it reserves as much as the largest
+//frame it has held so far, so it rarely regrows. Frame memory only lasts until the end of the frame after the one it was handed out in, so a buffer has to
+//be executed and Reset by then, and recorded again next frame, as FramePacket's are.
+//Commands point at the resources they use rather than copying them, so those have to stay alive until the buffer has been executed. With the RenderThread
+//running, that means destroying them through RenderThread::Enqueue, which runs after every frame submitted before it.
+class CommandBuffer
+{
+public:
+	CommandBuffer() = default;
+	~CommandBuffer();
+
+	//A copy would destroy the same callbacks twice. Moving leaves the source empty, so it destroys nothing.
+	CommandBuffer(const CommandBuffer&) = delete;
+	CommandBuffer& operator=(const CommandBuffer&) = delete;
+	CommandBuffer(CommandBuffer&&) = default;
+	CommandBuffer& operator=(CommandBuffer&&) = default;
+
+	void Clear(float red, float green, float blue, float alpha, unsigned int mask = GL_COLOR_BUFFER_BIT);
+	void SetViewport(int x, int y, int width, int height);
+	void BindTexture(const Texture& texture, unsigned int slot = 0);
+
+	//Uniform names are copied into the command, up to s_MaxUniformNameLength characters.
+	void SetUniform1i(Shader& shader, const char* name, int value);
+	void SetUniform1f(Shader& shader, const char* name, float value);
+	void SetUniform4f(Shader& shader, const char* name, const glm::vec4& value);
+	void SetUniformMat4f(Shader& shader, const char* name, const glm::mat4& matrix);
+
+	//indexCount 0 draws the whole index buffer.
+	void Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, const Shader& shader, unsigned int firstIndex = 0, unsigned int indexCount = 0);
+	void Draw(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout, const Shader& shader, unsigned int firstIndex = 0, unsigned int indexCount = 0); //Through the VertexArrayCache.
+	template<typename Layout>
+	void Draw(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const Shader& shader, unsigned int firstIndex = 0, unsigned int indexCount = 0)
+	{
+		DrawWithLayout(vertexBuffer, indexBuffer, Layout::Elements.data(), Layout::AttributeCount, Layout::Stride, Layout::Hash, shader, firstIndex, indexCount);
+	}
+
+	//Anything the commands above don't cover, such as an IndirectDrawBatch or old style GL code. Runs in order with everything else on the GL thread.
+	//The function is moved into frame memory rather than a std::function, so a callback never allocates however much it captures. It is destroyed on Reset.
+	template<typename Function>
+	void Callback(Function&& function)
+	{
+		using Stored = typename std::decay<Function>::type;
+		Stored* stored = new (FrameAllocator::Allocate(sizeof(Stored), alignof(Stored))) Stored(std::forward<Function>(function));
+		WriteCallback(stored, [](void* callable) { (*static_cast<Stored*>(callable))(); }, [](void* callable) { static_cast<Stored*>(callable)->~Stored(); });
+	}
+
+	//A GPUProfiler scope around the commands in between, such as one pass. name is kept as a pointer, so it has to be a string literal or live as long.
+	void BeginProfileScope(const char* name);
+	void EndProfileScope();
+
+	void Execute() const; //GL thread only.
+	void Reset(); //Drops every command and destroys the callbacks. The memory goes back with the frame it came from.
+
+	//Appends the commands source recorded between byte offset and offset + size, which have to fall on command boundaries, such as GetSize() taken before
+	//and after recording them. Callbacks are moved over rather than copied, so that part of source can't be executed or appended again.
+	void Append(CommandBuffer& source, size_t offset, size_t size);
+	inline void Reserve(size_t sizeInBytes) { m_Data.reserve(sizeInBytes); } //From this frame's memory.
+
+	inline bool IsEmpty() const { return m_CommandCount == 0; }
+	inline unsigned int GetCommandCount() const { return m_CommandCount; }
+	inline size_t GetSize() const { return m_Data.size(); } //In bytes.
+	inline const unsigned char* GetData() const { return m_Data.data(); } //The encoded stream, for comparing two recordings. Callbacks hold a pointer to their function, so only recordings without any compare equal.
+
+	static constexpr unsigned int s_MaxUniformNameLength = 47;
+
+private:
+	struct CommandHeader
+	{
+		RenderCommandType type;
+		uint32_t size; //Of the command that follows, rounded up so the next header stays 8 byte aligned.
+	};
+
+	template<typename Command>
+	void Write(RenderCommandType type, const Command& command);
+	size_t Grow(size_t size); //Returns the offset of the size bytes it added.
+	void WriteCallback(void* callable, void (*invoke)(void*), void (*destroy)(void*));
+	void DestroyCallbacks();
+	void DrawWithLayout(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferElement* elements, unsigned int elementCount, unsigned int stride, uint64_t layoutHash, const Shader& shader, unsigned int firstIndex, unsigned int indexCount);
+	static void CopyUniformName(char* destination, const char* name);
+
+	FrameVector<unsigned char> m_Data;
+	size_t m_LargestSize = 0; //The most the stream has held at a Reset, which is what it reserves up front the next time it is recorded.
+	unsigned int m_CommandCount = 0;
+	unsigned int m_CallbackCount = 0; //So Reset only walks the stream to destroy callbacks when there are any.
+
+	static constexpr size_t s_MinimumReserve = 4096;
+};
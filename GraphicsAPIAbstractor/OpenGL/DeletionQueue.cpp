@@ -0,0 +1,114 @@
+#include "GAAPrecompiledHeader.h"
+#include "DeletionQueue.h"
+#include "VertexArrayCache.h"
+#include "GPUMemoryTracker.h"
+
+std::mutex DeletionQueue::s_PendingMutex;
+DeletionQueue::NameLists DeletionQueue::s_Pending;
+std::vector<DeletionQueue::FrameBatch> DeletionQueue::s_InFlight;
+std::vector<DeletionQueue::FrameBatch> DeletionQueue::s_FreeBatches;
+std::atomic<uint64_t> DeletionQueue::s_FrameIndex(1);
+std::atomic<uint64_t> DeletionQueue::s_CompletedFrameIndex(0);
+
+void DeletionQueue::Enqueue(GLObjectType type, unsigned int rendererID)
+{
+	if (rendererID == 0) //Moved-from or never created.
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_PendingMutex);
+	s_Pending[(size_t)type].push_back(rendererID);
+}
+
+void DeletionQueue::EndFrame()
+{
+	FrameBatch batch;
+	if (!s_FreeBatches.empty())
+	{
+		batch = std::move(s_FreeBatches.back());
+		s_FreeBatches.pop_back();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_PendingMutex);
+		std::swap(batch.names, s_Pending); //Pending gets the recycled (empty) lists back.
+	}
+
+	//We fence every frame, even if nothing was queued, so that GetCompletedFrameIndex() keeps moving for everyone else that waits on frames.
+	batch.frameIndex = s_FrameIndex.load(std::memory_order_relaxed);
+	batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	s_InFlight.push_back(std::move(batch));
+	s_FrameIndex.fetch_add(1, std::memory_order_release);
+
+	//Fences signal in order, so we can stop at the first one that hasn't. A timeout of 0 means we only ever poll here, never wait.
+	size_t retiredCount = 0;
+	while (retiredCount < s_InFlight.size())
+	{
+		GLenum result = glClientWaitSync(s_InFlight[retiredCount].fence, 0, 0);
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+		RetireBatch(s_InFlight[retiredCount]);
+		retiredCount++;
+	}
+
+	for (size_t i = 0; i < retiredCount; i++)
+	{
+		s_FreeBatches.push_back(std::move(s_InFlight[i]));
+	}
+	s_InFlight.erase(s_InFlight.begin(), s_InFlight.begin() + retiredCount);
+}
+
+void DeletionQueue::Flush()
+{
+	EndFrame(); //Seal whatever is still pending behind a fence of its own.
+	for (FrameBatch& batch : s_InFlight)
+	{
+		glClientWaitSync(batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		RetireBatch(batch);
+	}
+	s_InFlight.clear();
+	s_FreeBatches.clear();
+}
+
+void DeletionQueue::RetireBatch(FrameBatch& batch)
+{
+	//One call per type, no matter how many objects of that type were released this frame.
+	std::vector<unsigned int>& buffers = batch.names[(size_t)GLObjectType::Buffer];
+	std::vector<unsigned int>& vertexArrays = batch.names[(size_t)GLObjectType::VertexArray];
+	std::vector<unsigned int>& textures = batch.names[(size_t)GLObjectType::Texture];
+	std::vector<unsigned int>& samplers = batch.names[(size_t)GLObjectType::Sampler];
+	if (!buffers.empty())
+	{
+		VertexArrayCache::OnBuffersDeleted(buffers.data(), buffers.size());
+		GPUMemoryTracker::OnObjectsDeleted(GLObjectType::Buffer, buffers.data(), buffers.size());
+		glDeleteBuffers((GLsizei)buffers.size(), buffers.data());
+	}
+	if (!vertexArrays.empty())
+	{
+		glDeleteVertexArrays((GLsizei)vertexArrays.size(), vertexArrays.data());
+	}
+	if (!textures.empty())
+	{
+		GPUMemoryTracker::OnObjectsDeleted(GLObjectType::Texture, textures.data(), textures.size());
+		glDeleteTextures((GLsizei)textures.size(), textures.data());
+	}
+	if (!samplers.empty())
+	{
+		glDeleteSamplers((GLsizei)samplers.size(), samplers.data());
+	}
+	for (unsigned int program : batch.names[(size_t)GLObjectType::Program]) //Programs have no batched delete.
+	{
+		glDeleteProgram(program);
+	}
+
+	for (std::vector<unsigned int>& names : batch.names)
+	{
+		names.clear();
+	}
+	glDeleteSync(batch.fence);
+	batch.fence = nullptr;
+	s_CompletedFrameIndex.store(batch.frameIndex, std::memory_order_release);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "GL/glew.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+enum class GLObjectType
+{
+	Buffer = 0, VertexArray, Texture, Program, Sampler, Count
+};
+
+//Deleting a GL object the GPU is still using this frame can stall the driver, and glDelete* can only be called on the thread that owns the context.
+//Instead, our resource destructors hand their names to this queue, which is safe to do from any thread. At the end of every frame the queued names are
+//sealed behind a glFenceSync, and once that fence has signalled they are deleted in one batched glDelete* call per object type.
+class DeletionQueue
+{
+public:
+	static void Enqueue(GLObjectType type, unsigned int rendererID);
+	static void EndFrame(); //Call on the GL thread once per frame, after presenting.
+	static void Flush(); //Waits for the GPU and deletes everything. Call before the context is destroyed.
+
+	//Both are read from any thread while the GL thread moves them on.
+	inline static uint64_t GetFrameIndex() { return s_FrameIndex.load(std::memory_order_acquire); } //The frame the GL thread is on. Frames before it have ended.
+	inline static uint64_t GetCompletedFrameIndex() { return s_CompletedFrameIndex.load(std::memory_order_acquire); } //The last frame the GPU has fully finished with.
+
+private:
+	using NameLists = std::array<std::vector<unsigned int>, (size_t)GLObjectType::Count>;
+
+	struct FrameBatch
+	{
+		GLsync fence = nullptr;
+		uint64_t frameIndex = 0;
+		NameLists names;
+	};
+
+	static void RetireBatch(FrameBatch& batch);
+
+private:
+	static std::mutex s_PendingMutex; //The enqueue list's own lock. Everything else below is only touched on the GL thread.
+	static NameLists s_Pending;
+	static std::vector<FrameBatch> s_InFlight; //Oldest first.
+	static std::vector<FrameBatch> s_FreeBatches; //Retired batches keep their vector capacity, so the steady state never allocates.
+	static std::atomic<uint64_t> s_FrameIndex;
+	static std::atomic<uint64_t> s_CompletedFrameIndex;
+};
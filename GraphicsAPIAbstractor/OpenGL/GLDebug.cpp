@@ -0,0 +1,143 @@
+#include "GAAPrecompiledHeader.h"
+#include "GLDebug.h"
+#include "GAAAssert.h"
+#include <cstring>
+
+GLDebugSettings GLDebug::s_Settings;
+std::mutex GLDebug::s_Mutex;
+std::atomic<uint64_t> GLDebug::s_MessageCount(0);
+
+namespace
+{
+	//In the same order as GLDebugSettings::sourceMask's bits.
+	const GLenum s_Sources[] =
+	{
+		GL_DEBUG_SOURCE_API, GL_DEBUG_SOURCE_WINDOW_SYSTEM, GL_DEBUG_SOURCE_SHADER_COMPILER, GL_DEBUG_SOURCE_THIRD_PARTY, GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_SOURCE_OTHER
+	};
+
+	//From least to most severe, as GLDebugSeverity is.
+	const GLenum s_Severities[] =
+	{
+		GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH
+	};
+}
+
+void GLDebug::SetSettings(const GLDebugSettings& settings)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_Settings = settings;
+}
+
+bool GLDebug::EnableForCurrentContext()
+{
+#ifdef GAA_ENABLE_GL_DEBUG
+	if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+	{
+		std::cout << "Warning: This context has no KHR_debug, so GL errors will go unreported! \n";
+		return false;
+	}
+
+	GLDebugSettings settings;
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		settings = s_Settings;
+	}
+
+	//Outside a debug context, drivers are free to report little or nothing. EntryPoint asks for one in the configurations that define GAA_ENABLE_GL_DEBUG.
+	GLint contextFlags = 0;
+	glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
+	if (!(contextFlags & GL_CONTEXT_FLAG_DEBUG_BIT))
+	{
+		std::cout << "Warning: Not a debug context, so the driver may hold back some of its debug messages! \n";
+	}
+
+	glEnable(GL_DEBUG_OUTPUT);
+	if (settings.synchronous)
+	{
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	}
+	else
+	{
+		glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	}
+	//The settings go in as the user parameter, so each context keeps the ones it was enabled with.
+	glDebugMessageCallback(&GLDebug::OnMessage, new GLDebugSettings(settings)); //Lives as long as the program, as the driver may call back right up to the end.
+
+	//Everything off, then back on for the sources and severities we want. Filtering here means the driver never even builds the messages we'd drop.
+	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+	for (size_t source = 0; source < sizeof(s_Sources) / sizeof(s_Sources[0]); source++)
+	{
+		if (!(settings.sourceMask & (1u << source)))
+		{
+			continue;
+		}
+		for (size_t severity = (size_t)settings.minimumSeverity; severity < sizeof(s_Severities) / sizeof(s_Severities[0]); severity++)
+		{
+			glDebugMessageControl(s_Sources[source], GL_DONT_CARE, s_Severities[severity], 0, nullptr, GL_TRUE);
+		}
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GLAPIENTRY GLDebug::OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParameter)
+{
+	const GLDebugSettings& settings = *static_cast<const GLDebugSettings*>(userParameter);
+	s_MessageCount.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		std::cout << "[OpenGL " << GetTypeName(type) << "] (" << GetSourceName(source) << ", " << GetSeverityName(severity) << ", id " << id << ")\n";
+		std::cout.write(message, length >= 0 ? length : (std::streamsize)strlen(message));
+		std::cout << "\n";
+	}
+
+	if (type == GL_DEBUG_TYPE_ERROR && settings.breakOnError && settings.synchronous)
+	{
+		GAA_DEBUG_BREAK(); //The call that caused this is right below us on the stack.
+	}
+}
+
+const char* GLDebug::GetSourceName(GLenum source)
+{
+	switch (source)
+	{
+		case GL_DEBUG_SOURCE_API:				return "API";
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM:		return "Window System";
+		case GL_DEBUG_SOURCE_SHADER_COMPILER:	return "Shader Compiler";
+		case GL_DEBUG_SOURCE_THIRD_PARTY:		return "Third Party";
+		case GL_DEBUG_SOURCE_APPLICATION:		return "Application";
+		case GL_DEBUG_SOURCE_OTHER:				return "Other";
+	}
+	return "Unknown";
+}
+
+const char* GLDebug::GetTypeName(GLenum type)
+{
+	switch (type)
+	{
+		case GL_DEBUG_TYPE_ERROR:				return "Error";
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:	return "Deprecated Behavior";
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:	return "Undefined Behavior";
+		case GL_DEBUG_TYPE_PORTABILITY:			return "Portability";
+		case GL_DEBUG_TYPE_PERFORMANCE:			return "Performance";
+		case GL_DEBUG_TYPE_MARKER:				return "Marker";
+		case GL_DEBUG_TYPE_PUSH_GROUP:			return "Push Group";
+		case GL_DEBUG_TYPE_POP_GROUP:			return "Pop Group";
+		case GL_DEBUG_TYPE_OTHER:				return "Other";
+	}
+	return "Unknown";
+}
+
+const char* GLDebug::GetSeverityName(GLenum severity)
+{
+	switch (severity)
+	{
+		case GL_DEBUG_SEVERITY_HIGH:			return "High";
+		case GL_DEBUG_SEVERITY_MEDIUM:			return "Medium";
+		case GL_DEBUG_SEVERITY_LOW:				return "Low";
+		case GL_DEBUG_SEVERITY_NOTIFICATION:	return "Notification";
+	}
+	return "Unknown";
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "GL/glew.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+enum class GLDebugSeverity : unsigned int
+{
+	Notification = 0, Low, Medium, High
+};
+
+struct GLDebugSettings
+{
+	bool synchronous = true; //Messages arrive inside the call that caused them, so the call stack points at it. Slower, as the driver can't defer its work.
+	bool breakOnError = true; //Stops in the debugger on GL_DEBUG_TYPE_ERROR. Only where synchronous, as otherwise the stack is somewhere else entirely.
+	GLDebugSeverity minimumSeverity = GLDebugSeverity::Low; //Notifications are mostly drivers telling us where they put a buffer.
+	//Which of GL_DEBUG_SOURCE_API, _WINDOW_SYSTEM, _SHADER_COMPILER, _THIRD_PARTY, _APPLICATION and _OTHER to listen to, as bits in that order. All of them by default.
+	unsigned int sourceMask = 0x3F;
+};
+
+//Validation through KHR_debug (core since 4.3). The driver checks every call as it goes anyway, and with debug output on it calls us back with what it
+//found, with far more detail than glGetError's single enum, and without us asking after every call, which can make the driver sync with itself.
+//Debug output is state of a context, so EnableForCurrentContext is called once for every context we make: the main one, and the upload thread's.
+//It only does anything where GAA_ENABLE_GL_DEBUG is defined (the Debug configurations define it), and even then only with a context that supports it.
+//Release builds never turn debug output on and never poll for errors, so their GL calls cost exactly what the driver makes them cost.
+class GLDebug
+{
+public:
+	static void SetSettings(const GLDebugSettings& settings); //Before EnableForCurrentContext. Contexts already enabled keep what they were enabled with.
+	static bool EnableForCurrentContext();
+
+	inline static uint64_t GetMessageCount() { return s_MessageCount.load(std::memory_order_relaxed); }
+
+	static const char* GetSourceName(GLenum source);
+	static const char* GetTypeName(GLenum type);
+	static const char* GetSeverityName(GLenum severity);
+
+private:
+	static void GLAPIENTRY OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParameter);
+
+	static GLDebugSettings s_Settings;
+	static std::mutex s_Mutex; //Guards s_Settings, and keeps messages from printing over each other, as they come in on whichever thread made the call.
+	static std::atomic<uint64_t> s_MessageCount;
+};
@@ -0,0 +1,186 @@
+#include "GAAPrecompiledHeader.h"
+#include "GPUCuller.h"
+#include "DeletionQueue.h"
+#include "GPUProfiler.h"
+#include "RenderStats.h"
+#include "GPUMemoryTracker.h"
+#include "GL/glew.h"
+#include <algorithm>
+#include <iterator>
+
+static constexpr unsigned int s_GroupSize = 64; //local_size_x in GPUCull.shader.
+
+bool GPUCuller::IsSupported()
+{
+	//The visible commands are zeroed with glClearBufferSubData every frame, which came in with 4.3 alongside SSBOs but is an extension of its own before that.
+	bool storageBuffers = GLEW_VERSION_4_3 || (GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_clear_buffer_object);
+	return HiZPyramid::IsSupported() && storageBuffers && IndirectDrawBatch::IsMultiDrawSupported();
+}
+
+bool GPUCuller::IsDrawCountSupported()
+{
+	return GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters;
+}
+
+GPUCuller::GPUCuller()
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+	m_Shader = std::make_unique<Shader>("OpenGL/Shaders/GPUCull.shader");
+	glGenBuffers(1, &m_BoundsBuffer);
+	glGenBuffers(1, &m_CommandBuffer);
+	glGenBuffers(1, &m_VisibleCommandBuffer);
+	glGenBuffers(1, &m_DrawCountBuffer);
+
+	unsigned int zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_DrawCountBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int), &zero, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	RenderStats::Add(RenderStat::BufferAllocations);
+	RenderStats::Add(RenderStat::BufferBytesAllocated, sizeof(unsigned int));
+	GPUMemoryTracker::Track(GLObjectType::Buffer, m_DrawCountBuffer, GPUMemoryCategory::Transient, sizeof(unsigned int));
+	RenderStats::Add(RenderStat::BytesUploaded, sizeof(unsigned int));
+}
+
+GPUCuller::~GPUCuller()
+{
+	DeletionQueue::Enqueue(GLObjectType::Buffer, m_BoundsBuffer);
+	DeletionQueue::Enqueue(GLObjectType::Buffer, m_CommandBuffer);
+	DeletionQueue::Enqueue(GLObjectType::Buffer, m_VisibleCommandBuffer);
+	DeletionQueue::Enqueue(GLObjectType::Buffer, m_DrawCountBuffer);
+}
+
+void GPUCuller::Cull(const IndirectDrawBatch& batch, const BoundingSphere* bounds, const glm::mat4& viewProjection, const HiZPyramid* previousDepth)
+{
+	m_MaxDrawCount = batch.GetDrawCount();
+	if (!m_Shader || m_MaxDrawCount == 0)
+	{
+		return;
+	}
+
+	GPU_PROFILE_SCOPE("GPU Culling");
+	const std::vector<DrawElementsIndirectCommand>& commands = batch.GetCommands();
+	IndirectDrawBatch::Upload(GL_SHADER_STORAGE_BUFFER, m_BoundsBuffer, m_BoundsBufferCapacity, bounds, m_MaxDrawCount * sizeof(BoundingSphere));
+	IndirectDrawBatch::Upload(GL_SHADER_STORAGE_BUFFER, m_CommandBuffer, m_CommandBufferCapacity, commands.data(), m_MaxDrawCount * sizeof(DrawElementsIndirectCommand));
+
+	//Only ever written by the GPU, so it just has to be big enough. Without a draw count, every command past the visible ones has to read as an empty draw.
+	size_t visibleSize = m_MaxDrawCount * sizeof(DrawElementsIndirectCommand);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_VisibleCommandBuffer);
+	if (visibleSize > m_VisibleCommandBufferCapacity)
+	{
+		m_VisibleCommandBufferCapacity = std::max(visibleSize, m_VisibleCommandBufferCapacity * 2);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_VisibleCommandBufferCapacity, nullptr, GL_DYNAMIC_DRAW);
+		RenderStats::Add(RenderStat::BufferAllocations);
+		RenderStats::Add(RenderStat::BufferBytesAllocated, m_VisibleCommandBufferCapacity);
+		GPUMemoryTracker::Track(GLObjectType::Buffer, m_VisibleCommandBuffer, GPUMemoryCategory::Transient, m_VisibleCommandBufferCapacity);
+	}
+	if (!IsDrawCountSupported())
+	{
+		glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, visibleSize, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr); //Null clears to 0.
+	}
+	unsigned int zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_DrawCountBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(unsigned int), &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	RenderStats::Add(RenderStat::BytesUploaded, sizeof(unsigned int));
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_BoundsBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_CommandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_VisibleCommandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_DrawCountBuffer);
+
+	Frustum frustum(viewProjection);
+	bool occlusion = previousDepth && previousDepth->IsValid();
+	m_Shader->Bind();
+	m_Shader->SetUniform1i("u_DrawCount", (int)m_MaxDrawCount);
+	m_Shader->SetUniform4fv("u_FrustumPlanes", Frustum::PlaneCount, &frustum.GetPlanes()[0].x);
+	m_Shader->SetUniform1i("u_OcclusionEnabled", occlusion);
+	if (occlusion)
+	{
+		previousDepth->Bind(0);
+		m_Shader->SetUniform1i("u_HiZ", 0);
+		m_Shader->SetUniform1i("u_HiZLevelCount", (int)previousDepth->GetLevelCount());
+		m_Shader->SetUniformMat4f("u_PreviousViewProjection", previousDepth->GetViewProjection());
+	}
+
+	glDispatchCompute((m_MaxDrawCount + s_GroupSize - 1) / s_GroupSize, 1, 1);
+	RenderStats::Add(RenderStat::ComputeDispatches);
+	//The draw reads the commands and the count as indirect arguments, not through the shader, which needs its own barrier.
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+unsigned int GPUCuller::ReadVisibleCount() const
+{
+	if (!m_Shader)
+	{
+		return 0;
+	}
+	unsigned int count = 0;
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_DrawCountBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(unsigned int), &count);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	return count;
+}
+
+unsigned int GPUCuller::Validate(const IndirectDrawBatch& batch, const BoundingSphere* bounds, const glm::mat4& viewProjection, const HiZPyramid* previousDepth) const
+{
+	if (!m_Shader || m_MaxDrawCount != batch.GetDrawCount())
+	{
+		std::cout << "Warning: GPUCuller::Validate needs the same batch the last Cull was given! \n";
+		return batch.GetDrawCount();
+	}
+
+	unsigned int gpuCount = std::min(ReadVisibleCount(), m_MaxDrawCount);
+	std::vector<DrawElementsIndirectCommand> gpuCommands(gpuCount);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_VisibleCommandBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, gpuCount * sizeof(DrawElementsIndirectCommand), gpuCommands.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	DepthPyramid cpuDepth;
+	if (previousDepth)
+	{
+		previousDepth->ReadBack(cpuDepth);
+	}
+	std::vector<DrawElementsIndirectCommand> cpuCommands(m_MaxDrawCount);
+	unsigned int cpuCount = CullOnCPU(batch.GetCommands().data(), bounds, m_MaxDrawCount, viewProjection, previousDepth ? &cpuDepth : nullptr, cpuCommands.data());
+
+	//The GPU appends in whatever order its invocations get there, so compare which draws were kept by their baseInstance, which is unique per draw.
+	std::vector<unsigned int> gpuDraws(gpuCount), cpuDraws(cpuCount);
+	for (unsigned int i = 0; i < gpuCount; i++)
+	{
+		gpuDraws[i] = gpuCommands[i].baseInstance;
+	}
+	for (unsigned int i = 0; i < cpuCount; i++)
+	{
+		cpuDraws[i] = cpuCommands[i].baseInstance;
+	}
+	std::sort(gpuDraws.begin(), gpuDraws.end());
+	std::sort(cpuDraws.begin(), cpuDraws.end());
+	std::vector<unsigned int> mismatches;
+	std::set_symmetric_difference(gpuDraws.begin(), gpuDraws.end(), cpuDraws.begin(), cpuDraws.end(), std::back_inserter(mismatches));
+
+	if (!mismatches.empty())
+	{
+		std::cout << "Warning: GPU culling kept " << gpuCount << " draws and the CPU reference " << cpuCount << ", disagreeing on " << mismatches.size() << " of them! \n";
+	}
+	return (unsigned int)mismatches.size();
+}
+
+unsigned int GPUCuller::CullOnCPU(const DrawElementsIndirectCommand* commands, const BoundingSphere* bounds, unsigned int count, const glm::mat4& viewProjection,
+	const DepthPyramid* previousDepth, DrawElementsIndirectCommand* visibleCommands)
+{
+	Frustum frustum(viewProjection);
+	unsigned int visibleCount = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (!frustum.Intersects(bounds[i]) || (previousDepth && previousDepth->IsOccluded(bounds[i])))
+		{
+			continue;
+		}
+		visibleCommands[visibleCount++] = commands[i];
+	}
+	return visibleCount;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "IndirectDrawBatch.h"
+#include "HiZPyramid.h"
+#include "BoundingVolumes.h"
+#include "DepthPyramid.h"
+#include "glm/glm.hpp"
+
+//Decides which of an IndirectDrawBatch's draws are visible on the GPU, so the CPU never looks at them one by one. A compute shader tests each draw's bounding
+//sphere against the frustum and, if given one, the HiZPyramid built from the previous frame's depth, and compacts the survivors into an indirect buffer that
+//IndirectDrawBatch::Submit(shader, culler) draws from. The number that survived stays on the GPU too: with ARB_indirect_parameters (GL 4.6) it is read straight
+//from the buffer the culling counted into, and without it the unused commands are left zeroed, which draws nothing.
+//A typical frame: Cull against last frame's pyramid, Submit, then build the pyramid again from this frame's depth.
+class GPUCuller
+{
+public:
+	GPUCuller();
+	~GPUCuller();
+
+	GPUCuller(const GPUCuller&) = delete;
+	GPUCuller& operator=(const GPUCuller&) = delete;
+
+	//bounds holds one world space sphere per draw recorded in batch, in the same order. previousDepth can be null, or not yet built, to only frustum cull.
+	void Cull(const IndirectDrawBatch& batch, const BoundingSphere* bounds, const glm::mat4& viewProjection, const HiZPyramid* previousDepth = nullptr);
+
+	inline unsigned int GetVisibleCommandBuffer() const { return m_VisibleCommandBuffer; }
+	inline unsigned int GetDrawCountBuffer() const { return m_DrawCountBuffer; }
+	inline unsigned int GetMaxDrawCount() const { return m_MaxDrawCount; } //How many draws the last Cull tested, and so the most it could have let through.
+
+	//Both of these read results back, which waits for the GPU to finish the frame. Only for debugging and testing.
+	unsigned int ReadVisibleCount() const;
+	//Runs CullOnCPU on the same inputs as the last Cull and compares the draws each kept. Returns how many draws they disagree on, which should be 0 give or
+	//take the odd object right on the edge of a plane or an occluder, where the GPU's float maths can round the other way.
+	unsigned int Validate(const IndirectDrawBatch& batch, const BoundingSphere* bounds, const glm::mat4& viewProjection, const HiZPyramid* previousDepth = nullptr) const;
+
+	//The reference implementation of the compute shader. Writes the visible commands in their original order and returns how many there are.
+	static unsigned int CullOnCPU(const DrawElementsIndirectCommand* commands, const BoundingSphere* bounds, unsigned int count, const glm::mat4& viewProjection,
+		const DepthPyramid* previousDepth, DrawElementsIndirectCommand* visibleCommands);
+
+	static bool IsSupported(); //Compute shaders, storage buffers and multi draw indirect, so GL 4.3.
+	static bool IsDrawCountSupported();
+
+private:
+	std::unique_ptr<Shader> m_Shader; //Only loaded where IsSupported.
+	unsigned int m_BoundsBuffer = 0;
+	unsigned int m_CommandBuffer = 0;
+	unsigned int m_VisibleCommandBuffer = 0;
+	unsigned int m_DrawCountBuffer = 0;
+	size_t m_BoundsBufferCapacity = 0;
+	size_t m_CommandBufferCapacity = 0;
+	size_t m_VisibleCommandBufferCapacity = 0;
+	unsigned int m_MaxDrawCount = 0;
+};
@@ -0,0 +1,255 @@
+#include "GAAPrecompiledHeader.h"
+#include "GPUMemoryTracker.h"
+#include "RenderStats.h"
+#include "Instrumentation.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <iterator>
+
+uint64_t GPUMemoryTracker::s_FrameIndex = 0;
+std::mutex GPUMemoryTracker::s_Mutex;
+std::unordered_map<uint64_t, GPUMemoryTracker::Allocation> GPUMemoryTracker::s_Allocations;
+GPUMemoryTotals GPUMemoryTracker::s_Totals[(size_t)GPUMemoryCategory::Count];
+uint64_t GPUMemoryTracker::s_Budgets[(size_t)GPUMemoryCategory::Count] = {};
+bool GPUMemoryTracker::s_OverBudget[(size_t)GPUMemoryCategory::Count] = {};
+DriverMemoryInfo GPUMemoryTracker::s_DriverInfo;
+
+namespace
+{
+	struct CategoryName
+	{
+		const char* name;
+		const char* counterName; //What the category's counter is called in the trace.
+	};
+
+	//In the same order as GPUMemoryCategory.
+	const CategoryName s_CategoryNames[(size_t)GPUMemoryCategory::Count] =
+	{
+		{ "Mesh", "GPU Memory Mesh" },
+		{ "Texture", "GPU Memory Texture" },
+		{ "Render Target", "GPU Memory Render Target" },
+		{ "UI", "GPU Memory UI" },
+		{ "Transient", "GPU Memory Transient" }
+	};
+
+	static_assert((size_t)RenderStat::TransientMemory - (size_t)RenderStat::MeshMemory + 1 == (size_t)GPUMemoryCategory::Count, "RenderStats has a memory stat per category, in the same order.");
+
+	double ToMegabytes(uint64_t bytes)
+	{
+		return (double)bytes / (1024.0 * 1024.0);
+	}
+}
+
+void GPUMemoryTracker::Track(GLObjectType type, unsigned int rendererID, GPUMemoryCategory category, uint64_t size)
+{
+	if (rendererID == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	auto result = s_Allocations.emplace(MakeKey(type, rendererID), Allocation{ category, size });
+	if (!result.second)
+	{
+		GPUMemoryTotals& previous = s_Totals[(size_t)result.first->second.category];
+		previous.bytes -= result.first->second.size;
+		previous.allocationCount--;
+		result.first->second = Allocation{ category, size };
+	}
+	s_Totals[(size_t)category].bytes += size;
+	s_Totals[(size_t)category].allocationCount++;
+}
+
+void GPUMemoryTracker::Untrack(GLObjectType type, unsigned int rendererID)
+{
+	OnObjectsDeleted(type, &rendererID, 1);
+}
+
+void GPUMemoryTracker::OnObjectsDeleted(GLObjectType type, const unsigned int* rendererIDs, size_t count)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	for (size_t i = 0; i < count; i++)
+	{
+		auto iterator = s_Allocations.find(MakeKey(type, rendererIDs[i]));
+		if (iterator == s_Allocations.end())
+		{
+			continue; //Never tracked, like the vertex arrays and samplers that go through the queue too.
+		}
+		GPUMemoryTotals& totals = s_Totals[(size_t)iterator->second.category];
+		totals.bytes -= iterator->second.size;
+		totals.allocationCount--;
+		s_Allocations.erase(iterator);
+	}
+}
+
+void GPUMemoryTracker::EndFrame()
+{
+	//Asking the driver is a round trip into it, and the numbers don't move much from one frame to the next, so we don't do it every frame.
+	if (s_FrameIndex++ % s_DriverQueryInterval == 0)
+	{
+		QueryDriver();
+	}
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	for (size_t i = 0; i < (size_t)GPUMemoryCategory::Count; i++)
+	{
+		//Memory is a level rather than a count, so it's set again every frame.
+		RenderStats::Set((RenderStat)((size_t)RenderStat::MeshMemory + i), s_Totals[i].bytes);
+		GAA_PROFILE_COUNTER(s_CategoryNames[i].counterName, s_Totals[i].bytes);
+
+		bool overBudget = s_Budgets[i] != 0 && s_Totals[i].bytes > s_Budgets[i];
+		if (overBudget && !s_OverBudget[i])
+		{
+			std::cout << "Warning: " << s_CategoryNames[i].name << " GPU memory is at " << ToMegabytes(s_Totals[i].bytes) << " MB, over its budget of "
+				<< ToMegabytes(s_Budgets[i]) << " MB! \n";
+		}
+		s_OverBudget[i] = overBudget;
+	}
+	if (s_DriverInfo.currentAvailableKB >= 0)
+	{
+		RenderStats::Set(RenderStat::DriverFreeMemory, (uint64_t)s_DriverInfo.currentAvailableKB * 1024);
+		GAA_PROFILE_COUNTER("GPU Memory Driver Free", (uint64_t)s_DriverInfo.currentAvailableKB * 1024);
+	}
+}
+
+GPUMemoryTotals GPUMemoryTracker::GetTotals(GPUMemoryCategory category)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	return s_Totals[(size_t)category];
+}
+
+uint64_t GPUMemoryTracker::GetTotalBytes()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	uint64_t bytes = 0;
+	for (const GPUMemoryTotals& totals : s_Totals)
+	{
+		bytes += totals.bytes;
+	}
+	return bytes;
+}
+
+DriverMemoryInfo GPUMemoryTracker::GetDriverMemoryInfo()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	return s_DriverInfo;
+}
+
+void GPUMemoryTracker::SetBudget(GPUMemoryCategory category, uint64_t bytes)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_Budgets[(size_t)category] = bytes;
+}
+
+const char* GPUMemoryTracker::GetCategoryName(GPUMemoryCategory category)
+{
+	return category < GPUMemoryCategory::Count ? s_CategoryNames[(size_t)category].name : "";
+}
+
+void GPUMemoryTracker::QueryDriver()
+{
+	DriverMemoryInfo info;
+	if (GLEW_NVX_gpu_memory_info)
+	{
+		GLint value = 0;
+		info.source = "NVX_gpu_memory_info";
+		glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &value);
+		info.dedicatedKB = value;
+		glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &value);
+		info.totalAvailableKB = value;
+		glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &value);
+		info.currentAvailableKB = value;
+		glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTION_COUNT_NVX, &value);
+		info.evictionCount = value;
+		glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, &value);
+		info.evictedKB = value;
+	}
+	else if (GLEW_ATI_meminfo)
+	{
+		//Each pool gives back its total free memory, its largest free block, and the same two for auxiliary memory. The pools may well be the same memory.
+		GLint values[4] = {};
+		info.source = "ATI_meminfo";
+		glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, values);
+		info.currentAvailableKB = values[0];
+	}
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_DriverInfo = info;
+}
+
+void GPUMemoryTracker::OnImGuiRender()
+{
+	GPUMemoryTotals totals[(size_t)GPUMemoryCategory::Count];
+	uint64_t budgets[(size_t)GPUMemoryCategory::Count];
+	DriverMemoryInfo driverInfo;
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		std::copy(std::begin(s_Totals), std::end(s_Totals), totals);
+		std::copy(std::begin(s_Budgets), std::end(s_Budgets), budgets);
+		driverInfo = s_DriverInfo;
+	}
+
+	ImGui::Begin("GPU Memory");
+	ImGui::Columns(4, "GPUMemoryColumns", false);
+	ImGui::Text("Category");
+	ImGui::NextColumn();
+	ImGui::Text("MB");
+	ImGui::NextColumn();
+	ImGui::Text("Objects");
+	ImGui::NextColumn();
+	ImGui::Text("Budget");
+	ImGui::NextColumn();
+	uint64_t totalBytes = 0;
+	for (size_t i = 0; i < (size_t)GPUMemoryCategory::Count; i++)
+	{
+		totalBytes += totals[i].bytes;
+		ImGui::Text("%s", s_CategoryNames[i].name);
+		ImGui::NextColumn();
+		if (budgets[i] != 0 && totals[i].bytes > budgets[i])
+		{
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%.2f", ToMegabytes(totals[i].bytes));
+		}
+		else
+		{
+			ImGui::Text("%.2f", ToMegabytes(totals[i].bytes));
+		}
+		ImGui::NextColumn();
+		ImGui::Text("%llu", (unsigned long long)totals[i].allocationCount);
+		ImGui::NextColumn();
+		if (budgets[i] != 0)
+		{
+			ImGui::Text("%.2f", ToMegabytes(budgets[i]));
+		}
+		else
+		{
+			ImGui::Text("-");
+		}
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+	ImGui::Separator();
+	ImGui::Text("Tracked: %.2f MB", ToMegabytes(totalBytes));
+
+	if (driverInfo.source == nullptr)
+	{
+		ImGui::Text("The driver doesn't report its memory (no NVX_gpu_memory_info or ATI_meminfo).");
+	}
+	else
+	{
+		ImGui::Text("Driver (%s):", driverInfo.source);
+		if (driverInfo.dedicatedKB >= 0)
+		{
+			ImGui::Text("Dedicated: %.2f MB", driverInfo.dedicatedKB / 1024.0);
+		}
+		if (driverInfo.totalAvailableKB >= 0)
+		{
+			ImGui::Text("Total Available: %.2f MB", driverInfo.totalAvailableKB / 1024.0);
+		}
+		ImGui::Text("Free: %.2f MB", driverInfo.currentAvailableKB / 1024.0);
+		if (driverInfo.evictionCount >= 0)
+		{
+			ImGui::Text("Evictions: %lld (%.2f MB)", (long long)driverInfo.evictionCount, driverInfo.evictedKB / 1024.0);
+		}
+	}
+	ImGui::End();
+}
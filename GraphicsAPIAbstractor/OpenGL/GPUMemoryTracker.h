@@ -0,0 +1,78 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "DeletionQueue.h"
+#include <cstdint>
+#include <mutex>
+
+enum class GPUMemoryCategory : unsigned int
+{
+	Mesh = 0, //Vertex and index buffers.
+	Texture,
+	RenderTarget, //Textures the GPU draws or computes into, like the Hi-Z pyramid.
+	UI,
+	Transient, //Buffers rewritten every frame, like indirect commands and per-draw data.
+	Count
+};
+
+struct GPUMemoryTotals
+{
+	uint64_t bytes = 0;
+	uint64_t allocationCount = 0;
+};
+
+//What the driver itself says about video memory, through NVX_gpu_memory_info or ATI_meminfo. Values a driver doesn't report stay at -1.
+struct DriverMemoryInfo
+{
+	const char* source = nullptr; //"NVX_gpu_memory_info", "ATI_meminfo", or null when neither is supported.
+	int64_t dedicatedKB = -1; //NVX only.
+	int64_t totalAvailableKB = -1; //NVX only.
+	int64_t currentAvailableKB = -1; //For ATI, the free memory in the texture pool.
+	int64_t evictionCount = -1; //NVX only. Anything above 0 means the driver has already been paging us out.
+	int64_t evictedKB = -1; //NVX only.
+};
+
+//Keeps the size and category of every buffer and texture we allocate, so we know where our video memory goes. Allocations are tagged where they're made
+//(Mesh in VertexBuffer and IndexBuffer, Texture in Texture and TextureStreamer and so on), and DeletionQueue takes them off again as it deletes the objects.
+//Once a frame, EndFrame publishes the totals to RenderStats and the trace, and every s_DriverQueryInterval frames it asks the driver how much it has left.
+//Setting a budget per category prints a warning the frame a category goes over it, long before the driver would start paging.
+class GPUMemoryTracker
+{
+public:
+	//Any thread. Tracking an object that is already tracked replaces its size and category, which is how respecified storage is handled.
+	static void Track(GLObjectType type, unsigned int rendererID, GPUMemoryCategory category, uint64_t size);
+	static void Untrack(GLObjectType type, unsigned int rendererID); //Only for objects something other than DeletionQueue deletes, such as ImGui's.
+	static void OnObjectsDeleted(GLObjectType type, const unsigned int* rendererIDs, size_t count); //Called by DeletionQueue.
+
+	static void EndFrame(); //GL thread, from OpenGLRenderer::EndFrame.
+
+	//Any thread.
+	static GPUMemoryTotals GetTotals(GPUMemoryCategory category);
+	static uint64_t GetTotalBytes();
+	static DriverMemoryInfo GetDriverMemoryInfo(); //As of the last query.
+	static void SetBudget(GPUMemoryCategory category, uint64_t bytes); //0, the default, means no budget.
+
+	static const char* GetCategoryName(GPUMemoryCategory category);
+
+	static void OnImGuiRender(); //A "GPU Memory" window. Main thread, between ImGui::NewFrame and ImGui::Render.
+
+	static constexpr unsigned int s_DriverQueryInterval = 30; //Frames.
+
+private:
+	struct Allocation
+	{
+		GPUMemoryCategory category;
+		uint64_t size;
+	};
+
+	inline static uint64_t MakeKey(GLObjectType type, unsigned int rendererID) { return ((uint64_t)type << 32) | rendererID; }
+	static void QueryDriver();
+
+	static uint64_t s_FrameIndex; //GL thread only.
+
+	static std::mutex s_Mutex; //Guards everything below.
+	static std::unordered_map<uint64_t, Allocation> s_Allocations;
+	static GPUMemoryTotals s_Totals[(size_t)GPUMemoryCategory::Count];
+	static uint64_t s_Budgets[(size_t)GPUMemoryCategory::Count];
+	static bool s_OverBudget[(size_t)GPUMemoryCategory::Count]; //So we only warn when a category goes over, not every frame it stays over.
+	static DriverMemoryInfo s_DriverInfo;
+};
@@ -0,0 +1,290 @@
+#include "GAAPrecompiledHeader.h"
+#include "GPUProfiler.h"
+#include "GL/glew.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <cstring>
+
+GPUProfiler::FrameQueries GPUProfiler::s_Frames[GPUProfiler::s_FrameLatency];
+uint64_t GPUProfiler::s_FrameIndex = 0;
+bool GPUProfiler::s_InFrame = false;
+std::vector<int> GPUProfiler::s_OpenScopes;
+std::vector<GPUProfiler::Node> GPUProfiler::s_Nodes;
+std::vector<int> GPUProfiler::s_FrameScopeNodes;
+uint64_t GPUProfiler::s_ReadBackCount = 1;
+std::atomic<uint64_t> GPUProfiler::s_DroppedFrameCount(0);
+std::mutex GPUProfiler::s_StatisticsMutex;
+std::vector<GPUProfiler::ScopeStatistics> GPUProfiler::s_Building;
+std::vector<GPUProfiler::ScopeStatistics> GPUProfiler::s_Published;
+
+void GPUProfiler::BeginFrame()
+{
+	if (s_InFrame)
+	{
+		std::cout << "Warning: GPUProfiler::BeginFrame was called twice without an EndFrame in between! \n";
+		return;
+	}
+
+	//This slot was last used s_FrameLatency frames ago. Timestamps are written in order, so once the frame's last one is there, all of them are.
+	FrameQueries& frame = s_Frames[s_FrameIndex % s_FrameLatency];
+	if (!frame.scopes.empty())
+	{
+		GLint available = 0;
+		glGetQueryObjectiv(frame.queries[frame.usedQueryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			ReadBack(frame);
+		}
+		else
+		{
+			s_DroppedFrameCount.fetch_add(1, std::memory_order_relaxed); //Reading it now would stall until the GPU catches up, which is what we're avoiding.
+		}
+	}
+	frame.usedQueryCount = 0;
+	frame.scopes.clear();
+	s_OpenScopes.clear();
+
+	s_InFrame = true;
+	BeginScope("Frame");
+}
+
+void GPUProfiler::EndFrame()
+{
+	if (!s_InFrame)
+	{
+		return;
+	}
+
+	if (s_OpenScopes.size() > 1)
+	{
+		std::cout << "Warning: " << s_OpenScopes.size() - 1 << " GPU profile scopes were still open at the end of the frame! \n";
+		while (s_OpenScopes.size() > 1)
+		{
+			EndScope();
+		}
+	}
+	EndScope();
+	s_InFrame = false;
+	s_FrameIndex++;
+}
+
+void GPUProfiler::BeginScope(const char* name)
+{
+	if (!s_InFrame)
+	{
+		return;
+	}
+
+	FrameQueries& frame = s_Frames[s_FrameIndex % s_FrameLatency];
+	FrameScope scope;
+	scope.name = name;
+	scope.parent = s_OpenScopes.empty() ? -1 : s_OpenScopes.back();
+	scope.beginQuery = WriteTimestamp(frame);
+	scope.endQuery = scope.beginQuery;
+	s_OpenScopes.push_back((int)frame.scopes.size());
+	frame.scopes.push_back(scope);
+}
+
+void GPUProfiler::EndScope()
+{
+	if (!s_InFrame)
+	{
+		return;
+	}
+	if (s_OpenScopes.empty())
+	{
+		std::cout << "Warning: GPUProfiler::EndScope was called without a scope to end! \n";
+		return;
+	}
+
+	FrameQueries& frame = s_Frames[s_FrameIndex % s_FrameLatency];
+	frame.scopes[s_OpenScopes.back()].endQuery = WriteTimestamp(frame);
+	s_OpenScopes.pop_back();
+}
+
+void GPUProfiler::Shutdown()
+{
+	for (FrameQueries& frame : s_Frames)
+	{
+		if (!frame.queries.empty())
+		{
+			glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+		}
+		frame.queries.clear();
+		frame.usedQueryCount = 0;
+		frame.scopes.clear();
+	}
+	s_Nodes.clear();
+	s_OpenScopes.clear();
+	s_InFrame = false;
+}
+
+void GPUProfiler::GetStatistics(std::vector<ScopeStatistics>& statistics)
+{
+	std::lock_guard<std::mutex> lock(s_StatisticsMutex);
+	statistics = s_Published; //Assigning keeps the caller's capacity, so polling every frame doesn't allocate.
+}
+
+void GPUProfiler::OnImGuiRender()
+{
+	static std::vector<ScopeStatistics> statistics;
+	GetStatistics(statistics);
+
+	ImGui::Begin("GPU Profiler");
+	if (statistics.empty())
+	{
+		ImGui::Text("Waiting for the first frames to come back from the GPU...");
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Text("Over the last %u frames, read back %u frames late. Dropped frames: %llu", s_HistoryLength, s_FrameLatency, (unsigned long long)GetDroppedFrameCount());
+	ImGui::Columns(5, "GPUProfilerColumns");
+	ImGui::Text("Scope");
+	ImGui::NextColumn();
+	ImGui::Text("Last (ms)");
+	ImGui::NextColumn();
+	ImGui::Text("Min (ms)");
+	ImGui::NextColumn();
+	ImGui::Text("Avg (ms)");
+	ImGui::NextColumn();
+	ImGui::Text("Max (ms)");
+	ImGui::NextColumn();
+	ImGui::Separator();
+	for (const ScopeStatistics& scope : statistics)
+	{
+		ImGui::Text("%*s%s", (int)scope.depth * 2, "", scope.name); //Children indented under their parents.
+		ImGui::NextColumn();
+		ImGui::Text("%.3f", scope.lastMilliseconds);
+		ImGui::NextColumn();
+		ImGui::Text("%.3f", scope.minimumMilliseconds);
+		ImGui::NextColumn();
+		ImGui::Text("%.3f", scope.averageMilliseconds);
+		ImGui::NextColumn();
+		ImGui::Text("%.3f", scope.maximumMilliseconds);
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+	ImGui::End();
+}
+
+unsigned int GPUProfiler::WriteTimestamp(FrameQueries& frame)
+{
+	if (frame.usedQueryCount == frame.queries.size())
+	{
+		unsigned int query;
+		glGenQueries(1, &query);
+		frame.queries.push_back(query);
+	}
+	glQueryCounter(frame.queries[frame.usedQueryCount], GL_TIMESTAMP); //Written once the GPU has finished everything before it, without blocking anything.
+	return frame.usedQueryCount++;
+}
+
+void GPUProfiler::ReadBack(FrameQueries& frame)
+{
+	s_FrameScopeNodes.resize(frame.scopes.size());
+	for (size_t i = 0; i < frame.scopes.size(); i++)
+	{
+		const FrameScope& scope = frame.scopes[i];
+		int node = FindOrAddNode(scope.parent < 0 ? -1 : s_FrameScopeNodes[scope.parent], scope.name);
+		s_FrameScopeNodes[i] = node;
+
+		//Timestamps are in nanoseconds.
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(frame.queries[scope.beginQuery], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(frame.queries[scope.endQuery], GL_QUERY_RESULT, &end);
+
+		//A scope that ran more than once in the frame, say once per object, adds up into one sample.
+		Node& statistics = s_Nodes[node];
+		float milliseconds = (float)(end - begin) / 1000000.0f;
+		if (statistics.lastReadBack != s_ReadBackCount)
+		{
+			statistics.lastReadBack = s_ReadBackCount;
+			statistics.history[statistics.historyCursor] = milliseconds;
+			statistics.historyCursor = (statistics.historyCursor + 1) % s_HistoryLength;
+			statistics.historyCount = std::min(statistics.historyCount + 1, s_HistoryLength);
+		}
+		else
+		{
+			statistics.history[(statistics.historyCursor + s_HistoryLength - 1) % s_HistoryLength] += milliseconds;
+		}
+	}
+
+	s_ReadBackCount++;
+
+	s_Building.clear();
+	for (size_t i = 0; i < s_Nodes.size(); i++)
+	{
+		if (s_Nodes[i].parent < 0)
+		{
+			PublishNode((int)i);
+		}
+	}
+	std::lock_guard<std::mutex> lock(s_StatisticsMutex);
+	s_Published.swap(s_Building);
+}
+
+int GPUProfiler::FindOrAddNode(int parent, const char* name)
+{
+	//Names are compared by content, as the same literal can have a different address in every file it is used in.
+	if (parent < 0)
+	{
+		for (size_t i = 0; i < s_Nodes.size(); i++)
+		{
+			if (s_Nodes[i].parent < 0 && strcmp(s_Nodes[i].name, name) == 0)
+			{
+				return (int)i;
+			}
+		}
+	}
+	else
+	{
+		for (int child : s_Nodes[parent].children)
+		{
+			if (strcmp(s_Nodes[child].name, name) == 0)
+			{
+				return child;
+			}
+		}
+	}
+
+	Node node;
+	node.name = name;
+	node.parent = parent;
+	node.depth = parent < 0 ? 0 : s_Nodes[parent].depth + 1;
+	s_Nodes.push_back(node);
+	int index = (int)s_Nodes.size() - 1;
+	if (parent >= 0)
+	{
+		s_Nodes[parent].children.push_back(index);
+	}
+	return index;
+}
+
+void GPUProfiler::PublishNode(int node)
+{
+	const Node& source = s_Nodes[node];
+	if (source.historyCount > 0)
+	{
+		ScopeStatistics statistics;
+		statistics.name = source.name;
+		statistics.depth = source.depth;
+		statistics.lastMilliseconds = source.history[(source.historyCursor + s_HistoryLength - 1) % s_HistoryLength];
+		statistics.minimumMilliseconds = source.history[0];
+		statistics.maximumMilliseconds = source.history[0];
+		float total = 0.0f;
+		for (unsigned int i = 0; i < source.historyCount; i++)
+		{
+			statistics.minimumMilliseconds = std::min(statistics.minimumMilliseconds, source.history[i]);
+			statistics.maximumMilliseconds = std::max(statistics.maximumMilliseconds, source.history[i]);
+			total += source.history[i];
+		}
+		statistics.averageMilliseconds = total / source.historyCount;
+		s_Building.push_back(statistics);
+	}
+
+	for (int child : source.children)
+	{
+		PublishNode(child);
+	}
+}
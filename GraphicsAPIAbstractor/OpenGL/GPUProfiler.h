@@ -0,0 +1,100 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+//Times passes on the GPU with GL_TIMESTAMP queries written before and after each scope. Timestamps rather than GL_TIME_ELAPSED, as only one elapsed query
+//can be running at a time, which rules out nesting. The GPU writes the results whenever it gets to them, so each frame's queries are only read back
+//s_FrameLatency frames later, by which point they are done. If they still aren't, that frame's results are dropped rather than waited for.
+//Scopes nest into a tree with the frame at its root. Every node keeps its last s_HistoryLength times for a rolling minimum, average and maximum.
+//Scopes only time anything between BeginFrame and EndFrame, which the RenderThread calls around every frame it renders.
+class GPUProfiler
+{
+public:
+	struct ScopeStatistics
+	{
+		const char* name;
+		unsigned int depth; //0 for the frame itself.
+		float lastMilliseconds, minimumMilliseconds, averageMilliseconds, maximumMilliseconds;
+	};
+
+	//GL thread only, from here on down to GetStatistics.
+	static void BeginFrame();
+	static void EndFrame();
+
+	//name has to stay valid for as long as the profiler runs, which string literals do. Scopes with the same name under the same parent share one node.
+	static void BeginScope(const char* name);
+	static void EndScope();
+
+	static void Shutdown(); //Deletes the queries. Called from OpenGLRenderer::Shutdown.
+
+	//Any thread. Fills statistics with every node, depth first, in the order their scopes first ran.
+	static void GetStatistics(std::vector<ScopeStatistics>& statistics);
+	inline static uint64_t GetDroppedFrameCount() { return s_DroppedFrameCount.load(std::memory_order_relaxed); } //Frames whose queries weren't done in time.
+
+	static void OnImGuiRender(); //The "GPU Profiler" window. Main thread, between ImGui::NewFrame and ImGui::Render.
+
+	static constexpr unsigned int s_FrameLatency = 4;
+	static constexpr unsigned int s_HistoryLength = 128;
+
+private:
+	//One scope as it ran in one frame.
+	struct FrameScope
+	{
+		const char* name;
+		int parent; //Index into the same frame's scopes, or -1.
+		unsigned int beginQuery, endQuery; //Indices into the frame's query pool.
+	};
+
+	struct FrameQueries
+	{
+		std::vector<unsigned int> queries; //Grows to however many the busiest frame needed, and is reused from then on.
+		unsigned int usedQueryCount = 0;
+		std::vector<FrameScope> scopes;
+	};
+
+	struct Node
+	{
+		const char* name;
+		int parent;
+		unsigned int depth;
+		std::vector<int> children;
+		float history[s_HistoryLength];
+		unsigned int historyCount = 0, historyCursor = 0;
+		uint64_t lastReadBack = 0; //Which ReadBack last added a sample, so repeats within a frame add to it instead.
+	};
+
+	static unsigned int WriteTimestamp(FrameQueries& frame);
+	static void ReadBack(FrameQueries& frame);
+	static int FindOrAddNode(int parent, const char* name);
+	static void PublishNode(int node);
+
+	static FrameQueries s_Frames[s_FrameLatency];
+	static uint64_t s_FrameIndex;
+	static bool s_InFrame;
+	static std::vector<int> s_OpenScopes; //Indices into the current frame's scopes.
+	static std::vector<Node> s_Nodes; //s_Nodes[0] is the frame, once there is one.
+	static std::vector<int> s_FrameScopeNodes; //Scratch for ReadBack.
+	static uint64_t s_ReadBackCount;
+	static std::atomic<uint64_t> s_DroppedFrameCount;
+
+	static std::mutex s_StatisticsMutex;
+	static std::vector<ScopeStatistics> s_Building;
+	static std::vector<ScopeStatistics> s_Published; //Guarded by s_StatisticsMutex. Swapped with s_Building once per frame.
+};
+
+//Times everything from here to the end of the enclosing block on the GPU. GL thread only.
+class GPUProfileScope
+{
+public:
+	GPUProfileScope(const char* name) { GPUProfiler::BeginScope(name); }
+	~GPUProfileScope() { GPUProfiler::EndScope(); }
+
+	GPUProfileScope(const GPUProfileScope&) = delete;
+	GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+};
+
+#define GPU_PROFILE_CONCATENATE_INNER(a, b) a##b
+#define GPU_PROFILE_CONCATENATE(a, b) GPU_PROFILE_CONCATENATE_INNER(a, b)
+#define GPU_PROFILE_SCOPE(name) GPUProfileScope GPU_PROFILE_CONCATENATE(gpuProfileScope, __LINE__)(name)
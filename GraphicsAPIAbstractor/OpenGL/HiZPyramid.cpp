@@ -0,0 +1,122 @@
+#include "GAAPrecompiledHeader.h"
+#include "HiZPyramid.h"
+#include "DeletionQueue.h"
+#include "SamplerCache.h"
+#include "GPUProfiler.h"
+#include "RenderStats.h"
+#include "GPUMemoryTracker.h"
+#include "GL/glew.h"
+
+static constexpr unsigned int s_GroupSize = 8; //local_size_x and y in HiZPyramid.shader.
+
+bool HiZPyramid::IsSupported()
+{
+	return GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_shader_image_load_store && GLEW_ARB_texture_storage);
+}
+
+HiZPyramid::HiZPyramid()
+{
+	if (IsSupported())
+	{
+		m_Shader = std::make_unique<Shader>("OpenGL/Shaders/HiZPyramid.shader");
+	}
+}
+
+HiZPyramid::~HiZPyramid()
+{
+	DeletionQueue::Enqueue(GLObjectType::Texture, m_DepthTexture);
+	DeletionQueue::Enqueue(GLObjectType::Texture, m_Texture);
+}
+
+void HiZPyramid::Allocate(unsigned int width, unsigned int height)
+{
+	DeletionQueue::Enqueue(GLObjectType::Texture, m_DepthTexture);
+	DeletionQueue::Enqueue(GLObjectType::Texture, m_Texture);
+	m_Width = width;
+	m_Height = height;
+	m_LevelCount = DepthPyramid::CalculateLevelCount(width, height);
+
+	//Immutable storage, as glTexStorage2D gives us every level up front and we only ever write into them.
+	glGenTextures(1, &m_DepthTexture);
+	glBindTexture(GL_TEXTURE_2D, m_DepthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenTextures(1, &m_Texture);
+	glBindTexture(GL_TEXTURE_2D, m_Texture);
+	glTexStorage2D(GL_TEXTURE_2D, m_LevelCount, GL_R32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	//Both are 4 bytes a texel, and a full mip chain adds up to a third on top of its top level.
+	uint64_t levelZeroBytes = (uint64_t)width * height * 4;
+	RenderStats::Add(RenderStat::TextureAllocations, 2);
+	RenderStats::Add(RenderStat::TextureBytesAllocated, levelZeroBytes + levelZeroBytes * 4 / 3);
+	GPUMemoryTracker::Track(GLObjectType::Texture, m_DepthTexture, GPUMemoryCategory::RenderTarget, levelZeroBytes);
+	GPUMemoryTracker::Track(GLObjectType::Texture, m_Texture, GPUMemoryCategory::RenderTarget, levelZeroBytes * 4 / 3);
+}
+
+void HiZPyramid::Build(unsigned int width, unsigned int height, const glm::mat4& viewProjection)
+{
+	if (!m_Shader || width == 0 || height == 0)
+	{
+		return;
+	}
+	GPU_PROFILE_SCOPE("Hi-Z Pyramid");
+	if (width != m_Width || height != m_Height || m_Texture == 0)
+	{
+		Allocate(width, height);
+	}
+	m_ViewProjection = viewProjection;
+
+	glBindTexture(GL_TEXTURE_2D, m_DepthTexture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+	m_Shader->Bind();
+	glActiveTexture(GL_TEXTURE0);
+	SamplerCache::Unbind(0); //A sampler left on the slot would override ours, and a mipmapping one would make the single level depth texture incomplete.
+	m_Shader->SetUniform1i("u_Depth", 0);
+
+	for (unsigned int level = 0; level < m_LevelCount; level++)
+	{
+		unsigned int levelWidth = std::max(width >> level, 1u), levelHeight = std::max(height >> level, 1u);
+		m_Shader->SetUniform1i("u_CopyDepth", level == 0);
+		if (level > 0)
+		{
+			glBindImageTexture(0, m_Texture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		}
+		glBindImageTexture(1, m_Texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glDispatchCompute((levelWidth + s_GroupSize - 1) / s_GroupSize, (levelHeight + s_GroupSize - 1) / s_GroupSize, 1);
+		RenderStats::Add(RenderStat::ComputeDispatches);
+		//Each level reads the one before, so its writes have to land first.
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT); //And the culling reads it through texelFetch.
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void HiZPyramid::Bind(unsigned int slot) const
+{
+	glActiveTexture(GL_TEXTURE0 + slot);
+	glBindTexture(GL_TEXTURE_2D, m_Texture);
+	SamplerCache::Unbind(slot); //Through the cache, so the next Texture::Bind on this slot knows to bind its sampler again.
+	RenderStats::Add(RenderStat::TextureBinds);
+	RenderStats::Add(RenderStat::SamplerBinds);
+}
+
+void HiZPyramid::ReadBack(DepthPyramid& pyramid) const
+{
+	if (!IsValid())
+	{
+		pyramid.Clear();
+		return;
+	}
+	std::vector<float> depth((size_t)m_Width * m_Height);
+	glBindTexture(GL_TEXTURE_2D, m_Texture);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, depth.data());
+	glBindTexture(GL_TEXTURE_2D, 0);
+	pyramid.Build(depth.data(), m_Width, m_Height, m_ViewProjection);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "Shader.h"
+#include "DepthPyramid.h"
+#include "glm/glm.hpp"
+
+//The GPU's DepthPyramid: a mip chain of the farthest depth, built by compute shaders from the depth buffer at the end of a frame so that next frame's
+//GPUCuller can test against it without any of it coming back to the CPU. Objects are reprojected through the view projection it was built with, so a moving
+//camera still culls correctly against last frame's depth, give or take what moved.
+class HiZPyramid
+{
+public:
+	HiZPyramid();
+	~HiZPyramid();
+
+	HiZPyramid(const HiZPyramid&) = delete;
+	HiZPyramid& operator=(const HiZPyramid&) = delete;
+
+	//Copies the depth of the framebuffer bound for reading and reduces it. viewProjection is what that depth was drawn with. Reallocates if the size changed.
+	void Build(unsigned int width, unsigned int height, const glm::mat4& viewProjection);
+	void Bind(unsigned int slot) const; //For texelFetch, with each level's texels at that level.
+	void ReadBack(DepthPyramid& pyramid) const; //Rebuilds the same pyramid on the CPU from level 0, for validation. Stalls until the GPU catches up.
+
+	inline bool IsValid() const { return m_Texture != 0; } //Built at least once.
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetLevelCount() const { return m_LevelCount; }
+	inline const glm::mat4& GetViewProjection() const { return m_ViewProjection; }
+
+	//Compute shaders and image load/store, both of which GL 4.3 has.
+	static bool IsSupported();
+
+private:
+	void Allocate(unsigned int width, unsigned int height);
+
+	std::unique_ptr<Shader> m_Shader; //Only loaded where IsSupported.
+	unsigned int m_DepthTexture = 0; //The copy of the depth buffer. The default framebuffer's own can't be sampled.
+	unsigned int m_Texture = 0; //R32F, every level.
+	unsigned int m_Width = 0, m_Height = 0, m_LevelCount = 0;
+	glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+};
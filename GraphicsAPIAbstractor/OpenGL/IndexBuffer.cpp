@@ -1,5 +1,8 @@
 #include "GAAPrecompiledHeader.h"
 #include "IndexBuffer.h"
+#include "DeletionQueue.h"
+#include "RenderStats.h"
+#include "GPUMemoryTracker.h"
 #include "GL/glew.h"
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count) : m_Count(count)
@@ -7,16 +10,43 @@ IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count) : m_Count
     glGenBuffers(1, &m_RendererID);         
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);  
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
+    RenderStats::Add(RenderStat::BufferAllocations);
+    RenderStats::Add(RenderStat::BufferBytesAllocated, count * sizeof(unsigned int));
+    GPUMemoryTracker::Track(GLObjectType::Buffer, m_RendererID, GPUMemoryCategory::Mesh, count * sizeof(unsigned int));
+    if (data != nullptr)
+    {
+        RenderStats::Add(RenderStat::BytesUploaded, count * sizeof(unsigned int));
+    }
 }
 
 IndexBuffer::~IndexBuffer()
 {
-    glDeleteBuffers(1, &m_RendererID);
+    DeletionQueue::Enqueue(GLObjectType::Buffer, m_RendererID);
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept : m_RendererID(other.m_RendererID), m_Count(other.m_Count)
+{
+    other.m_RendererID = 0;
+    other.m_Count = 0;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        DeletionQueue::Enqueue(GLObjectType::Buffer, m_RendererID);
+        m_RendererID = other.m_RendererID;
+        m_Count = other.m_Count;
+        other.m_RendererID = 0;
+        other.m_Count = 0;
+    }
+    return *this;
 }
 
 void IndexBuffer::Bind() const
 {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);  //OpenGL will always select whatever is bound to the buffer and do your commands with it.
+    RenderStats::Add(RenderStat::BufferBinds);
 }
 
 void IndexBuffer::Unbind() const
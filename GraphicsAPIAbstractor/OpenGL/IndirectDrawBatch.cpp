@@ -0,0 +1,205 @@
+#include "GAAPrecompiledHeader.h"
+#include "IndirectDrawBatch.h"
+#include "DeletionQueue.h"
+#include "GPUCuller.h"
+#include "GPUProfiler.h"
+#include "RenderStats.h"
+#include "GPUMemoryTracker.h"
+#include <algorithm>
+
+bool IndirectDrawBatch::IsMultiDrawSupported()
+{
+	return GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+}
+
+IndirectDrawBatch::IndirectDrawBatch(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout, const VertexBufferLayout& perDrawLayout)
+	: m_VertexAttributeCount((unsigned int)layout.GetElements().size()), m_PerDrawLayout(perDrawLayout)
+{
+	//Our own vertex array rather than one from the VertexArrayCache, as the per-draw attributes read from a second buffer the cache knows nothing about.
+	glGenVertexArrays(1, &m_VertexArray);
+	glGenBuffers(1, &m_PerDrawBuffer);
+	glBindVertexArray(m_VertexArray);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer.GetRendererID());
+	const auto& elements = layout.GetElements();
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		glEnableVertexAttribArray(i);
+		glVertexAttribPointer(i, elements[i].count, elements[i].type, elements[i].normalized, layout.GetStride(), (const void*)(uintptr_t)elements[i].offset);
+	}
+
+	//A divisor of 1 advances the per-draw attributes once per instance rather than per vertex, starting from the draw's baseInstance.
+	glBindBuffer(GL_ARRAY_BUFFER, m_PerDrawBuffer);
+	for (unsigned int i = 0; i < m_PerDrawLayout.GetElements().size(); i++)
+	{
+		glEnableVertexAttribArray(m_VertexAttributeCount + i);
+		glVertexAttribDivisor(m_VertexAttributeCount + i, 1);
+	}
+	SetPerDrawAttributes(0);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.GetRendererID());
+	glBindVertexArray(0);
+
+	if (IsMultiDrawSupported())
+	{
+		glGenBuffers(1, &m_IndirectBuffer);
+	}
+}
+
+IndirectDrawBatch::~IndirectDrawBatch()
+{
+	DeletionQueue::Enqueue(GLObjectType::VertexArray, m_VertexArray);
+	DeletionQueue::Enqueue(GLObjectType::Buffer, m_PerDrawBuffer);
+	DeletionQueue::Enqueue(GLObjectType::Buffer, m_IndirectBuffer);
+}
+
+void IndirectDrawBatch::Clear()
+{
+	m_Commands.clear();
+	m_PerDrawData.clear();
+}
+
+unsigned int IndirectDrawBatch::AddDraw(unsigned int indexCount, unsigned int firstIndex, int baseVertex, const void* perDrawData)
+{
+	unsigned int drawIndex = (unsigned int)m_Commands.size();
+	m_Commands.push_back({ indexCount, 1, firstIndex, baseVertex, drawIndex }); //baseInstance is the index of this draw's block in the per-draw buffer.
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(perDrawData);
+	m_PerDrawData.insert(m_PerDrawData.end(), bytes, bytes + m_PerDrawLayout.GetStride());
+	return drawIndex;
+}
+
+void IndirectDrawBatch::Upload(unsigned int target, unsigned int bufferID, size_t& capacity, const void* data, size_t size)
+{
+	glBindBuffer(target, bufferID);
+	if (size > capacity)
+	{
+		capacity = std::max(size, capacity * 2);
+		RenderStats::Add(RenderStat::BufferAllocations);
+		RenderStats::Add(RenderStat::BufferBytesAllocated, capacity);
+		GPUMemoryTracker::Track(GLObjectType::Buffer, bufferID, GPUMemoryCategory::Transient, capacity);
+	}
+	//Respecifying the storage first orphans last frame's copy, which the GPU may still be reading, instead of waiting for it.
+	glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(target, 0, size, data);
+	RenderStats::Add(RenderStat::BytesUploaded, size); //Orphaning hands the driver back the same size of storage, so it isn't counted as an allocation.
+}
+
+void IndirectDrawBatch::SetPerDrawAttributes(size_t byteOffset)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, m_PerDrawBuffer);
+	const auto& elements = m_PerDrawLayout.GetElements();
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		const void* pointer = (const void*)(uintptr_t)(byteOffset + elements[i].offset);
+		//Per-draw data is often an index or an ID, which a float conversion would mangle past 2^24.
+		if (VertexBufferElement::IsIntegerAttribute(elements[i].type, elements[i].normalized))
+		{
+			glVertexAttribIPointer(m_VertexAttributeCount + i, elements[i].count, elements[i].type, m_PerDrawLayout.GetStride(), pointer);
+		}
+		else
+		{
+			glVertexAttribPointer(m_VertexAttributeCount + i, elements[i].count, elements[i].type, elements[i].normalized, m_PerDrawLayout.GetStride(), pointer);
+		}
+	}
+}
+
+void IndirectDrawBatch::BindForSubmit(const Shader& shader)
+{
+	shader.Bind();
+	glBindVertexArray(m_VertexArray);
+	RenderStats::Add(RenderStat::VertexArrayBinds);
+	Upload(GL_ARRAY_BUFFER, m_PerDrawBuffer, m_PerDrawBufferCapacity, m_PerDrawData.data(), m_PerDrawData.size());
+}
+
+void IndirectDrawBatch::Submit(const Shader& shader)
+{
+	m_LastSubmitCallCount = 0;
+	if (m_Commands.empty())
+	{
+		return;
+	}
+
+	GPU_PROFILE_SCOPE("Indirect Draw");
+	BindForSubmit(shader);
+
+	if (IsUsingMultiDraw())
+	{
+		if (m_PerDrawAttributesMoved)
+		{
+			SetPerDrawAttributes(0);
+			m_PerDrawAttributesMoved = false;
+		}
+		Upload(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer, m_IndirectBufferCapacity, m_Commands.data(), m_Commands.size() * sizeof(DrawElementsIndirectCommand));
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)m_Commands.size(), 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		m_LastSubmitCallCount = 1;
+		RecordSubmit(1);
+		return;
+	}
+
+	//GL 3.3 can't offset instanced attributes by a base instance, so the per-draw attributes are moved to each draw's block instead.
+	for (size_t i = 0; i < m_Commands.size(); i++)
+	{
+		const DrawElementsIndirectCommand& command = m_Commands[i];
+		SetPerDrawAttributes(command.baseInstance * (size_t)m_PerDrawLayout.GetStride());
+		glDrawElementsBaseVertex(GL_TRIANGLES, command.indexCount, GL_UNSIGNED_INT, (void*)(uintptr_t)(command.firstIndex * sizeof(unsigned int)), command.baseVertex);
+	}
+	m_PerDrawAttributesMoved = true;
+	m_LastSubmitCallCount = (unsigned int)m_Commands.size();
+	RecordSubmit(m_LastSubmitCallCount);
+}
+
+void IndirectDrawBatch::Submit(const Shader& shader, const GPUCuller& culler)
+{
+	m_LastSubmitCallCount = 0;
+	if (m_Commands.empty() || culler.GetMaxDrawCount() != m_Commands.size() || culler.GetVisibleCommandBuffer() == 0)
+	{
+		std::cout << "Warning: Submitting a batch the GPUCuller hasn't culled! \n";
+		return;
+	}
+
+	//The culled commands kept their baseInstance, so every per-draw attribute still lines up from the start of the buffer.
+	GPU_PROFILE_SCOPE("Indirect Draw");
+	BindForSubmit(shader);
+	if (m_PerDrawAttributesMoved)
+	{
+		SetPerDrawAttributes(0);
+		m_PerDrawAttributesMoved = false;
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, culler.GetVisibleCommandBuffer());
+	if (GPUCuller::IsDrawCountSupported())
+	{
+		//The count the culling wrote is read by the GPU itself, so the CPU never waits on it. Draws past it aren't even looked at.
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, culler.GetDrawCountBuffer());
+		if (GLEW_VERSION_4_6)
+		{
+			glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, (GLsizei)m_Commands.size(), 0);
+		}
+		else
+		{
+			glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, (GLsizei)m_Commands.size(), 0);
+		}
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+	}
+	else
+	{
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)m_Commands.size(), 0); //The culled slots are zeroed, so they draw nothing.
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	m_LastSubmitCallCount = 1;
+	RecordSubmit(1); //How many survived the culling is only known to the GPU, so this counts every command the culling could have let through.
+}
+
+void IndirectDrawBatch::RecordSubmit(unsigned int callCount) const
+{
+	uint64_t triangleCount = 0;
+	for (const DrawElementsIndirectCommand& command : m_Commands)
+	{
+		triangleCount += (uint64_t)command.indexCount / 3 * command.instanceCount;
+	}
+	RenderStats::Add(RenderStat::DrawCalls, callCount);
+	RenderStats::Add(RenderStat::DrawCommands, m_Commands.size());
+	RenderStats::Add(RenderStat::Triangles, triangleCount);
+}
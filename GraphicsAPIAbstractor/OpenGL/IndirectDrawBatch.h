@@ -0,0 +1,70 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "Shader.h"
+
+//The layout OpenGL reads indirect draws in, so these go into the GPU buffer exactly as they are.
+struct DrawElementsIndirectCommand
+{
+	unsigned int indexCount;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "OpenGL expects tightly packed indirect commands.");
+
+class GPUCuller;
+
+//Records many draws of meshes that share one vertex buffer, index buffer, layout and shader, such as every LOD of every mesh packed into one pair of buffers,
+//and submits them all with a single glMultiDrawElementsIndirect. The cost of submitting is then the same for 10 draws as it is for 100k.
+//Each draw carries a block of per-draw data (a transform, a color, a material index...) described by perDrawLayout. The vertex shader gets it as instanced
+//attributes following the mesh's own, and every draw's baseInstance points at its own block, so the shader reads it like any other input without needing
+//gl_DrawID and GL 4.6. Without ARB_multi_draw_indirect we fall back to a draw call per draw, repointing the per-draw attributes in between.
+class IndirectDrawBatch
+{
+public:
+	//The buffers must outlive the batch, as it keeps a vertex array object referencing them.
+	IndirectDrawBatch(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout, const VertexBufferLayout& perDrawLayout);
+	~IndirectDrawBatch();
+
+	IndirectDrawBatch(const IndirectDrawBatch&) = delete;
+	IndirectDrawBatch& operator=(const IndirectDrawBatch&) = delete;
+
+	void Clear(); //Call before recording each frame's draws.
+	unsigned int AddDraw(unsigned int indexCount, unsigned int firstIndex, int baseVertex, const void* perDrawData); //perDrawData is one perDrawLayout vertex. Returns the draw's index.
+	void Submit(const Shader& shader); //Uploads this frame's draws and issues them.
+	void Submit(const Shader& shader, const GPUCuller& culler); //Issues only the draws culler let through, after it has culled this batch. Needs multi draw indirect.
+
+	inline unsigned int GetDrawCount() const { return (unsigned int)m_Commands.size(); }
+	inline const std::vector<DrawElementsIndirectCommand>& GetCommands() const { return m_Commands; }
+	inline unsigned int GetLastSubmitCallCount() const { return m_LastSubmitCallCount; } //Draw calls the last Submit made, for comparing the two paths.
+	inline void SetMultiDrawEnabled(bool enabled) { m_MultiDrawEnabled = enabled; } //Only takes effect where it is supported. Turning it off forces the fallback.
+	inline bool IsUsingMultiDraw() const { return m_MultiDrawEnabled && IsMultiDrawSupported(); }
+
+	//Needs baseInstance to be honored too, which came in GL 4.2 alongside indirect drawing's other prerequisites.
+	static bool IsMultiDrawSupported();
+
+private:
+	friend class GPUCuller; //Shares Upload.
+	void BindForSubmit(const Shader& shader); //Binds everything and uploads the per-draw data.
+	void SetPerDrawAttributes(size_t byteOffset); //Points the per-draw attributes at one draw's block. Expects m_VertexArray bound.
+	void RecordSubmit(unsigned int callCount) const; //Adds a submit of every command to RenderStats.
+	static void Upload(unsigned int target, unsigned int bufferID, size_t& capacity, const void* data, size_t size);
+
+	unsigned int m_VertexArray = 0;
+	unsigned int m_PerDrawBuffer = 0;
+	unsigned int m_IndirectBuffer = 0;
+	size_t m_PerDrawBufferCapacity = 0;
+	size_t m_IndirectBufferCapacity = 0;
+	unsigned int m_VertexAttributeCount;
+	VertexBufferLayout m_PerDrawLayout;
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+	std::vector<unsigned char> m_PerDrawData;
+	unsigned int m_LastSubmitCallCount = 0;
+	bool m_MultiDrawEnabled = true;
+	bool m_PerDrawAttributesMoved = false; //The fallback leaves them pointing at the last draw.
+};
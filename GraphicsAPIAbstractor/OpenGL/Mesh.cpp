@@ -0,0 +1,64 @@
+#include "GAAPrecompiledHeader.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <cstring>
+
+Mesh::Mesh(const std::string& filePath)
+{
+	MeshFile file;
+	if (!file.Open(filePath))
+	{
+		return;
+	}
+
+	const MeshFileHeader& header = file.GetHeader();
+	m_VertexBuffer = ResourceRegistry::VertexBuffers().Create(file.GetVertexData(), (unsigned int)file.GetVertexDataSize());
+	m_IndexBuffer = ResourceRegistry::IndexBuffers().Create(file.GetIndices(), header.indexCount);
+	m_Layout = file.CreateLayout();
+	m_LODs.assign(file.GetLODs(), file.GetLODs() + header.lodCount);
+	m_Meshlets.assign(file.GetMeshlets(), file.GetMeshlets() + header.meshletCount);
+	m_Attributes.assign(file.GetAttributes(), file.GetAttributes() + header.attributeCount);
+	for (const MeshFileAttribute& attribute : m_Attributes)
+	{
+		m_DequantizeScales.insert(m_DequantizeScales.end(), attribute.dequantizeScale, attribute.dequantizeScale + 4);
+		m_DequantizeOffsets.insert(m_DequantizeOffsets.end(), attribute.dequantizeOffset, attribute.dequantizeOffset + 4);
+	}
+	memcpy(m_BoundsMinimum, header.boundsMinimum, sizeof(m_BoundsMinimum));
+	memcpy(m_BoundsMaximum, header.boundsMaximum, sizeof(m_BoundsMaximum));
+}
+
+Mesh::~Mesh()
+{
+	ResourceRegistry::Destroy(m_VertexBuffer);
+	ResourceRegistry::Destroy(m_IndexBuffer);
+}
+
+void Mesh::ApplyDequantization(Shader& shader) const
+{
+	if (m_Attributes.empty())
+	{
+		return;
+	}
+	shader.Bind();
+	shader.SetUniform4fv("u_DequantizeScale", (unsigned int)m_Attributes.size(), m_DequantizeScales.data());
+	shader.SetUniform4fv("u_DequantizeOffset", (unsigned int)m_Attributes.size(), m_DequantizeOffsets.data());
+}
+
+unsigned int Mesh::SelectLOD(float distance, float projectionScale, float maxPixelError) const
+{
+	return SelectMeshLOD(m_LODs.data(), (unsigned int)m_LODs.size(), distance, projectionScale, maxPixelError);
+}
+
+void Mesh::Draw(OpenGLRenderer& renderer, Shader& shader, unsigned int lod) const
+{
+	VertexBuffer* vertexBuffer = GetVertexBuffer();
+	IndexBuffer* indexBuffer = GetIndexBuffer();
+	if (!vertexBuffer || !indexBuffer || m_LODs.empty())
+	{
+		return;
+	}
+
+	const MeshLOD& meshLOD = m_LODs[std::min<size_t>(lod, m_LODs.size() - 1)];
+	ApplyDequantization(shader);
+	renderer.Draw(*vertexBuffer, *indexBuffer, m_Layout, shader, meshLOD.firstIndex, meshLOD.indexCount);
+}
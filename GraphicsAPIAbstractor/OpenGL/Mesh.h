@@ -0,0 +1,46 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "ResourceRegistry.h"
+#include "VertexBufferLayout.h"
+#include "MeshFile.h"
+
+//A cooked mesh on the GPU. Loading maps the .gaam file and hands its vertex and index sections straight to glBufferData, then unmaps it again, as the
+//GPU copy is all we draw from. The LOD ranges and meshlets stay on the CPU for the renderer to use. Remapped attributes, positions in particular, come out of
+//the vertex fetch in [0, 1], so Draw hands the shader each attribute's scale and offset to decode them with.
+class Mesh
+{
+public:
+	Mesh(const std::string& filePath);
+	~Mesh();
+
+	Mesh(const Mesh&) = delete;
+	Mesh& operator=(const Mesh&) = delete;
+
+	void Draw(OpenGLRenderer& renderer, Shader& shader, unsigned int lod = 0) const;
+	//Sets the vec4 arrays u_DequantizeScale and u_DequantizeOffset, one element per attribute in layout order. The shader decodes with fetched * scale + offset.
+	void ApplyDequantization(Shader& shader) const;
+	//The coarsest LOD whose error, projected at this distance, stays under maxPixelError. Get projectionScale from CalculateProjectionScale.
+	unsigned int SelectLOD(float distance, float projectionScale, float maxPixelError = 1.0f) const;
+
+	inline bool IsLoaded() const { return m_VertexBuffer.IsValid(); }
+	inline VertexBuffer* GetVertexBuffer() const { return ResourceRegistry::Get(m_VertexBuffer); }
+	inline IndexBuffer* GetIndexBuffer() const { return ResourceRegistry::Get(m_IndexBuffer); }
+	inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+	inline const std::vector<MeshLOD>& GetLODs() const { return m_LODs; }
+	inline const std::vector<Meshlet>& GetMeshlets() const { return m_Meshlets; }
+	inline const std::vector<MeshFileAttribute>& GetAttributes() const { return m_Attributes; } //For the dequantization the shader needs to apply.
+	inline const float* GetBoundsMinimum() const { return m_BoundsMinimum; }
+	inline const float* GetBoundsMaximum() const { return m_BoundsMaximum; }
+
+private:
+	VertexBufferHandle m_VertexBuffer;
+	IndexBufferHandle m_IndexBuffer;
+	VertexBufferLayout m_Layout;
+	std::vector<MeshLOD> m_LODs;
+	std::vector<Meshlet> m_Meshlets;
+	std::vector<MeshFileAttribute> m_Attributes;
+	std::vector<float> m_DequantizeScales; //The attributes' scales and offsets gathered into the arrays the uniforms take.
+	std::vector<float> m_DequantizeOffsets;
+	float m_BoundsMinimum[3] = { 0.0f, 0.0f, 0.0f };
+	float m_BoundsMaximum[3] = { 0.0f, 0.0f, 0.0f };
+};
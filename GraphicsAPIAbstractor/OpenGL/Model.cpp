@@ -0,0 +1,114 @@
+#include "GAAPrecompiledHeader.h"
+#include "Model.h"
+
+Model::Model(const std::string& filePath)
+{
+	GLTFScene scene;
+	if (!scene.Load(filePath))
+	{
+		return;
+	}
+
+	//Textures only take RGBA8 pixels, which is exactly what the scene decoded. Sharing an image between textures is rare, so each texture uploads its own.
+	std::vector<GLTFImage>& images = scene.GetImages();
+	for (const GLTFTexture& texture : scene.GetTextures())
+	{
+		if (texture.image < 0 || texture.image >= (int)images.size() || !images[texture.image].pixels)
+		{
+			m_Textures.emplace_back();
+			continue;
+		}
+		SamplerState samplerState;
+		samplerState.minFilter = texture.minFilter;
+		samplerState.magFilter = texture.magFilter;
+		samplerState.wrapS = texture.wrapS;
+		samplerState.wrapT = texture.wrapT;
+		const GLTFImage& image = images[texture.image];
+		m_Textures.push_back(ResourceRegistry::Textures().Create(image.pixels.get(), image.width, image.height, samplerState));
+	}
+
+	//glTF says an untextured material samples as white, which leaves u_Color as it is. Binding this also keeps the last primitive's texture off slot 0.
+	const unsigned char white[4] = { 255, 255, 255, 255 };
+	SamplerState whiteSamplerState;
+	whiteSamplerState.minFilter = GL_NEAREST;
+	whiteSamplerState.magFilter = GL_NEAREST;
+	m_WhiteTexture = ResourceRegistry::Textures().Create(white, 1, 1, whiteSamplerState);
+
+	std::vector<unsigned int> meshFirstPrimitive;
+	for (const GLTFMesh& mesh : scene.GetMeshes())
+	{
+		meshFirstPrimitive.push_back((unsigned int)m_Primitives.size());
+		for (const GLTFPrimitive& source : mesh.primitives)
+		{
+			Primitive primitive;
+			primitive.vertexBuffer = ResourceRegistry::VertexBuffers().Create(source.GetVertexData(), (unsigned int)source.vertexDataSize);
+			primitive.indexBuffer = ResourceRegistry::IndexBuffers().Create(source.GetIndices(), (unsigned int)source.indexCount);
+			primitive.layout = source.layout;
+			primitive.material = source.material;
+			m_Primitives.push_back(primitive);
+		}
+	}
+
+	const std::vector<GLTFMesh>& meshes = scene.GetMeshes();
+	for (const GLTFNode& node : scene.GetNodes())
+	{
+		if (node.mesh >= 0 && node.mesh < (int)meshes.size() && !meshes[node.mesh].primitives.empty())
+		{
+			m_Instances.push_back({ node.worldTransform, meshFirstPrimitive[node.mesh], (unsigned int)meshes[node.mesh].primitives.size() });
+		}
+	}
+	m_Materials = scene.GetMaterials();
+	m_Statistics = scene.GetStatistics();
+	m_Loaded = true;
+}
+
+Model::~Model()
+{
+	for (const Primitive& primitive : m_Primitives)
+	{
+		ResourceRegistry::Destroy(primitive.vertexBuffer);
+		ResourceRegistry::Destroy(primitive.indexBuffer);
+	}
+	for (TextureHandle texture : m_Textures)
+	{
+		ResourceRegistry::Destroy(texture);
+	}
+	ResourceRegistry::Destroy(m_WhiteTexture);
+}
+
+void Model::Draw(OpenGLRenderer& renderer, Shader& shader, const glm::mat4& viewProjection) const
+{
+	shader.Bind();
+	shader.SetUniform1i("u_Texture", 0);
+	for (const Instance& instance : m_Instances)
+	{
+		shader.SetUniformMat4f("u_MVP", viewProjection * instance.transform);
+		for (unsigned int i = instance.firstPrimitive; i < instance.firstPrimitive + instance.primitiveCount; i++)
+		{
+			const Primitive& primitive = m_Primitives[i];
+			VertexBuffer* vertexBuffer = ResourceRegistry::Get(primitive.vertexBuffer);
+			IndexBuffer* indexBuffer = ResourceRegistry::Get(primitive.indexBuffer);
+			if (!vertexBuffer || !indexBuffer)
+			{
+				continue;
+			}
+
+			GLTFMaterial material;
+			if (primitive.material >= 0 && primitive.material < (int)m_Materials.size())
+			{
+				material = m_Materials[primitive.material];
+			}
+			shader.SetUniform4f("u_Color", material.baseColorFactor[0], material.baseColorFactor[1], material.baseColorFactor[2], material.baseColorFactor[3]);
+			Texture* texture = material.baseColorTexture >= 0 && material.baseColorTexture < (int)m_Textures.size() ? ResourceRegistry::Get(m_Textures[material.baseColorTexture]) : nullptr;
+			if (!texture)
+			{
+				texture = ResourceRegistry::Get(m_WhiteTexture);
+			}
+			if (texture)
+			{
+				texture->Bind(0);
+			}
+			renderer.Draw(*vertexBuffer, *indexBuffer, primitive.layout, shader);
+		}
+	}
+}
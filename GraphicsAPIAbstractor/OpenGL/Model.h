@@ -0,0 +1,48 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "ResourceRegistry.h"
+#include "VertexBufferLayout.h"
+#include "GLTFScene.h"
+#include "glm/glm.hpp"
+
+//A glTF scene on the GPU. Each primitive gets its own vertex and index buffer, uploaded straight from the scene's views into the file where it could avoid
+//copying them, and each image becomes a Texture. The scene itself is released once everything is uploaded.
+class Model
+{
+public:
+	Model(const std::string& filePath);
+	~Model();
+
+	Model(const Model&) = delete;
+	Model& operator=(const Model&) = delete;
+
+	//Draws every node that has a mesh. Sets u_MVP per node and u_Color to the material's base color, and binds its base color texture, or white without one, to slot 0 for u_Texture.
+	void Draw(OpenGLRenderer& renderer, Shader& shader, const glm::mat4& viewProjection) const;
+
+	inline bool IsLoaded() const { return m_Loaded; }
+	inline const GLTFStatistics& GetStatistics() const { return m_Statistics; }
+	inline size_t GetPrimitiveCount() const { return m_Primitives.size(); }
+
+private:
+	struct Primitive
+	{
+		VertexBufferHandle vertexBuffer;
+		IndexBufferHandle indexBuffer;
+		VertexBufferLayout layout;
+		int material = -1;
+	};
+
+	struct Instance
+	{
+		glm::mat4 transform;
+		unsigned int firstPrimitive, primitiveCount; //Into m_Primitives, which holds each mesh's primitives together.
+	};
+
+	std::vector<Primitive> m_Primitives;
+	std::vector<Instance> m_Instances;
+	std::vector<GLTFMaterial> m_Materials;
+	std::vector<TextureHandle> m_Textures; //Per glTF texture. Invalid if its image failed to decode.
+	TextureHandle m_WhiteTexture; //For primitives without a base color texture, or whose texture failed to decode.
+	GLTFStatistics m_Statistics;
+	bool m_Loaded = false;
+};
@@ -1,5 +1,17 @@
 #include "GAAPrecompiledHeader.h"
 #include "OpenGLRenderer.h"
+#include "DeletionQueue.h"
+#include "ResourceRegistry.h"
+#include "SamplerCache.h"
+#include "FrameAllocator.h"
+#include "AllocationTracker.h"
+#include "IndirectDrawBatch.h"
+#include "GPUCuller.h"
+#include "UploadThread.h"
+#include "GPUProfiler.h"
+#include "RenderStats.h"
+#include "GPUMemoryTracker.h"
+#include "Instrumentation.h"
 #include "GL/glew.h"
 
 GraphicalInformation OpenGLRenderer::systemInformation;
@@ -33,13 +45,71 @@ void OpenGLRenderer::Clear() const
 
 void OpenGLRenderer::Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, const Shader& shader)
 {
+    GAA_PROFILE_FUNCTION();
     shader.Bind();
     vertexArray.Bind();
     indexBuffer.Bind();
 
-    GLCall(glDrawElements(GL_TRIANGLES, indexBuffer.GetCount(), GL_UNSIGNED_INT, nullptr)); //We can put nullptr because the data is already bound to the buffer.
+    DrawIndexed(indexBuffer.GetCount());
 }
 
+void OpenGLRenderer::Draw(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout, const Shader& shader)
+{
+    GAA_PROFILE_FUNCTION();
+    shader.Bind();
+    VertexArrayCache::Bind(vertexBuffer, indexBuffer, layout);
+    DrawIndexed(indexBuffer.GetCount());
+}
+
+void OpenGLRenderer::Draw(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout, const Shader& shader, unsigned int firstIndex, unsigned int indexCount)
+{
+    GAA_PROFILE_FUNCTION();
+    shader.Bind();
+    VertexArrayCache::Bind(vertexBuffer, indexBuffer, layout);
+    DrawIndexed(indexCount, firstIndex);
+}
 
+void OpenGLRenderer::Draw(IndirectDrawBatch& batch, const Shader& shader)
+{
+    GAA_PROFILE_FUNCTION();
+    batch.Submit(shader);
+}
 
+void OpenGLRenderer::Draw(IndirectDrawBatch& batch, const Shader& shader, const GPUCuller& culler)
+{
+    GAA_PROFILE_FUNCTION();
+    batch.Submit(shader, culler);
+}
 
+void OpenGLRenderer::DrawIndexed(unsigned int indexCount, unsigned int firstIndex)
+{
+    //The last argument is a byte offset into the bound index buffer rather than a pointer, as the data is already on the GPU.
+    GLCall(glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, (const void*)(uintptr_t)(firstIndex * sizeof(unsigned int))));
+    RenderStats::RecordDraw(indexCount);
+}
+
+
+
+
+
+
+void OpenGLRenderer::EndFrame()
+{
+    DeletionQueue::EndFrame();
+    ResourceRegistry::EndFrame();
+    FrameAllocator::EndFrame();
+    AllocationTracker::EndFrame();
+    RenderStats::Set(RenderStat::HeapAllocations, AllocationTracker::GetLastFrameAllocationCount());
+    UploadThread::EndFrame();
+    GPUMemoryTracker::EndFrame(); //After the DeletionQueue, so memory freed this frame is already off.
+    RenderStats::EndFrame(); //Last, so anything the calls above did counts towards the frame that's ending.
+}
+
+void OpenGLRenderer::Shutdown()
+{
+    ResourceRegistry::Shutdown();
+    GPUProfiler::Shutdown();
+    SamplerCache::Clear();
+    VertexArrayCache::Clear();
+    DeletionQueue::Flush();
+}
\ No newline at end of file
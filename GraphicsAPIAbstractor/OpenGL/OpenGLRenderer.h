@@ -3,6 +3,12 @@
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
+#include "VertexArrayCache.h"
+#include "Instrumentation.h"
+#include "GAAAssert.h"
+
+class IndirectDrawBatch;
+class GPUCuller;
 
 struct GraphicalInformation
 {
@@ -11,10 +17,15 @@ struct GraphicalInformation
     const char* vendorInformation = "";
 };
 
-#define ASSERT(x) if ((x == false)) __debugbreak();  //__ means Compiler Intrisic. This will only work in MSVS.
-#define GLCall(x) GLClearError();\
+//Errors are reported by GLDebug through KHR_debug, which costs nothing per call. Polling glGetError around every call, which can make the driver sync with
+//itself, is left as a diagnostic for drivers without KHR_debug: define GAA_ENABLE_GL_ERROR_POLLING to turn it on. Everywhere else GLCall is just the call.
+#ifdef GAA_ENABLE_GL_ERROR_POLLING
+#define GLCall(x) do { GLClearError();\
     x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+    ASSERT(GLLogCall(#x, __FILE__, __LINE__)); } while (0)
+#else
+#define GLCall(x) x
+#endif
 
 void GLClearError();  //Clears all errors.
 bool GLLogCall(const char* function, const char* file, int line);
@@ -26,7 +37,36 @@ public:
     inline GraphicalInformation RetrieveGraphicalInformation() const { return systemInformation; }
     void Clear() const;
     void Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, const Shader& shader);
+    //These take the VAO from the VertexArrayCache instead, so meshes sharing a layout share its setup.
+    void Draw(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout, const Shader& shader);
+    void Draw(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout, const Shader& shader, unsigned int firstIndex, unsigned int indexCount);
+    template<typename Layout>
+    void Draw(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const Shader& shader)
+    {
+        GAA_PROFILE_FUNCTION();
+        shader.Bind();
+        VertexArrayCache::Bind<Layout>(vertexBuffer, indexBuffer);
+        DrawIndexed(indexBuffer.GetCount());
+    }
+    //Draws part of the index buffer, such as one LOD out of a chain that shares a single buffer.
+    template<typename Layout>
+    void Draw(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const Shader& shader, unsigned int firstIndex, unsigned int indexCount)
+    {
+        GAA_PROFILE_FUNCTION();
+        shader.Bind();
+        VertexArrayCache::Bind<Layout>(vertexBuffer, indexBuffer);
+        DrawIndexed(indexCount, firstIndex);
+    }
+
+    //Every draw recorded in the batch, in one glMultiDrawElementsIndirect where the driver supports it.
+    void Draw(IndirectDrawBatch& batch, const Shader& shader);
+    void Draw(IndirectDrawBatch& batch, const Shader& shader, const GPUCuller& culler); //Only what the culler let through, without the CPU knowing how many that was.
+
+    static void EndFrame(); //Call once per frame after presenting. Retires resources the GPU has finished with.
+    static void Shutdown(); //Call before the context is destroyed.
 private:
+    void DrawIndexed(unsigned int indexCount, unsigned int firstIndex = 0);
+
     static GraphicalInformation systemInformation;
 };
 
@@ -0,0 +1,144 @@
+#include "GAAPrecompiledHeader.h"
+#include "ParallelCommandRecorder.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	//Leaves 24 bits for the Record call and 40 for the item, which is a trillion items in one call.
+	constexpr unsigned int s_ItemIndexBits = 40;
+}
+
+ParallelCommandRecorder::ThreadRecording::ThreadRecording() : arena(std::make_unique<LinearAllocator>(s_InitialArenaCapacity)), groups(LinearAllocatorAdapter<CommandGroup>(arena.get()))
+{
+}
+
+void ParallelCommandRecorder::ThreadRecording::ResetGroups()
+{
+	largestGroupCount = std::max(largestGroupCount, groups.size());
+	groups = GroupVector(LinearAllocatorAdapter<CommandGroup>(arena.get())); //Nothing is freed, the arena is reset below.
+
+	//A vector that regrows leaves its old blocks behind in the arena, so we leave room for the largest frame twice over.
+	size_t neededCapacity = largestGroupCount * sizeof(CommandGroup) * 2;
+	if (neededCapacity > arena->GetCapacity())
+	{
+		arena = std::make_unique<LinearAllocator>(neededCapacity);
+		groups = GroupVector(LinearAllocatorAdapter<CommandGroup>(arena.get()));
+	}
+	arena->Reset();
+	groups.reserve(largestGroupCount);
+}
+
+void ParallelCommandRecorder::Record(size_t count, const RecordFunction& record, size_t minimumGrainSize)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	//One slot per JobSystem thread, plus the last one for every other thread to share.
+	size_t threadSlots = JobSystem::GetThreadCount() + 1;
+	while (m_Threads.size() < threadSlots)
+	{
+		m_Threads.push_back(std::make_unique<ThreadRecording>());
+	}
+
+	uint64_t recordIndex = m_RecordCount++;
+	if (recordIndex == 0)
+	{
+		m_RecordMilliseconds = 0.0f;
+	}
+	JobSystem::ParallelFor(count, [this, &record, recordIndex](size_t begin, size_t end)
+	{
+		unsigned int threadIndex = JobSystem::GetThreadIndex();
+		ThreadRecording& thread = *m_Threads[threadIndex];
+		std::unique_lock<std::mutex> lock(thread.mutex, std::defer_lock);
+		if (threadIndex == JobSystem::GetThreadCount())
+		{
+			lock.lock();
+		}
+
+		for (size_t i = begin; i < end; i++)
+		{
+			size_t offset = thread.commands.GetSize();
+			uint64_t sortKey = record(i, thread.commands);
+			size_t size = thread.commands.GetSize() - offset;
+			if (size > 0)
+			{
+				thread.groups.push_back({ sortKey, (recordIndex << s_ItemIndexBits) | (uint64_t)i, offset, size });
+			}
+		}
+	}, minimumGrainSize);
+
+	m_RecordMilliseconds += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParallelCommandRecorder::Merge(CommandBuffer& destination)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto isBefore = [](const CommandGroup& a, const CommandGroup& b)
+	{
+		return a.sortKey != b.sortKey ? a.sortKey < b.sortKey : a.order < b.order;
+	};
+
+	//Each thread sorts its own groups, in parallel, and then a k-way merge over the threads interleaves them. There are only ever as many lists as threads,
+	//so the heap stays tiny.
+	JobSystem::ParallelFor(m_Threads.size(), [this, &isBefore](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			std::sort(m_Threads[i]->groups.begin(), m_Threads[i]->groups.end(), isBefore);
+		}
+	});
+
+	std::vector<MergeEntry>& heads = m_MergeHeads;
+	std::vector<size_t>& cursors = m_MergeCursors;
+	heads.clear();
+	cursors.assign(m_Threads.size(), 0);
+	auto isAfter = [&isBefore](const MergeEntry& a, const MergeEntry& b) { return isBefore(*b.group, *a.group); }; //std::push_heap builds a max heap, and we want the smallest on top.
+	for (unsigned int i = 0; i < (unsigned int)m_Threads.size(); i++)
+	{
+		if (!m_Threads[i]->groups.empty())
+		{
+			heads.push_back({ &m_Threads[i]->groups[0], i });
+		}
+	}
+	std::make_heap(heads.begin(), heads.end(), isAfter);
+
+	m_MergeOrder.clear();
+	while (!heads.empty())
+	{
+		std::pop_heap(heads.begin(), heads.end(), isAfter);
+		MergeEntry next = heads.back();
+		m_MergeOrder.push_back(next);
+
+		GroupVector& groups = m_Threads[next.thread]->groups;
+		if (++cursors[next.thread] < groups.size())
+		{
+			heads.back().group = &groups[cursors[next.thread]];
+			std::push_heap(heads.begin(), heads.end(), isAfter);
+		}
+		else
+		{
+			heads.pop_back();
+		}
+	}
+
+	size_t totalSize = destination.GetSize();
+	for (const std::unique_ptr<ThreadRecording>& thread : m_Threads)
+	{
+		totalSize += thread->commands.GetSize();
+	}
+	destination.Reserve(totalSize);
+	for (const MergeEntry& entry : m_MergeOrder)
+	{
+		destination.Append(m_Threads[entry.thread]->commands, entry.group->offset, entry.group->size);
+	}
+
+	m_ItemCount = m_MergeOrder.size();
+	for (std::unique_ptr<ThreadRecording>& thread : m_Threads)
+	{
+		thread->commands.Reset();
+		thread->ResetGroups();
+	}
+	m_RecordCount = 0;
+	m_MergeMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
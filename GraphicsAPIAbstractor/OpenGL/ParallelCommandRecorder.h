@@ -0,0 +1,75 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "CommandBuffer.h"
+#include <cstdint>
+#include <mutex>
+
+//Records commands for many items at once on the JobSystem, and merges them into one stream for the GL thread. Walking the scene and building draws is
+//then spread over every core, while executing the result stays on the one thread GL allows.
+//Each thread records into a command buffer of its own, whose stream comes from the frame's memory, and keeps the sort keys of what it recorded in an arena
+//of its own, so recording takes no locks and no heap allocations. Merge resets the arenas, so Record and Merge have to happen within the same frame.
+//Every item's commands are tagged with the sort key the record function returns. Merging orders them by that key, and items with equal keys by the order
+//they were recorded in: Record call first, then item index. Which thread happened to record what never shows, so the same input always produces the
+//same stream, byte for byte.
+class ParallelCommandRecorder
+{
+public:
+	//Records the commands for item index and returns their sort key, such as the shader and material in the high bits and depth below.
+	//Called from any thread, so it can only touch the item and the command buffer it is given. It mustn't wait on other jobs either, as the thread could pick
+	//up another item while it waits and record that into the middle of this one.
+	using RecordFunction = std::function<uint64_t(size_t index, CommandBuffer& commands)>;
+
+	ParallelCommandRecorder() = default;
+	ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+	ParallelCommandRecorder& operator=(const ParallelCommandRecorder&) = delete;
+
+	//Calls record for every item in [0, count), in parallel, and returns once all of them are recorded. minimumGrainSize keeps jobs from getting so small
+	//that scheduling them costs more than recording; count or more records everything on the calling thread.
+	void Record(size_t count, const RecordFunction& record, size_t minimumGrainSize = 64);
+
+	//Appends everything recorded since the last Merge to destination in sorted order, and clears it for the next frame.
+	void Merge(CommandBuffer& destination);
+
+	inline size_t GetItemCount() const { return m_ItemCount; } //How many items the last Merge put in, not counting items that recorded nothing.
+	inline float GetRecordMilliseconds() const { return m_RecordMilliseconds; } //Summed over the Record calls since the Merge before them.
+	inline float GetMergeMilliseconds() const { return m_MergeMilliseconds; }
+
+private:
+	//Where one item's commands sit in the buffer of the thread that recorded them.
+	struct CommandGroup
+	{
+		uint64_t sortKey;
+		uint64_t order; //The Record call in the high bits and the item index below, so equal keys still sort the same way every time.
+		size_t offset, size;
+	};
+
+	using GroupVector = std::vector<CommandGroup, LinearAllocatorAdapter<CommandGroup>>;
+
+	struct ThreadRecording
+	{
+		ThreadRecording();
+		void ResetGroups(); //Empties the groups and resets the arena, growing it first if the most groups we've seen no longer fit.
+
+		CommandBuffer commands;
+		std::unique_ptr<LinearAllocator> arena; //Only this thread's groups live in it, so growing them never contends with the other threads.
+		GroupVector groups;
+		size_t largestGroupCount = 0;
+		std::mutex mutex; //Only ever contended in the last slot, which every thread outside the JobSystem shares.
+	};
+
+	struct MergeEntry
+	{
+		const CommandGroup* group;
+		unsigned int thread;
+	};
+
+	std::vector<std::unique_ptr<ThreadRecording>> m_Threads;
+	std::vector<MergeEntry> m_MergeOrder; //These three are only kept around so merging doesn't allocate once they have grown.
+	std::vector<MergeEntry> m_MergeHeads;
+	std::vector<size_t> m_MergeCursors;
+	uint64_t m_RecordCount = 0;
+	static constexpr size_t s_InitialArenaCapacity = 64 * 1024; //Per thread. 2048 groups, and it grows at Merge when that isn't enough.
+	size_t m_ItemCount = 0;
+	float m_RecordMilliseconds = 0.0f;
+	float m_MergeMilliseconds = 0.0f;
+};
@@ -0,0 +1,211 @@
+#include "GAAPrecompiledHeader.h"
+#include "RenderStats.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <cfloat>
+
+std::atomic<uint64_t> RenderStats::s_Current[(size_t)RenderStat::Count] = {};
+uint64_t RenderStats::s_FrameIndex = 0;
+std::mutex RenderStats::s_Mutex;
+std::vector<RenderStatsFrame> RenderStats::s_History;
+size_t RenderStats::s_HistoryCursor = 0;
+RenderStatsFrame RenderStats::s_LastFrame;
+std::ofstream RenderStats::s_Dump;
+
+namespace
+{
+	struct StatName
+	{
+		const char* name;
+		const char* key;
+	};
+
+	//In the same order as RenderStat.
+	const StatName s_StatNames[(size_t)RenderStat::Count] =
+	{
+		{ "Draw Calls", "draw_calls" },
+		{ "Draw Commands", "draw_commands" },
+		{ "Triangles", "triangles" },
+		{ "Compute Dispatches", "compute_dispatches" },
+		{ "Shader Binds", "shader_binds" },
+		{ "Texture Binds", "texture_binds" },
+		{ "Sampler Binds", "sampler_binds" },
+		{ "Vertex Array Binds", "vertex_array_binds" },
+		{ "Buffer Binds", "buffer_binds" },
+		{ "Uniform Uploads", "uniform_uploads" },
+		{ "Buffer Allocations", "buffer_allocations" },
+		{ "Buffer Bytes Allocated", "buffer_bytes_allocated" },
+		{ "Texture Allocations", "texture_allocations" },
+		{ "Texture Bytes Allocated", "texture_bytes_allocated" },
+		{ "Bytes Uploaded", "bytes_uploaded" },
+		{ "Mesh Memory", "mesh_memory" },
+		{ "Texture Memory", "texture_memory" },
+		{ "Render Target Memory", "render_target_memory" },
+		{ "UI Memory", "ui_memory" },
+		{ "Transient Memory", "transient_memory" },
+		{ "Driver Free Memory", "driver_free_memory" },
+		{ "Heap Allocations", "heap_allocations" }
+	};
+}
+
+void RenderStats::RecordDraw(uint64_t indexCount, uint64_t instanceCount)
+{
+	Add(RenderStat::DrawCalls);
+	Add(RenderStat::DrawCommands);
+	Add(RenderStat::Triangles, indexCount / 3 * instanceCount);
+}
+
+void RenderStats::EndFrame()
+{
+	//Anything counted on another thread while we go through these lands in either this frame or the next, but never in neither.
+	RenderStatsFrame frame;
+	frame.frameIndex = s_FrameIndex++;
+	for (size_t i = 0; i < (size_t)RenderStat::Count; i++)
+	{
+		frame.values[i] = s_Current[i].exchange(0, std::memory_order_relaxed);
+	}
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_LastFrame = frame;
+	if (s_History.size() < s_HistoryLength)
+	{
+		s_History.push_back(frame);
+	}
+	else
+	{
+		s_History[s_HistoryCursor] = frame;
+	}
+	s_HistoryCursor = (s_HistoryCursor + 1) % s_HistoryLength;
+
+	if (s_Dump.is_open())
+	{
+		s_Dump << frame.frameIndex;
+		for (size_t i = 0; i < (size_t)RenderStat::Count; i++)
+		{
+			s_Dump << ',' << frame.values[i];
+		}
+		s_Dump << '\n';
+	}
+}
+
+RenderStatsFrame RenderStats::GetLastFrame()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	return s_LastFrame;
+}
+
+void RenderStats::GetHistory(std::vector<RenderStatsFrame>& history)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	history.clear();
+	if (s_History.size() < s_HistoryLength)
+	{
+		history.insert(history.end(), s_History.begin(), s_History.end());
+		return;
+	}
+	history.insert(history.end(), s_History.begin() + s_HistoryCursor, s_History.end());
+	history.insert(history.end(), s_History.begin(), s_History.begin() + s_HistoryCursor);
+}
+
+bool RenderStats::StartDump(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	if (s_Dump.is_open())
+	{
+		s_Dump.close();
+	}
+	s_Dump.open(path);
+	if (!s_Dump)
+	{
+		std::cout << "Warning: Couldn't open " << path << " to write render stats to! \n";
+		return false;
+	}
+
+	s_Dump << "frame";
+	for (const StatName& name : s_StatNames)
+	{
+		s_Dump << ',' << name.key;
+	}
+	s_Dump << '\n';
+	return true;
+}
+
+void RenderStats::StopDump()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	if (s_Dump.is_open())
+	{
+		s_Dump.close();
+	}
+}
+
+const char* RenderStats::GetName(RenderStat stat)
+{
+	return stat < RenderStat::Count ? s_StatNames[(size_t)stat].name : "";
+}
+
+const char* RenderStats::GetKey(RenderStat stat)
+{
+	return stat < RenderStat::Count ? s_StatNames[(size_t)stat].key : "";
+}
+
+void RenderStats::OnImGuiRender()
+{
+	static std::vector<RenderStatsFrame> history;
+	static std::vector<float> drawCalls;
+	static std::vector<float> triangles;
+	GetHistory(history);
+	if (history.empty())
+	{
+		return;
+	}
+
+	//Sums and peaks over the history, so a spike that only lasted a frame still shows.
+	uint64_t totals[(size_t)RenderStat::Count] = {};
+	uint64_t peaks[(size_t)RenderStat::Count] = {};
+	drawCalls.resize(history.size());
+	triangles.resize(history.size());
+	for (size_t frame = 0; frame < history.size(); frame++)
+	{
+		for (size_t i = 0; i < (size_t)RenderStat::Count; i++)
+		{
+			totals[i] += history[frame].values[i];
+			peaks[i] = std::max(peaks[i], history[frame].values[i]);
+		}
+		drawCalls[frame] = (float)history[frame][RenderStat::DrawCalls];
+		triangles[frame] = (float)history[frame][RenderStat::Triangles];
+	}
+
+	//Pinned to the top right corner, see-through, and out of the way of the mouse and keyboard.
+	ImGuiIO& io = ImGui::GetIO();
+	ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x - 10.0f, 10.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+	ImGui::SetNextWindowBgAlpha(0.35f);
+	ImGui::Begin("Render Stats", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
+	const RenderStatsFrame& last = history.back();
+	ImGui::Text("Frame %llu, average and peak over %u frames", (unsigned long long)last.frameIndex, (unsigned int)history.size());
+	ImGui::Separator();
+	ImGui::Columns(4, "RenderStatsColumns", false);
+	ImGui::Text("Stat");
+	ImGui::NextColumn();
+	ImGui::Text("Last");
+	ImGui::NextColumn();
+	ImGui::Text("Average");
+	ImGui::NextColumn();
+	ImGui::Text("Peak");
+	ImGui::NextColumn();
+	for (size_t i = 0; i < (size_t)RenderStat::Count; i++)
+	{
+		ImGui::Text("%s", s_StatNames[i].name);
+		ImGui::NextColumn();
+		ImGui::Text("%llu", (unsigned long long)last.values[i]);
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", (double)totals[i] / history.size());
+		ImGui::NextColumn();
+		ImGui::Text("%llu", (unsigned long long)peaks[i]);
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+	ImGui::PlotLines("Draw Calls", drawCalls.data(), (int)drawCalls.size(), 0, nullptr, 0.0f, FLT_MAX, ImVec2(240.0f, 40.0f));
+	ImGui::PlotLines("Triangles", triangles.data(), (int)triangles.size(), 0, nullptr, 0.0f, FLT_MAX, ImVec2(240.0f, 40.0f));
+	ImGui::End();
+}
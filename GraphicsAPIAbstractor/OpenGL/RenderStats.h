@@ -0,0 +1,83 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+
+enum class RenderStat : unsigned int
+{
+	DrawCalls = 0, //Calls into GL that draw, so a multi draw indirect counts once.
+	DrawCommands, //What those calls drew, so each draw in a multi draw indirect counts.
+	Triangles,
+	ComputeDispatches,
+	ShaderBinds,
+	TextureBinds,
+	SamplerBinds,
+	VertexArrayBinds,
+	BufferBinds,
+	UniformUploads,
+	BufferAllocations,
+	BufferBytesAllocated,
+	TextureAllocations,
+	TextureBytesAllocated,
+	BytesUploaded, //Buffer and texture data sent from the CPU, allocations that came with data included.
+	//Levels rather than counts, so these are how much is allocated at the end of the frame. GPUMemoryTracker sets them, one per GPUMemoryCategory.
+	MeshMemory,
+	TextureMemory,
+	RenderTargetMemory,
+	UIMemory,
+	TransientMemory,
+	DriverFreeMemory, //Only with NVX_gpu_memory_info or ATI_meminfo, 0 otherwise.
+	HeapAllocations, //Calls to operator new on any thread during the frame, from AllocationTracker. Should stay at 0 once the loop has warmed up.
+	Count
+};
+
+//Everything RenderStats counted over one frame.
+struct RenderStatsFrame
+{
+	uint64_t frameIndex = 0;
+	uint64_t values[(size_t)RenderStat::Count] = {};
+
+	inline uint64_t operator[](RenderStat stat) const { return values[(size_t)stat]; }
+};
+
+//Counts the work the backend hands to GL, per frame. Our GL wrappers add to it as they go (draws, binds, uniforms, allocations and uploads), so anything
+//drawn through them shows up without the caller doing a thing. Raw GL calls, and ImGui's own drawing, aren't counted.
+//Counting is a relaxed atomic add, as resources can be created on the UploadThread while the render thread draws. OpenGLRenderer::EndFrame closes
+//each frame off into a snapshot, kept in a history of the last s_HistoryLength frames, and optionally written as one CSV row per frame, which is the
+//format to diff between runs, such as checking a CI run's draw calls didn't jump from 2k to 9k.
+class RenderStats
+{
+public:
+	inline static void Add(RenderStat stat, uint64_t amount = 1) { s_Current[(size_t)stat].fetch_add(amount, std::memory_order_relaxed); }
+	inline static void Set(RenderStat stat, uint64_t value) { s_Current[(size_t)stat].store(value, std::memory_order_relaxed); } //For levels, set again every frame.
+	static void RecordDraw(uint64_t indexCount, uint64_t instanceCount = 1); //One draw call of GL_TRIANGLES.
+
+	static void EndFrame(); //Called from OpenGLRenderer::EndFrame.
+
+	//Any thread.
+	static RenderStatsFrame GetLastFrame();
+	static void GetHistory(std::vector<RenderStatsFrame>& history); //Oldest first.
+
+	//Writes a header naming every stat, then a row per frame from the next EndFrame on. Replaces any dump already running.
+	static bool StartDump(const std::string& path);
+	static void StopDump();
+
+	static const char* GetName(RenderStat stat); //"Draw Calls"
+	static const char* GetKey(RenderStat stat); //"draw_calls", as the dump's header has it.
+
+	static void OnImGuiRender(); //A small overlay in the top right corner. Main thread, between ImGui::NewFrame and ImGui::Render.
+
+	static constexpr unsigned int s_HistoryLength = 240;
+
+private:
+	static std::atomic<uint64_t> s_Current[(size_t)RenderStat::Count];
+	static uint64_t s_FrameIndex;
+
+	static std::mutex s_Mutex; //Guards everything below.
+	static std::vector<RenderStatsFrame> s_History; //A ring, once full. s_HistoryCursor is where the next frame goes.
+	static size_t s_HistoryCursor;
+	static RenderStatsFrame s_LastFrame;
+	static std::ofstream s_Dump;
+};
@@ -0,0 +1,233 @@
+#include "GAAPrecompiledHeader.h"
+#include "RenderThread.h"
+#include "OpenGLRenderer.h"
+#include "GPUProfiler.h"
+#include "Instrumentation.h"
+#include "GL/glew.h"
+#include "GLFW/glfw3.h"
+#include "imgui/imgui_impl_opengl3.h"
+#include <algorithm>
+#include <chrono>
+
+GLFWwindow* RenderThread::s_Window = nullptr;
+std::thread RenderThread::s_Thread;
+bool RenderThread::s_Running = false;
+bool RenderThread::s_Quit = false;
+unsigned int RenderThread::s_MaxFramesAhead = 1;
+std::vector<std::unique_ptr<FramePacket>> RenderThread::s_Packets;
+std::mutex RenderThread::s_Mutex;
+std::condition_variable RenderThread::s_FrameSubmitted;
+std::condition_variable RenderThread::s_FrameRendered;
+uint64_t RenderThread::s_SubmittedFrames = 0;
+uint64_t RenderThread::s_RenderedFrames = 0;
+std::mutex RenderThread::s_OperationMutex;
+CommandBuffer RenderThread::s_PendingOperations;
+std::atomic<float> RenderThread::s_RenderMilliseconds(0.0f);
+float RenderThread::s_WaitMilliseconds = 0.0f;
+
+FramePacket::~FramePacket()
+{
+	for (ImDrawList* drawList : m_ImGuiDrawLists)
+	{
+		IM_DELETE(drawList);
+	}
+}
+
+void FramePacket::CaptureImGui(ImDrawData* drawData)
+{
+	if (drawData == nullptr || !drawData->Valid)
+	{
+		m_HasImGui = false;
+		return;
+	}
+
+	while ((int)m_ImGuiDrawLists.size() < drawData->CmdListsCount)
+	{
+		m_ImGuiDrawLists.push_back(IM_NEW(ImDrawList)(nullptr)); //Only ever used to hold buffers, so it needs none of ImGui's shared data.
+	}
+	for (int i = 0; i < drawData->CmdListsCount; i++)
+	{
+		//ImGui clears its lists when the next frame starts, keeping whatever capacity they have, so it doesn't mind getting ours back instead.
+		ImDrawList* source = drawData->CmdLists[i];
+		ImDrawList* destination = m_ImGuiDrawLists[i];
+		destination->CmdBuffer.swap(source->CmdBuffer);
+		destination->IdxBuffer.swap(source->IdxBuffer);
+		destination->VtxBuffer.swap(source->VtxBuffer);
+		destination->Flags = source->Flags;
+	}
+	m_ImGuiDrawData = *drawData;
+	m_ImGuiDrawData.CmdLists = m_ImGuiDrawLists.data();
+	m_HasImGui = true;
+}
+
+void FramePacket::Reset()
+{
+	commands.Reset();
+	resourceOperations.Reset();
+	m_HasImGui = false;
+}
+
+void RenderThread::Start(GLFWwindow* window, unsigned int maxFramesAhead)
+{
+	if (s_Running)
+	{
+		std::cout << "Warning: The render thread is already running! \n";
+		return;
+	}
+
+	s_Window = window;
+	s_MaxFramesAhead = std::max(1u, maxFramesAhead);
+	s_Packets.clear();
+	for (unsigned int i = 0; i <= s_MaxFramesAhead; i++)
+	{
+		s_Packets.push_back(std::make_unique<FramePacket>());
+	}
+	s_SubmittedFrames = 0;
+	s_RenderedFrames = 0;
+	s_Quit = false;
+
+	//Packets, and anything else the main thread records, live in frame memory, whose arenas turn over once per rendered frame. The main thread can be recording
+	//up to maxFramesAhead frames past the one being rendered, and one more before BeginFrame has waited for its packet, so that many arenas have to be in the ring.
+	FrameAllocator::ReserveArenas(s_MaxFramesAhead + 2);
+
+	//A context can only be current on one thread at a time, so we let go of it before the render thread picks it up.
+	glfwMakeContextCurrent(nullptr);
+	s_Running = true;
+	s_Thread = std::thread(&RenderThread::ThreadLoop);
+}
+
+void RenderThread::Stop()
+{
+	if (!s_Running)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		s_Quit = true;
+	}
+	s_FrameSubmitted.notify_one();
+	s_Thread.join();
+
+	glfwMakeContextCurrent(s_Window);
+	s_Running = false;
+
+	//Anything enqueued after the last frame was submitted still has to happen, and this is the GL thread again now.
+	CommandBuffer operations;
+	{
+		std::lock_guard<std::mutex> lock(s_OperationMutex);
+		operations.Append(s_PendingOperations, 0, s_PendingOperations.GetSize());
+		s_PendingOperations.Reset();
+	}
+	operations.Execute();
+	operations.Reset();
+}
+
+FramePacket& RenderThread::BeginFrame()
+{
+	ASSERT(s_Running);
+	auto start = std::chrono::steady_clock::now();
+
+	//Frame n goes into the packet frame n - (maxFramesAhead + 1) used, so that one has to be rendered first.
+	GAA_PROFILE_ZONE("Wait For Render Thread");
+	std::unique_lock<std::mutex> lock(s_Mutex);
+	s_FrameRendered.wait(lock, []() { return s_SubmittedFrames - s_RenderedFrames <= s_MaxFramesAhead; });
+	s_WaitMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	FramePacket& packet = *s_Packets[s_SubmittedFrames % s_Packets.size()];
+	packet.m_FrameIndex = s_SubmittedFrames;
+	return packet;
+}
+
+void RenderThread::SubmitFrame()
+{
+	ASSERT(s_Running);
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		FramePacket& packet = *s_Packets[s_SubmittedFrames % s_Packets.size()];
+		{
+			std::lock_guard<std::mutex> operationLock(s_OperationMutex);
+			if (!s_PendingOperations.IsEmpty())
+			{
+				packet.resourceOperations.Append(s_PendingOperations, 0, s_PendingOperations.GetSize());
+				s_PendingOperations.Reset();
+			}
+		}
+		s_SubmittedFrames++;
+	}
+	s_FrameSubmitted.notify_one();
+}
+
+void RenderThread::WaitForIdle()
+{
+	if (!s_Running)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(s_Mutex);
+	s_FrameRendered.wait(lock, []() { return s_RenderedFrames == s_SubmittedFrames; });
+}
+
+bool RenderThread::IsRenderThread()
+{
+	return s_Running && std::this_thread::get_id() == s_Thread.get_id();
+}
+
+void RenderThread::ThreadLoop()
+{
+	GAA_PROFILE_THREAD("Render Thread");
+	glfwMakeContextCurrent(s_Window);
+	while (true)
+	{
+		FramePacket* packet = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(s_Mutex);
+			s_FrameSubmitted.wait(lock, []() { return s_RenderedFrames < s_SubmittedFrames || s_Quit; });
+			if (s_RenderedFrames == s_SubmittedFrames)
+			{
+				break; //Asked to quit, and every submitted frame is rendered.
+			}
+			packet = s_Packets[s_RenderedFrames % s_Packets.size()].get();
+		}
+
+		RenderFrame(*packet);
+
+		{
+			std::lock_guard<std::mutex> lock(s_Mutex);
+			s_RenderedFrames++;
+		}
+		s_FrameRendered.notify_all();
+	}
+	glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::RenderFrame(FramePacket& packet)
+{
+	GAA_PROFILE_FUNCTION();
+	auto start = std::chrono::steady_clock::now();
+	GPUProfiler::BeginFrame();
+	{
+		GPU_PROFILE_SCOPE("Resource Operations");
+		packet.resourceOperations.Execute();
+	}
+	{
+		GPU_PROFILE_SCOPE("Commands");
+		packet.commands.Execute();
+	}
+	if (packet.m_HasImGui)
+	{
+		GPU_PROFILE_SCOPE("ImGui");
+		ImGui_ImplOpenGL3_RenderDrawData(&packet.m_ImGuiDrawData);
+	}
+	GPUProfiler::EndFrame();
+	s_RenderMilliseconds.store(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+
+	{
+		GAA_PROFILE_ZONE("Swap Buffers");
+		glfwSwapBuffers(s_Window);
+	}
+	packet.Reset(); //Before EndFrame, as that may reset the arena holding the packet's commands and callbacks while we'd still destroy them.
+	OpenGLRenderer::EndFrame(); //Retires resources destroyed in frames the GPU has finished with.
+}
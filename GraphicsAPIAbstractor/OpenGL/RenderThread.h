@@ -0,0 +1,101 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "CommandBuffer.h"
+#include "imgui/imgui.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+struct GLFWwindow;
+
+//Everything the render thread needs to draw one frame, filled in by the main thread a frame ahead of it.
+class FramePacket
+{
+public:
+	FramePacket() = default;
+	~FramePacket();
+
+	FramePacket(const FramePacket&) = delete;
+	FramePacket& operator=(const FramePacket&) = delete;
+
+	CommandBuffer commands;
+	CommandBuffer resourceOperations; //Callbacks run before the commands: creating, filling and destroying GL objects.
+
+	//ImGui reuses its draw lists as soon as the next frame starts, which is long before the render thread gets to them, so we take their contents over.
+	//Swapping buffers with ImGui rather than copying them means the packet ends up with the data and ImGui with our old, already allocated, buffers.
+	void CaptureImGui(ImDrawData* drawData);
+
+	inline uint64_t GetFrameIndex() const { return m_FrameIndex; }
+
+private:
+	friend class RenderThread;
+	void Reset();
+
+	uint64_t m_FrameIndex = 0;
+	std::vector<ImDrawList*> m_ImGuiDrawLists;
+	ImDrawData m_ImGuiDrawData;
+	bool m_HasImGui = false;
+};
+
+//Moves every GL call onto a thread of its own, which takes the window's context over, so that simulating one frame overlaps with the driver working through
+//the previous one instead of adding up. The main thread fills a FramePacket and submits it; the render thread executes it, presents and retires resources.
+//maxFramesAhead bounds how far the main thread may run ahead, which is also how much input latency this adds. Reaching it makes BeginFrame block.
+//GLFW wants events polled on the main thread, which is where they stay. Swapping buffers is fine from any thread.
+class RenderThread
+{
+public:
+	//Call on the main thread, with the window's context current. The context moves to the render thread until Stop.
+	static void Start(GLFWwindow* window, unsigned int maxFramesAhead = 1);
+	static void Stop(); //Renders every frame already submitted, then hands the context back to the calling thread.
+
+	static FramePacket& BeginFrame(); //Main thread. Blocks while maxFramesAhead submitted frames are still waiting for the render thread.
+	static void SubmitFrame();
+
+	//Any thread. Runs on the render thread ahead of the next submitted frame's commands, and after every frame submitted before it, which makes it the safe
+	//place to destroy something earlier frames still draw with. Before Start, or after Stop, it runs right away.
+	//The function goes into frame memory as a CommandBuffer callback rather than a std::function, so enqueueing doesn't allocate either.
+	template<typename Function>
+	static void Enqueue(Function&& operation)
+	{
+		if (!s_Running)
+		{
+			operation();
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(s_OperationMutex);
+		s_PendingOperations.Callback(std::forward<Function>(operation));
+	}
+	static void WaitForIdle(); //Blocks until every submitted frame has been rendered.
+
+	static bool IsRenderThread();
+	inline static bool IsRunning() { return s_Running; }
+	inline static unsigned int GetMaxFramesAhead() { return s_MaxFramesAhead; }
+	inline static float GetRenderMilliseconds() { return s_RenderMilliseconds.load(std::memory_order_relaxed); } //The render thread's last frame, excluding waiting for it.
+	inline static float GetWaitMilliseconds() { return s_WaitMilliseconds; } //How long the last BeginFrame blocked for. Mostly 0 unless we are GPU or driver bound.
+
+private:
+	static void ThreadLoop();
+	static void RenderFrame(FramePacket& packet);
+
+	static GLFWwindow* s_Window;
+	static std::thread s_Thread;
+	static bool s_Running;
+	static bool s_Quit; //Guarded by s_Mutex.
+	static unsigned int s_MaxFramesAhead;
+	static std::vector<std::unique_ptr<FramePacket>> s_Packets; //A ring of maxFramesAhead + 1. Frame n uses s_Packets[n % size].
+
+	static std::mutex s_Mutex;
+	static std::condition_variable s_FrameSubmitted;
+	static std::condition_variable s_FrameRendered;
+	static uint64_t s_SubmittedFrames; //Both guarded by s_Mutex.
+	static uint64_t s_RenderedFrames;
+
+	static std::mutex s_OperationMutex;
+	static CommandBuffer s_PendingOperations; //Moved into the next submitted packet.
+
+	static std::atomic<float> s_RenderMilliseconds;
+	static float s_WaitMilliseconds;
+};
@@ -0,0 +1,36 @@
+#include "GAAPrecompiledHeader.h"
+#include "ResourceRegistry.h"
+#include "RenderThread.h"
+
+ResourcePool<VertexArray> ResourceRegistry::s_VertexArrays;
+ResourcePool<VertexBuffer> ResourceRegistry::s_VertexBuffers;
+ResourcePool<IndexBuffer> ResourceRegistry::s_IndexBuffers;
+ResourcePool<Shader> ResourceRegistry::s_Shaders;
+ResourcePool<Texture> ResourceRegistry::s_Textures;
+
+void ResourceRegistry::EndFrame()
+{
+	//Called after DeletionQueue::EndFrame, so the frame before its current one is the one the GL thread just finished executing.
+	uint64_t completedFrame = DeletionQueue::GetFrameIndex() - 1;
+	s_VertexArrays.CollectGarbage(completedFrame);
+	s_VertexBuffers.CollectGarbage(completedFrame);
+	s_IndexBuffers.CollectGarbage(completedFrame);
+	s_Shaders.CollectGarbage(completedFrame);
+	s_Textures.CollectGarbage(completedFrame);
+}
+
+uint64_t ResourceRegistry::GetRetireFrame()
+{
+	//Without a render thread, everything recorded so far is executed by the end of the frame the GL thread is on. With one, the main thread may be recording
+	//up to maxFramesAhead frames past it, and those have to be executed too.
+	return DeletionQueue::GetFrameIndex() + (RenderThread::IsRunning() ? RenderThread::GetMaxFramesAhead() : 0);
+}
+
+void ResourceRegistry::Shutdown()
+{
+	s_VertexArrays.Clear();
+	s_VertexBuffers.Clear();
+	s_IndexBuffers.Clear();
+	s_Shaders.Clear();
+	s_Textures.Clear();
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "ResourcePool.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "DeletionQueue.h"
+
+using VertexArrayHandle = Handle<VertexArray>;
+using VertexBufferHandle = Handle<VertexBuffer>;
+using IndexBufferHandle = Handle<IndexBuffer>;
+using ShaderHandle = Handle<Shader>;
+using TextureHandle = Handle<Texture>;
+
+//Owns one pool per GPU resource type. Resources are created and looked up through handles. Destroying one keeps the object alive until the GL thread has
+//executed every frame that could have recorded commands pointing at it. Its destructor then hands the GL names to the DeletionQueue, whose fences alone
+//cover the GPU's side, so nothing waits on the GPU twice. Call EndFrame() once per frame after the DeletionQueue's.
+class ResourceRegistry
+{
+public:
+	inline static ResourcePool<VertexArray>& VertexArrays() { return s_VertexArrays; }
+	inline static ResourcePool<VertexBuffer>& VertexBuffers() { return s_VertexBuffers; }
+	inline static ResourcePool<IndexBuffer>& IndexBuffers() { return s_IndexBuffers; }
+	inline static ResourcePool<Shader>& Shaders() { return s_Shaders; }
+	inline static ResourcePool<Texture>& Textures() { return s_Textures; }
+
+	inline static VertexArray* Get(VertexArrayHandle handle) { return s_VertexArrays.Get(handle); }
+	inline static VertexBuffer* Get(VertexBufferHandle handle) { return s_VertexBuffers.Get(handle); }
+	inline static IndexBuffer* Get(IndexBufferHandle handle) { return s_IndexBuffers.Get(handle); }
+	inline static Shader* Get(ShaderHandle handle) { return s_Shaders.Get(handle); }
+	inline static Texture* Get(TextureHandle handle) { return s_Textures.Get(handle); }
+
+	inline static void Destroy(VertexArrayHandle handle) { s_VertexArrays.Destroy(handle, GetRetireFrame()); }
+	inline static void Destroy(VertexBufferHandle handle) { s_VertexBuffers.Destroy(handle, GetRetireFrame()); }
+	inline static void Destroy(IndexBufferHandle handle) { s_IndexBuffers.Destroy(handle, GetRetireFrame()); }
+	inline static void Destroy(ShaderHandle handle) { s_Shaders.Destroy(handle, GetRetireFrame()); }
+	inline static void Destroy(TextureHandle handle) { s_Textures.Destroy(handle, GetRetireFrame()); }
+
+	static void EndFrame(); //Retires anything destroyed in a frame the GL thread has executed.
+	static void Shutdown(); //Destroys everything immediately. Only call once the GPU is idle.
+
+private:
+	static uint64_t GetRetireFrame(); //The DeletionQueue frame after which nothing recorded so far can still point at a destroyed object.
+
+	static ResourcePool<VertexArray> s_VertexArrays;
+	static ResourcePool<VertexBuffer> s_VertexBuffers;
+	static ResourcePool<IndexBuffer> s_IndexBuffers;
+	static ResourcePool<Shader> s_Shaders;
+	static ResourcePool<Texture> s_Textures;
+};
@@ -0,0 +1,77 @@
+#include "GAAPrecompiledHeader.h"
+#include "SamplerCache.h"
+#include "RenderStats.h"
+
+std::unordered_map<SamplerState, unsigned int, SamplerStateHash> SamplerCache::s_Samplers;
+std::array<unsigned int, 32> SamplerCache::s_BoundSamplers = {};
+
+size_t SamplerStateHash::operator()(const SamplerState& state) const
+{
+	//Boost's hash_combine. The enums are small and well distributed, so this is plenty.
+	size_t hash = 0;
+	auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+	combine(state.minFilter);
+	combine(state.magFilter);
+	combine(state.wrapS);
+	combine(state.wrapT);
+	combine(std::hash<float>()(state.maxAnisotropy));
+	return hash;
+}
+
+unsigned int SamplerCache::GetSampler(const SamplerState& state)
+{
+	auto iterator = s_Samplers.find(state);
+	if (iterator != s_Samplers.end())
+	{
+		return iterator->second;
+	}
+
+	unsigned int sampler;
+	glGenSamplers(1, &sampler);
+	glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, state.minFilter);
+	glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, state.magFilter);
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, state.wrapS);
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, state.wrapT);
+	if (state.maxAnisotropy > 1.0f && GLEW_EXT_texture_filter_anisotropic)
+	{
+		glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, state.maxAnisotropy);
+	}
+
+	s_Samplers[state] = sampler;
+	return sampler;
+}
+
+void SamplerCache::Bind(unsigned int slot, const SamplerState& state)
+{
+	unsigned int sampler = GetSampler(state);
+	if (slot < s_BoundSamplers.size() && s_BoundSamplers[slot] == sampler)
+	{
+		return;
+	}
+
+	glBindSampler(slot, sampler); //Sampler state on a slot overrides whatever parameters are set on the texture bound there.
+	RenderStats::Add(RenderStat::SamplerBinds);
+	if (slot < s_BoundSamplers.size())
+	{
+		s_BoundSamplers[slot] = sampler;
+	}
+}
+
+void SamplerCache::Unbind(unsigned int slot)
+{
+	glBindSampler(slot, 0);
+	if (slot < s_BoundSamplers.size())
+	{
+		s_BoundSamplers[slot] = 0;
+	}
+}
+
+void SamplerCache::Clear()
+{
+	for (auto& sampler : s_Samplers)
+	{
+		glDeleteSamplers(1, &sampler.second);
+	}
+	s_Samplers.clear();
+	s_BoundSamplers.fill(0);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "GL/glew.h"
+
+//Describes how a texture is sampled. These used to be glTexParameteri calls on every texture object, but OpenGL 3.3 lets us keep them in separate sampler objects.
+//Hundreds of textures tend to share a handful of these, so we hash them into a shared cache and bind the matching sampler to the texture's slot instead.
+struct SamplerState
+{
+	unsigned int minFilter = GL_LINEAR;
+	unsigned int magFilter = GL_LINEAR;
+	unsigned int wrapS = GL_CLAMP_TO_EDGE;
+	unsigned int wrapT = GL_CLAMP_TO_EDGE;
+	float maxAnisotropy = 1.0f; //Only applied if EXT_texture_filter_anisotropic is available.
+
+	bool operator==(const SamplerState& other) const
+	{
+		return minFilter == other.minFilter && magFilter == other.magFilter && wrapS == other.wrapS && wrapT == other.wrapT && maxAnisotropy == other.maxAnisotropy;
+	}
+};
+
+struct SamplerStateHash
+{
+	size_t operator()(const SamplerState& state) const;
+};
+
+//Like every other GL object cache here this is only touched from the thread owning the context, so it takes no locks.
+class SamplerCache
+{
+public:
+	static unsigned int GetSampler(const SamplerState& state); //Creates the sampler object on first use.
+	static void Bind(unsigned int slot, const SamplerState& state);
+	static void Unbind(unsigned int slot);
+	static void Clear(); //Deletes every cached sampler. Call before the context is destroyed.
+
+	inline static size_t GetSamplerCount() { return s_Samplers.size(); }
+
+private:
+	static std::unordered_map<SamplerState, unsigned int, SamplerStateHash> s_Samplers;
+	static std::array<unsigned int, 32> s_BoundSamplers; //What we last bound per texture slot, so rebinding the same sampler costs nothing.
+};
@@ -1,23 +1,51 @@
 #include "GAAPrecompiledHeader.h"
 #include "Shader.h"
+#include "DeletionQueue.h"
 #include "OpenGLRenderer.h"
+#include "VertexBufferLayout.h"
+#include "Instrumentation.h"
+#include "RenderStats.h"
 #include "GL/glew.h"
 
 
-Shader::Shader(const std::string& filePath) : m_FilePath(filePath), m_RendererID(0)
+Shader::Shader(const std::string& filePath) : m_FilePath(filePath), m_RendererID(0), m_IsCompute(false)
 {
+    GAA_PROFILE_FUNCTION();
     ShaderProgramSource source = ParseShader(filePath);
-    m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+    m_IsCompute = !source.ComputeSource.empty();
+    m_RendererID = m_IsCompute ? CreateComputeShader(source.ComputeSource) : CreateShader(source.VertexSource, source.FragmentSource);
+    ReflectAttributes();
 }
 
 Shader::~Shader()
 {
-    glDeleteProgram(m_RendererID);
+    DeletionQueue::Enqueue(GLObjectType::Program, m_RendererID);
+}
+
+Shader::Shader(Shader&& other) noexcept : m_RendererID(other.m_RendererID), m_FilePath(std::move(other.m_FilePath)), m_IsCompute(other.m_IsCompute), m_Attributes(std::move(other.m_Attributes)), m_UniformLocationCache(std::move(other.m_UniformLocationCache))
+{
+    other.m_RendererID = 0;
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept
+{
+    if (this != &other)
+    {
+        DeletionQueue::Enqueue(GLObjectType::Program, m_RendererID);
+        m_RendererID = other.m_RendererID;
+        m_FilePath = std::move(other.m_FilePath);
+        m_IsCompute = other.m_IsCompute;
+        m_Attributes = std::move(other.m_Attributes);
+        m_UniformLocationCache = std::move(other.m_UniformLocationCache);
+        other.m_RendererID = 0;
+    }
+    return *this;
 }
 
 void Shader::Bind() const
 {
     glUseProgram(m_RendererID);
+    RenderStats::Add(RenderStat::ShaderBinds);
 }
 
 void Shader::Unbind() const
@@ -25,58 +53,131 @@ void Shader::Unbind() const
     glUseProgram(0);
 }
 
-void Shader::SetUniform1i(const std::string& name, int value)
+void Shader::SetUniform1i(const char* name, int value)
 {
     glUniform1i(GetUniformLocation(name), value);
+    RenderStats::Add(RenderStat::UniformUploads);
 }
 
-void Shader::SetUniform1f(const std::string& name, float value)
+void Shader::SetUniform1f(const char* name, float value)
 {
     glUniform1f(GetUniformLocation(name), value);
+    RenderStats::Add(RenderStat::UniformUploads);
 }
 
 //We must have a shader bound before setting uniform data so that it knows which shader to send on to.
 //The difference between each uniform is the type of data we're sending and how many components we have. In this, case its a Vec4 aka 4 floats. 
 //When a shader is created, every uniform is assigned an ID which we can then reference. 
 //We reference it by name! :)
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+void Shader::SetUniform4f(const char* name, float v0, float v1, float v2, float v3)
 {
     glUniform4f(GetUniformLocation(name), v0, v1, v2, v3);
+    RenderStats::Add(RenderStat::UniformUploads);
+}
+
+void Shader::SetUniform4fv(const char* name, unsigned int count, const float* values)
+{
+    glUniform4fv(GetUniformLocation(name), count, values);
+    RenderStats::Add(RenderStat::UniformUploads);
 }
 
-void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
+void Shader::SetUniformMat4f(const char* name, const glm::mat4& matrix)
 {
     //0, 0 means element 0 inside column 0 in &matrix.
     glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]); //v means we're passing it a float array. 1 because we're passing in 1 matrix. Transpose means whether we need to adjust how the matrix's memory is laid out in memory. (rows or columns) GLM stores the matrixes in column major, so we don't need to do anything.  
+    RenderStats::Add(RenderStat::UniformUploads);
 }
 
-int Shader::GetUniformLocation(const std::string& name)
+int Shader::GetUniformLocation(const char* name)
 {
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
+    for (const UniformLocation& uniform : m_UniformLocationCache)
     {
-        return m_UniformLocationCache[name];
+        if (uniform.name == name)
+        {
+            return uniform.location;
+        }
     }
-    int location = glGetUniformLocation(m_RendererID, name.c_str());
+    int location = glGetUniformLocation(m_RendererID, name);
     if (location == -1) //Stripped/Can't Obtain Uniform
     {
         std::cout << "Warning: Uniform " << name << " doesn't exist! \n";
     }
-    m_UniformLocationCache[name] = location;
+    m_UniformLocationCache.push_back({ name, location });
    
     return location;
 }
 
+static unsigned int GetAttributeComponentCount(unsigned int type)
+{
+    switch (type)
+    {
+        case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT:                       return 1;
+        case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2:        return 2;
+        case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3:        return 3;
+        case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4:        return 4;
+    }
+    return 4; //Matrices take a location per column, each of which is a vec4 at most.
+}
+
+void Shader::ReflectAttributes()
+{
+    m_Attributes.clear();
+    int attributeCount = 0, maxNameLength = 0;
+    glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+    glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> name(std::max(maxNameLength, 1));
+    for (int i = 0; i < attributeCount; i++)
+    {
+        int size = 0, length = 0;
+        unsigned int type = 0;
+        glGetActiveAttrib(m_RendererID, i, (int)name.size(), &length, &size, &type, name.data());
+        int location = glGetAttribLocation(m_RendererID, name.data());
+        if (location == -1) //Built-ins such as gl_VertexID are reported too, but have no location.
+        {
+            continue;
+        }
+        m_Attributes.push_back({ std::string(name.data(), length), location, type, GetAttributeComponentCount(type) });
+    }
+}
+
+bool Shader::IsCompatibleWith(const VertexBufferLayout& layout) const
+{
+    return IsCompatibleWith(layout.GetElements().data(), (unsigned int)layout.GetElements().size());
+}
+
+bool Shader::IsCompatibleWith(const VertexBufferElement* elements, unsigned int elementCount) const
+{
+    bool compatible = true;
+    for (const ShaderAttribute& attribute : m_Attributes)
+    {
+        if ((unsigned int)attribute.location >= elementCount)
+        {
+            std::cout << "Warning: " << m_FilePath << " reads attribute " << attribute.name << " at location " << attribute.location << ", but the layout only has " << elementCount << " elements! \n";
+            compatible = false;
+        }
+        //Packed formats always have 4 components, but their 2 bit w is often just padding behind a vec3.
+        else if (elements[attribute.location].count > attribute.componentCount && !(VertexBufferElement::IsPackedType(elements[attribute.location].type) && attribute.componentCount >= 3))
+        {
+            //Fewer components than the shader declares is fine, OpenGL fills in the rest with (0, 0, 0, 1). More means the layout is probably wrong.
+            std::cout << "Warning: " << m_FilePath << " declares " << attribute.name << " with " << attribute.componentCount << " components, but the layout provides " << elements[attribute.location].count << "! \n";
+            compatible = false;
+        }
+    }
+    return compatible;
+}
+
 ShaderProgramSource Shader::ParseShader(const std::string& filePath)
 {
     std::ifstream stream(filePath);
 
     enum class ShaderType
     {
-        None = -1, Vertex = 0, Fragment = 1
+        None = -1, Vertex = 0, Fragment = 1, Compute = 2
     };
 
     std::string line;
-    std::stringstream ss[2];
+    std::stringstream ss[3];
     ShaderType type = ShaderType::None;
 
     while (getline(stream, line))
@@ -91,18 +192,23 @@ ShaderProgramSource Shader::ParseShader(const std::string& filePath)
             {
                 type = ShaderType::Fragment;
             }
+            else if (line.find("compute") != std::string::npos)
+            {
+                type = ShaderType::Compute;
+            }
         }
-        else
+        else if (type != ShaderType::None)
         {
             //The enum index here is used as the array index. Hence the above manual index assignments. Smart!
             ss[(int)type] << line << "\n";
         }
     }
-    return { ss[0].str(), ss[1].str() };
+    return { ss[0].str(), ss[1].str(), ss[2].str() };
 }
 
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 {
+    GAA_PROFILE_FUNCTION();
     unsigned int id = glCreateShader(type);
     const char* src = source.c_str();
     glShaderSource(id, 1, &src, nullptr);
@@ -116,7 +222,7 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
         glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
         char* message = (char*)alloca(length * sizeof(char)); //Alloca allows us to allocate on the stack dynamically. 
         glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << "shader!" << "\n";
+        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : type == GL_FRAGMENT_SHADER ? "fragment" : "compute") << " shader!" << "\n";
         std::cout << message << "\n";
         glDeleteShader(id);
         return 0;
@@ -127,6 +233,7 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 
 unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
 {
+    GAA_PROFILE_FUNCTION(); //Linking, which is where a lot of drivers do the real compiling.
     unsigned int program = glCreateProgram();
     unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
     unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
@@ -141,4 +248,22 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
     glDeleteShader(fs);
 
     return program;
-}
\ No newline at end of file
+}
+
+unsigned int Shader::CreateComputeShader(const std::string& computeShader)
+{
+    //Compute shaders arrived in GL 4.3. Without them there is nothing to compile, and callers are expected to have checked before loading one.
+    if (!GLEW_VERSION_4_3 && !GLEW_ARB_compute_shader)
+    {
+        std::cout << "Warning: " << m_FilePath << " is a compute shader, which this driver doesn't support! \n";
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    unsigned int cs = CompileShader(GL_COMPUTE_SHADER, computeShader);
+    glAttachShader(program, cs);
+    glLinkProgram(program);
+    glDeleteShader(cs);
+
+    return program;
+}
@@ -2,10 +2,23 @@
 #include "GAAPrecompiledHeader.h"
 #include "glm/glm.hpp"
 
+class VertexBufferLayout;
+struct VertexBufferElement;
+
+//An active vertex input as reported by the linked program.
+struct ShaderAttribute
+{
+	std::string name;
+	int location;
+	unsigned int type; //GL_FLOAT_VEC3 and so on.
+	unsigned int componentCount;
+};
+
 struct ShaderProgramSource
 {
 	std::string VertexSource;
 	std::string FragmentSource;
+	std::string ComputeSource; //A compute shader goes in a program of its own, so a file has either this or the two above.
 };
 
 class Shader
@@ -14,22 +27,46 @@ public:
 	Shader(const std::string& filePath);
 	~Shader();
 
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
 	void Bind() const;
 	void Unbind() const;
 
 	//Set Uniforms
-	void SetUniform1i(const std::string& name, int value); //To take in a texture slot. The int sent is the texture slot ID the texture is bound om/
-	void SetUniform1f(const std::string& name, float value);
-	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
+	//Names are taken as const char* so that setting a uniform by literal never builds a temporary std::string.
+	void SetUniform1i(const char* name, int value); //To take in a texture slot. The int sent is the texture slot ID the texture is bound om/
+	void SetUniform1f(const char* name, float value);
+	void SetUniform4f(const char* name, float v0, float v1, float v2, float v3);
+	void SetUniform4fv(const char* name, unsigned int count, const float* values); //An array of count vec4s.
+	void SetUniformMat4f(const char* name, const glm::mat4& matrix);
+
+	//Checks the vertex inputs we reflected after linking against a layout. Layout element i feeds attribute location i, as set up by VertexArray::AddBuffer.
+	inline bool IsCompute() const { return m_IsCompute; } //Dispatched with glDispatchCompute rather than drawn with.
+	inline const std::vector<ShaderAttribute>& GetAttributes() const { return m_Attributes; }
+	bool IsCompatibleWith(const VertexBufferLayout& layout) const;
+	template<typename Layout>
+	bool IsCompatibleWith() const { return IsCompatibleWith(Layout::Elements.data(), Layout::AttributeCount); }
+	bool IsCompatibleWith(const VertexBufferElement* elements, unsigned int elementCount) const;
 private:
 	unsigned int m_RendererID;
 	std::string m_FilePath;
-	std::unordered_map<std::string, int> m_UniformLocationCache; //Remember that Uniform Locations in OpenGL is always a 32bit Integer, not unsigned.
+	bool m_IsCompute;
+	struct UniformLocation
+	{
+		std::string name;
+		int location; //Remember that Uniform Locations in OpenGL is always a 32bit Integer, not unsigned.
+	};
+	std::vector<ShaderAttribute> m_Attributes;
+	std::vector<UniformLocation> m_UniformLocationCache; //Shaders only have a handful of uniforms, so a linear scan is cheap, and comparing against a const char* never allocates.
 private:
 	ShaderProgramSource ParseShader(const std::string& filePath);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
 	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	int GetUniformLocation(const std::string& name);
+	unsigned int CreateComputeShader(const std::string& computeShader);
+	int GetUniformLocation(const char* name);
+	void ReflectAttributes();
 
 };
@@ -0,0 +1,41 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec4 normal;
+layout(location = 2) in vec2 texCoord;
+
+uniform mat4 u_Model;
+uniform mat4 u_ViewProjection;
+//One per attribute, as Mesh::ApplyDequantization sets them. Remapped attributes arrive in [0, 1] and are decoded with fetched * scale + offset.
+uniform vec4 u_DequantizeScale[3];
+uniform vec4 u_DequantizeOffset[3];
+
+out vec3 v_Normal;
+out vec2 v_TexCoord;
+
+void main()
+{
+   vec3 decodedPosition = position.xyz * u_DequantizeScale[0].xyz + u_DequantizeOffset[0].xyz;
+   v_Normal = mat3(u_Model) * (normal.xyz * u_DequantizeScale[1].xyz + u_DequantizeOffset[1].xyz);
+   v_TexCoord = texCoord * u_DequantizeScale[2].xy + u_DequantizeOffset[2].xy;
+   gl_Position = u_ViewProjection * u_Model * vec4(decodedPosition, 1.0);
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec3 v_Normal;
+in vec2 v_TexCoord;
+
+uniform vec4 u_Color;
+
+void main()
+{
+   //A checker from the texture coordinates, so that decoding them wrong shows as well as decoding the positions wrong.
+   float checker = mod(floor(v_TexCoord.x * 16.0) + floor(v_TexCoord.y * 8.0), 2.0);
+   float lighting = 0.3 + 0.7 * max(dot(normalize(v_Normal), normalize(vec3(0.4, 0.8, 0.6))), 0.0);
+   color = vec4(u_Color.rgb * lighting * (0.85 + 0.15 * checker), u_Color.a);
+};
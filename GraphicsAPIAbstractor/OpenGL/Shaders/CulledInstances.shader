@@ -0,0 +1,30 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec3 position;
+//Per draw, through baseInstance, as in MultiDrawIndirect.shader.
+layout(location = 1) in vec4 offsetScale;
+layout(location = 2) in vec4 color;
+
+out vec4 v_Color;
+uniform mat4 u_ViewProjection;
+
+void main()
+{
+   gl_Position = u_ViewProjection * vec4(position * offsetScale.w + offsetScale.xyz, 1.0);
+   //There are no normals, but the corners of a unit cube point roughly the right way for some cheap shading.
+   float shade = 0.6 + 0.4 * dot(normalize(position), normalize(vec3(0.4, 0.8, 0.3)));
+   v_Color = vec4(color.rgb * shade, color.a);
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+   color = v_Color;
+};
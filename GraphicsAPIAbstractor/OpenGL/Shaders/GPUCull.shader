@@ -0,0 +1,102 @@
+#shader compute
+#version 430 core
+
+//One invocation per draw. Draws whose bounds pass the frustum, and then the previous frame's depth pyramid, are appended to the visible commands.
+//GPUCuller::CullOnCPU is the same test on the CPU, so keep the two in step.
+layout(local_size_x = 64) in;
+
+struct DrawCommand
+{
+   uint indexCount;
+   uint instanceCount;
+   uint firstIndex;
+   int baseVertex;
+   uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Bounds { vec4 b_Bounds[]; }; //Center and radius.
+layout(std430, binding = 1) readonly buffer Commands { DrawCommand b_Commands[]; };
+layout(std430, binding = 2) writeonly buffer VisibleCommands { DrawCommand b_VisibleCommands[]; };
+layout(std430, binding = 3) buffer DrawCount { uint b_DrawCount; };
+
+uniform int u_DrawCount;
+uniform vec4 u_FrustumPlanes[6];
+uniform int u_OcclusionEnabled;
+uniform mat4 u_PreviousViewProjection;
+uniform sampler2D u_HiZ;
+uniform int u_HiZLevelCount;
+
+bool IsOccluded(vec3 center, float radius)
+{
+   //The box around the sphere, projected into last frame's view.
+   vec2 minimum = vec2(1e30), maximum = vec2(-1e30);
+   float nearestDepth = 1.0;
+   for (int corner = 0; corner < 8; corner++)
+   {
+      vec3 position = vec3((corner & 1) != 0 ? center.x + radius : center.x - radius, (corner & 2) != 0 ? center.y + radius : center.y - radius, (corner & 4) != 0 ? center.z + radius : center.z - radius);
+      vec4 clip = u_PreviousViewProjection * vec4(position, 1.0);
+      if (clip.w <= 1e-5)
+      {
+         return false; //Reaches behind the camera.
+      }
+      vec3 ndc = clip.xyz / clip.w;
+      minimum = min(minimum, ndc.xy);
+      maximum = max(maximum, ndc.xy);
+      nearestDepth = min(nearestDepth, ndc.z * 0.5 + 0.5);
+   }
+   minimum = minimum * 0.5 + 0.5;
+   maximum = maximum * 0.5 + 0.5;
+   if (maximum.x < 0.0 || maximum.y < 0.0 || minimum.x > 1.0 || minimum.y > 1.0)
+   {
+      return false; //Wasn't on screen last frame, so there is no depth to test against.
+   }
+
+   //The first level at which the rectangle fits within 2x2 texels.
+   ivec2 size = textureSize(u_HiZ, 0);
+   ivec2 first = clamp(ivec2(minimum * vec2(size)), ivec2(0), size - 1);
+   ivec2 last = clamp(ivec2(maximum * vec2(size)), ivec2(0), size - 1);
+   int level = 0;
+   while (level + 1 < u_HiZLevelCount && ((last.x >> level) - (first.x >> level) > 1 || (last.y >> level) - (first.y >> level) > 1))
+   {
+      level++;
+   }
+
+   ivec2 levelSize = textureSize(u_HiZ, level);
+   ivec2 firstTexel = min(first >> level, levelSize - 1);
+   ivec2 lastTexel = min(last >> level, levelSize - 1);
+   float farthest = 0.0;
+   for (int y = firstTexel.y; y <= lastTexel.y; y++)
+   {
+      for (int x = firstTexel.x; x <= lastTexel.x; x++)
+      {
+         farthest = max(farthest, texelFetch(u_HiZ, ivec2(x, y), level).r);
+      }
+   }
+   return nearestDepth > farthest;
+}
+
+void main()
+{
+   uint index = gl_GlobalInvocationID.x;
+   if (index >= uint(u_DrawCount))
+   {
+      return;
+   }
+
+   vec4 sphere = b_Bounds[index];
+   for (int i = 0; i < 6; i++)
+   {
+      if (dot(u_FrustumPlanes[i].xyz, sphere.xyz) + u_FrustumPlanes[i].w < -sphere.w)
+      {
+         return;
+      }
+   }
+   if (u_OcclusionEnabled != 0 && IsOccluded(sphere.xyz, sphere.w))
+   {
+      return;
+   }
+
+   //The command keeps its baseInstance, so the draw still finds its own per-draw data wherever it lands.
+   uint slot = atomicAdd(b_DrawCount, 1u);
+   b_VisibleCommands[slot] = b_Commands[index];
+};
@@ -0,0 +1,44 @@
+#shader compute
+#version 430 core
+
+//Writes one level of the pyramid. Level 0 is copied from the depth buffer, every other level takes the farthest of the texels it covers in the level before,
+//exactly as DepthPyramid::Build does on the CPU.
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D u_Depth;
+uniform int u_CopyDepth;
+layout(r32f, binding = 0) uniform readonly image2D u_Source;
+layout(r32f, binding = 1) uniform writeonly image2D u_Destination;
+
+void main()
+{
+   ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+   ivec2 destinationSize = imageSize(u_Destination);
+   if (texel.x >= destinationSize.x || texel.y >= destinationSize.y)
+   {
+      return;
+   }
+
+   if (u_CopyDepth != 0)
+   {
+      imageStore(u_Destination, texel, vec4(texelFetch(u_Depth, texel, 0).r));
+      return;
+   }
+
+   //The last row and column of an odd sized level take in the one the halving would otherwise drop.
+   ivec2 sourceSize = imageSize(u_Source);
+   ivec2 first = min(texel * 2, sourceSize - 1);
+   ivec2 last = min(texel * 2 + 1, sourceSize - 1);
+   if (texel.x == destinationSize.x - 1) last.x = sourceSize.x - 1;
+   if (texel.y == destinationSize.y - 1) last.y = sourceSize.y - 1;
+
+   float farthest = 0.0;
+   for (int y = first.y; y <= last.y; y++)
+   {
+      for (int x = first.x; x <= last.x; x++)
+      {
+         farthest = max(farthest, imageLoad(u_Source, ivec2(x, y)).r);
+      }
+   }
+   imageStore(u_Destination, texel, vec4(farthest));
+};
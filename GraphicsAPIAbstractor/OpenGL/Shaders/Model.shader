@@ -0,0 +1,37 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texCoord;
+
+uniform mat4 u_MVP;
+
+out vec3 v_Normal;
+out vec2 v_TexCoord;
+
+void main()
+{
+   gl_Position = u_MVP * position;
+   v_Normal = normal;
+   v_TexCoord = texCoord;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec3 v_Normal;
+in vec2 v_TexCoord;
+
+uniform vec4 u_Color;
+uniform sampler2D u_Texture;
+
+void main()
+{
+   //Model only hands us u_MVP, so this lights in object space. Primitives without normals read them as zero and stay unlit.
+   float lighting = dot(v_Normal, v_Normal) > 0.0 ? 0.4 + 0.6 * max(dot(normalize(v_Normal), normalize(vec3(0.4, 0.8, 0.6))), 0.0) : 1.0;
+   vec4 texColor = texture(u_Texture, v_TexCoord) * u_Color;
+   color = vec4(texColor.rgb * lighting, texColor.a);
+};
@@ -0,0 +1,28 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 position;
+//Per draw. These advance once per instance, and every draw in the batch starts at its own instance.
+layout(location = 1) in vec4 offsetScale;
+layout(location = 2) in vec4 color;
+
+out vec4 v_Color;
+uniform mat4 u_ViewProjection;
+
+void main()
+{
+   gl_Position = u_ViewProjection * vec4(position * offsetScale.z + offsetScale.xy, 0.0, 1.0);
+   v_Color = color;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+   color = v_Color;
+};
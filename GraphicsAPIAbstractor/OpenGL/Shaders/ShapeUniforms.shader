@@ -0,0 +1,25 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 position;
+
+uniform mat4 u_ViewProjection;
+//Per draw, set by a command before each one, where MultiDrawIndirect.shader gets the same from per instance attributes.
+uniform vec4 u_OffsetScale;
+
+void main()
+{
+   gl_Position = u_ViewProjection * vec4(position * u_OffsetScale.z + u_OffsetScale.xy, 0.0, 1.0);
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+uniform vec4 u_Color;
+
+void main()
+{
+   color = u_Color;
+};
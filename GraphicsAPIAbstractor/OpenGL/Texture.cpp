@@ -1,41 +1,104 @@
 #include "GAAPrecompiledHeader.h"
 #include "Texture.h"
+#include "DeletionQueue.h"
+#include "Instrumentation.h"
+#include "RenderStats.h"
+#include "GPUMemoryTracker.h"
 #include "stb_image/stb_image.h"
 
-Texture::Texture(const std::string& path) : m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+Texture::Texture(const std::string& path, const SamplerState& samplerState) : m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0), m_SamplerState(samplerState)
 {
-	stbi_set_flip_vertically_on_load(1); //Flips the texture vertically upside down. OpenGL expects our texture pixels to start from the bottom left of 0,0. Typically, when we load a PNG image, it stores it in a top to bottom format. Thus, we have to flip it on load for OpenGL. If you see your image is upside down, play with this!
-	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	GAA_PROFILE_ZONE("Texture Load");
+	//Per thread, as GLTFScene turns flipping off on the job threads it decodes on, and that setting would otherwise override ours there.
+	stbi_set_flip_vertically_on_load_thread(1); //Flips the texture vertically upside down. OpenGL expects our texture pixels to start from the bottom left of 0,0. Typically, when we load a PNG image, it stores it in a top to bottom format. Thus, we have to flip it on load for OpenGL. If you see your image is upside down, play with this!
+	{
+		GAA_PROFILE_ZONE("Texture Decode");
+		m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	}
 	
+	Upload(m_LocalBuffer);
+
+	if (m_LocalBuffer)
+	{
+		stbi_image_free(m_LocalBuffer);
+	}
+}
+
+Texture::Texture(const unsigned char* pixels, int width, int height, const SamplerState& samplerState) : m_RendererID(0), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(4), m_SamplerState(samplerState)
+{
+	Upload(pixels);
+}
+
+void Texture::Upload(const unsigned char* pixels)
+{
+	GAA_PROFILE_FUNCTION();
 	glGenTextures(1, &m_RendererID);
 	glBindTexture(GL_TEXTURE_2D, m_RendererID);
 
-	//We need to specify these 4 things, or we might get a black screen.
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); //i for Integer. Minification Filter is used if your texture need to be resampled down if it needs to be rendered smaller than it is per pixel. Linear means everything will be linearly resampled.  
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); //If we render our texture on an area that is large in pixels than our actual texture size so we have to scaale it up. 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); //Horizontal wrap and clamp. We don't want to expand the area.
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); //Specify we don't want tiling.
+	//Filtering and wrapping come from the sampler bound to the same slot in Bind(), which overrides the texture's own parameters.
+	//We still set the same state on the texture as a fallback, so anything binding the raw ID without a sampler (ImGui::Image for one) samples it the same way
+	//instead of hitting the default mipmapped min filter, which makes a texture without mips incomplete.
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_SamplerState.minFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_SamplerState.magFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_SamplerState.wrapS);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_SamplerState.wrapT);
 
 	//0 because it is not a multi level texture, Internal Format is how OpenGL will store your texture data, while format is the format of the data we're providing OpenGL with. 
 	//Each of the RGBA channels is an unsigned byte.
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+	//Samplers that filter between mips need the mips to exist, or the texture is incomplete and samples as black.
+	uint64_t allocatedBytes = GetSizeInBytes();
+	if (m_SamplerState.minFilter != GL_NEAREST && m_SamplerState.minFilter != GL_LINEAR)
+	{
+		glGenerateMipmap(GL_TEXTURE_2D);
+		allocatedBytes += allocatedBytes / 3; //The whole chain below the top level adds up to a third of it.
+	}
 	glBindTexture(GL_TEXTURE_2D, 0); //Unbind once done! :)
 
-	if (m_LocalBuffer)
+	RenderStats::Add(RenderStat::TextureAllocations);
+	RenderStats::Add(RenderStat::TextureBytesAllocated, allocatedBytes);
+	GPUMemoryTracker::Track(GLObjectType::Texture, m_RendererID, GPUMemoryCategory::Texture, allocatedBytes);
+	if (pixels != nullptr)
 	{
-		stbi_image_free(m_LocalBuffer);
+		RenderStats::Add(RenderStat::BytesUploaded, GetSizeInBytes());
 	}
 }
 
 Texture::~Texture()
 {
-	glDeleteTextures(1, &m_RendererID);
+	DeletionQueue::Enqueue(GLObjectType::Texture, m_RendererID);
+}
+
+Texture::Texture(Texture&& other) noexcept : m_RendererID(other.m_RendererID), m_FilePath(std::move(other.m_FilePath)), m_LocalBuffer(nullptr),
+	m_Width(other.m_Width), m_Height(other.m_Height), m_BPP(other.m_BPP), m_SamplerState(other.m_SamplerState)
+{
+	other.m_RendererID = 0;
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+	if (this != &other)
+	{
+		DeletionQueue::Enqueue(GLObjectType::Texture, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		m_FilePath = std::move(other.m_FilePath);
+		m_LocalBuffer = nullptr; //Only valid during construction anyway.
+		m_Width = other.m_Width;
+		m_Height = other.m_Height;
+		m_BPP = other.m_BPP;
+		m_SamplerState = other.m_SamplerState;
+		other.m_RendererID = 0;
+	}
+	return *this;
 }
 
 void Texture::Bind(unsigned int slot) const
 {
 	glActiveTexture(GL_TEXTURE0 + slot); //I'm going to make the active texture Slot 0. This means the next texture I bind into will be slot 16 until I select another slot again.
 	glBindTexture(GL_TEXTURE_2D, m_RendererID);
+	RenderStats::Add(RenderStat::TextureBinds);
+	SamplerCache::Bind(slot, m_SamplerState);
 }
 
 void Texture::Unbind() const
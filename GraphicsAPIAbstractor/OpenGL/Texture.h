@@ -1,23 +1,36 @@
 #pragma once
 #include "OpenGLRenderer.h"
+#include "SamplerCache.h"
 
 class Texture
 {
 public:
-	Texture(const std::string& path);
+	Texture(const std::string& path, const SamplerState& samplerState = SamplerState());
+	Texture(const unsigned char* pixels, int width, int height, const SamplerState& samplerState = SamplerState()); //From RGBA8 pixels already in memory, such as a decoded glTF image. Uploaded as they are, without flipping.
 	~Texture();
 
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+
 	void Bind(unsigned int slot = 0) const;  //Allows us to specify a slot we want to bind the texture to. In OpenGl, we have these slots because we have the ability to bind more than one texture at once. In OpenGl, there are slots for us to bind textures to. On Windows, we typically have 32 texture slots. Of course, we can query OpenGL for many we have. 
 	void Unbind() const;
 
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+	inline void SetSamplerState(const SamplerState& samplerState) { m_SamplerState = samplerState; } //Takes effect on the next Bind.
+	inline const SamplerState& GetSamplerState() const { return m_SamplerState; }
+	inline size_t GetSizeInBytes() const { return (size_t)m_Width * m_Height * 4; } //We always upload as RGBA8, regardless of how many channels the file had.
 
 private:
+	void Upload(const unsigned char* pixels);
+
 	unsigned int m_RendererID;
 	std::string m_FilePath;
 	unsigned char* m_LocalBuffer;  //Local Storage for the Texture
 	int m_Width, m_Height, m_BPP; //Bits per pixel.
+	SamplerState m_SamplerState; //Filtering and wrapping live in a shared sampler object rather than on the texture itself.
 };
 
 //The number of bits of information stored per pixel of an image or displayed by a graphics adapter. The more bits there are, the more colours can be represented,
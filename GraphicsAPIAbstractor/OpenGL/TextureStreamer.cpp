@@ -0,0 +1,339 @@
+#include "GAAPrecompiledHeader.h"
+#include "TextureStreamer.h"
+#include "DeletionQueue.h"
+#include "FrameAllocator.h"
+#include "RenderStats.h"
+#include "GPUMemoryTracker.h"
+#include "GL/glew.h"
+#include "stb_image/stb_image.h"
+#include <algorithm>
+#include <cmath>
+
+TextureStreamer::TextureStreamer(size_t memoryBudgetInBytes) : m_MemoryBudget(memoryBudgetInBytes), m_ResidentMemory(0), m_CurrentFrame(1), m_MaxMipUploadsPerFrame(4)
+{
+	m_SamplerState.minFilter = GL_LINEAR_MIPMAP_LINEAR; //Trilinear, so that raising a mip fades in rather than pops.
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	for (StreamedTexture& texture : m_Textures)
+	{
+		DeletionQueue::Enqueue(GLObjectType::Texture, texture.tailRendererID);
+		DeletionQueue::Enqueue(GLObjectType::Texture, texture.rendererID);
+	}
+}
+
+unsigned int TextureStreamer::RegisterTexture(const std::string& filePath)
+{
+	StreamedTexture texture;
+	texture.filePath = filePath;
+
+	int width = 0, height = 0, bpp = 0;
+	stbi_set_flip_vertically_on_load_thread(1); //Same orientation as Texture, OpenGL expects the first row to be the bottom of the image. Per thread, like GLTFScene's, so neither overrides the other.
+	unsigned char* pixels = stbi_load(filePath.c_str(), &width, &height, &bpp, 4);
+	if (pixels)
+	{
+		GenerateMipChain(texture, pixels, width, height);
+		stbi_image_free(pixels);
+	}
+	else
+	{
+		std::cout << "Warning: Failed to load streamed texture " << filePath << "! \n";
+		const unsigned char placeholder[4] = { 0, 0, 0, 255 };
+		GenerateMipChain(texture, placeholder, 1, 1);
+	}
+
+	//Only the mip tail is loaded up front. Everything above it is raised by Update() once the texture is actually requested at a larger size.
+	texture.requestedTopMip = texture.residentTopMip = texture.uploadedTopMip = texture.tailMip;
+	texture.lastUsedFrame = m_CurrentFrame;
+	texture.tailRendererID = AllocateTexture(texture, texture.tailMip);
+	for (unsigned int i = texture.tailMip; i < texture.mips.size(); i++)
+	{
+		UploadMip(texture, i, texture.tailMip);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	UpdateResidentBytes(texture);
+
+	m_Textures.push_back(std::move(texture));
+	return (unsigned int)m_Textures.size() - 1;
+}
+
+void TextureStreamer::RequestScreenSize(unsigned int streamingID, float screenSizeInPixels)
+{
+	StreamedTexture& texture = m_Textures[streamingID];
+	if (texture.lastRequestFrame != m_CurrentFrame) //First request this frame replaces last frame's, later ones keep the largest.
+	{
+		texture.requestedScreenSize = screenSizeInPixels;
+		texture.lastRequestFrame = m_CurrentFrame;
+	}
+	else
+	{
+		texture.requestedScreenSize = std::max(texture.requestedScreenSize, screenSizeInPixels);
+	}
+	texture.lastUsedFrame = m_CurrentFrame;
+}
+
+void TextureStreamer::Bind(unsigned int streamingID, unsigned int slot)
+{
+	StreamedTexture& texture = m_Textures[streamingID];
+	texture.lastUsedFrame = m_CurrentFrame;
+
+	glActiveTexture(GL_TEXTURE0 + slot);
+	glBindTexture(GL_TEXTURE_2D, texture.rendererID != 0 ? texture.rendererID : texture.tailRendererID);
+	RenderStats::Add(RenderStat::TextureBinds);
+	SamplerCache::Bind(slot, m_SamplerState);
+}
+
+void TextureStreamer::Update()
+{
+	FrameVector<StreamedTexture*> raiseCandidates; //Scratch for this frame only, so it comes from the frame arena rather than the heap.
+	raiseCandidates.reserve(m_Textures.size());
+	for (StreamedTexture& texture : m_Textures)
+	{
+		if (texture.lastRequestFrame == m_CurrentFrame)
+		{
+			texture.requestedTopMip = CalculateRequestedTopMip(texture);
+		}
+
+		//Drop mips we no longer need straight away. Textures that weren't requested this frame keep their mips until the budget asks for them back.
+		if (texture.residentTopMip < texture.requestedTopMip)
+		{
+			DropTopMip(texture, texture.requestedTopMip);
+		}
+		else if (texture.residentTopMip > texture.requestedTopMip && texture.lastRequestFrame == m_CurrentFrame)
+		{
+			raiseCandidates.push_back(&texture);
+		}
+	}
+
+	//Most recently used textures get their uploads first. We upload one mip per texture per frame so that the upload cost is spread out.
+	std::sort(raiseCandidates.begin(), raiseCandidates.end(), [](const StreamedTexture* a, const StreamedTexture* b) { return a->lastUsedFrame > b->lastUsedFrame; });
+
+	unsigned int uploadCount = 0;
+	for (StreamedTexture* texture : raiseCandidates)
+	{
+		if (uploadCount >= m_MaxMipUploadsPerFrame)
+		{
+			break;
+		}
+
+		size_t extraBytes = texture->rendererID != 0 ? 0 : CalculateResidentBytes(*texture, 0); //Only allocating the whole chain costs memory.
+		if (!EvictLeastRecentlyUsed(extraBytes, false)) //Nothing older left to evict, so everything else is in use this frame.
+		{
+			break;
+		}
+		if (RaiseTopMip(*texture))
+		{
+			uploadCount++;
+		}
+	}
+
+	//The budget may have been lowered, so make sure we are back within it even if that means touching textures used this frame.
+	EvictLeastRecentlyUsed(0, true);
+	m_CurrentFrame++;
+}
+
+void TextureStreamer::GenerateMipChain(StreamedTexture& texture, const unsigned char* pixels, int width, int height)
+{
+	texture.mips.clear();
+	texture.mips.push_back({ width, height, std::vector<unsigned char>(pixels, pixels + (size_t)width * height * 4) });
+
+	//Simple 2x2 box filter down to 1x1. Odd dimensions clamp the last row/column.
+	while (width > 1 || height > 1)
+	{
+		const MipLevel& source = texture.mips.back();
+		MipLevel mip;
+		mip.width = std::max(1, width / 2);
+		mip.height = std::max(1, height / 2);
+		mip.pixels.resize((size_t)mip.width * mip.height * 4);
+
+		for (int y = 0; y < mip.height; y++)
+		{
+			int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+			for (int x = 0; x < mip.width; x++)
+			{
+				int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+				for (int channel = 0; channel < 4; channel++)
+				{
+					unsigned int sum = source.pixels[((size_t)y0 * width + x0) * 4 + channel] + source.pixels[((size_t)y0 * width + x1) * 4 + channel] +
+									   source.pixels[((size_t)y1 * width + x0) * 4 + channel] + source.pixels[((size_t)y1 * width + x1) * 4 + channel];
+					mip.pixels[((size_t)y * mip.width + x) * 4 + channel] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+
+		width = mip.width;
+		height = mip.height;
+		texture.mips.push_back(std::move(mip));
+	}
+
+	texture.tailMip = (unsigned int)texture.mips.size() - 1;
+	for (unsigned int i = 0; i < texture.mips.size(); i++)
+	{
+		if (std::max(texture.mips[i].width, texture.mips[i].height) <= s_MipTailSize)
+		{
+			texture.tailMip = i;
+			break;
+		}
+	}
+}
+
+size_t TextureStreamer::CalculateResidentBytes(const StreamedTexture& texture, unsigned int topMip)
+{
+	size_t bytes = 0;
+	for (unsigned int i = topMip; i < texture.mips.size(); i++)
+	{
+		bytes += texture.mips[i].pixels.size();
+	}
+	return bytes;
+}
+
+unsigned int TextureStreamer::CalculateRequestedTopMip(const StreamedTexture& texture) const
+{
+	if (texture.requestedScreenSize <= 0.0f)
+	{
+		return texture.tailMip;
+	}
+
+	//Each mip halves the resolution, so the mip that matches the screen size is log2 of how much larger the texture is than its footprint.
+	float textureSize = (float)std::max(texture.mips[0].width, texture.mips[0].height);
+	float ratio = textureSize / texture.requestedScreenSize;
+	unsigned int topMip = ratio <= 1.0f ? 0 : (unsigned int)std::floor(std::log2(ratio));
+	return std::min(topMip, texture.tailMip);
+}
+
+unsigned int TextureStreamer::AllocateTexture(const StreamedTexture& texture, unsigned int firstMip) const
+{
+	unsigned int rendererID;
+	glGenTextures(1, &rendererID);
+	glBindTexture(GL_TEXTURE_2D, rendererID);
+
+	unsigned int levelCount = (unsigned int)texture.mips.size() - firstMip;
+	if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+	{
+		//Every level is allocated here, once, at a size that never changes, so the driver never has to revalidate the chain as we fill it in.
+		glTexStorage2D(GL_TEXTURE_2D, levelCount, GL_RGBA8, texture.mips[firstMip].width, texture.mips[firstMip].height);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < levelCount; i++)
+		{
+			const MipLevel& mip = texture.mips[firstMip + i];
+			glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_SamplerState.minFilter); //Fallback for binds that skip our sampler, as in Texture::Upload().
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_SamplerState.magFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_SamplerState.wrapS);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_SamplerState.wrapT);
+
+	size_t allocatedBytes = CalculateResidentBytes(texture, firstMip);
+	RenderStats::Add(RenderStat::TextureAllocations);
+	RenderStats::Add(RenderStat::TextureBytesAllocated, allocatedBytes);
+	GPUMemoryTracker::Track(GLObjectType::Texture, rendererID, GPUMemoryCategory::Texture, allocatedBytes);
+	return rendererID;
+}
+
+void TextureStreamer::UploadMip(const StreamedTexture& texture, unsigned int mip, unsigned int firstMip)
+{
+	const MipLevel& level = texture.mips[mip];
+	glTexSubImage2D(GL_TEXTURE_2D, mip - firstMip, 0, 0, level.width, level.height, GL_RGBA, GL_UNSIGNED_BYTE, level.pixels.data());
+	RenderStats::Add(RenderStat::BytesUploaded, level.pixels.size());
+}
+
+bool TextureStreamer::RaiseTopMip(StreamedTexture& texture)
+{
+	if (texture.rendererID == 0)
+	{
+		//The tail is tiny, so filling it in again right away is cheaper than keeping track of a chain that is only partly valid at the bottom.
+		texture.rendererID = AllocateTexture(texture, 0);
+		for (unsigned int i = texture.tailMip; i < texture.mips.size(); i++)
+		{
+			UploadMip(texture, i, 0);
+		}
+		texture.uploadedTopMip = texture.tailMip;
+		UpdateResidentBytes(texture);
+	}
+	else
+	{
+		glBindTexture(GL_TEXTURE_2D, texture.rendererID);
+	}
+
+	//Levels dropped earlier still hold their data, so those come back for free. Only a level that has never been filled in costs an upload.
+	bool uploaded = false;
+	while (texture.residentTopMip > texture.requestedTopMip)
+	{
+		unsigned int mip = texture.residentTopMip - 1;
+		if (mip < texture.uploadedTopMip)
+		{
+			if (uploaded)
+			{
+				break;
+			}
+			UploadMip(texture, mip, 0);
+			texture.uploadedTopMip = mip;
+			uploaded = true;
+		}
+		texture.residentTopMip = mip;
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.residentTopMip);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return uploaded;
+}
+
+void TextureStreamer::DropTopMip(StreamedTexture& texture, unsigned int topMip)
+{
+	if (topMip >= texture.tailMip)
+	{
+		ReleaseChain(texture); //The tail has everything we still need, and the chain's memory goes back.
+		return;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, texture.rendererID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, topMip);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	texture.residentTopMip = topMip;
+}
+
+void TextureStreamer::ReleaseChain(StreamedTexture& texture)
+{
+	//Draws in flight may still sample the chain, so it goes through the deletion queue rather than being deleted here.
+	DeletionQueue::Enqueue(GLObjectType::Texture, texture.rendererID);
+	texture.rendererID = 0;
+	texture.residentTopMip = texture.uploadedTopMip = texture.tailMip;
+	UpdateResidentBytes(texture);
+}
+
+void TextureStreamer::UpdateResidentBytes(StreamedTexture& texture)
+{
+	m_ResidentMemory -= texture.residentBytes;
+	texture.residentBytes = CalculateResidentBytes(texture, texture.tailMip) + (texture.rendererID != 0 ? CalculateResidentBytes(texture, 0) : 0);
+	m_ResidentMemory += texture.residentBytes;
+}
+
+bool TextureStreamer::EvictLeastRecentlyUsed(size_t bytesNeeded, bool allowCurrentFrame)
+{
+	while (m_ResidentMemory + bytesNeeded > m_MemoryBudget)
+	{
+		StreamedTexture* victim = nullptr;
+		for (StreamedTexture& texture : m_Textures)
+		{
+			if (texture.rendererID == 0 || (!allowCurrentFrame && texture.lastUsedFrame == m_CurrentFrame))
+			{
+				continue;
+			}
+			if (victim == nullptr || texture.lastUsedFrame < victim->lastUsedFrame)
+			{
+				victim = &texture;
+			}
+		}
+
+		if (victim == nullptr)
+		{
+			return false;
+		}
+		ReleaseChain(*victim); //Immutable storage can't hand back single levels, so the whole chain goes at once.
+	}
+	return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "SamplerCache.h"
+
+//The texture streamer keeps every texture it owns within a fixed video memory budget. Every texture keeps a small one of just its smallest mips (the mip tail)
+//resident. Once it is requested larger than that, it gets immutable storage for its whole mip chain, and the top mips are raised one level, and one upload,
+//at a time. Which levels are sampled is only GL_TEXTURE_BASE_LEVEL, so dropping a mip uploads nothing, and raising one that was dropped earlier doesn't either.
+//Immutable storage can't give single levels back though, so when the resident total goes over budget, the least recently used textures go back to their tail.
+//The full mip chain stays in system memory so that raising a mip never touches the disk. Everything here makes GL calls, so it is GL thread only.
+
+class TextureStreamer
+{
+public:
+	TextureStreamer(size_t memoryBudgetInBytes);
+	~TextureStreamer();
+
+	unsigned int RegisterTexture(const std::string& filePath); //Returns the streaming ID used by every other call.
+	void RequestScreenSize(unsigned int streamingID, float screenSizeInPixels); //The largest on-screen dimension the texture will be drawn at this frame.
+	void Bind(unsigned int streamingID, unsigned int slot = 0);
+	void Update(); //Call once per frame after all requests have been made.
+
+	void SetMemoryBudget(size_t memoryBudgetInBytes) { m_MemoryBudget = memoryBudgetInBytes; }
+	void SetSamplerState(const SamplerState& samplerState) { m_SamplerState = samplerState; }
+	void SetMaxMipUploadsPerFrame(unsigned int maxUploads) { m_MaxMipUploadsPerFrame = maxUploads; }
+	inline size_t GetMemoryBudget() const { return m_MemoryBudget; }
+	inline size_t GetResidentMemory() const { return m_ResidentMemory; }
+	inline size_t GetTextureResidentMemory(unsigned int streamingID) const { return m_Textures[streamingID].residentBytes; }
+	inline unsigned int GetResidentTopMip(unsigned int streamingID) const { return m_Textures[streamingID].residentTopMip; }
+	inline unsigned int GetTextureCount() const { return (unsigned int)m_Textures.size(); }
+
+private:
+	struct MipLevel
+	{
+		int width, height;
+		std::vector<unsigned char> pixels; //RGBA, 4 bytes per texel.
+	};
+
+	struct StreamedTexture
+	{
+		unsigned int tailRendererID = 0; //Just the mip tail. Bound whenever the whole chain isn't resident.
+		unsigned int rendererID = 0; //The whole chain, or 0 while only the tail is resident.
+		std::string filePath;
+		std::vector<MipLevel> mips; //Mip 0 is full resolution.
+		unsigned int tailMip = 0; //The highest resolution mip that is always resident.
+		unsigned int residentTopMip = 0; //The base level we sample from.
+		unsigned int uploadedTopMip = 0; //The whole chain holds valid data from this mip down.
+		unsigned int requestedTopMip = 0;
+		unsigned int lastUsedFrame = 0;
+		unsigned int lastRequestFrame = 0;
+		float requestedScreenSize = 0.0f;
+		size_t residentBytes = 0;
+	};
+
+	static void GenerateMipChain(StreamedTexture& texture, const unsigned char* pixels, int width, int height);
+	static size_t CalculateResidentBytes(const StreamedTexture& texture, unsigned int topMip);
+	unsigned int CalculateRequestedTopMip(const StreamedTexture& texture) const;
+	unsigned int AllocateTexture(const StreamedTexture& texture, unsigned int firstMip) const; //Storage for mips [firstMip, last], left bound.
+	static void UploadMip(const StreamedTexture& texture, unsigned int mip, unsigned int firstMip); //Into the bound texture, whose level 0 is firstMip.
+	bool RaiseTopMip(StreamedTexture& texture); //Towards the requested mip, with at most one upload. Returns whether it uploaded.
+	void DropTopMip(StreamedTexture& texture, unsigned int topMip);
+	void ReleaseChain(StreamedTexture& texture); //Back to the tail alone.
+	void UpdateResidentBytes(StreamedTexture& texture);
+	bool EvictLeastRecentlyUsed(size_t bytesNeeded, bool allowCurrentFrame); //Releases whole chains until the extra bytes fit within budget.
+
+private:
+	std::vector<StreamedTexture> m_Textures;
+	size_t m_MemoryBudget;
+	size_t m_ResidentMemory;
+	unsigned int m_CurrentFrame;
+	unsigned int m_MaxMipUploadsPerFrame;
+	SamplerState m_SamplerState; //Shared by every streamed texture.
+	static constexpr int s_MipTailSize = 64; //Mips at or below this size are loaded at registration and never evicted.
+};
@@ -0,0 +1,179 @@
+#include "GAAPrecompiledHeader.h"
+#include "UploadThread.h"
+#include "RenderThread.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Texture.h"
+#include "Instrumentation.h"
+#include "GLDebug.h"
+#include "GLFW/glfw3.h"
+
+GLFWwindow* UploadThread::s_Window = nullptr;
+std::thread UploadThread::s_Thread;
+bool UploadThread::s_Running = false;
+bool UploadThread::s_Quit = false;
+std::mutex UploadThread::s_Mutex;
+std::condition_variable UploadThread::s_RequestAdded;
+std::deque<UploadThread::Request> UploadThread::s_Requests;
+std::mutex UploadThread::s_InFlightMutex;
+std::vector<UploadThread::InFlightUpload> UploadThread::s_InFlight;
+std::atomic<unsigned int> UploadThread::s_PendingCount(0);
+
+void UploadThread::Start(GLFWwindow* window)
+{
+	if (s_Running)
+	{
+		std::cout << "Warning: The upload thread is already running! \n";
+		return;
+	}
+
+	//The window hints are still the ones the main window was made with, so this context gets the same version and profile, which sharing requires.
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	s_Window = glfwCreateWindow(1, 1, "Upload Context", nullptr, window);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (s_Window == nullptr)
+	{
+		std::cout << "Warning: Couldn't create a shared context for uploading, so uploads will run on the GL thread instead! \n";
+		return;
+	}
+
+	s_Quit = false;
+	s_Running = true;
+	s_Thread = std::thread(&UploadThread::ThreadLoop);
+}
+
+void UploadThread::Stop()
+{
+	if (s_Running)
+	{
+		{
+			std::lock_guard<std::mutex> lock(s_Mutex);
+			s_Quit = true;
+		}
+		s_RequestAdded.notify_one();
+		s_Thread.join();
+		s_Running = false;
+		glfwDestroyWindow(s_Window);
+		s_Window = nullptr;
+	}
+
+	//Whatever is still in flight gets waited on here, as nothing will poll it after this.
+	std::lock_guard<std::mutex> lock(s_InFlightMutex);
+	for (InFlightUpload& upload : s_InFlight)
+	{
+		glClientWaitSync(upload.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		glDeleteSync(upload.fence);
+		upload.publish();
+		s_PendingCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+	s_InFlight.clear();
+}
+
+AsyncResource<VertexBuffer> UploadThread::CreateVertexBuffer(const void* data, unsigned int size)
+{
+	auto bytes = std::make_shared<std::vector<unsigned char>>((const unsigned char*)data, (const unsigned char*)data + size);
+	return Create<VertexBuffer>([bytes]() { return std::make_unique<VertexBuffer>(bytes->data(), (unsigned int)bytes->size()); });
+}
+
+AsyncResource<IndexBuffer> UploadThread::CreateIndexBuffer(const unsigned int* data, unsigned int count)
+{
+	auto indices = std::make_shared<std::vector<unsigned int>>(data, data + count);
+	return Create<IndexBuffer>([indices]() { return std::make_unique<IndexBuffer>(indices->data(), (unsigned int)indices->size()); });
+}
+
+AsyncResource<Texture> UploadThread::CreateTexture(const std::string& path, const SamplerState& samplerState)
+{
+	return Create<Texture>([path, samplerState]() { return std::make_unique<Texture>(path, samplerState); });
+}
+
+void UploadThread::Submit(std::function<void()> upload, std::function<void()> publish)
+{
+	s_PendingCount.fetch_add(1, std::memory_order_relaxed);
+	if (!s_Running)
+	{
+		//Enqueue runs it right away when there is no render thread either, in which case this thread is the GL thread.
+		RenderThread::Enqueue([request = Request{ std::move(upload), std::move(publish) }]() mutable { RunUpload(request); });
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		s_Requests.push_back(Request{ std::move(upload), std::move(publish) });
+	}
+	s_RequestAdded.notify_one();
+}
+
+void UploadThread::RunUpload(Request& request)
+{
+	GAA_PROFILE_FUNCTION();
+	request.upload();
+
+	//The fence goes in right behind the upload's commands. Flushing sends them to the GPU now, as otherwise a context that has nothing else to do might
+	//hold on to them, and the fence would never signal for the GL thread polling it.
+	GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+
+	std::lock_guard<std::mutex> lock(s_InFlightMutex);
+	s_InFlight.push_back(InFlightUpload{ fence, std::move(request.publish) });
+}
+
+void UploadThread::EndFrame()
+{
+	std::lock_guard<std::mutex> lock(s_InFlightMutex);
+
+	//Fences from the upload context and ones from the fallback path can both be in here, and those don't signal in order with each other, so we look at
+	//every one rather than stopping at the first that hasn't. A timeout of 0 means we only ever poll, never wait.
+	size_t keptCount = 0;
+	for (size_t i = 0; i < s_InFlight.size(); i++)
+	{
+		GLenum result = glClientWaitSync(s_InFlight[i].fence, 0, 0);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+		{
+			glDeleteSync(s_InFlight[i].fence);
+			s_InFlight[i].publish();
+			s_PendingCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			if (keptCount != i)
+			{
+				s_InFlight[keptCount] = std::move(s_InFlight[i]);
+			}
+			keptCount++;
+		}
+	}
+	s_InFlight.resize(keptCount);
+}
+
+void UploadThread::ThreadLoop()
+{
+	GAA_PROFILE_THREAD("Upload Thread");
+	glfwMakeContextCurrent(s_Window);
+	GLDebug::EnableForCurrentContext(); //Debug output is per context, so ours needs it as well as the main one.
+
+	//Vertex arrays are the one kind of object contexts don't share, but binding an index buffer needs one bound in a core profile, so this context gets its own.
+	unsigned int vertexArray;
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+
+	while (true)
+	{
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(s_Mutex);
+			s_RequestAdded.wait(lock, []() { return !s_Requests.empty() || s_Quit; });
+			if (s_Requests.empty())
+			{
+				break; //Asked to quit, and every request is uploaded.
+			}
+			request = std::move(s_Requests.front());
+			s_Requests.pop_front();
+		}
+		RunUpload(request);
+	}
+
+	glBindVertexArray(0);
+	glDeleteVertexArrays(1, &vertexArray);
+	glFinish(); //So every upload has landed before the context goes away with its window.
+	glfwMakeContextCurrent(nullptr);
+}
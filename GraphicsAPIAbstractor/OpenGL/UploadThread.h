@@ -0,0 +1,104 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "GL/glew.h"
+#include "OpenGLRenderer.h"
+#include "SamplerCache.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+class VertexBuffer;
+class IndexBuffer;
+class Texture;
+struct GLFWwindow;
+
+//A resource the UploadThread is still creating. It only reports ready once the GPU has actually finished the upload, and the GL thread has seen it finish,
+//so anything recorded after IsReady() returns true can draw with it. Until then, draw without it, or with a placeholder.
+//Copies share the same resource, which lives until the last copy is gone.
+template<typename Resource>
+class AsyncResource
+{
+public:
+	AsyncResource() = default;
+
+	inline bool IsReady() const { return m_State && m_State->ready.load(std::memory_order_acquire); }
+	inline Resource& Get() const { ASSERT(IsReady()); return *m_State->resource; }
+	inline void Reset() { m_State.reset(); } //Lets go of the resource, which is then destroyed through the DeletionQueue like any other.
+
+private:
+	friend class UploadThread;
+
+	struct State
+	{
+		std::unique_ptr<Resource> resource; //Written by the upload, and only read once ready has been set.
+		std::atomic<bool> ready{ false };
+	};
+
+	std::shared_ptr<State> m_State;
+};
+
+//Creates buffers and textures on a thread of its own, so that loading and uploading them never takes time out of a frame.
+//The thread has its own context, made for a hidden window, which shares objects with the main window's. Objects created in one context only show up
+//correctly in another once the GPU has finished the commands that filled them, so every upload is followed by a glFenceSync. The GL thread polls those
+//fences at the end of each frame, never waiting on them, and only marks a resource ready once its fence has passed.
+//If the shared context can't be made, uploads still work, they just run on the GL thread ahead of the next frame through RenderThread::Enqueue.
+class UploadThread
+{
+public:
+	//Call on the main thread, after the window's context exists and before RenderThread::Start, as GLFW only creates windows on the main thread.
+	static void Start(GLFWwindow* window);
+	static void Stop(); //Finishes every upload already requested. Call on the GL thread, after RenderThread::Stop.
+
+	//Any thread. The data is copied, so it doesn't have to outlive the call.
+	static AsyncResource<VertexBuffer> CreateVertexBuffer(const void* data, unsigned int size);
+	static AsyncResource<IndexBuffer> CreateIndexBuffer(const unsigned int* data, unsigned int count);
+	static AsyncResource<Texture> CreateTexture(const std::string& path, const SamplerState& samplerState = SamplerState()); //Decodes the file on the upload thread as well.
+
+	//Anything else. create runs on the upload thread with its context current, so it has to capture what it needs by value.
+	template<typename Resource>
+	static AsyncResource<Resource> Create(std::function<std::unique_ptr<Resource>()> create)
+	{
+		AsyncResource<Resource> handle;
+		handle.m_State = std::make_shared<typename AsyncResource<Resource>::State>();
+		std::shared_ptr<typename AsyncResource<Resource>::State> state = handle.m_State;
+		Submit([state, create]() { state->resource = create(); }, [state]() { state->ready.store(true, std::memory_order_release); });
+		return handle;
+	}
+
+	static void EndFrame(); //Called from OpenGLRenderer::EndFrame. Publishes every upload whose fence has passed.
+
+	inline static bool IsRunning() { return s_Running; }
+	inline static unsigned int GetPendingCount() { return s_PendingCount.load(std::memory_order_relaxed); } //Requested, but not ready yet.
+
+private:
+	struct Request
+	{
+		std::function<void()> upload;
+		std::function<void()> publish;
+	};
+
+	struct InFlightUpload
+	{
+		GLsync fence;
+		std::function<void()> publish;
+	};
+
+	static void Submit(std::function<void()> upload, std::function<void()> publish);
+	static void RunUpload(Request& request); //On whichever thread has a context: the upload thread, or the GL thread as a fallback.
+	static void ThreadLoop();
+
+	static GLFWwindow* s_Window; //The hidden one.
+	static std::thread s_Thread;
+	static bool s_Running;
+	static bool s_Quit; //Guarded by s_Mutex.
+
+	static std::mutex s_Mutex;
+	static std::condition_variable s_RequestAdded;
+	static std::deque<Request> s_Requests;
+
+	static std::mutex s_InFlightMutex;
+	static std::vector<InFlightUpload> s_InFlight;
+	static std::atomic<unsigned int> s_PendingCount;
+};
@@ -1,6 +1,8 @@
 #include "GAAPrecompiledHeader.h"
 #include "GL/glew.h"
 #include "VertexArray.h"
+#include "DeletionQueue.h"
+#include "RenderStats.h"
 #include "VertexBufferLayout.h"
 
 VertexArray::VertexArray()
@@ -10,28 +12,56 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
-	glDeleteVertexArrays(1, &m_RendererID);
+	DeletionQueue::Enqueue(GLObjectType::VertexArray, m_RendererID);
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept : m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+	if (this != &other)
+	{
+		DeletionQueue::Enqueue(GLObjectType::VertexArray, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		other.m_RendererID = 0;
+	}
+	return *this;
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vertexBuffer, const VertexBufferLayout& layout)
+{
+	const auto& elements = layout.GetElements();
+	AddBuffer(vertexBuffer, elements.data(), (unsigned int)elements.size(), layout.GetStride());
+}
+
+void VertexArray::AddBuffer(const VertexBuffer& vertexBuffer, const VertexBufferElement* elements, unsigned int elementCount, unsigned int stride)
 {
 	Bind();
 	vertexBuffer.Bind();
-	const auto& elements = layout.GetElements();
-	unsigned int offset = 0;
 
-	for (unsigned int i = 0; i < elements.size(); i++)
+	for (unsigned int i = 0; i < elementCount; i++)
 	{
 		const auto& element = elements[i];
 		glEnableVertexAttribArray(i);
-		glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset);
-		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		//Plain integers have to reach the shader as ints or uints. glVertexAttribPointer would turn them into floats.
+		if (VertexBufferElement::IsIntegerAttribute(element.type, element.normalized))
+		{
+			glVertexAttribIPointer(i, element.count, element.type, stride, (const void*)(uintptr_t)element.offset);
+		}
+		else
+		{
+			glVertexAttribPointer(i, element.count, element.type, element.normalized, stride, (const void*)(uintptr_t)element.offset);
+		}
 	}
 }
 
 void VertexArray::Bind() const
 {
 	glBindVertexArray(m_RendererID);
+	RenderStats::Add(RenderStat::VertexArrayBinds);
 }
 
 void VertexArray::Unbind() const
@@ -2,6 +2,7 @@
 #include "VertexBuffer.h"
 
 class VertexBufferLayout;
+struct VertexBufferElement;
 
 class VertexArray
 {
@@ -9,7 +10,15 @@ public:
 	VertexArray();
 	~VertexArray();
 
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+
 	void AddBuffer(const VertexBuffer& vertexBuffer, const VertexBufferLayout& layout);
+	template<typename Layout>
+	void AddBuffer(const VertexBuffer& vertexBuffer) { AddBuffer(vertexBuffer, Layout::Elements.data(), Layout::AttributeCount, Layout::Stride); } //For compile time VertexLayouts, no runtime layout object needed.
+	void AddBuffer(const VertexBuffer& vertexBuffer, const VertexBufferElement* elements, unsigned int elementCount, unsigned int stride);
 	void Bind() const;
 	void Unbind() const;
 private:
@@ -0,0 +1,142 @@
+#include "GAAPrecompiledHeader.h"
+#include "VertexArrayCache.h"
+#include "VertexBufferLayout.h"
+#include "RenderStats.h"
+#include "GL/glew.h"
+
+std::unordered_map<uint64_t, VertexArrayCache::LayoutVertexArray> VertexArrayCache::s_LayoutVertexArrays;
+std::unordered_map<VertexArrayCache::BufferSetKey, unsigned int, VertexArrayCache::BufferSetKeyHash> VertexArrayCache::s_BufferSetVertexArrays;
+
+bool VertexArrayCache::IsUsingAttribBinding()
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+}
+
+void VertexArrayCache::Bind(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout)
+{
+	const auto& elements = layout.GetElements();
+	Bind(vertexBuffer.GetRendererID(), indexBuffer.GetRendererID(), elements.data(), (unsigned int)elements.size(), layout.GetStride(), layout.GetHash());
+}
+
+void VertexArrayCache::Bind(unsigned int vertexBufferID, unsigned int indexBufferID, const VertexBufferElement* elements, unsigned int elementCount, unsigned int stride, uint64_t layoutHash)
+{
+	if (IsUsingAttribBinding())
+	{
+		auto iterator = s_LayoutVertexArrays.find(layoutHash);
+		if (iterator == s_LayoutVertexArrays.end())
+		{
+			//The format is described once per layout. Every attribute reads from binding point 0, whose buffer we swap per draw.
+			LayoutVertexArray vertexArray = { 0, 0 };
+			glGenVertexArrays(1, &vertexArray.rendererID);
+			glBindVertexArray(vertexArray.rendererID);
+			RenderStats::Add(RenderStat::VertexArrayBinds);
+			for (unsigned int i = 0; i < elementCount; i++)
+			{
+				glEnableVertexAttribArray(i);
+				if (VertexBufferElement::IsIntegerAttribute(elements[i].type, elements[i].normalized))
+				{
+					glVertexAttribIFormat(i, elements[i].count, elements[i].type, elements[i].offset);
+				}
+				else
+				{
+					glVertexAttribFormat(i, elements[i].count, elements[i].type, elements[i].normalized, elements[i].offset);
+				}
+				glVertexAttribBinding(i, 0);
+			}
+			iterator = s_LayoutVertexArrays.emplace(layoutHash, vertexArray).first;
+		}
+		else
+		{
+			glBindVertexArray(iterator->second.rendererID);
+			RenderStats::Add(RenderStat::VertexArrayBinds);
+		}
+
+		if (iterator->second.boundVertexBuffer != vertexBufferID)
+		{
+			glBindVertexBuffer(0, vertexBufferID, 0, stride);
+			RenderStats::Add(RenderStat::BufferBinds);
+			iterator->second.boundVertexBuffer = vertexBufferID;
+		}
+	}
+	else
+	{
+		BufferSetKey key = { layoutHash, vertexBufferID, indexBufferID };
+		auto iterator = s_BufferSetVertexArrays.find(key);
+		if (iterator == s_BufferSetVertexArrays.end())
+		{
+			unsigned int rendererID;
+			glGenVertexArrays(1, &rendererID);
+			glBindVertexArray(rendererID);
+			RenderStats::Add(RenderStat::VertexArrayBinds);
+			glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+			for (unsigned int i = 0; i < elementCount; i++)
+			{
+				glEnableVertexAttribArray(i);
+				if (VertexBufferElement::IsIntegerAttribute(elements[i].type, elements[i].normalized))
+				{
+					glVertexAttribIPointer(i, elements[i].count, elements[i].type, stride, (const void*)(uintptr_t)elements[i].offset);
+				}
+				else
+				{
+					glVertexAttribPointer(i, elements[i].count, elements[i].type, elements[i].normalized, stride, (const void*)(uintptr_t)elements[i].offset);
+				}
+			}
+			s_BufferSetVertexArrays.emplace(key, rendererID);
+		}
+		else
+		{
+			glBindVertexArray(iterator->second);
+			RenderStats::Add(RenderStat::VertexArrayBinds);
+		}
+	}
+
+	//The element buffer binding is part of VAO state too, but anything creating an IndexBuffer while our VAO is bound overwrites it, so we always set it.
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferID);
+	RenderStats::Add(RenderStat::BufferBinds);
+}
+
+void VertexArrayCache::OnBuffersDeleted(const unsigned int* rendererIDs, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		for (auto& layoutVertexArray : s_LayoutVertexArrays)
+		{
+			if (layoutVertexArray.second.boundVertexBuffer == rendererIDs[i])
+			{
+				layoutVertexArray.second.boundVertexBuffer = 0; //Force a rebind, even if a new buffer comes back with the same name.
+			}
+		}
+
+		for (auto iterator = s_BufferSetVertexArrays.begin(); iterator != s_BufferSetVertexArrays.end();)
+		{
+			if (iterator->first.vertexBufferID == rendererIDs[i] || iterator->first.indexBufferID == rendererIDs[i])
+			{
+				glDeleteVertexArrays(1, &iterator->second); //Safe to delete right away, we only get here once the GPU is done with the buffers.
+				iterator = s_BufferSetVertexArrays.erase(iterator);
+			}
+			else
+			{
+				++iterator;
+			}
+		}
+	}
+}
+
+void VertexArrayCache::Clear()
+{
+	for (auto& layoutVertexArray : s_LayoutVertexArrays)
+	{
+		glDeleteVertexArrays(1, &layoutVertexArray.second.rendererID);
+	}
+	for (auto& bufferSetVertexArray : s_BufferSetVertexArrays)
+	{
+		glDeleteVertexArrays(1, &bufferSetVertexArray.second);
+	}
+	s_LayoutVertexArrays.clear();
+	s_BufferSetVertexArrays.clear();
+}
+
+size_t VertexArrayCache::GetVertexArrayCount()
+{
+	return s_LayoutVertexArrays.size() + s_BufferSetVertexArrays.size();
+}
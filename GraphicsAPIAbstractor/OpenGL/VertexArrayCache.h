@@ -0,0 +1,53 @@
+#pragma once
+#include "GAAPrecompiledHeader.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include <cstdint>
+
+class VertexBufferLayout;
+struct VertexBufferElement;
+
+//Hands out vertex array objects by layout instead of having every mesh build its own. With ARB_vertex_attrib_binding, the attribute format is separate
+//from the buffer it reads from, so we keep a single VAO per layout hash and only swap the buffer bound to it. Without it, we fall back to one VAO per
+//(layout, vertex buffer, index buffer) combination, which is still only ever set up once.
+class VertexArrayCache
+{
+public:
+	static void Bind(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const VertexBufferLayout& layout);
+	template<typename Layout>
+	static void Bind(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer)
+	{
+		Bind(vertexBuffer.GetRendererID(), indexBuffer.GetRendererID(), Layout::Elements.data(), Layout::AttributeCount, Layout::Stride, Layout::Hash);
+	}
+	static void Bind(unsigned int vertexBufferID, unsigned int indexBufferID, const VertexBufferElement* elements, unsigned int elementCount, unsigned int stride, uint64_t layoutHash);
+
+	static void OnBuffersDeleted(const unsigned int* rendererIDs, size_t count); //Called by the DeletionQueue, as GL may hand the same names out again.
+	static void Clear();
+
+	static size_t GetVertexArrayCount();
+	static bool IsUsingAttribBinding();
+
+private:
+	struct LayoutVertexArray
+	{
+		unsigned int rendererID;
+		unsigned int boundVertexBuffer; //What binding point 0 currently holds, so rebinding the same mesh is free.
+	};
+
+	struct BufferSetKey
+	{
+		uint64_t layoutHash;
+		unsigned int vertexBufferID;
+		unsigned int indexBufferID;
+
+		bool operator==(const BufferSetKey& other) const { return layoutHash == other.layoutHash && vertexBufferID == other.vertexBufferID && indexBufferID == other.indexBufferID; }
+	};
+
+	struct BufferSetKeyHash
+	{
+		size_t operator()(const BufferSetKey& key) const { return (size_t)(key.layoutHash ^ ((uint64_t)key.vertexBufferID << 32) ^ ((uint64_t)key.indexBufferID * 0x9E3779B97F4A7C15ull)); }
+	};
+
+	static std::unordered_map<uint64_t, LayoutVertexArray> s_LayoutVertexArrays; //ARB_vertex_attrib_binding path.
+	static std::unordered_map<BufferSetKey, unsigned int, BufferSetKeyHash> s_BufferSetVertexArrays; //Fallback path.
+};
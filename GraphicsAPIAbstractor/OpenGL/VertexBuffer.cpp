@@ -1,5 +1,8 @@
 #include "GAAPrecompiledHeader.h"
 #include "VertexBuffer.h"
+#include "DeletionQueue.h"
+#include "RenderStats.h"
+#include "GPUMemoryTracker.h"
 #include "GL/glew.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
@@ -7,16 +10,40 @@ VertexBuffer::VertexBuffer(const void* data, unsigned int size)
     glGenBuffers(1, &m_RendererID);          //We would like to generate 1 empty buffer and store it in the memory address of "buffer".
     glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);  //OpenGL will always select whatever is bound to the buffer and do your commands with it.
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    RenderStats::Add(RenderStat::BufferAllocations);
+    RenderStats::Add(RenderStat::BufferBytesAllocated, size);
+    GPUMemoryTracker::Track(GLObjectType::Buffer, m_RendererID, GPUMemoryCategory::Mesh, size);
+    if (data != nullptr)
+    {
+        RenderStats::Add(RenderStat::BytesUploaded, size);
+    }
 }
 
 VertexBuffer::~VertexBuffer()
 {
-    glDeleteBuffers(1, &m_RendererID);
+    DeletionQueue::Enqueue(GLObjectType::Buffer, m_RendererID); //The GPU may still be reading this buffer for frames in flight, so the actual delete waits on a fence.
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept : m_RendererID(other.m_RendererID)
+{
+    other.m_RendererID = 0; //The deletion queue ignores 0, so the moved-from object's destructor does nothing.
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        DeletionQueue::Enqueue(GLObjectType::Buffer, m_RendererID);
+        m_RendererID = other.m_RendererID;
+        other.m_RendererID = 0;
+    }
+    return *this;
 }
 
 void VertexBuffer::Bind() const
 {
     glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);  //OpenGL will always select whatever is bound to the buffer and do your commands with it.
+    RenderStats::Add(RenderStat::BufferBinds);
 }
 
 void VertexBuffer::Unbind() const
@@ -6,8 +6,15 @@ public:
 	VertexBuffer(const void* data, unsigned int size);
 	~VertexBuffer();
 
+	//Only ever one owner per GL buffer, so these can be moved (into a ResourcePool, say) but never copied.
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
 	void Bind() const;
 	void Unbind() const;
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 
 private:
 	//We know that OpenGL needs an unsigned integer to keep track of every object we create in OpenGL such as Textures, Shaders etc.
@@ -2,62 +2,237 @@
 #include "GAAPrecompiledHeader.h"
 #include "GL/glew.h"
 #include "OpenGLRenderer.h"
+#include <cstdint>
 
 struct VertexBufferElement
 {
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	unsigned int offset; //Byte offset of this attribute from the start of the vertex.
 
-	static unsigned int GetSizeOfType(unsigned int type)
+	//0 for a type we don't support, so loaders can turn a corrupt file away rather than assert.
+	static unsigned int FindSizeOfType(unsigned int type)
 	{
 		switch (type)
 		{
-			case GL_FLOAT:			return 4;
-			case GL_UNSIGNED_INT:	return 4;
-			case GL_UNSIGNED_BYTE:  return 1;
+			case GL_FLOAT:							return 4;
+			case GL_UNSIGNED_INT:					return 4;
+			case GL_HALF_FLOAT:						return 2;
+			case GL_SHORT:							return 2;
+			case GL_UNSIGNED_SHORT:					return 2;
+			case GL_BYTE:							return 1;
+			case GL_UNSIGNED_BYTE:					return 1;
+			case GL_INT_2_10_10_10_REV:				return 4; //For the whole attribute, see GetSize().
+			case GL_UNSIGNED_INT_2_10_10_10_REV:	return 4;
 		}
-		ASSERT(false);
 		return 0;
 	}
+
+	static unsigned int GetSizeOfType(unsigned int type)
+	{
+		unsigned int size = FindSizeOfType(type);
+		ASSERT(size != 0);
+		return size;
+	}
+
+	//Packed formats squeeze all 4 components into a single 32 bit value, and OpenGL only accepts them with a count of 4.
+	static bool IsPackedType(unsigned int type)
+	{
+		return type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV;
+	}
+
+	//Integer data the shader reads as ints or uints rather than floats, which has to go through glVertexAttribIPointer to arrive unconverted.
+	static bool IsIntegerAttribute(unsigned int type, unsigned char normalized)
+	{
+		if (normalized)
+		{
+			return false;
+		}
+		return type == GL_UNSIGNED_INT || type == GL_SHORT || type == GL_UNSIGNED_SHORT || type == GL_BYTE || type == GL_UNSIGNED_BYTE;
+	}
+
+	static unsigned int GetSize(unsigned int type, unsigned int count)
+	{
+		return IsPackedType(type) ? GetSizeOfType(type) : count * GetSizeOfType(type);
+	}
 };
 
-struct VertexBufferLayout
+//Tags for the runtime Push<T>() of quantized formats, which have no C++ type of their own. Each pushes components that the shader reads back as floats.
+namespace VertexFormat
+{
+	struct Half {};					//16 bit float. Exact for small integers, roughly 3 significant digits otherwise.
+	struct Snorm16 {};				//16 bit signed, [-32767, 32767] maps to [-1, 1].
+	struct Unorm16 {};				//16 bit unsigned, [0, 65535] maps to [0, 1].
+	struct Snorm10_10_10_2 {};		//3 x 10 bit signed plus a 2 bit w, in one 32 bit value. Good enough for normals and tangents.
+	struct Unorm10_10_10_2 {};		//3 x 10 bit unsigned plus a 2 bit w. Colors and anything else already in [0, 1].
+}
+
+//FNV-1a over everything that affects how the attributes are fetched. Both layout types below hash through this, so a compile time layout and a runtime one
+//describing the same vertex always agree, which is what lets caches key on it.
+constexpr uint64_t HashVertexElements(const VertexBufferElement* elements, size_t elementCount, unsigned int stride)
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto combine = [&hash](uint64_t value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			hash ^= (value >> (i * 8)) & 0xFF;
+			hash *= 1099511628211ull;
+		}
+	};
+	for (size_t i = 0; i < elementCount; i++)
+	{
+		combine(elements[i].type);
+		combine(elements[i].count);
+		combine(elements[i].normalized);
+		combine(elements[i].offset);
+	}
+	combine(stride);
+	return hash;
+}
+
+class VertexBufferLayout
 {
 public:
 	VertexBufferLayout() : m_Stride(0) {}
+	VertexBufferLayout(const VertexBufferElement* elements, unsigned int elementCount, unsigned int stride) : m_Elements(elements, elements + elementCount), m_Stride(stride) {} //For layouts read back from a file.
 
 	template<typename T>
 	void Push(unsigned int count)
 	{
-		static_assert(false);
+		static_assert(sizeof(T) == 0, "VertexBufferLayout::Push doesn't support this type."); //Dependent on T, so this only fires if this overload is actually instantiated.
 	}
 
-	template<>
-	void Push<float>(unsigned int count)
-	{
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
-	}
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
+	inline unsigned int GetStride() const { return m_Stride; }
+	inline uint64_t GetHash() const { return HashVertexElements(m_Elements.data(), m_Elements.size(), m_Stride); }
 
-	template<>
-	void Push<unsigned int>(unsigned int count)
+	//Skips bytes so that the next attribute starts on the given alignment. Odd sized attributes like three halves should be followed by this, as most hardware
+	//fetches attributes that straddle a 4 byte boundary at a penalty.
+	void Align(unsigned int alignment)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
+		m_Stride = (m_Stride + alignment - 1) / alignment * alignment;
 	}
 
-	template<>
-	void Push<unsigned char>(unsigned int count)
+private:
+	void PushElement(unsigned int type, unsigned int count, unsigned char normalized)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+		m_Elements.push_back({ type, count, normalized, m_Stride });
+		m_Stride += VertexBufferElement::GetSize(type, count);
 	}
 
-	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
-	inline unsigned int GetStride() const { return m_Stride; }
-
-private:
 	std::vector<VertexBufferElement> m_Elements;
 	unsigned int m_Stride;
-};
\ No newline at end of file
+};
+
+//Explicit specializations have to live at namespace scope. MSVC lets them sit inside the class, but GCC and Clang don't.
+template<>
+inline void VertexBufferLayout::Push<float>(unsigned int count)
+{
+	PushElement(GL_FLOAT, count, GL_FALSE);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned int>(unsigned int count)
+{
+	PushElement(GL_UNSIGNED_INT, count, GL_FALSE);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned char>(unsigned int count)
+{
+	PushElement(GL_UNSIGNED_BYTE, count, GL_TRUE);
+}
+
+template<>
+inline void VertexBufferLayout::Push<VertexFormat::Half>(unsigned int count)
+{
+	PushElement(GL_HALF_FLOAT, count, GL_FALSE);
+}
+
+template<>
+inline void VertexBufferLayout::Push<VertexFormat::Snorm16>(unsigned int count)
+{
+	PushElement(GL_SHORT, count, GL_TRUE);
+}
+
+template<>
+inline void VertexBufferLayout::Push<VertexFormat::Unorm16>(unsigned int count)
+{
+	PushElement(GL_UNSIGNED_SHORT, count, GL_TRUE);
+}
+
+template<>
+inline void VertexBufferLayout::Push<VertexFormat::Snorm10_10_10_2>(unsigned int count)
+{
+	ASSERT((count == 4));
+	PushElement(GL_INT_2_10_10_10_REV, 4, GL_TRUE);
+}
+
+template<>
+inline void VertexBufferLayout::Push<VertexFormat::Unorm10_10_10_2>(unsigned int count)
+{
+	ASSERT((count == 4));
+	PushElement(GL_UNSIGNED_INT_2_10_10_10_REV, 4, GL_TRUE);
+}
+
+//Attribute types for compile time layouts. Each describes its GL type, component count and size in bytes.
+namespace Attribute
+{
+	template<unsigned int GLType, unsigned int ComponentCount, unsigned char IsNormalized, unsigned int ComponentSize>
+	struct AttributeType
+	{
+		static constexpr unsigned int Type = GLType;
+		static constexpr unsigned int Count = ComponentCount;
+		static constexpr unsigned char Normalized = IsNormalized;
+		static constexpr unsigned int Size = ComponentCount * ComponentSize;
+	};
+
+	using Float = AttributeType<GL_FLOAT, 1, GL_FALSE, 4>;
+	using Float2 = AttributeType<GL_FLOAT, 2, GL_FALSE, 4>;
+	using Float3 = AttributeType<GL_FLOAT, 3, GL_FALSE, 4>;
+	using Float4 = AttributeType<GL_FLOAT, 4, GL_FALSE, 4>;
+	using UInt = AttributeType<GL_UNSIGNED_INT, 1, GL_FALSE, 4>;
+	using UByte4Norm = AttributeType<GL_UNSIGNED_BYTE, 4, GL_TRUE, 1>; //Colors.
+
+	//Quantized types. These halve the size of the float versions, or better, at the cost of precision. VertexQuantizer can pick between them for you.
+	using Half2 = AttributeType<GL_HALF_FLOAT, 2, GL_FALSE, 2>;
+	using Half4 = AttributeType<GL_HALF_FLOAT, 4, GL_FALSE, 2>;
+	using Short2Norm = AttributeType<GL_SHORT, 2, GL_TRUE, 2>;
+	using Short4Norm = AttributeType<GL_SHORT, 4, GL_TRUE, 2>;
+	using UShort2Norm = AttributeType<GL_UNSIGNED_SHORT, 2, GL_TRUE, 2>;
+	using UShort4Norm = AttributeType<GL_UNSIGNED_SHORT, 4, GL_TRUE, 2>;
+
+	template<unsigned int GLType>
+	struct PackedAttributeType
+	{
+		static constexpr unsigned int Type = GLType;
+		static constexpr unsigned int Count = 4;
+		static constexpr unsigned char Normalized = GL_TRUE;
+		static constexpr unsigned int Size = 4;
+	};
+
+	using Int2_10_10_10Norm = PackedAttributeType<GL_INT_2_10_10_10_REV>; //Normals and tangents, with the tangent's handedness in w.
+	using UInt2_10_10_10Norm = PackedAttributeType<GL_UNSIGNED_INT_2_10_10_10_REV>;
+}
+
+//A vertex layout that is fully worked out by the compiler: VertexLayout<Attribute::Float3, Attribute::Float3, Attribute::Float2> has its stride, offsets and hash
+//as constants, and its elements in a static constexpr array, so setting it up costs nothing beyond the GL calls themselves.
+template<typename... Attributes>
+struct VertexLayout
+{
+	static constexpr unsigned int AttributeCount = sizeof...(Attributes);
+	static constexpr unsigned int Stride = (0u + ... + Attributes::Size);
+
+	static constexpr std::array<VertexBufferElement, AttributeCount> MakeElements()
+	{
+		std::array<VertexBufferElement, AttributeCount> elements = {};
+		unsigned int index = 0, offset = 0;
+		((elements[index++] = VertexBufferElement{ Attributes::Type, Attributes::Count, Attributes::Normalized, offset }, offset += Attributes::Size), ...);
+		return elements;
+	}
+
+	static constexpr std::array<VertexBufferElement, AttributeCount> Elements = MakeElements();
+	static constexpr uint64_t Hash = HashVertexElements(Elements.data(), AttributeCount, Stride);
+};
@@ -24,11 +24,12 @@ namespace Test
 		void RegisterTest(const std::string& name)
 		{
 			std::cout << "Registering Test" << name << "\n";
-			m_Tests.push_back(std::make_pair(name, []() { return new T(); }));
+			m_Tests.push_back(std::make_pair(name, []() -> Test* { return new T(); })); //Captureless, so this converts to a plain function pointer.
 		}
 		
 	private: //Label & Function
+		using TestFactory = Test* (*)();
 		Test*& m_CurrentActiveTest;
-		std::vector<std::pair<std::string, std::function<Test* ()>>> m_Tests;
+		std::vector<std::pair<std::string, TestFactory>> m_Tests;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "GAAPrecompiledHeader.h"
+#include "TestCookedMesh.h"
+#include "MeshCooker.h"
+#include "imgui/imgui.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include <cmath>
+
+namespace Test
+{
+	//Cooked every time the scene opens, so it always matches what the current cooker writes.
+	static const char* s_CookedMeshPath = "Resources/CookedSphere.gaam";
+	static const float s_FieldOfView = glm::radians(45.0f);
+
+	TestCookedMesh::TestCookedMesh() : m_LOD(0), m_AutomaticLOD(true), m_MaxPixelError(1.0f), m_ProjectionScale(1.0f), m_Rotation(0.0f), m_Distance(4.0f)
+	{
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		GenerateSphere(vertices, indices, 96, 192);
+		if (MeshCooker::CookMesh(vertices, indices, s_CookedMeshPath, MeshCookSettings()))
+		{
+			m_Mesh = std::make_unique<Mesh>(s_CookedMeshPath);
+		}
+		m_Shader = ResourceRegistry::Shaders().Create("OpenGL/Shaders/CookedMesh.shader");
+		if (m_Mesh && m_Mesh->IsLoaded())
+		{
+			ResourceRegistry::Get(m_Shader)->IsCompatibleWith(m_Mesh->GetLayout());
+		}
+	}
+
+	TestCookedMesh::~TestCookedMesh()
+	{
+		m_Mesh.reset();
+		ResourceRegistry::Destroy(m_Shader);
+	}
+
+	void TestCookedMesh::GenerateSphere(std::vector<float>& vertices, std::vector<unsigned int>& indices, unsigned int rings, unsigned int segments)
+	{
+		//Interleaved position, normal and texture coordinates, as MeshCooker takes them. The seam column is duplicated so its texture coordinates can wrap.
+		const float pi = 3.14159265f;
+		for (unsigned int ring = 0; ring <= rings; ring++)
+		{
+			float v = (float)ring / rings;
+			float theta = v * pi;
+			for (unsigned int segment = 0; segment <= segments; segment++)
+			{
+				float u = (float)segment / segments;
+				float phi = u * 2.0f * pi;
+				float normal[3] = { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+				vertices.insert(vertices.end(), { normal[0], normal[1], normal[2], normal[0], normal[1], normal[2], u, v });
+			}
+		}
+		for (unsigned int ring = 0; ring < rings; ring++)
+		{
+			for (unsigned int segment = 0; segment < segments; segment++)
+			{
+				unsigned int a = ring * (segments + 1) + segment, b = a + segments + 1;
+				indices.insert(indices.end(), { a, a + 1, b, b, a + 1, b + 1 });
+			}
+		}
+	}
+
+	bool TestCookedMesh::CheckLODSelection()
+	{
+		const std::vector<MeshLOD>& lods = m_Mesh->GetLODs();
+		unsigned int previousLOD = 0;
+		for (float distance = 0.5f; distance < 10000.0f; distance *= 1.05f)
+		{
+			unsigned int lod = m_Mesh->SelectLOD(distance, m_ProjectionScale, m_MaxPixelError);
+			if (lod < previousLOD)
+			{
+				m_CheckResult = "Failed: LOD " + std::to_string(lod) + " picked at " + std::to_string(distance) + " after LOD " + std::to_string(previousLOD) + " was picked closer.";
+				return false;
+			}
+			//LOD 0 is the fallback when nothing is good enough, so only the coarser ones have to meet the threshold.
+			if (lod > 0 && lods[lod].error / distance * m_ProjectionScale > m_MaxPixelError)
+			{
+				m_CheckResult = "Failed: LOD " + std::to_string(lod) + " projects to more than " + std::to_string(m_MaxPixelError) + " pixels at " + std::to_string(distance) + ".";
+				return false;
+			}
+			previousLOD = lod;
+		}
+		m_CheckResult = "Passed, reaching LOD " + std::to_string(previousLOD) + ".";
+		return true;
+	}
+
+	void TestCookedMesh::OnUpdate(float deltaTime)
+	{
+		m_Rotation += deltaTime * 0.5f;
+	}
+
+	void TestCookedMesh::OnRender()
+	{
+		int viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		Shader* shader = ResourceRegistry::Get(m_Shader);
+		if (!shader || !m_Mesh || !m_Mesh->IsLoaded() || viewport[2] == 0 || viewport[3] == 0)
+		{
+			return;
+		}
+
+		m_ProjectionScale = CalculateProjectionScale((float)viewport[3], s_FieldOfView);
+		if (m_AutomaticLOD)
+		{
+			m_LOD = (int)m_Mesh->SelectLOD(m_Distance, m_ProjectionScale, m_MaxPixelError);
+		}
+
+		glm::mat4 viewProjection = glm::perspective(s_FieldOfView, (float)viewport[2] / viewport[3], 0.1f, 1000.0f) * glm::lookAt(glm::vec3(0.0f, 0.0f, m_Distance), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		shader->Bind();
+		shader->SetUniformMat4f("u_ViewProjection", viewProjection);
+		shader->SetUniformMat4f("u_Model", glm::rotate(glm::mat4(1.0f), m_Rotation, glm::vec3(0.0f, 1.0f, 0.0f)));
+		shader->SetUniform4f("u_Color", 0.9f, 0.6f, 0.3f, 1.0f);
+
+		OpenGLRenderer renderer;
+		glEnable(GL_DEPTH_TEST);
+		m_Mesh->Draw(renderer, *shader, (unsigned int)m_LOD);
+		glDisable(GL_DEPTH_TEST);
+	}
+
+	void TestCookedMesh::OnImGuiRender()
+	{
+		if (!m_Mesh || !m_Mesh->IsLoaded())
+		{
+			ImGui::Text("Couldn't cook or load %s.", s_CookedMeshPath);
+			return;
+		}
+
+		ImGui::SliderFloat("Distance", &m_Distance, 1.5f, 200.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+		ImGui::Checkbox("Pick LOD from distance", &m_AutomaticLOD);
+		if (m_AutomaticLOD)
+		{
+			ImGui::SliderFloat("Max pixel error", &m_MaxPixelError, 0.1f, 16.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+			ImGui::Text("LOD %d", m_LOD);
+		}
+		else
+		{
+			ImGui::SliderInt("LOD", &m_LOD, 0, (int)m_Mesh->GetLODs().size() - 1);
+		}
+		const MeshLOD& lod = m_Mesh->GetLODs()[m_LOD];
+		ImGui::Text("%u triangles, error %.5f, %.2f pixels on screen", lod.indexCount / 3, lod.error, lod.error / m_Distance * m_ProjectionScale);
+
+		if (ImGui::Button("Check LOD selection") && !CheckLODSelection())
+		{
+			std::cout << "Warning: The cooked mesh's LOD selection check failed! " << m_CheckResult << " \n";
+		}
+		ImGui::Text("%s", m_CheckResult.c_str());
+		ImGui::Text("Vertex stride %u bytes", m_Mesh->GetLayout().GetStride());
+		for (const MeshFileAttribute& attribute : m_Mesh->GetAttributes())
+		{
+			ImGui::Text("Scale (%.3f, %.3f, %.3f) offset (%.3f, %.3f, %.3f)", attribute.dequantizeScale[0], attribute.dequantizeScale[1], attribute.dequantizeScale[2],
+				attribute.dequantizeOffset[0], attribute.dequantizeOffset[1], attribute.dequantizeOffset[2]);
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Test.h"
+#include "OpenGLRenderer.h"
+#include "ResourceRegistry.h"
+#include "Mesh.h"
+
+namespace Test
+{
+	//A sphere generated here, cooked through MeshCooker and loaded back as a Mesh, the way cooked assets are. Its positions are remapped into unorms by the
+	//cooker, so the sphere only comes out round if the shader applies the mesh's dequantization. The LOD is picked from the camera distance like a renderer would.
+	class TestCookedMesh : public Test
+	{
+	public:
+		TestCookedMesh();
+		~TestCookedMesh();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		static void GenerateSphere(std::vector<float>& vertices, std::vector<unsigned int>& indices, unsigned int rings, unsigned int segments);
+		//Sweeps the distance outwards and checks that the chosen LOD never gets finer and that its projected error stays under the threshold.
+		bool CheckLODSelection();
+
+		std::unique_ptr<Mesh> m_Mesh;
+		ShaderHandle m_Shader;
+		int m_LOD;
+		bool m_AutomaticLOD;
+		float m_MaxPixelError;
+		float m_ProjectionScale;
+		float m_Rotation;
+		float m_Distance;
+		std::string m_CheckResult;
+	};
+}
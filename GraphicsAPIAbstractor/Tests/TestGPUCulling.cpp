@@ -0,0 +1,217 @@
+#include "GAAPrecompiledHeader.h"
+#include "TestGPUCulling.h"
+#include "imgui/imgui.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include <chrono>
+#include <cmath>
+
+namespace Test
+{
+	TestGPUCulling::TestGPUCulling() : m_ObjectCount(50000), m_BuiltObjectCount(0), m_CameraAngle(0.0f), m_CameraPaused(false), m_CullOnGPU(GPUCuller::IsSupported()),
+		m_OcclusionCulling(true), m_ValidateNextFrame(false), m_CPUVisibleCount(0), m_GPUVisibleCount(0), m_Mismatches(0), m_CullMilliseconds(0.0f)
+	{
+		//A unit cube.
+		float positions[] =
+		{
+			-0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f, 0.5f, -0.5f,   -0.5f, 0.5f, -0.5f,
+			-0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f, 0.5f,  0.5f,   -0.5f, 0.5f,  0.5f
+		};
+		unsigned int indices[] =
+		{
+			0, 2, 1, 2, 0, 3, //Back
+			4, 5, 6, 6, 7, 4, //Front
+			0, 4, 7, 7, 3, 0, //Left
+			1, 2, 6, 6, 5, 1, //Right
+			0, 1, 5, 5, 4, 0, //Bottom
+			3, 7, 6, 6, 2, 3  //Top
+		};
+		m_VertexBuffer = ResourceRegistry::VertexBuffers().Create(positions, (unsigned int)sizeof(positions));
+		m_IndexBuffer = ResourceRegistry::IndexBuffers().Create(indices, 36);
+		m_Shader = ResourceRegistry::Shaders().Create("OpenGL/Shaders/CulledInstances.shader");
+
+		VertexBufferLayout layout;
+		layout.Push<float>(3);
+		VertexBufferLayout perDrawLayout;
+		perDrawLayout.Push<float>(4);
+		perDrawLayout.Push<unsigned char>(4);
+		static_assert(sizeof(PerDrawData) == 20, "PerDrawData should match the per draw layout above.");
+		m_Batch = std::make_unique<IndirectDrawBatch>(*ResourceRegistry::Get(m_VertexBuffer), *ResourceRegistry::Get(m_IndexBuffer), layout, perDrawLayout);
+		m_Culler = std::make_unique<GPUCuller>();
+		m_HiZPyramid = std::make_unique<HiZPyramid>();
+	}
+
+	TestGPUCulling::~TestGPUCulling()
+	{
+		m_Batch.reset();
+		ResourceRegistry::Destroy(m_VertexBuffer);
+		ResourceRegistry::Destroy(m_IndexBuffer);
+		ResourceRegistry::Destroy(m_Shader);
+	}
+
+	void TestGPUCulling::BuildScene()
+	{
+		m_Commands.clear();
+		m_PerDrawData.clear();
+		m_Bounds.clear();
+
+		//Object 0 is the occluder in the middle, the rest are scattered around it on a jittered grid.
+		auto addObject = [this](float x, float y, float z, float scale, unsigned char r, unsigned char g, unsigned char b)
+		{
+			unsigned int drawIndex = (unsigned int)m_Commands.size();
+			m_Commands.push_back({ 36, 1, 0, 0, drawIndex });
+			m_PerDrawData.push_back({ { x, y, z, scale }, { r, g, b, 255 } });
+			m_Bounds.push_back({ glm::vec3(x, y, z), scale * 0.8660254f }); //Half the cube's diagonal.
+		};
+		addObject(0.0f, 6.0f, 0.0f, 12.0f, 200, 200, 200);
+
+		int columns = (int)std::ceil(std::sqrt((float)m_ObjectCount));
+		float spacing = 200.0f / columns;
+		for (int i = 1; i < m_ObjectCount; i++)
+		{
+			float x = (i % columns + 0.5f) * spacing - 100.0f + std::sin(i * 12.9898f) * spacing * 0.25f;
+			float z = (i / columns + 0.5f) * spacing - 100.0f + std::sin(i * 78.233f) * spacing * 0.25f;
+			if (std::abs(x) < 7.0f && std::abs(z) < 7.0f)
+			{
+				x += 14.0f; //Not inside the occluder.
+			}
+			float scale = spacing * 0.5f;
+			addObject(x, scale * 0.5f, z, scale, (unsigned char)(i * 37), (unsigned char)(i * 73), (unsigned char)(i * 151));
+		}
+		m_BuiltObjectCount = m_ObjectCount;
+	}
+
+	void TestGPUCulling::OnUpdate(float deltaTime)
+	{
+		if (!m_CameraPaused)
+		{
+			m_CameraAngle += deltaTime * 0.2f;
+		}
+	}
+
+	void TestGPUCulling::OnRender()
+	{
+		int viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		Shader* shader = ResourceRegistry::Get(m_Shader);
+		if (!shader || viewport[2] == 0 || viewport[3] == 0)
+		{
+			return;
+		}
+		if (m_BuiltObjectCount != m_ObjectCount)
+		{
+			BuildScene();
+		}
+
+		glm::vec3 eye(std::cos(m_CameraAngle) * 30.0f, 3.0f, std::sin(m_CameraAngle) * 30.0f);
+		glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), (float)viewport[2] / viewport[3], 0.1f, 300.0f) * glm::lookAt(eye, glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		bool cullOnGPU = m_CullOnGPU && GPUCuller::IsSupported();
+
+		//The GPU path records every object and lets the culler pick. The CPU path only records what its reference cull kept.
+		auto cullStart = std::chrono::steady_clock::now();
+		m_Batch->Clear();
+		if (cullOnGPU)
+		{
+			for (const DrawElementsIndirectCommand& command : m_Commands)
+			{
+				m_Batch->AddDraw(command.indexCount, command.firstIndex, command.baseVertex, &m_PerDrawData[command.baseInstance]);
+			}
+		}
+		else
+		{
+			//Object 0 is the only occluder worth drawing. It goes in as a box a little inside the real cube, so the software depth never covers more than it does.
+			const DepthPyramid* occluderDepth = nullptr;
+			if (m_OcclusionCulling)
+			{
+				const PerDrawData& occluder = m_PerDrawData[0];
+				glm::vec3 center(occluder.offsetScale[0], occluder.offsetScale[1], occluder.offsetScale[2]);
+				glm::vec3 halfSize(occluder.offsetScale[3] * 0.49f);
+				m_DepthRasterizer.Begin(viewProjection);
+				m_DepthRasterizer.AddOccluder(BoundingBox{ center - halfSize, center + halfSize });
+				m_DepthRasterizer.Rasterize();
+				occluderDepth = &m_DepthRasterizer.GetPyramid();
+			}
+			m_VisibleCommands.resize(m_Commands.size());
+			m_CPUVisibleCount = GPUCuller::CullOnCPU(m_Commands.data(), m_Bounds.data(), (unsigned int)m_Commands.size(), viewProjection, occluderDepth, m_VisibleCommands.data());
+			for (unsigned int i = 0; i < m_CPUVisibleCount; i++)
+			{
+				const DrawElementsIndirectCommand& command = m_VisibleCommands[i];
+				m_Batch->AddDraw(command.indexCount, command.firstIndex, command.baseVertex, &m_PerDrawData[command.baseInstance]);
+			}
+		}
+
+		const HiZPyramid* previousDepth = (m_OcclusionCulling && m_HiZPyramid->IsValid()) ? m_HiZPyramid.get() : nullptr;
+		if (cullOnGPU)
+		{
+			m_Culler->Cull(*m_Batch, m_Bounds.data(), viewProjection, previousDepth);
+			if (m_ValidateNextFrame)
+			{
+				m_Mismatches = m_Culler->Validate(*m_Batch, m_Bounds.data(), viewProjection, previousDepth);
+				m_GPUVisibleCount = m_Culler->ReadVisibleCount();
+				m_ValidateNextFrame = false;
+			}
+		}
+		m_CullMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+
+		glEnable(GL_DEPTH_TEST);
+		OpenGLRenderer renderer;
+		shader->Bind();
+		shader->SetUniformMat4f("u_ViewProjection", viewProjection);
+		if (cullOnGPU)
+		{
+			renderer.Draw(*m_Batch, *shader, *m_Culler);
+		}
+		else
+		{
+			renderer.Draw(*m_Batch, *shader);
+		}
+		glDisable(GL_DEPTH_TEST);
+
+		//This frame's depth is next frame's occlusion.
+		if (cullOnGPU && m_OcclusionCulling)
+		{
+			m_HiZPyramid->Build(viewport[2], viewport[3], viewProjection);
+		}
+	}
+
+	void TestGPUCulling::OnImGuiRender()
+	{
+		ImGui::SliderInt("Objects", &m_ObjectCount, 1, 1000000);
+		ImGui::Checkbox("Pause camera", &m_CameraPaused);
+		ImGui::Checkbox("Occlusion culling", &m_OcclusionCulling);
+		if (!GPUCuller::IsSupported())
+		{
+			ImGui::Text("GPU culling needs GL 4.3, so the CPU reference is culling.");
+		}
+		else
+		{
+			ImGui::Checkbox("Cull on the GPU (occlusion from last frame's Hi-Z)", &m_CullOnGPU);
+			if (!GPUCuller::IsDrawCountSupported())
+			{
+				ImGui::Text("No ARB_indirect_parameters, so culled draws are submitted as empty commands.");
+			}
+		}
+
+		if (m_CullOnGPU && GPUCuller::IsSupported())
+		{
+			if (ImGui::Button("Validate against the CPU reference"))
+			{
+				m_ValidateNextFrame = true;
+			}
+			ImGui::Text("Last validation: %u visible on the GPU, %u disagreements", m_GPUVisibleCount, m_Mismatches);
+			ImGui::Text("%u objects, visibility decided on the GPU (%.3f ms CPU to record and cull)", m_Batch->GetDrawCount(), m_CullMilliseconds);
+		}
+		else
+		{
+			ImGui::Text("%u of %d objects visible (%.3f ms CPU to cull and record)", m_CPUVisibleCount, m_BuiltObjectCount, m_CullMilliseconds);
+			if (m_OcclusionCulling)
+			{
+				ImGui::Text("Occluder rasterized at %ux%u in %.3f ms", m_DepthRasterizer.GetWidth(), m_DepthRasterizer.GetHeight(), m_DepthRasterizer.GetRasterizeMilliseconds());
+			}
+		}
+		ImGui::Text("%u draw calls", m_Batch->GetLastSubmitCallCount());
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Test.h"
+#include "OpenGLRenderer.h"
+#include "IndirectDrawBatch.h"
+#include "GPUCuller.h"
+#include "HiZPyramid.h"
+#include "ResourceRegistry.h"
+#include "DepthRasterizer.h"
+
+namespace Test
+{
+	//A field of cubes around one big occluder, with the camera circling it. Visibility is decided either by GPUCuller, against the frustum and last frame's
+	//Hi-Z pyramid, or on the CPU by its reference implementation, against the frustum and the occluder drawn by a DepthRasterizer. Validate compares the GPU
+	//with the reference on the same frame.
+	class TestGPUCulling : public Test
+	{
+	public:
+		TestGPUCulling();
+		~TestGPUCulling();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		struct PerDrawData
+		{
+			float offsetScale[4]; //x, y, z and scale.
+			unsigned char color[4];
+		};
+
+		void BuildScene();
+
+		VertexBufferHandle m_VertexBuffer;
+		IndexBufferHandle m_IndexBuffer;
+		ShaderHandle m_Shader;
+		std::unique_ptr<IndirectDrawBatch> m_Batch;
+		std::unique_ptr<GPUCuller> m_Culler;
+		std::unique_ptr<HiZPyramid> m_HiZPyramid;
+		DepthRasterizer m_DepthRasterizer;
+
+		//Every object, whichever way it is culled.
+		std::vector<DrawElementsIndirectCommand> m_Commands;
+		std::vector<PerDrawData> m_PerDrawData;
+		std::vector<BoundingSphere> m_Bounds;
+		std::vector<DrawElementsIndirectCommand> m_VisibleCommands; //For the CPU path.
+
+		int m_ObjectCount, m_BuiltObjectCount;
+		float m_CameraAngle;
+		bool m_CameraPaused, m_CullOnGPU, m_OcclusionCulling, m_ValidateNextFrame;
+		unsigned int m_CPUVisibleCount, m_GPUVisibleCount, m_Mismatches;
+		float m_CullMilliseconds;
+	};
+}
@@ -0,0 +1,155 @@
+#include "GAAPrecompiledHeader.h"
+#include "TestModel.h"
+#include "imgui/imgui.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include <fstream>
+
+namespace Test
+{
+	//Next to Resources/Textures, so the images can be referenced relative to the .gltf.
+	static const char* s_ModelPath = "Resources/GeneratedCubes.gltf";
+	static const char* s_ModelBinaryPath = "Resources/GeneratedCubes.bin";
+
+	TestModel::TestModel() : m_Rotation(0.0f)
+	{
+		m_Shader = ResourceRegistry::Shaders().Create("OpenGL/Shaders/Model.shader");
+		Reload();
+	}
+
+	TestModel::~TestModel()
+	{
+		m_Model.reset();
+		ResourceRegistry::Destroy(m_Shader);
+	}
+
+	bool TestModel::WriteScene(const std::string& gltfPath, const std::string& binaryPath)
+	{
+		//A unit cube with its own four vertices per face, so each face gets flat normals and the whole texture. Position, normal and texture coordinates, interleaved.
+		std::vector<float> vertices;
+		std::vector<uint16_t> indices;
+		for (int face = 0; face < 6; face++)
+		{
+			int axis = face / 2;
+			float sign = face % 2 == 0 ? 1.0f : -1.0f;
+			glm::vec3 normal(0.0f), tangent(0.0f), bitangent(0.0f);
+			normal[axis] = sign;
+			tangent[(axis + 1) % 3] = sign;
+			bitangent[(axis + 2) % 3] = 1.0f;
+			const float corners[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+			uint16_t first = (uint16_t)(vertices.size() / 8);
+			for (const float* corner : corners)
+			{
+				glm::vec3 position = 0.5f * normal + (corner[0] - 0.5f) * tangent + (corner[1] - 0.5f) * bitangent;
+				vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, corner[0], 1.0f - corner[1] });
+			}
+			indices.insert(indices.end(), { first, (uint16_t)(first + 1), (uint16_t)(first + 2), (uint16_t)(first + 2), (uint16_t)(first + 3), first });
+		}
+
+		std::ofstream binary(binaryPath, std::ios::binary);
+		binary.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(float));
+		binary.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint16_t));
+		if (!binary)
+		{
+			return false;
+		}
+
+		size_t vertexBytes = vertices.size() * sizeof(float), indexBytes = indices.size() * sizeof(uint16_t);
+		std::string binaryName = binaryPath.substr(binaryPath.find_last_of("/\\") + 1);
+		std::ofstream gltf(gltfPath);
+		gltf << R"({
+	"asset": { "version": "2.0" },
+	"scene": 0,
+	"scenes": [ { "nodes": [ 0 ] } ],
+	"nodes": [
+		{ "name": "Parent", "children": [ 1, 2, 3 ], "rotation": [ 0.2588190, 0.0, 0.0, 0.9659258 ] },
+		{ "name": "Container", "mesh": 0, "translation": [ -1.6, 0.0, 0.0 ] },
+		{ "name": "Plain", "mesh": 1, "translation": [ 1.6, 0.0, 0.0 ], "scale": [ 0.7, 0.7, 0.7 ] },
+		{ "name": "Face", "mesh": 2, "translation": [ 0.0, 1.4, 0.0 ], "rotation": [ 0.0, 0.3826834, 0.0, 0.9238795 ], "scale": [ 0.6, 0.6, 0.6 ] }
+	],
+	"meshes": [
+		{ "primitives": [ { "attributes": { "POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2 }, "indices": 3, "material": 0 } ] },
+		{ "primitives": [ { "attributes": { "POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2 }, "indices": 3, "material": 1 } ] },
+		{ "primitives": [ { "attributes": { "POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2 }, "indices": 3, "material": 2 } ] }
+	],
+	"materials": [
+		{ "name": "Container", "pbrMetallicRoughness": { "baseColorTexture": { "index": 0 } } },
+		{ "name": "Plain", "pbrMetallicRoughness": { "baseColorFactor": [ 0.3, 0.6, 0.9, 1.0 ] } },
+		{ "name": "Face", "pbrMetallicRoughness": { "baseColorTexture": { "index": 1 }, "baseColorFactor": [ 1.0, 0.9, 0.8, 1.0 ] } }
+	],
+	"textures": [ { "source": 0, "sampler": 0 }, { "source": 1, "sampler": 0 } ],
+	"samplers": [ { "magFilter": 9729, "minFilter": 9729, "wrapS": 33071, "wrapT": 33071 } ],
+	"images": [ { "uri": "Textures/Container.jpg" }, { "uri": "Textures/AwesomeFace.png" } ],
+	"buffers": [ { "uri": ")" << binaryName << R"(", "byteLength": )" << vertexBytes + indexBytes << R"( } ],
+	"bufferViews": [
+		{ "buffer": 0, "byteOffset": 0, "byteLength": )" << vertexBytes << R"(, "byteStride": 32 },
+		{ "buffer": 0, "byteOffset": )" << vertexBytes << R"(, "byteLength": )" << indexBytes << R"( }
+	],
+	"accessors": [
+		{ "bufferView": 0, "byteOffset": 0, "componentType": 5126, "count": )" << vertices.size() / 8 << R"(, "type": "VEC3", "min": [ -0.5, -0.5, -0.5 ], "max": [ 0.5, 0.5, 0.5 ] },
+		{ "bufferView": 0, "byteOffset": 12, "componentType": 5126, "count": )" << vertices.size() / 8 << R"(, "type": "VEC3" },
+		{ "bufferView": 0, "byteOffset": 24, "componentType": 5126, "count": )" << vertices.size() / 8 << R"(, "type": "VEC2" },
+		{ "bufferView": 1, "byteOffset": 0, "componentType": 5123, "count": )" << indices.size() << R"(, "type": "SCALAR" }
+	]
+}
+)";
+		return (bool)gltf;
+	}
+
+	void TestModel::Reload()
+	{
+		//Rewritten every time, so it always matches what this test expects, then loaded fresh. The old model's buffers are only released once the GPU is done with them.
+		m_Model.reset();
+		if (!WriteScene(s_ModelPath, s_ModelBinaryPath))
+		{
+			std::cout << "Warning: Couldn't write " << s_ModelPath << " ! \n";
+			return;
+		}
+		m_Model = std::make_unique<Model>(s_ModelPath);
+	}
+
+	void TestModel::OnUpdate(float deltaTime)
+	{
+		m_Rotation += deltaTime * 0.5f;
+	}
+
+	void TestModel::OnRender()
+	{
+		int viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		Shader* shader = ResourceRegistry::Get(m_Shader);
+		if (!shader || !m_Model || !m_Model->IsLoaded() || viewport[2] == 0 || viewport[3] == 0)
+		{
+			return;
+		}
+
+		glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), (float)viewport[2] / viewport[3], 0.1f, 100.0f) * glm::lookAt(glm::vec3(0.0f, 1.0f, 6.0f), glm::vec3(0.0f, 0.3f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		OpenGLRenderer renderer;
+		glEnable(GL_DEPTH_TEST);
+		m_Model->Draw(renderer, *shader, viewProjection * glm::rotate(glm::mat4(1.0f), m_Rotation, glm::vec3(0.0f, 1.0f, 0.0f)));
+		glDisable(GL_DEPTH_TEST);
+	}
+
+	void TestModel::OnImGuiRender()
+	{
+		if (ImGui::Button("Reload"))
+		{
+			Reload();
+		}
+		if (!m_Model || !m_Model->IsLoaded())
+		{
+			ImGui::Text("Couldn't load %s.", s_ModelPath);
+			return;
+		}
+
+		const GLTFStatistics& statistics = m_Model->GetStatistics();
+		ImGui::Text("%zu primitives", m_Model->GetPrimitiveCount());
+		ImGui::Text("%.1f KB read, of which %.1f KB images", statistics.fileBytes / 1024.0f, statistics.imageBytes / 1024.0f);
+		ImGui::Text("%.1f KB vertices and %.1f KB indices, %.1f KB copied", statistics.vertexBytes / 1024.0f, statistics.indexBytes / 1024.0f, statistics.copiedBytes / 1024.0f);
+		ImGui::Text("Parse %.2f ms, decode %.2f ms, images %.2f ms", statistics.parseMilliseconds, statistics.decodeMilliseconds, statistics.imageMilliseconds);
+		ImGui::Text("Total %.2f ms, %.1f MB/s", statistics.totalMilliseconds, statistics.GetMegabytesPerSecond());
+	}
+}
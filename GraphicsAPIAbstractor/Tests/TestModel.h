@@ -0,0 +1,30 @@
+#pragma once
+#include "Test.h"
+#include "OpenGLRenderer.h"
+#include "ResourceRegistry.h"
+#include "Model.h"
+
+namespace Test
+{
+	//A small glTF written out here and loaded back through Model: three cubes under one parent node, two textured with images from Resources/Textures, which
+	//decode in parallel with the geometry, and one with just a base color. The vertices are interleaved in the .bin, so they upload straight from the mapping,
+	//while the 16 bit indices get widened.
+	class TestModel : public Test
+	{
+	public:
+		TestModel();
+		~TestModel();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		static bool WriteScene(const std::string& gltfPath, const std::string& binaryPath);
+		void Reload();
+
+		std::unique_ptr<Model> m_Model;
+		ShaderHandle m_Shader;
+		float m_Rotation;
+	};
+}
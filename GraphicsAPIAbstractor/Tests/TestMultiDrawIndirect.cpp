@@ -0,0 +1,193 @@
+#include "GAAPrecompiledHeader.h"
+#include "TestMultiDrawIndirect.h"
+#include "JobSystem.h"
+#include "imgui/imgui.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace Test
+{
+	TestMultiDrawIndirect::TestMultiDrawIndirect() : m_ProjectionMatrix(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_DrawCount(10000),
+		m_UseMultiDraw(true), m_RecordMilliseconds(0.0f), m_SubmitMilliseconds(0.0f), m_RecordCommands(false), m_CheckDeterminismNextFrame(false), m_DeterminismResult(nullptr)
+	{
+		//Two meshes in one pair of buffers: a quad, then a triangle whose indices start from 0 again, which each draw's baseVertex accounts for.
+		float positions[] =
+		{
+			-0.5f, -0.5f,   0.5f, -0.5f,   0.5f, 0.5f,   -0.5f, 0.5f, //Quad
+			-0.5f, -0.5f,   0.5f, -0.5f,   0.0f, 0.5f                 //Triangle
+		};
+		unsigned int indices[] =
+		{
+			0, 1, 2, 2, 3, 0,
+			0, 1, 2
+		};
+		m_VertexBuffer = ResourceRegistry::VertexBuffers().Create(positions, (unsigned int)sizeof(positions));
+		m_IndexBuffer = ResourceRegistry::IndexBuffers().Create(indices, 9);
+		m_Shader = ResourceRegistry::Shaders().Create("OpenGL/Shaders/MultiDrawIndirect.shader");
+
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		VertexBufferLayout perDrawLayout;
+		perDrawLayout.Push<float>(4);
+		perDrawLayout.Push<unsigned char>(4);
+		static_assert(sizeof(PerDrawData) == 20, "PerDrawData should match the per draw layout above.");
+		m_Batch = std::make_unique<IndirectDrawBatch>(*ResourceRegistry::Get(m_VertexBuffer), *ResourceRegistry::Get(m_IndexBuffer), layout, perDrawLayout);
+
+		unsigned int commandIndices[] =
+		{
+			0, 1, 2, 2, 3, 0,
+			4, 5, 6
+		};
+		m_CommandIndexBuffer = ResourceRegistry::IndexBuffers().Create(commandIndices, 9);
+		m_CommandShader = ResourceRegistry::Shaders().Create("OpenGL/Shaders/ShapeUniforms.shader");
+	}
+
+	TestMultiDrawIndirect::~TestMultiDrawIndirect()
+	{
+		m_Batch.reset();
+		ResourceRegistry::Destroy(m_VertexBuffer);
+		ResourceRegistry::Destroy(m_IndexBuffer);
+		ResourceRegistry::Destroy(m_Shader);
+		ResourceRegistry::Destroy(m_CommandIndexBuffer);
+		ResourceRegistry::Destroy(m_CommandShader);
+	}
+
+	TestMultiDrawIndirect::PerDrawData TestMultiDrawIndirect::GetShape(int index, int columns, float cellSize)
+	{
+		PerDrawData data;
+		data.offsetScale[0] = (index % columns + 0.5f) * cellSize;
+		data.offsetScale[1] = (index / columns + 0.5f) * cellSize;
+		data.offsetScale[2] = cellSize * 0.8f;
+		data.offsetScale[3] = 0.0f;
+		data.color[0] = (unsigned char)(index * 37);
+		data.color[1] = (unsigned char)(index * 73);
+		data.color[2] = (unsigned char)(index * 151);
+		data.color[3] = 255;
+		return data;
+	}
+
+	//A uniform for each of the shape's offset and color, then its draw, recorded on whichever threads the JobSystem has free and merged into destination.
+	void TestMultiDrawIndirect::RecordCommands(Shader& shader, int drawCount, int columns, float cellSize, CommandBuffer& destination)
+	{
+		const VertexBuffer& vertexBuffer = *ResourceRegistry::Get(m_VertexBuffer);
+		const IndexBuffer& indexBuffer = *ResourceRegistry::Get(m_CommandIndexBuffer);
+		destination.SetUniformMat4f(shader, "u_ViewProjection", m_ProjectionMatrix);
+		m_Recorder.Record((size_t)drawCount, [&](size_t index, CommandBuffer& commands) -> uint64_t
+		{
+			PerDrawData data = GetShape((int)index, columns, cellSize);
+			bool isQuad = index % 2 == 0;
+			commands.SetUniform4f(shader, "u_OffsetScale", glm::vec4(data.offsetScale[0], data.offsetScale[1], data.offsetScale[2], data.offsetScale[3]));
+			commands.SetUniform4f(shader, "u_Color", glm::vec4(data.color[0], data.color[1], data.color[2], data.color[3]) / 255.0f);
+			commands.Draw<ShapeLayout>(vertexBuffer, indexBuffer, shader, isQuad ? 0 : 6, isQuad ? 6 : 3);
+			return isQuad ? 0 : 1; //Every quad, then every triangle, each in the order they were recorded.
+		});
+		m_Recorder.Merge(destination);
+	}
+
+	//Records the same shapes twice and compares the merged streams byte for byte. The JobSystem splits the shapes over its threads differently every time,
+	//so anything in the stream that depends on which thread recorded what shows up as a difference.
+	void TestMultiDrawIndirect::CheckDeterminism(Shader& shader, int drawCount, int columns, float cellSize)
+	{
+		CommandBuffer first, second;
+		RecordCommands(shader, drawCount, columns, cellSize, first);
+		RecordCommands(shader, drawCount, columns, cellSize, second);
+		bool identical = first.GetSize() == second.GetSize() && memcmp(first.GetData(), second.GetData(), first.GetSize()) == 0;
+		m_DeterminismResult = identical ? "Identical, byte for byte." : "Different!";
+		if (!identical)
+		{
+			std::cout << "Warning: Recording the same shapes twice gave two different command streams! \n";
+		}
+	}
+
+	void TestMultiDrawIndirect::OnUpdate(float /*deltaTime*/)
+	{
+	}
+
+	void TestMultiDrawIndirect::OnRender()
+	{
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		Shader* shader = ResourceRegistry::Get(m_Shader);
+		Shader* commandShader = ResourceRegistry::Get(m_CommandShader);
+		if (!shader || !commandShader)
+		{
+			return;
+		}
+
+		//Shapes fill the window in a grid, alternating between the two meshes.
+		int drawCount = m_RecordCommands ? std::min(m_DrawCount, s_MaxRecordedDraws) : m_DrawCount;
+		int columns = (int)std::ceil(std::sqrt(drawCount * 960.0f / 540.0f));
+		float cellSize = 960.0f / columns;
+		if (m_RecordCommands)
+		{
+			if (m_CheckDeterminismNextFrame)
+			{
+				CheckDeterminism(*commandShader, drawCount, columns, cellSize);
+				m_CheckDeterminismNextFrame = false;
+			}
+			auto recordStart = std::chrono::steady_clock::now();
+			RecordCommands(*commandShader, drawCount, columns, cellSize, m_Commands);
+			auto executeStart = std::chrono::steady_clock::now();
+			m_Commands.Execute(); //We're on the thread with the context already, so there's no need to hand the commands to another.
+			m_Commands.Reset();
+			auto executeEnd = std::chrono::steady_clock::now();
+
+			m_RecordMilliseconds = std::chrono::duration<float, std::milli>(executeStart - recordStart).count();
+			m_SubmitMilliseconds = std::chrono::duration<float, std::milli>(executeEnd - executeStart).count();
+			return;
+		}
+
+		auto recordStart = std::chrono::steady_clock::now();
+		m_Batch->Clear();
+		for (int i = 0; i < drawCount; i++)
+		{
+			PerDrawData data = GetShape(i, columns, cellSize);
+			bool isQuad = i % 2 == 0;
+			m_Batch->AddDraw(isQuad ? 6 : 3, isQuad ? 0 : 6, isQuad ? 0 : 4, &data);
+		}
+
+		auto submitStart = std::chrono::steady_clock::now();
+		OpenGLRenderer renderer;
+		shader->Bind();
+		shader->SetUniformMat4f("u_ViewProjection", m_ProjectionMatrix);
+		m_Batch->SetMultiDrawEnabled(m_UseMultiDraw);
+		renderer.Draw(*m_Batch, *shader);
+		auto submitEnd = std::chrono::steady_clock::now();
+
+		m_RecordMilliseconds = std::chrono::duration<float, std::milli>(submitStart - recordStart).count();
+		m_SubmitMilliseconds = std::chrono::duration<float, std::milli>(submitEnd - submitStart).count();
+	}
+
+	void TestMultiDrawIndirect::OnImGuiRender()
+	{
+		ImGui::SliderInt("Draws", &m_DrawCount, 1, 100000);
+		ImGui::Checkbox("Record a command buffer in parallel instead", &m_RecordCommands);
+		if (m_RecordCommands)
+		{
+			ImGui::Text("Up to %d draws, a draw call each, recorded over %u threads.", s_MaxRecordedDraws, JobSystem::GetThreadCount());
+			ImGui::Text("Recording %.3f ms, merging %.3f ms, executing %.3f ms (CPU)", m_Recorder.GetRecordMilliseconds(), m_Recorder.GetMergeMilliseconds(), m_SubmitMilliseconds);
+			if (ImGui::Button("Check recording is deterministic"))
+			{
+				m_CheckDeterminismNextFrame = true;
+			}
+			if (m_DeterminismResult)
+			{
+				ImGui::SameLine();
+				ImGui::Text("%s", m_DeterminismResult);
+			}
+			return;
+		}
+		ImGui::Checkbox("Multi draw indirect", &m_UseMultiDraw);
+		if (!IndirectDrawBatch::IsMultiDrawSupported())
+		{
+			ImGui::Text("Not supported by this driver, so every draw is its own call.");
+		}
+		ImGui::Text("%u draw calls for %u draws", m_Batch->GetLastSubmitCallCount(), m_Batch->GetDrawCount());
+		ImGui::Text("Recording %.3f ms, submitting %.3f ms (CPU)", m_RecordMilliseconds, m_SubmitMilliseconds);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Test.h"
+#include "OpenGLRenderer.h"
+#include "VertexBufferLayout.h"
+#include "IndirectDrawBatch.h"
+#include "ParallelCommandRecorder.h"
+#include "ResourceRegistry.h"
+
+namespace Test
+{
+	//Draws thousands of small shapes out of one vertex and index buffer, either all at once through multi draw indirect or one draw call each,
+	//so the CPU cost of the two can be compared. A third way records a command buffer with a draw per shape, spread over the JobSystem by a
+	//ParallelCommandRecorder, which can also be checked for recording the same stream every time, however the shapes were split over the threads.
+	class TestMultiDrawIndirect : public Test
+	{
+	public:
+		TestMultiDrawIndirect();
+		~TestMultiDrawIndirect();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		using ShapeLayout = VertexLayout<Attribute::Float2>; //Position.
+
+		struct PerDrawData
+		{
+			float offsetScale[4]; //x, y, scale and padding.
+			unsigned char color[4];
+		};
+
+		static PerDrawData GetShape(int index, int columns, float cellSize);
+		void RecordCommands(Shader& shader, int drawCount, int columns, float cellSize, CommandBuffer& destination);
+		void CheckDeterminism(Shader& shader, int drawCount, int columns, float cellSize);
+
+		VertexBufferHandle m_VertexBuffer;
+		IndexBufferHandle m_IndexBuffer;
+		ShaderHandle m_Shader;
+		std::unique_ptr<IndirectDrawBatch> m_Batch;
+		glm::mat4 m_ProjectionMatrix;
+		int m_DrawCount;
+		bool m_UseMultiDraw;
+		float m_RecordMilliseconds, m_SubmitMilliseconds;
+
+		//The command buffer path. Its draws have no base vertex, so it has an index buffer of its own with the triangle's indices already offset.
+		IndexBufferHandle m_CommandIndexBuffer;
+		ShaderHandle m_CommandShader;
+		ParallelCommandRecorder m_Recorder;
+		CommandBuffer m_Commands;
+		bool m_RecordCommands;
+		bool m_CheckDeterminismNextFrame;
+		const char* m_DeterminismResult; //Null until the first check.
+
+		//Each draw is 3 commands and about 300 bytes, recorded once per thread and again merged, all of it in frame memory, and a determinism check triples that.
+		static constexpr int s_MaxRecordedDraws = 10000;
+	};
+}
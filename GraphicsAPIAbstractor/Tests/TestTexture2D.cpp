@@ -9,7 +9,7 @@ namespace Test
     TestTexture2D::TestTexture2D() :
         m_ProjectionMatrix(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)),
         m_ViewMatrix(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0))),
-        m_TranslationA(200, 200, 0), m_TranslationB(400, 200, 0)
+        m_TranslationA(200, 200, 0), m_TranslationB(400, 200, 0), m_Visibility{ 0 }, m_VisibleCount(0)
     {
         float positions[] =
         {
@@ -29,13 +29,10 @@ namespace Test
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); //We're saying that for the source, take the source's Alpha, and when we try to render something on top of that, take 1 - the source Alpha = the destination alpha. 
 
-        m_VertexArrayObject = std::make_unique<VertexArray>();
-        m_VertexBuffer = std::make_unique<VertexBuffer>(positions, 4 * 4 * sizeof(float));
-        VertexBufferLayout layout;
-        layout.Push<float>(2);
-        layout.Push<float>(2);
-        m_VertexArrayObject->AddBuffer(*m_VertexBuffer, layout);
-        m_IndexBuffer = std::make_unique<IndexBuffer>(indices, 6);
+        //No VertexArray of our own. The renderer gets one for QuadLayout from the VertexArrayCache when we draw.
+        m_VertexBuffer = ResourceRegistry::VertexBuffers().Create(positions, 4 * 4 * sizeof(float));
+        static_assert(QuadLayout::Stride == 4 * sizeof(float), "The quad layout should match the positions above.");
+        m_IndexBuffer = ResourceRegistry::IndexBuffers().Create(indices, 6);
         //Below we have our projection matrix. Anything bigger than what we specified for the bounds will not be rendered! 
         //Thus, ensure the positions above are within the bounds specified.
         //These positions below when multiplied with the above positions will be turned into that 1 to 1 normalized coordinate space.
@@ -46,22 +43,33 @@ namespace Test
 
         //We can see that we have successfully converted our vertex positions into that -1 to 1 space.
         //That is what projection does in both 2D and 3D, orthographic or perspective. All you're doing is telling your computer how to convert from whatever space you're dealing with (what you give it) to that -1 to 1 space.
-        m_Shader = std::make_unique<Shader>("OpenGL/Shaders/Basic.shader");
-        m_Shader->Bind();
-        m_Shader->SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
+        m_Shader = ResourceRegistry::Shaders().Create("OpenGL/Shaders/Basic.shader");
+        Shader* shader = ResourceRegistry::Get(m_Shader);
+        shader->IsCompatibleWith<QuadLayout>();
+        shader->Bind();
+        shader->SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
 
-        m_Texture = std::make_unique<Texture>("Resources/Textures/PrismEngineLogo.png");
-        m_SecondTexture = std::make_unique<Texture>("Resources/Textures/AeternumGameLogo.png");
+        m_Texture = ResourceRegistry::Textures().Create("Resources/Textures/PrismEngineLogo.png");
+        m_SecondTexture = ResourceRegistry::Textures().Create("Resources/Textures/AeternumGameLogo.png");
         // texture.Bind();
          //shader.SetUniform1i("u_Texture", 0); //0 because we bound our texture to slot 0 in Texture.cpp.
                                               //Texture Coordinates tell our geometry which part of the texture to sample from. Our Fragment/Pixel shader goes through and rasterizes the rectangle,  
                                               //The fragment shader is responsible for the color of each pixel. We need to somehow tell the fragment shader to sample from the texture pixels to decide which color the pixel on the geometry will be.
                                               //We are to specify for each vertex we have on our rectangle, what area of the texture it should be. The frag shader will turn interpolate between that so that if we're rendering a pixel halfway between 2indices, it will choose a coordinate that is halfway through as well.  
-        m_Shader->SetUniform1i("u_Texture", 0);
+        shader->SetUniform1i("u_Texture", 0);
+
+        m_Culler.Add(BoundingBox());
+        m_Culler.Add(BoundingBox());
     }
 
     TestTexture2D::~TestTexture2D()
     {
+        //These only retire once the frames that may still be drawing with them have completed.
+        ResourceRegistry::Destroy(m_VertexBuffer);
+        ResourceRegistry::Destroy(m_IndexBuffer);
+        ResourceRegistry::Destroy(m_Shader);
+        ResourceRegistry::Destroy(m_Texture);
+        ResourceRegistry::Destroy(m_SecondTexture);
     }
 
     void TestTexture2D::OnUpdate(float deltaTime)
@@ -73,27 +81,46 @@ namespace Test
         glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
+        VertexBuffer* vertexBuffer = ResourceRegistry::Get(m_VertexBuffer);
+        IndexBuffer* indexBuffer = ResourceRegistry::Get(m_IndexBuffer);
+        Shader* shader = ResourceRegistry::Get(m_Shader);
+        Texture* texture = ResourceRegistry::Get(m_Texture);
+        Texture* secondTexture = ResourceRegistry::Get(m_SecondTexture);
+        if (!vertexBuffer || !indexBuffer || !shader || !texture || !secondTexture)
+        {
+            return;
+        }
+
+        //The quads are 100 pixels across, centered on their translations. Anything outside the projection's bounds would be clipped by the GPU anyway,
+        //but culling it here means it never costs a draw call at all.
+        glm::vec3 halfSize(50.0f, 50.0f, 0.0f);
+        m_Culler.Set(0, BoundingBox{ m_TranslationA - halfSize, m_TranslationA + halfSize });
+        m_Culler.Set(1, BoundingBox{ m_TranslationB - halfSize, m_TranslationB + halfSize });
+        m_VisibleCount = m_Culler.Cull(m_ProjectionMatrix * m_ViewMatrix, m_Visibility, CullingVolume::Box);
+
         OpenGLRenderer renderer;
-        m_Texture->Bind();
+        texture->Bind();
+        if (FrustumCuller::IsVisible(m_Visibility, 0))
         {
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationA);
             //MVP - Model View Projection Matrix. Remember that this is in reverse because OpenGL's memory layout in its shader and GPU is column major, and that is why glm does this for us due to OpenGL.
             glm::mat4 mvp = m_ProjectionMatrix * m_ViewMatrix * model;
-            m_Shader->Bind();
-            m_Texture->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
-            m_Shader->SetUniform1i("u_Texture", 0);
-            renderer.Draw(*m_VertexArrayObject, *m_IndexBuffer, *m_Shader);
+            shader->Bind();
+            texture->Bind();
+            shader->SetUniformMat4f("u_MVP", mvp);
+            shader->SetUniform1i("u_Texture", 0);
+            renderer.Draw<QuadLayout>(*vertexBuffer, *indexBuffer, *shader);
         }
 
+        if (FrustumCuller::IsVisible(m_Visibility, 1))
         {
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationB);
             glm::mat4 mvp = m_ProjectionMatrix * m_ViewMatrix * model;
-            m_Shader->Bind();
-            m_SecondTexture->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
-            m_Shader->SetUniform1i("u_Texture", 0);
-            renderer.Draw(*m_VertexArrayObject, *m_IndexBuffer, *m_Shader);
+            shader->Bind();
+            secondTexture->Bind();
+            shader->SetUniformMat4f("u_MVP", mvp);
+            shader->SetUniform1i("u_Texture", 0);
+            renderer.Draw<QuadLayout>(*vertexBuffer, *indexBuffer, *shader);
         }
     }
 
@@ -101,5 +128,6 @@ namespace Test
     {
         ImGui::SliderFloat3("Translation A", &m_TranslationA.x, 0.0f, 960.0f);
         ImGui::SliderFloat3("Translation B", &m_TranslationB.x, 0.0f, 960.0f);
+        ImGui::Text("%u of 2 quads drawn", m_VisibleCount);
     }
 }
\ No newline at end of file
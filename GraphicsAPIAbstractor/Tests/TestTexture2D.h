@@ -4,6 +4,8 @@
 #include "OpenGLRenderer.h"
 #include "VertexBufferLayout.h"
 #include "Texture.h"
+#include "ResourceRegistry.h"
+#include "FrustumCuller.h"
 
 namespace Test
 {
@@ -18,14 +20,18 @@ namespace Test
 		void OnImGuiRender() override;
  
 	private:
-		std::unique_ptr<VertexArray> m_VertexArrayObject;
-		std::unique_ptr<VertexBuffer> m_VertexBuffer;
-		std::unique_ptr<IndexBuffer> m_IndexBuffer;
-		std::unique_ptr<Shader> m_Shader;
-		std::unique_ptr<Texture> m_Texture;
-		std::unique_ptr<Texture> m_SecondTexture;
+		using QuadLayout = VertexLayout<Attribute::Float2, Attribute::Float2>; //Position, texture coordinates.
+
+		VertexBufferHandle m_VertexBuffer;
+		IndexBufferHandle m_IndexBuffer;
+		ShaderHandle m_Shader;
+		TextureHandle m_Texture;
+		TextureHandle m_SecondTexture;
 		glm::mat4 m_ProjectionMatrix, m_ViewMatrix;
 		glm::vec3 m_TranslationA, m_TranslationB;
+		FrustumCuller m_Culler; //One box per quad, so a quad dragged off screen isn't drawn.
+		unsigned char m_Visibility[1];
+		unsigned int m_VisibleCount;
 		float m_ClearColor[4];
 	};
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "GAAPrecompiledHeader.h"
+#include "TestTextureStreaming.h"
+#include "imgui/imgui.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace Test
+{
+	TestTextureStreaming::TestTextureStreaming() : m_Streamer(4 * 1024 * 1024), m_Visible{ true, true, true }, m_QuadSize(64.0f), m_BudgetInMegabytes(4.0f),
+		m_ProjectionMatrix(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+	{
+		//A unit quad, scaled to the requested size when drawn.
+		float positions[] =
+		{
+			-0.5f, -0.5f, 0.0f, 0.0f,
+			 0.5f, -0.5f, 1.0f, 0.0f,
+			 0.5f,  0.5f, 1.0f, 1.0f,
+			-0.5f,  0.5f, 0.0f, 1.0f
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		m_VertexBuffer = ResourceRegistry::VertexBuffers().Create(positions, (unsigned int)sizeof(positions));
+		m_IndexBuffer = ResourceRegistry::IndexBuffers().Create(indices, 6);
+		m_Shader = ResourceRegistry::Shaders().Create("OpenGL/Shaders/Basic.shader");
+		ResourceRegistry::Get(m_Shader)->IsCompatibleWith<QuadLayout>();
+
+		const char* paths[s_QuadCount] = { "Resources/Textures/PrismEngineLogo.png", "Resources/Textures/AeternumGameLogo.png", "Resources/Textures/Container.jpg" };
+		for (unsigned int i = 0; i < s_QuadCount; i++)
+		{
+			m_StreamingIDs[i] = m_Streamer.RegisterTexture(paths[i]);
+		}
+	}
+
+	TestTextureStreaming::~TestTextureStreaming()
+	{
+		ResourceRegistry::Destroy(m_VertexBuffer);
+		ResourceRegistry::Destroy(m_IndexBuffer);
+		ResourceRegistry::Destroy(m_Shader);
+	}
+
+	void TestTextureStreaming::OnRender()
+	{
+		VertexBuffer* vertexBuffer = ResourceRegistry::Get(m_VertexBuffer);
+		IndexBuffer* indexBuffer = ResourceRegistry::Get(m_IndexBuffer);
+		Shader* shader = ResourceRegistry::Get(m_Shader);
+		if (!vertexBuffer || !indexBuffer || !shader)
+		{
+			return;
+		}
+
+		//Requests first, then one Update, then the draws, so every texture is bound at the mips this frame asked for.
+		for (unsigned int i = 0; i < s_QuadCount; i++)
+		{
+			if (m_Visible[i])
+			{
+				m_Streamer.RequestScreenSize(m_StreamingIDs[i], m_QuadSize);
+			}
+		}
+		m_Streamer.SetMemoryBudget((size_t)(m_BudgetInMegabytes * 1024.0f * 1024.0f));
+		m_Streamer.Update();
+
+		OpenGLRenderer renderer;
+		shader->Bind();
+		shader->SetUniform1i("u_Texture", 0);
+		for (unsigned int i = 0; i < s_QuadCount; i++)
+		{
+			if (!m_Visible[i])
+			{
+				continue;
+			}
+			float spacing = 960.0f / s_QuadCount;
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(spacing * (i + 0.5f), 270.0f, 0.0f)) * glm::scale(glm::mat4(1.0f), glm::vec3(m_QuadSize, m_QuadSize, 1.0f));
+			shader->SetUniformMat4f("u_MVP", m_ProjectionMatrix * model);
+			m_Streamer.Bind(m_StreamingIDs[i], 0);
+			renderer.Draw<QuadLayout>(*vertexBuffer, *indexBuffer, *shader);
+		}
+	}
+
+	void TestTextureStreaming::OnImGuiRender()
+	{
+		ImGui::SliderFloat("Quad Size", &m_QuadSize, 4.0f, 1024.0f, "%.0f px");
+		ImGui::SliderFloat("Budget", &m_BudgetInMegabytes, 0.25f, 64.0f, "%.2f MB");
+		ImGui::Text("Resident %.2f of %.2f MB", m_Streamer.GetResidentMemory() / (1024.0f * 1024.0f), m_Streamer.GetMemoryBudget() / (1024.0f * 1024.0f));
+		for (unsigned int i = 0; i < s_QuadCount; i++)
+		{
+			ImGui::PushID((int)i);
+			ImGui::Checkbox("##Visible", &m_Visible[i]);
+			ImGui::SameLine();
+			ImGui::Text("Texture %u: top mip %u, %.1f KB", i, m_Streamer.GetResidentTopMip(m_StreamingIDs[i]), m_Streamer.GetTextureResidentMemory(m_StreamingIDs[i]) / 1024.0f);
+			ImGui::PopID();
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Test.h"
+#include "OpenGLRenderer.h"
+#include "VertexBufferLayout.h"
+#include "ResourceRegistry.h"
+#include "TextureStreamer.h"
+
+namespace Test
+{
+	//A row of quads, each with a streamed texture, drawn at a size you pick. Growing them raises their top mips a level and an upload at a time, shrinking them
+	//drops mips straight away, and hiding one leaves its chain to be evicted once the budget is needed elsewhere.
+	class TestTextureStreaming : public Test
+	{
+	public:
+		TestTextureStreaming();
+		~TestTextureStreaming();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		using QuadLayout = VertexLayout<Attribute::Float2, Attribute::Float2>; //Position, texture coordinates.
+
+		static constexpr unsigned int s_QuadCount = 3;
+
+		VertexBufferHandle m_VertexBuffer;
+		IndexBufferHandle m_IndexBuffer;
+		ShaderHandle m_Shader;
+		TextureStreamer m_Streamer;
+		unsigned int m_StreamingIDs[s_QuadCount];
+		bool m_Visible[s_QuadCount];
+		float m_QuadSize; //In pixels.
+		float m_BudgetInMegabytes;
+		glm::mat4 m_ProjectionMatrix;
+	};
+}